@@ -0,0 +1,178 @@
+#ifndef bench_hpp_INCLUDED
+#define bench_hpp_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <common.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * # Benchmarks.
+ *
+ * Every source of `benchmarks` is one suite built by `./nob bench` with the
+ * optimizations (`-O3 -march=native`) into its own binary, so this header
+ * is included once per program and replaces the global `operator new`
+ * to count the allocations. Buffers of the values are taken by `malloc`
+ * (@see Value_Pool), they are counted by the pool and added to the ones
+ * of `operator new`.
+ *
+ * ```cpp
+ * int main(int argc, char **argv) {
+ *     bench::Suite suite { "table", argc, argv };
+ *
+ *     suite.run("insert_row", [&] (size_t ops) {
+ *         for (size_t i = 0; i < ops; i++) table.insert_row(row);
+ *         return ops; // rows
+ *     });
+ *
+ *     return suite.finish();
+ * }
+ * ```
+ *
+ * Results are printed and written as JSON to the path of the first
+ * argument, the second one selects benchmarks by the name prefix.
+ * Version of the sources is taken from `TOAD_DB_VERSION` (set by
+ * `./nob bench` to `git describe --always --dirty`).
+ **/
+namespace toad_db::bench {
+    inline std::atomic<size_t> allocations { 0 };
+    inline std::atomic<size_t> allocated_bytes { 0 };
+
+    /**
+     * Allocations of `operator new` and of the value pool.
+     **/
+    inline size_t all_allocations(void) { return allocations.load() + Value_Pool::mallocs(); }
+    inline size_t all_allocated_bytes(void) { return allocated_bytes.load() + Value_Pool::malloc_bytes(); }
+
+    /**
+     * Min time of the measured run, count of operations is doubled until it's reached.
+     **/
+    constexpr double Min_Time_Ns = 2e8;
+
+    struct Result {
+        std::string name;
+
+        size_t ops;
+        size_t rows;
+        double ns;
+
+        size_t allocations;
+        size_t allocated_bytes;
+
+        double ns_per_op(void) const { return ns / ops; }
+        double rows_per_s(void) const { return rows / (ns / 1e9); }
+    };
+
+    /**
+     * Value is considered used, so computation of it isn't optimized out.
+     **/
+    template<typename T>
+    void keep(const T &value) {
+        asm volatile("" : : "r"(&value) : "memory");
+    }
+
+    class Suite {
+        public:
+            /**
+             * @param argv - `[<output.json> [<name prefix>]]`.
+             **/
+            Suite(std::string name, int argc, char **argv): _name(std::move(name)) {
+                if (argc > 1) _output = argv[1];
+                if (argc > 2) _filter = argv[2];
+            }
+
+            /**
+             * Measure `fn(ops)` which performs `ops` operations and returns
+             * count of processed rows.
+             **/
+            template<typename Fn>
+            void run(const std::string &name, Fn &&fn) {
+                if (!name.starts_with(_filter)) return;
+
+                // Warm up caches and lazily built state.
+                fn(1);
+
+                for (size_t ops = 1;; ops *= 2) {
+                    const size_t allocations_before = all_allocations(), bytes_before = all_allocated_bytes();
+                    const auto start = std::chrono::steady_clock::now();
+
+                    const size_t rows = fn(ops);
+
+                    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                    if (ns < Min_Time_Ns) continue;
+
+                    _results.push_back({ name, ops, rows, ns, all_allocations() - allocations_before,
+                                         all_allocated_bytes() - bytes_before });
+                    print(_results.back());
+                    return;
+                }
+            }
+
+            /**
+             * Write the results.
+             *
+             * @return exit code of the suite.
+             **/
+            int finish(void) {
+                if (_output.empty()) return 0;
+
+                std::ofstream out { _output };
+                if (!out) {
+                    std::cerr << "Can't write results to `" << _output << "`" << std::endl;
+                    return 1;
+                }
+
+                const char *version = std::getenv("TOAD_DB_VERSION");
+                out << "{\"suite\": \"" << _name << "\", \"version\": \"" << (version ? version : "unknown")
+                    << "\", \"benchmarks\": [";
+                for (size_t i = 0; i < _results.size(); i++) {
+                    const Result &result = _results[i];
+
+                    out << (i ? ", " : "") << "{\"name\": \"" << result.name << "\", \"ops\": " << result.ops
+                        << ", \"rows\": " << result.rows << ", \"ns\": " << result.ns
+                        << ", \"ns_per_op\": " << result.ns_per_op() << ", \"rows_per_s\": " << result.rows_per_s()
+                        << ", \"allocations_per_op\": " << (double)result.allocations / result.ops
+                        << ", \"allocated_bytes_per_op\": " << (double)result.allocated_bytes / result.ops << "}";
+                }
+                out << "]}\n";
+
+                return out ? 0 : 1;
+            }
+
+        private:
+            std::string _name;
+            std::string _output;
+            std::string _filter;
+            std::vector<Result> _results;
+
+            void print(const Result &result) const {
+                std::cout << _name << "/" << result.name << ": " << result.ns_per_op() << " ns/op, "
+                          << result.rows_per_s() << " rows/s, "
+                          << (double)result.allocations / result.ops << " allocs/op, "
+                          << (double)result.allocated_bytes / result.ops << " bytes/op" << std::endl;
+            }
+    };
+}
+
+void* operator new(std::size_t size) {
+    toad_db::bench::allocations.fetch_add(1, std::memory_order_relaxed);
+    toad_db::bench::allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void *ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+#endif // bench_hpp_INCLUDED
@@ -0,0 +1,38 @@
+#include <bench.hpp>
+#include <parser.hpp>
+#include <string>
+
+using namespace toad_db;
+
+/**
+ * `Syntax_Tree::parse` of the generated scripts of different statements.
+ **/
+int main(int argc, char **argv) {
+    bench::Suite suite { "parser", argc, argv };
+
+    const size_t stmts = 10000;
+    std::string inserts, queries, definitions;
+
+    for (size_t i = 0; i < stmts; i++) {
+        const std::string n = std::to_string(i);
+
+        inserts += "Groups << { title: \"admin_" + n + "\", level: " + std::to_string(i % 7) + " }"
+                   " << { title: \"user;" + n + "\", level: 1 };\n";
+
+        queries += "(@Users<name, group_key>{name, uk} * @Groups<title, key>{title, gk}"
+                   " ?=> gk == uk && level > " + std::to_string(i % 7) + ")<name, title>;\n";
+
+        definitions += i % 2 ? "domain Vector_" + n + " := x(F32) & y(F32) & z(F32);\n"
+                             : "table Values_" + n + " {\n   id(Key),\n   value(Str): not_null?,\n};\n";
+    }
+
+    for (auto &[name, script]: { std::pair { "parse_inserts", &inserts }, std::pair { "parse_queries", &queries },
+                                 std::pair { "parse_definitions", &definitions } }) {
+        suite.run(name, [&] (size_t ops) {
+            for (size_t i = 0; i < ops; i++) bench::keep(parser::Syntax_Tree::parse(*script));
+            return ops * stmts;
+        });
+    }
+
+    return suite.finish();
+}
@@ -0,0 +1,176 @@
+#include <arena.hpp>
+#include <bench.hpp>
+#include <common.hpp>
+#include <sstream>
+#include <string>
+#include <table_view.hpp>
+#include <vector>
+
+using namespace toad_db;
+using namespace toad_db::types;
+
+/**
+ * Field access, assignment, insertion, scans and formatting of the rows.
+ **/
+int main(int argc, char **argv) {
+    bench::Suite suite { "table", argc, argv };
+
+    auto domains = Domain::default_domains();
+    domains.add({ "Person", Domain::Complex_Variant::Mul, {
+                    { "name", domains["Str"] }, { "age", domains["U8"] }, { "score", domains["I32"] } } });
+
+    Domain_Value<> person { &domains("Person") }, other { &domains("Person") };
+    person.view()["name"].set_string("Vlad");
+    person.view()["age"].set_basic<U8>(20);
+    person.view()["score"].set_basic<I32>(100);
+
+    suite.run("domain_view_field", [&] (size_t ops) {
+        Domain_View view = person.view();
+        for (size_t i = 0; i < ops; i++) {
+            bench::keep(view["age"].unwrap_basic<U8>());
+            bench::keep(view["score"].unwrap_basic<I32>());
+        }
+        return ops;
+    });
+
+    suite.run("assign", [&] (size_t ops) {
+        Domain_View from = person.view(), to = other.view();
+        for (size_t i = 0; i < ops; i++) {
+            to.assign(from);
+            bench::keep(*to.data);
+        }
+        return ops;
+    });
+
+    suite.run("domain_value_str", [&] (size_t ops) {
+        for (size_t i = 0; i < ops; i++) {
+            Domain_Value<> value { &domains("Str") };
+            value.view().set_string("user_name");
+            bench::keep(*value.view().data);
+        }
+        return ops;
+    });
+
+    suite.run("domain_value_date_arena", [&] (size_t ops) {
+        Arena arena { };
+        for (size_t i = 0; i < ops; i++) {
+            Domain_Value<> value { &domains("Date"), arena };
+            value.view()["year"].set_basic<U16>(2024);
+            bench::keep(*value.view().data);
+
+            if (i % 1024 == 1023) arena.reset();
+        }
+        return ops;
+    });
+
+    suite.run("domain_value_move", [&] (size_t ops) {
+        std::vector<Domain_Value<>> values;
+        for (size_t i = 0; i < ops; i++) values.push_back(Domain_Value<> { person });
+
+        bench::keep(values);
+        return ops;
+    });
+
+    Domain_Value<> name { &domains("Str") }, age { &domains("I32") };
+    name.view().set_string("user_name");
+    age.view().set_basic<I32>(30);
+
+    suite.run("insert_row", [&] (size_t ops) {
+        Table table { { "name", &domains("Str") }, { "age", &domains("I32") } };
+        for (size_t i = 0; i < ops; i++) table.insert_row({ name.view(), age.view() });
+
+        bench::keep(table);
+        return ops;
+    });
+
+    // Every 4th row has the name longer than the column, like a dump with the bad rows.
+    Domain_Value<> short_name { &domains("Text") }, long_name { &domains("Text") };
+    short_name.view().set_string("user_name");
+    long_name.view().set_string(std::string(100, 'x'));
+
+    Table strict { { "name", &domains("Str") }, { "age", &domains("I32") } };
+    const std::vector<Domain_View> good { short_name.view(), age.view() }, bad { long_name.view(), age.view() };
+
+    suite.run("insert_row_rejected", [&] (size_t ops) {
+        size_t failed = 0;
+        for (size_t i = 0; i < ops; i++) {
+            try {
+                strict.insert_row(i % 4 ? good : bad);
+            } catch (Table::Failed_To_Insert_Row&) {
+                failed++;
+            }
+        }
+        bench::keep(failed);
+        return ops;
+    });
+
+    suite.run("try_insert_row_rejected", [&] (size_t ops) {
+        Error_Log errors;
+        for (size_t i = 0; i < ops; i++) {
+            if (auto inserted = strict.try_insert_row(i % 4 ? good : bad); !inserted) errors.record(i, inserted.error());
+        }
+        bench::keep(errors);
+        return ops;
+    });
+
+    Table table { { "name", &domains("Str") }, { "age", &domains("I32") } };
+    for (size_t i = 0; i < 100000; i++) {
+        age.view().set_basic<I32>((I32)i);
+        table.insert_row({ name.view(), age.view() });
+    }
+
+    suite.run("scan_table_iter", [&] (size_t ops) {
+        const Table &rows = table;
+
+        for (size_t i = 0; i < ops; i++) {
+            I64 sum = 0;
+            for (const auto &row: rows) {
+                auto field = row.begin();
+                sum += (*++field).unwrap_basic<I32>();
+            }
+            bench::keep(sum);
+        }
+        return ops * rows.size();
+    });
+
+    // Values of the dictionary are interned and looked up without allocations, big ones too.
+    Dictionary names { &domains("BigText") };
+    Domain_Value<> text { &domains("BigText") };
+    for (size_t i = 0; i < 16; i++) {
+        text.view().set_string("text_" + std::to_string(i));
+        names.try_intern(text.view());
+    }
+
+    suite.run("dictionary_intern_big", [&] (size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(names.try_intern(text.view()));
+        return ops;
+    });
+
+    suite.run("dictionary_find_big", [&] (size_t ops) {
+        for (size_t i = 0; i < ops; i++) bench::keep(names.find(std::string_view { "text_7" }));
+        return ops;
+    });
+
+    Table small { { "name", &domains("Str") }, { "age", &domains("I32") } };
+    for (size_t i = 0; i < 1000; i++) small.insert_row({ name.view(), age.view() });
+
+    suite.run("display_table_view", [&] (size_t ops) {
+        for (size_t i = 0; i < ops; i++) {
+            std::ostringstream out;
+            out << make_table_cview(small);
+            bench::keep(out);
+        }
+        return ops * small.size();
+    });
+
+    suite.run("display_table", [&] (size_t ops) {
+        for (size_t i = 0; i < ops; i++) {
+            std::ostringstream out;
+            out << small;
+            bench::keep(out);
+        }
+        return ops * small.size();
+    });
+
+    return suite.finish();
+}
@@ -1,5 +1,6 @@
 #include <common.hpp>
 #include <iostream>
+#include <utility>
 
 int main() {
     using namespace toad_db::types;
@@ -62,6 +63,15 @@ int main() {
     view["v3"]["z"].set_basic<F32>(6.5);
     std::cout << "vector: " << to_string(view) << std::endl;
 
+    // Moved-from value is empty until other value is assigned to it.
+    toad_db::Domain_Value text { &domains("Text") };
+    text.view().set_string("big value");
+    toad_db::Domain_Value moved { std::move(text) }, copied { text };
+    std::cout << "moved: `" << to_string(moved.view()) << "`, moved-from is "
+              << (text.view().domain == nullptr && copied.view().domain == nullptr ? "empty" : "NOT empty");
+
+    text = moved;
+    std::cout << ", assigned: `" << to_string(text.view()) << "`." << std::endl;
 
     return 0;
 }
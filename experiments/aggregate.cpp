@@ -0,0 +1,95 @@
+#include <aggregate.hpp>
+#include <chrono>
+#include <common.hpp>
+#include <iostream>
+
+using namespace toad_db;
+using namespace toad_db::types;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double seconds(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(void) {
+    auto domains = Domain::default_domains();
+    const size_t rows = 1 << 22;
+
+    Table users { { "key", &domains("Key") }, { "group_key", &domains("Key") },
+                  { "level", &domains("U8") }, { "score", &domains("F64") },
+                  { "month", &domains("Month") } };
+
+    const size_t group_key = users.column_offset(1), level = users.column_offset(2),
+                 score = users.column_offset(3);
+
+    U8 *row = users.append_rows(rows);
+    for (size_t i = 0; i < rows; i++, row += users.row_size()) {
+        *(U64*)row = i;
+        *(U64*)(row + group_key) = (i * 2654435761u) % 100000;
+        row[level] = (U8)(i % 7);
+        *(F64*)(row + score) = (F64)(i % 1000) / 10;
+        Domain_View { &domains("Month"), row + users.column_offset(4) }[i % 3 ? "feb" : "jan"];
+    }
+
+    const std::vector<Group_By::Aggregate> aggregates = {
+        { Group_By::Function::Count, "",      "users" },
+        { Group_By::Function::Sum,   "level", "levels" },
+        { Group_By::Function::Min,   "score", "min_score" },
+        { Group_By::Function::Max,   "level", "max_level" },
+        { Group_By::Function::Avg,   "score", "avg_score" },
+    };
+
+    Engine engine { };
+
+    std::cout << "by month:" << std::endl;
+    Group_By by_month { domains, users, { "month" }, aggregates };
+    std::cout << by_month.run(engine) << std::endl;
+
+    std::cout << "total:" << std::endl;
+    Group_By total { domains, users, { }, aggregates };
+    std::cout << total.run(engine) << std::endl;
+
+    Group_By in_memory { domains, users, { "group_key" }, aggregates };
+    Group_By spilling { domains, users, { "group_key" }, aggregates, { .memory_budget = 1 << 20 } };
+
+    std::vector<Table> results;
+    const double in_memory_sec = seconds([&] { results.push_back(in_memory.run(engine)); });
+    const double spilling_sec = seconds([&] { results.push_back(spilling.run(engine)); });
+
+    std::cout << "by group_key, " << rows << " rows, " << results[0].size() << " groups:" << std::endl
+              << "  in memory: " << rows / in_memory_sec << " rows/sec" << std::endl
+              << "  with 1MiB budget: " << rows / spilling_sec << " rows/sec, "
+              << spilling.stats().spills << " spills, "
+              << spilling.stats().spilled_entries << " spilled entries, "
+              << spilling.stats().repartitions << " repartitions" << std::endl;
+
+    // Hash tables of the merge are freed partition by partition, so the peak is about the budget, not the groups.
+    std::cout << "  peak of hash tables: in memory " << in_memory.stats().peak_bytes << " bytes, with 1MiB budget "
+              << spilling.stats().peak_bytes << " bytes"
+              << (spilling.stats().peak_bytes <= 3 * (1 << 20) ? " (within budget)" : " (OVER BUDGET)") << std::endl;
+
+    // Partitions over the budget are split again by the next bits of the hash.
+    Group_By tiny { domains, users, { "group_key" }, aggregates, { .memory_budget = 64 << 10, .partitions = 4 } };
+    results.push_back(tiny.run(engine));
+    std::cout << "  with 64KiB budget and 4 partitions: " << tiny.stats().repartitions << " repartitions, peak "
+              << tiny.stats().peak_bytes << " bytes"
+              << (tiny.stats().peak_bytes <= 3 * (64 << 10) ? " (within budget)" : " (OVER BUDGET)") << std::endl;
+
+    /* Same groups must have the same states. */
+    const Table &a = results[0], &b = results[1], &c = results[2];
+    auto sum_of = [](const Table &table, size_t column) {
+        U64 sum = 0;
+        for (size_t i = 0; i < table.size(); i++) sum += *(U64*)(table.row_data(i) + table.column_offset(column));
+        return sum;
+    };
+    std::cout << "  same result: " << std::boolalpha
+              << (a.size() == b.size() && sum_of(a, 0) == sum_of(b, 0) && sum_of(a, 1) == sum_of(b, 1)
+                  && sum_of(a, 2) == sum_of(b, 2))
+              << ", " << (a.size() == c.size() && sum_of(a, 0) == sum_of(c, 0) && sum_of(a, 1) == sum_of(c, 1)
+                          && sum_of(a, 2) == sum_of(c, 2)) << std::endl;
+
+    return 0;
+}
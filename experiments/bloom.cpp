@@ -0,0 +1,121 @@
+#include <bloom.hpp>
+#include <chrono>
+#include <common.hpp>
+#include <iostream>
+#include <parser.hpp>
+#include <planner.hpp>
+#include <string>
+#include <vector>
+#include <vectorized.hpp>
+
+using namespace toad_db;
+using namespace toad_db::types;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double ms(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(void) {
+    auto domains = Domain::default_domains();
+    Engine engine { };
+
+    Table accounts { { "uk", &domains("Key") }, { "external_id", &domains("U64") }, { "name", &domains("Str") } };
+    Domain &name_domain = domains("Str");
+
+    // Random external ids and user names, nothing is ordered, so zone maps don't help.
+    const size_t rows = 16 * Table::Segment_Rows + 1000;
+    U64 random = 42;
+    std::vector<U64> ids;
+    std::vector<std::string> names;
+
+    U8 *row = accounts.append_rows(rows);
+    for (size_t i = 0; i < rows; i++, row += accounts.row_size()) {
+        random = random * 6364136223846793005ull + 1442695040888963407ull;
+
+        std::string name = "user_" + std::to_string(random >> 20);
+        Domain::set_counter(row + accounts.column_offset(2), name_domain.array.capacity, name.size());
+        std::memcpy(row + accounts.column_offset(2) + Domain::counter_size_of(name_domain.array.capacity),
+                    name.data(), name.size());
+
+        *(U64*)(row + accounts.column_offset(0)) = i;
+        *(U64*)(row + accounts.column_offset(1)) = random >> 4;
+
+        if (i % 100000 == 7) {
+            ids.push_back(random >> 4);
+            names.push_back(name);
+        }
+    }
+
+    Segment_Blooms blooms { accounts };
+    blooms.add_column(1);
+    blooms.add_column(2);
+    const double build_ms = ms([&] { blooms.update(); });
+
+    std::cout << blooms.sealed(1) << " segments of " << accounts.size() << " rows, filters of 2 columns built in "
+              << build_ms << " ms, " << blooms.bytes() << " bytes" << std::endl;
+
+    const std::vector<std::string> predicates {
+        "external_id == " + std::to_string(ids[5]),
+        "name == \"" + names[3] + "\"",
+        "name == \"nobody\" || external_id == " + std::to_string(ids[1]),
+        "name != \"nobody\" && uk < 10",
+    };
+
+    for (auto &text: predicates) {
+        auto tree = parser::Syntax_Tree::parse(text + ";");
+        auto &predicate = tree->stmts[0].call_data.root;
+
+        std::vector<size_t> expected, selected;
+        vectorized::Batch_Filter::Stats stats { };
+
+        const double plain_ms = ms([&] { expected = vectorized::Batch_Filter { accounts, predicate }.filter(engine); });
+        const double bloom_ms = ms([&] {
+            selected = vectorized::Batch_Filter { accounts, predicate, { nullptr, nullptr, &blooms } }.filter(engine, { }, &stats);
+        });
+
+        std::cout << text << ": " << plain_ms << " ms all segments, " << bloom_ms << " ms with blooms (skipped "
+                  << stats.bloom_skipped_blocks << " of " << stats.bloom_blocks << ", false positives "
+                  << stats.bloom_false_positives << "), rows " << expected.size()
+                  << (expected == selected ? ", same rows" : ", DIFFERENT rows") << std::endl;
+    }
+
+    // Few looked up ids are probed only in the segments which may have them.
+    Table lookups { { "id", &domains("U64") } };
+    for (size_t i = 0; i < 3; i++) *(U64*)lookups.append_rows(1) = ids[2 * i];
+
+    plan::Planner planner { };
+    planner.add_table("Accounts", accounts);
+    planner.add_table("Lookups", lookups);
+
+    const std::string join = "(Lookups * Accounts ?=> id == external_id)<uk, name>";
+    const size_t plain_rows = planner.plan(join + ";").execute(engine).size();
+
+    // Filters are built by the first query over the table.
+    planner.add_bloom_filter("Accounts", "external_id");
+    planner.add_bloom_filter("Accounts", "name");
+    const size_t bloom_rows = planner.plan(join + ";").execute(engine).size();
+
+    std::cout << "\njoin rows without blooms " << plain_rows << ", with blooms " << bloom_rows << "\nexplain analyze:\n"
+              << planner.explain_analyze("explain analyze " + join + ";", engine).to_string()
+              << planner.explain_analyze("explain analyze (Accounts ?=> name == \"" + names[8] + "\")<uk>;", engine).to_string();
+
+    // Segment of -0.0 may contain 0.0, both by the filter and by the join.
+    Table zeros { { "z", &domains("F64") } }, zero { { "z0", &domains("F64") } };
+    F64 *values = (F64*)zeros.append_rows(Table::Segment_Rows);
+    for (size_t i = 0; i < Table::Segment_Rows; i++) values[i] = -0.0;
+    *(F64*)zero.append_rows(1) = 0.0;
+
+    planner.add_table("Zeros", zeros);
+    planner.add_table("Zero", zero);
+    planner.add_bloom_filter("Zeros", "z");
+    const size_t filtered = planner.plan("(Zeros ?=> z == 0);").execute(engine).size();
+    const size_t joined = planner.plan("(Zero * Zeros ?=> z0 == z);").execute(engine).size();
+    std::cout << "\nrows of -0.0 equal to 0.0: " << filtered << " filtered, " << joined << " joined of "
+              << zeros.size() << std::endl;
+
+    return 0;
+}
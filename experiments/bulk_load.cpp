@@ -0,0 +1,102 @@
+#include <bulk_load.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <parser.hpp>
+#include <string>
+#include <unistd.h>
+
+using namespace toad_db;
+using namespace toad_db::types;
+
+template<typename Fn>
+double mb_per_sec(size_t bytes, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return bytes / sec / (1 << 20);
+}
+
+int main(void) {
+    auto domains = Domain::default_domains();
+
+    Table groups {
+        { "id",    &domains("U64") },
+        { "title", &domains("String") },
+        { "level", &domains("U8") },
+        { "score", &domains("F64") },
+        { "admin", &domains("Bool") },
+    };
+
+    char path[] = "/tmp/toad_dump_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        std::perror("mkstemp");
+        return 1;
+    }
+
+    const size_t stmts = 500000;
+    size_t size = 0;
+    {
+        std::string chunk;
+        for (size_t i = 0; i < stmts; i++) {
+            const std::string n = std::to_string(i);
+            chunk += "Groups << { id: " + n + ", title: \"admin_" + n + "\", level: " + std::to_string(i % 7)
+                     + ", score: " + std::to_string(i % 100) + ", admin: true }"
+                     " << { id: " + n + "0, title: \"user;" + n + "\", level: 1, score: -1, admin: false };\n";
+
+            // Statements the loader doesn't take go to the general parser.
+            if (i % 100000 == 0) chunk += "Groups << { id: 1 + 1 };\n";
+
+            if (chunk.size() > (1 << 20) || i + 1 == stmts) {
+                size += write(fd, chunk.data(), chunk.size());
+                chunk.clear();
+            }
+        }
+    }
+    close(fd);
+
+    std::cout << "dump: " << size / (1 << 20) << " MiB, " << stmts << " statements" << std::endl;
+
+    double speed = mb_per_sec(size, [&] {
+        std::vector<char> buffer((size_t)1 << 20);
+        int fd = open(path, O_RDONLY);
+        while (read(fd, buffer.data(), buffer.size()) > 0);
+        close(fd);
+    });
+    std::cout << "  read only:    " << speed << " MB/sec" << std::endl;
+
+    size_t rows = 0, fallbacks = 0;
+    speed = mb_per_sec(size, [&] {
+        parser::Syntax_Tree::parse_file(path, [&] (const parser::Top_Level_Statement &stmt) {
+            for (auto node = stmt.call_data.root->args[0]; node->name == "<<"; node = node->args[0]) rows++;
+        });
+    });
+    std::cout << "  syntax tree:  " << speed << " MB/sec, " << rows << " rows (not decoded)" << std::endl;
+
+    parser::Bulk_Loader loader { };
+    loader.add_table("Groups", groups);
+
+    speed = mb_per_sec(size, [&] {
+        loader.load_file(path, [&] (const parser::Top_Level_Statement&) { fallbacks++; });
+    });
+    std::cout << "  bulk load:    " << speed << " MB/sec, " << loader.loaded_rows() << " rows ("
+              << groups.size() * groups.row_size() / (1 << 20) << " MiB in the table), "
+              << fallbacks << " statements to the general parser" << std::endl;
+
+    const U8 *row = groups.row_data(groups.size() - 1);
+    std::cout << "  last row: id " << *(U64*)(row + groups.column_offset(0))
+              << ", title length " << (size_t)row[groups.column_offset(1)]
+              << ", score " << *(F64*)(row + groups.column_offset(3)) << std::endl;
+
+    try {
+        loader.load_stmt("Groups << { id: 1, level: 300 };");
+    } catch (parser::Bulk_Loader::Bulk_Load_Failed &error) {
+        std::cout << error.what() << std::endl;
+    }
+
+    unlink(path);
+
+    return 0;
+}
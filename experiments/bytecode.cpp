@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <bytecode.hpp>
+#include <common.hpp>
+#include <iostream>
+#include <limits>
+#include <parser.hpp>
+#include <utility>
+#include <vectorized.hpp>
+
+int main(void) {
+    using namespace toad_db;
+    using namespace toad_db::types;
+    using namespace toad_db::interact::bytecode;
+
+    auto domains = Domain::default_domains();
+
+    Table groups { { "key", &domains("Key") }, { "title", &domains("Str") },
+                   { "level", &domains("U8") }, { "month", &domains("Month") } };
+
+    const std::vector<std::pair<std::string, U8>> rows = {
+        { "admin", 2 }, { "mod", 1 }, { "user", 0 }, { "admin", 0 } };
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        U8 *row = groups.append_rows(1);
+        Domain_View { &domains("Key"), row + groups.column_offset(0) }.set_basic<U64>(i);
+        Domain_View { &domains("Str"), row + groups.column_offset(1) }.set_string(rows[i].first);
+        Domain_View { &domains("U8"), row + groups.column_offset(2) }.set_basic<U8>(rows[i].second);
+        Domain_View { &domains("Month"), row + groups.column_offset(3) }[i % 2 ? "feb" : "jan"];
+    }
+
+    auto tree = parser::Syntax_Tree::parse(
+            "level > 0 && title == \"admin\";\n"
+            "title != \"admin\" || month == feb;\n"
+            "(key + 1) * 10 / 4;\n"
+    );
+
+    for (auto &stmt: tree->stmts) {
+        std::cout << "expr: " << parser::to_string(stmt.call_data) << std::endl;
+
+        Compiler compiler { groups };
+        auto program = compiler.compile(stmt.call_data.root);
+        std::cout << program;
+
+        Vm vm { program };
+        for (size_t row = 0; row < groups.size(); row++) {
+            auto value = vm.eval(groups.row_data(row));
+            std::cout << "  row " << row << ": "
+                      << (program.result_type == Type::Bool ? (value.u ? "true" : "false")
+                                                            : std::to_string(value.i))
+                      << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    // U64 at and above 2^63 compared with I64, by the VM and by the batches, to the exact comparisons.
+    Table numbers { { "u", &domains("U64") }, { "i", &domains("I64") } };
+    const std::vector<std::pair<U64, I64>> values = {
+        { 1ull << 63, 0 }, { 1ull << 63, -1 }, { std::numeric_limits<U64>::max(), std::numeric_limits<I64>::min() },
+        { (1ull << 63) - 1, std::numeric_limits<I64>::max() }, { 5, 5 }, { 0, -1 }, { 0, 0 },
+    };
+    for (auto [u, i]: values) {
+        U8 *row = numbers.append_rows(1);
+        *(U64*)(row + numbers.column_offset(0)) = u;
+        *(I64*)(row + numbers.column_offset(1)) = i;
+    }
+
+    const std::vector<std::pair<std::string, bool (*)(U64, I64)>> compares = {
+        { "u > -1",  [](U64 u, I64)   { return std::cmp_greater(u, -1); } },
+        { "-1 < u",  [](U64 u, I64)   { return std::cmp_less(-1, u); } },
+        { "u == i",  [](U64 u, I64 i) { return std::cmp_equal(u, i); } },
+        { "u != i",  [](U64 u, I64 i) { return std::cmp_not_equal(u, i); } },
+        { "u > i",   [](U64 u, I64 i) { return std::cmp_greater(u, i); } },
+        { "u <= i",  [](U64 u, I64 i) { return std::cmp_less_equal(u, i); } },
+        { "i < u",   [](U64 u, I64 i) { return std::cmp_less(i, u); } },
+        { "i >= u",  [](U64 u, I64 i) { return std::cmp_greater_equal(i, u); } },
+    };
+
+    interact::Engine engine { 1 };
+    for (auto &[text, expected]: compares) {
+        auto predicate = parser::Syntax_Tree::parse(text + ";");
+        auto &root = predicate->stmts[0].call_data.root;
+
+        auto program = Compiler { numbers }.compile(root);
+        Vm vm { program };
+        auto selected = interact::vectorized::Batch_Filter { numbers, root }.filter(engine);
+
+        size_t wrong = 0;
+        for (size_t row = 0; row < numbers.size(); row++) {
+            const bool exact = expected(values[row].first, values[row].second);
+            const bool batch = std::find(selected.begin(), selected.end(), row) != selected.end();
+            wrong += (vm.test(numbers.row_data(row)) != exact) + (batch != exact);
+        }
+        std::cout << text << ": " << wrong << " wrong" << std::endl;
+    }
+
+    return 0;
+}
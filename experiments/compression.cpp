@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <chrono>
+#include <common.hpp>
+#include <compression.hpp>
+#include <iostream>
+#include <parser.hpp>
+#include <planner.hpp>
+#include <string>
+#include <vector>
+#include <vectorized.hpp>
+
+using namespace toad_db;
+using namespace toad_db::types;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double ms(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(void) {
+    auto domains = Domain::default_domains();
+    Engine engine { };
+
+    Table events {
+        { "uk", &domains("Key") }, { "ts", &domains("Time_Stamp") }, { "level", &domains("I16") },
+        { "ok", &domains("Bool") }, { "score", &domains("F64") },
+    };
+
+    // Append-ordered keys and time stamps, small levels and long runs of the flags.
+    const size_t rows = 64 * Table::Segment_Rows + 1000;
+    U64 ts = 1700000000000, random = 42;
+
+    U8 *row = events.append_rows(rows);
+    for (size_t i = 0; i < rows; i++, row += events.row_size()) {
+        random = random * 6364136223846793005ull + 1442695040888963407ull;
+        ts += random >> 60;
+
+        *(U64*)(row + events.column_offset(0)) = i;
+        *(U64*)(row + events.column_offset(1)) = ts;
+        *(I16*)(row + events.column_offset(2)) = (I16)(-50 + (I16)(random >> 59));
+        row[events.column_offset(3)] = (i / 5000) % 7 != 0;
+        *(F64*)(row + events.column_offset(4)) = (double)(random >> 40) / 1000;
+    }
+
+    compression::Compressed_Segments compressed { events };
+    const double compress_ms = ms([&] { compressed.update(); });
+
+    static constexpr const char *encodings[] = { "Plain", "Run_Length", "Frame_Of_Reference", "Delta" };
+    std::cout << compressed.sealed() << " sealed segments of " << events.size() << " rows compressed in "
+              << compress_ms << " ms: " << compressed.plain_bytes() << " -> " << compressed.bytes() << " bytes ("
+              << (double)compressed.plain_bytes() / compressed.bytes() << "x)" << std::endl;
+
+    for (size_t i = 0; i < events.columns().size(); i++) {
+        auto &column = compressed.column(0, i);
+        std::cout << "  " << events.columns()[i].name << ": " << encodings[column.encoding()] << ", "
+                  << column.bytes() << " bytes per segment" << std::endl;
+    }
+
+    const std::vector<std::string> predicates {
+        "level > -25", "ok == false", "uk >= 1000000 && uk < 1100000", "ts < 1700001000000", "score > 16000000 || ok == false",
+    };
+
+    for (auto &text: predicates) {
+        auto tree = parser::Syntax_Tree::parse(text + ";");
+        auto &predicate = tree->stmts[0].call_data.root;
+
+        std::vector<size_t> expected, selected;
+        const double plain_ms = ms([&] { expected = vectorized::Batch_Filter { events, predicate }.filter(engine); });
+        const double compressed_ms = ms([&] {
+            selected = vectorized::Batch_Filter { events, predicate, { &compressed } }.filter(engine);
+        });
+
+        std::cout << text << ": " << plain_ms << " ms by rows, " << compressed_ms << " ms compressed, rows "
+                  << expected.size() << (expected == selected ? ", same rows" : ", DIFFERENT rows") << std::endl;
+    }
+
+    // Filters of the planned queries read the compressed segments of the tables given to the planner.
+    plan::Planner planner { };
+    planner.add_table("Events", events);
+    const std::string query = "(Events ?=> level > -25 && ok == false)<uk, score>;";
+    Table plain = planner.plan(query).execute(engine);
+
+    planner.add_compression("Events");
+    Table planned = planner.plan(query).execute(engine);
+
+    bool same = plain.size() == planned.size() && plain.row_size() == planned.row_size();
+    for (size_t i = 0; same && i < plain.size(); i++)
+        same = std::equal(plain.row_data(i), plain.row_data(i) + plain.row_size(), planned.row_data(i));
+    std::cout << "planned " << query << " rows " << planned.size() << (same ? ", same rows" : ", DIFFERENT rows") << std::endl;
+
+    return 0;
+}
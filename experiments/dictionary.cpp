@@ -0,0 +1,152 @@
+#include <aggregate.hpp>
+#include <chrono>
+#include <common.hpp>
+#include <generator.hpp>
+#include <iostream>
+#include <optional>
+#include <parser.hpp>
+#include <planner.hpp>
+#include <string>
+#include <table_view.hpp>
+#include <utility>
+#include <vector>
+#include <vectorized.hpp>
+
+using namespace toad_db;
+using namespace toad_db::types;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double ms(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::string str_of(Domain_View view) {
+    return { (const char*)view.data + 1, view.data[0] };
+}
+
+int main(void) {
+    auto domains = Domain::default_domains();
+    Engine engine { };
+
+    parser::Syntax_Tree tree { };
+    auto definition = tree.parse_table("table Users { uk(Key), level(U8), title(Str), country(Str), };");
+
+    Data_Generator generator { domains, definition };
+    generator.set_distribution("title", { Distribution::Zipf, 1, 20, 1, 4, 12 });
+    generator.set_distribution("country", { Distribution::Zipf, 1, 200, 0.5, 5, 5 });
+    generator.set_distribution("level", { Distribution::Uniform, 0, 9 });
+
+    Table plain = generator.make_table();
+    generator.generate(plain, 1000000, engine);
+
+    const std::vector<std::string> columns { "title", "country" };
+    std::optional<Table> encoded_table;
+    const double encode_ms = ms([&] { encoded_table.emplace(plain.encode(columns)); });
+    const Table &encoded = *encoded_table;
+
+    auto &title = *encoded.columns()[2].dictionary, &country = *encoded.columns()[3].dictionary;
+    const size_t plain_bytes = plain.size() * 2 * domains("Str").size_of();
+    const size_t encoded_bytes = encoded.size() * (title.code_size() + country.code_size())
+                                 + title.memory_bytes() + country.memory_bytes();
+
+    std::cout << plain.size() << " rows encoded in " << encode_ms << " ms: row " << plain.row_size() << " -> "
+              << encoded.row_size() << " bytes, " << title.size() << " titles, " << country.size() << " countries\n"
+              << "string columns: " << plain_bytes << " -> " << encoded_bytes << " bytes with dictionaries ("
+              << (double)plain_bytes / encoded_bytes << "x)" << std::endl;
+
+    // Title of the first row, it's the most frequent one.
+    const std::string value = "\"" + str_of(*std::next(encoded.begin()->begin(), 2)) + "\"";
+
+    const std::vector<std::string> predicates { "title == " + value, "title != " + value + " && level > 4",
+                                                "title == \"nobody\"" };
+    for (auto &text: predicates) {
+        auto parsed = parser::Syntax_Tree::parse(text + ";");
+        auto &predicate = parsed->stmts[0].call_data.root;
+
+        std::vector<size_t> expected, rows;
+        const double plain_ms = ms([&] { expected = vectorized::Batch_Filter { plain, predicate }.filter(engine); });
+        const double encoded_ms = ms([&] { rows = vectorized::Batch_Filter { encoded, predicate }.filter(engine); });
+
+        std::cout << text << ": " << plain_ms << " ms by bytes, " << encoded_ms << " ms by codes, rows "
+                  << expected.size() << (expected == rows ? ", same rows" : ", DIFFERENT rows") << std::endl;
+    }
+
+    // Groups share the dictionary of the titles, so the join compares the codes.
+    Table groups { { "gk", &domains("Key") }, Table::Column_Field::encoded("group", encoded.columns()[2].dictionary) };
+    for (U64 i = 0; i < 5; i++) {
+        Domain_Value key { &domains("Key") };
+        key.view().set_basic<U64>(i);
+
+        Domain_Value name { &domains("Str") };
+        for (char c: str_of(title.value((U32)i))) name.view().array_push_basic<I8>((I8)c);
+        groups << std::vector<Domain_View> { key.view(), name.view() };
+    }
+
+    plan::Planner planner { };
+    planner.add_table("Users", encoded);
+    planner.add_table("Groups", groups);
+
+    const std::string query = "(Users * Groups ?=> title == group && level == 0)<uk, group, country>";
+    std::cout << "\n" << planner.explain("explain " + query + ";");
+
+    Table joined = planner.plan(query + ";").execute(engine);
+    std::cout << joined.size() << " rows, first ones decoded:\n";
+
+    Table head { joined.columns() };
+    for (size_t i = 0; i < 3 && i < joined.size(); i++)
+        std::memcpy(head.append_rows(1), joined.row_data(i), joined.row_size());
+    std::cout << make_table_view(std::as_const(head));
+
+    // Value reused after the longer string keeps its bytes after the length, but gets the same code.
+    Dictionary roles { &domains("Str") };
+    Domain_Value fresh { &domains("Str") }, reused { &domains("Str") };
+    fresh.view().set_string("admin");
+    reused.view().set_string("administrator");
+    const U32 longer = *roles.try_intern(reused.view());
+    reused.view().set_string("admin");
+
+    const U32 admin = *roles.try_intern(fresh.view());
+    std::cout << "reused value: code " << *roles.try_intern(reused.view()) << ", fresh value: code " << admin
+              << (*roles.try_intern(reused.view()) == admin && admin != longer ? ", same codes" : ", DIFFERENT codes")
+              << std::endl;
+
+    // Rows read from the table are inserted to it again, while the table grows under them.
+    const std::vector<U8> first_group(groups.row_data(0), groups.row_data(0) + groups.row_size());
+    for (size_t i = 0; i < 1000; i++) {
+        auto row = groups.begin()->begin();
+        groups << std::vector<Domain_View> { *row, *std::next(row) };
+    }
+    bool same_groups = true;
+    for (size_t i = 5; i < groups.size(); i++)
+        same_groups &= std::memcmp(groups.row_data(i), first_group.data(), groups.row_size()) == 0;
+    std::cout << "reinserted rows: " << (same_groups ? "same values" : "DIFFERENT values") << std::endl;
+
+    // Row rejected by the other column doesn't add the value to the dictionary.
+    Table members { Table::Column_Field::encoded("role", std::make_shared<Dictionary>(&domains("Str"), 256)),
+                    { "level", &domains("U8") } };
+    Domain_Value role { &domains("Str") }, level { &domains("Str") };
+    role.view().set_string("guest");
+    level.view().set_string("high");
+    const bool rejected = !members.try_insert_row(std::vector<Domain_View> { role.view(), level.view() });
+    std::cout << "rejected row: " << (rejected ? "rejected" : "INSERTED") << ", "
+              << members.columns()[0].dictionary->size() << " values in the dictionary" << std::endl;
+
+    // Codes aren't the values, so they aren't summed.
+    try {
+        Group_By { domains, encoded, { }, { { Group_By::Function::Max, "title", "max_title" } } };
+    } catch (Toad_Exception &error) {
+        std::cout << error.what() << std::endl;
+    }
+
+    try {
+        auto parsed = parser::Syntax_Tree::parse("title < \"b\";");
+        vectorized::Batch_Filter { encoded, parsed->stmts[0].call_data.root };
+    } catch (Toad_Exception &error) {
+        std::cout << error.what() << std::endl;
+    }
+
+    return 0;
+}
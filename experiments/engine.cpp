@@ -0,0 +1,131 @@
+#include <atomic>
+#include <chrono>
+#include <common.hpp>
+#include <interpreter.hpp>
+#include <iostream>
+#include <thread>
+#include <thread_pool.hpp>
+#include <vector>
+
+int main(void) {
+    using namespace toad_db;
+    using namespace toad_db::types;
+
+    auto domains = Domain::default_domains();
+
+    Table table { { "key", &domains("Key") }, { "level", &domains("U8") }, { "value", &domains("I64") } };
+
+    const size_t rows = 1 << 23;
+    const size_t level_offset = table.column_offset(1), value_offset = table.column_offset(2);
+
+    U8 *data = table.append_rows(rows);
+    for (size_t i = 0; i < rows; i++, data += table.row_size()) {
+        *(U64*)data = i;
+        data[level_offset] = (U8)(i % 4);
+        *(I64*)(data + value_offset) = (I64)(i % 1000);
+    }
+
+    std::cout << "scan-filter-aggregate: `sum(value) where level > 1` over "
+              << rows << " rows." << std::endl;
+
+    double single = 0;
+    for (size_t threads = 1; threads <= std::thread::hardware_concurrency(); threads *= 2) {
+        interact::Engine engine { threads };
+
+        auto start = std::chrono::steady_clock::now();
+        I64 sum = engine.aggregate(table, I64(0),
+                [&](I64 &acc, const Table &table, interact::Engine::Morsel morsel) {
+                    const U8 *row = table.row_data(morsel.begin);
+                    for (size_t i = morsel.begin; i < morsel.end; i++, row += table.row_size()) {
+                        if (row[level_offset] > 1) acc += *(const I64*)(row + value_offset);
+                    }
+                },
+                [](I64 &acc, const I64 &partial) { acc += partial; });
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (threads == 1) single = ms;
+        std::cout << "  threads: " << threads << ", sum: " << sum << ", time: " << ms << "ms"
+                  << ", speedup: " << single / ms << std::endl;
+    }
+
+    // Float sums are merged in morsel order, so they are equal bit to bit for any count of threads.
+    auto float_sum = [&](interact::Engine &engine) {
+        return engine.aggregate(table, F64(0),
+                [&](F64 &acc, const Table &table, interact::Engine::Morsel morsel) {
+                    const U8 *row = table.row_data(morsel.begin);
+                    for (size_t i = morsel.begin; i < morsel.end; i++, row += table.row_size()) {
+                        acc += 1.0 / (F64)(*(const I64*)(row + value_offset) + 1);
+                    }
+                },
+                [](F64 &acc, const F64 &partial) { acc += partial; });
+    };
+
+    interact::Engine engine { };
+    const F64 sum = float_sum(engine);
+
+    bool same = true;
+    for (size_t threads = 1; threads <= 2 * std::thread::hardware_concurrency(); threads *= 2) {
+        interact::Engine threaded { threads };
+        same &= float_sum(threaded) == sum;
+    }
+
+    // Threads out of the pool may share the engine.
+    std::vector<F64> sums(4);
+    std::vector<std::thread> callers;
+    for (size_t i = 0; i < sums.size(); i++) callers.emplace_back([&, i] { sums[i] = float_sum(engine); });
+    for (auto &caller: callers) caller.join();
+    for (F64 other: sums) same &= other == sum;
+
+    std::cout << "float sum: " << sum << (same ? ", same for all threads" : ", DIFFERENT for threads") << std::endl;
+
+    // Slot of the worker runs one task of the batch at a time, with nested batches and several callers.
+    auto overlaps = [&](interact::Thread_Pool &pool) {
+        std::vector<std::atomic<bool>> busy(pool.size());
+        std::atomic<size_t> overlapped { 0 }, nested_overlapped { 0 };
+
+        std::vector<interact::Thread_Pool::Task> tasks;
+        for (size_t i = 0; i < 64; i++) {
+            tasks.push_back([&](size_t worker) {
+                if (busy[worker].exchange(true)) overlapped++;
+
+                std::vector<std::atomic<bool>> nested_busy(pool.size());
+                std::vector<interact::Thread_Pool::Task> nested;
+                for (size_t j = 0; j < 16; j++) {
+                    nested.push_back([&](size_t worker) {
+                        if (nested_busy[worker].exchange(true)) nested_overlapped++;
+                        std::this_thread::yield();
+                        nested_busy[worker] = false;
+                    });
+                }
+                pool.run(nested);
+
+                busy[worker] = false;
+            });
+        }
+        pool.run(tasks);
+        return overlapped + nested_overlapped;
+    };
+
+    interact::Thread_Pool pool { 4 };
+    std::atomic<size_t> overlapped { 0 };
+    callers.clear();
+    for (size_t i = 0; i < 4; i++) callers.emplace_back([&] { overlapped += overlaps(pool); });
+    for (auto &caller: callers) caller.join();
+    std::cout << "tasks sharing a slot: " << overlapped << std::endl;
+
+    auto selected = engine.filter(table, [&](const U8 *row) { return row[level_offset] == 3; });
+    auto projected = engine.project(table, { 0, 2 }, selected);
+    std::cout << "filtered: " << selected.size() << ", projected: " << projected.size() << std::endl;
+
+    Table levels { { "level", &domains("U8") }, { "title", &domains("Str") } };
+    for (U8 level = 0; level < 4; level++) {
+        U8 *row = levels.append_rows(1);
+        row[0] = level;
+        Domain_View { &domains("Str"), row + levels.column_offset(1) }
+            .set_string("level " + std::to_string(level));
+    }
+    auto pairs = engine.hash_join(levels, 0, table, 1);
+    std::cout << "joined: " << pairs.probe.size() << std::endl;
+
+    return 0;
+}
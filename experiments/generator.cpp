@@ -0,0 +1,88 @@
+#include <bulk_load.hpp>
+#include <chrono>
+#include <common.hpp>
+#include <cstring>
+#include <generator.hpp>
+#include <iostream>
+#include <parser.hpp>
+#include <sstream>
+#include <string>
+
+using namespace toad_db;
+using namespace toad_db::types;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double ms(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(void) {
+    auto domains = Domain::default_domains();
+    Engine engine { };
+
+    parser::Syntax_Tree tree { };
+    auto events = tree.parse_table(
+        "table Events { uk(Key), user(U32), score(F64), name(Str), bio(Text), month(Month), at(Date), ok(Bool), };");
+
+    Data_Generator generator { domains, events };
+    generator.set_distribution("user", { Distribution::Zipf, 1, 100000, 1.2 });
+    generator.set_distribution("name", { Distribution::Zipf, 1, 1000, 1, 3, 10 });
+    generator.set_distribution("bio", { .min_length = 0, .max_length = 200 });
+    generator.set_distribution("month", { Distribution::Zipf, 0, 0, 1.5 });
+
+    const size_t rows = 1000000;
+    Table table = generator.make_table();
+    const double generate_ms = ms([&] { generator.generate(table, rows, engine); });
+
+    std::cout << "generated " << table.size() << " rows of " << table.row_size() << " bytes in " << generate_ms
+              << " ms (" << (size_t)(rows / generate_ms * 1000) << " rows/s, " << engine.threads_count()
+              << " threads)" << std::endl;
+
+    // Zipf skew: the first users and months are the most frequent.
+    size_t first_user = 0, january = 0;
+    for (size_t i = 0; i < table.size(); i++) {
+        first_user += *(const U32*)(table.row_data(i) + table.column_offset(1)) == 1;
+        january += table.row_data(i)[table.column_offset(5)] == 0;
+    }
+    std::cout << "user 1: " << first_user << " rows, jan: " << january << " rows\n" << std::endl;
+
+    std::cout << generator.insert_script(0, 3) << std::endl;
+
+    // Script of the columns understood by the bulk loader is loaded back to the same rows.
+    auto plain = tree.parse_table("table Plain { uk(Key), level(I16), score(F32), name(Str), ok(Bool), };");
+    Data_Generator plain_generator { domains, plain, 7 };
+
+    std::ostringstream script;
+    const double script_ms = ms([&] { plain_generator.write_script(script, rows, engine); });
+    std::cout << "script of " << rows << " rows, " << script.str().size() << " bytes in " << script_ms << " ms"
+              << std::endl;
+
+    Table expected = plain_generator.make_table(), loaded = plain_generator.make_table();
+    plain_generator.generate(expected, rows, engine);
+
+    parser::Bulk_Loader loader { };
+    loader.add_table("Plain", loaded);
+
+    const std::string text = script.str();
+    std::string_view view = text;
+    while (!view.empty()) {
+        const size_t end = view.find(";\n");
+        loader.load_stmt(view.substr(0, end + 1));
+        view.remove_prefix(end + 2);
+    }
+
+    const bool same = loaded.size() == expected.size() &&
+                      std::memcmp(loaded.row_data(0), expected.row_data(0), expected.size() * expected.row_size()) == 0;
+    std::cout << "loaded " << loaded.size() << " rows" << (same ? ", same rows" : ", DIFFERENT rows") << std::endl;
+
+    try {
+        generator.set_distribution("nope", { });
+    } catch (Table::Table_Has_Not_Such_Column &error) {
+        std::cout << error.what() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <chrono>
+#include <common.hpp>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <planner.hpp>
+#include <statistics.hpp>
+#include <string>
+#include <vector>
+
+using namespace toad_db;
+using namespace toad_db::types;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double ms(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Rows of the result of one U64 column, sorted.
+ **/
+std::vector<U64> rows_of(const Table &table) {
+    std::vector<U64> ret;
+    for (size_t i = 0; i < table.size(); i++) ret.push_back(*(const U64*)table.row_data(i));
+
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+/**
+ * Star schema: fact table of sales and dimensions of products, stores and dates.
+ **/
+int main(void) {
+    auto domains = Domain::default_domains();
+
+    Table sales {
+        { "product_key", &domains("Key") }, { "store_key", &domains("Key") },
+        { "date_key", &domains("Key") }, { "amount", &domains("U64") },
+    };
+    Table products { { "key", &domains("Key") }, { "category", &domains("U8") } };
+    Table stores { { "key", &domains("Key") }, { "region", &domains("U8") } };
+    Table dates { { "key", &domains("Key") }, { "month", &domains("U8") } };
+
+    const size_t sales_count = 200000, products_count = 1000, stores_count = 50, dates_count = 365;
+
+    U64 seed = 42;
+    const auto random = [&seed] {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    };
+
+    U8 *row = products.append_rows(products_count);
+    for (size_t i = 0; i < products_count; i++, row += products.row_size()) {
+        *(U64*)(row + products.column_offset(0)) = i;
+        row[products.column_offset(1)] = (U8)(i % 20);
+    }
+
+    row = stores.append_rows(stores_count);
+    for (size_t i = 0; i < stores_count; i++, row += stores.row_size()) {
+        *(U64*)(row + stores.column_offset(0)) = i;
+        row[stores.column_offset(1)] = (U8)(i % 5);
+    }
+
+    row = dates.append_rows(dates_count);
+    for (size_t i = 0; i < dates_count; i++, row += dates.row_size()) {
+        *(U64*)(row + dates.column_offset(0)) = i;
+        row[dates.column_offset(1)] = (U8)(i * 12 / dates_count + 1);
+    }
+
+    plan::Planner written { false }, ordered { };
+    for (auto planner: { &written, &ordered }) {
+        planner->add_table("Sales", sales);
+        planner->add_table("Products", products);
+        planner->add_table("Stores", stores);
+        planner->add_table("Dates", dates);
+    }
+
+    // Rows appended after the tables were registered are taken into the statistics incrementally.
+    row = sales.append_rows(sales_count);
+    for (size_t i = 0; i < sales_count; i++, row += sales.row_size()) {
+        *(U64*)(row + sales.column_offset(0)) = random() % products_count;
+        *(U64*)(row + sales.column_offset(1)) = random() % stores_count;
+        *(U64*)(row + sales.column_offset(2)) = random() % dates_count;
+        *(U64*)(row + sales.column_offset(3)) = i;
+    }
+
+    const auto &statistics = ordered.statistics("Sales");
+    std::cout << "Sales: " << statistics.rows() << " rows, ~" << (size_t)statistics.column(0).distinct_count()
+              << " products, ~" << (size_t)statistics.column(1).distinct_count() << " stores, ~"
+              << (size_t)statistics.column(2).distinct_count() << " dates\n" << std::endl;
+
+    Engine engine { };
+
+    const std::vector<std::string> queries = {
+        "(Products{key: pk} * Stores{key: sk} * Dates{key: dk} * Sales"
+        " ?=> product_key == pk && store_key == sk && date_key == dk"
+        " && category == 3 && region == 2 && month == 12)<amount>",
+
+        "(Sales * Dates{key: dk} * Products{key: pk} ?=> date_key == dk && product_key == pk"
+        " && month < 4 && category > 17)<amount>",
+
+        "(Stores{key: sk} * Products{key: pk} * Sales ?=> store_key == sk && product_key == pk && region == 0)<amount>",
+    };
+
+    for (auto &text: queries) {
+        auto left_to_right = written.plan(text + ";");
+        auto best = ordered.plan(text + ";");
+
+        std::cout << "query: " << text << std::endl;
+        std::cout << "left to right:\n" << left_to_right.explain();
+        std::cout << "cost based:\n" << best.explain();
+
+        std::optional<Table> expected, result;
+        const double written_ms = ms([&] { expected.emplace(left_to_right.execute(engine)); });
+        const double ordered_ms = ms([&] { result.emplace(best.execute(engine)); });
+
+        std::cout << "  left to right: " << written_ms << " ms, cost based: " << ordered_ms << " ms, rows "
+                  << expected->size() << " == " << result->size()
+                  << (rows_of(*expected) == rows_of(*result) ? ", same rows" : ", DIFFERENT rows") << "\n" << std::endl;
+    }
+
+    ordered.analyze("analyze Sales;");
+    ordered.analyze("analyze;");
+    std::cout << "after analyze: " << ordered.statistics("Sales").rows() << " rows" << std::endl;
+
+    // NaNs (the first row too) are counted apart from the numbers 0..99.
+    Table samples { { "x", &domains("F64") } };
+    for (size_t i = 0; i < 10000; i++)
+        *(F64*)samples.append_rows(1) = i % 4 == 0 ? std::numeric_limits<F64>::quiet_NaN() : (F64)(i % 100);
+
+    plan::Table_Statistics sample_statistics { samples };
+    sample_statistics.update();
+
+    const auto &x = sample_statistics.column(0);
+    std::cout << "with NaNs: " << x.numbers << " numbers in [" << x.min << ", " << x.max << "], " << x.nans
+              << " NaNs, histogram [" << x.histogram.bounds().front() << ", " << x.histogram.bounds().back() << "]"
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <chrono>
+#include <iostream>
+#include <lexer.hpp>
+#include <parser.hpp>
+#include <sstream>
+#include <string>
+#include <thread_pool.hpp>
+
+using namespace toad_db;
+
+/**
+ * Script of `count` statements with all kinds of expressions.
+ **/
+std::string generate_corpus(size_t count) {
+    std::string ret;
+
+    for (size_t i = 0; i < count; i++) {
+        const std::string n = std::to_string(i);
+
+        switch (i % 4) {
+        case 0: ret += "let x_" + n + " = a_" + n + " + b * (c - " + n + ") in\n"
+                       "    if x_" + n + " >= 10 && level != -1 then [x_" + n + ", \"str\", 'c'] else f x_" + n + " (g y);\n"; break;
+        case 1: ret += "let view_" + n + " = Table1 with (name as name_1, age as age_1, id) in\n"
+                       "    display (view_" + n + " * Table2@) \"wide\";\n"; break;
+        case 2: ret += "gk == uk && level > 1 || title == \"admin_" + n + "\" && ((a + b) * c / 7 ** 2) < d;\n"; break;
+        case 3: ret += "result_" + n + " := [[1 + 2, 2 + 3], [3 + 4, " + n + "]];\n"; break;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * Expression with `depth` nested bound operators: `(a + [b, let x = 1 in if c then ... else 1])`.
+ **/
+std::string generate_nested(size_t depth) {
+    std::string ret;
+
+    for (size_t i = 0; i < depth; i++) {
+        ret += i % 3 == 0 ? "(a + " : i % 3 == 1 ? "[b, " : "let x = 1 in if c then ";
+    }
+    ret += "0";
+    for (size_t i = depth; i-- > 0;) {
+        ret += i % 3 == 0 ? ")" : i % 3 == 1 ? "]" : " else 1";
+    }
+
+    return ret + ";";
+}
+
+template<typename Fn>
+double mb_per_sec(size_t bytes, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return bytes / sec / (1 << 20);
+}
+
+int main(void) {
+    parser::Syntax_Tree tree { };
+
+    std::cout << "parsing of generated scripts, MB/sec:" << std::endl;
+
+    for (size_t count: { 1000, 10000, 100000 }) {
+        const std::string corpus = generate_corpus(count);
+        size_t tokens = 0, stmts = 0;
+
+        const double lex = mb_per_sec(corpus.size(), [&] {
+            std::string_view view = corpus;
+            while (true) {
+                auto stmt = parser::read_stmt(view);
+                if (stmt.size() == 0) break;
+                tokens += parser::tokenize(stmt, tree.symbols).size();
+                view = { stmt.end(), view.end() };
+            }
+        });
+
+        const double parse = mb_per_sec(corpus.size(), [&] {
+            stmts = parser::Syntax_Tree::parse(corpus)->stmts.size();
+        });
+
+        std::cout << "  " << corpus.size() / 1024 << " KiB (" << stmts << " stmts, "
+                  << tokens << " tokens): tokenize " << lex << ", parse " << parse << std::endl;
+    }
+
+    std::cout << "parallel parsing, MB/sec:" << std::endl;
+
+    {
+        const std::string corpus = generate_corpus(1000000);
+
+        std::unique_ptr<parser::Syntax_Tree> sequential, parallel;
+
+        const double one = mb_per_sec(corpus.size(), [&] { sequential = parser::Syntax_Tree::parse(corpus); });
+
+        interact::Thread_Pool pool { };
+        const double all = mb_per_sec(corpus.size(), [&] { parallel = parser::Syntax_Tree::parse(corpus, pool); });
+
+        std::stringstream lhs, rhs;
+        lhs << *sequential;
+        rhs << *parallel;
+
+        std::cout << "  " << corpus.size() / (1 << 20) << " MiB: 1 thread " << one << ", "
+                  << pool.size() << " threads " << all << ", same trees: "
+                  << (lhs.str() == rhs.str() ? "yes" : "no") << std::endl;
+    }
+
+    std::cout << "parsing of nested expressions, MB/sec:" << std::endl;
+
+    for (size_t depth: { 100, 1000, 10000, 100000 }) {
+        const std::string nested = generate_nested(depth);
+
+        const size_t repeats = 1000000 / depth;
+
+        std::cout << "  depth " << depth << ": " << mb_per_sec(nested.size() * repeats, [&] {
+            for (size_t i = 0; i < repeats; i++) parser::Syntax_Tree::parse(nested);
+        }) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <arena.hpp>
+#include <chrono>
+#include <common.hpp>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <parser.hpp>
+#include <planner.hpp>
+#include <string>
+#include <vector>
+
+using namespace toad_db;
+using namespace toad_db::types;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double ms(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void set_str(Table &table, U8 *row, size_t column, const std::string &str) {
+    Domain::set_counter(row + table.column_offset(column), 64, str.size());
+    std::memcpy(row + table.column_offset(column) + 1, str.data(), str.size());
+}
+
+std::string get_str(const Table &table, size_t row, size_t column) {
+    const U8 *data = table.row_data(row) + table.column_offset(column);
+    return { (const char*)data + 1, data[0] };
+}
+
+/**
+ * Rows of the result as sorted strings, so results of the plans with
+ * different order of rows can be compared.
+ **/
+std::vector<std::string> rows_of(const Table &table) {
+    std::vector<std::string> ret;
+    for (size_t i = 0; i < table.size(); i++) {
+        std::string row;
+        for (size_t column = 0; column < table.columns().size(); column++) row += get_str(table, i, column) + "|";
+        ret.push_back(row);
+    }
+
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+int main(void) {
+    auto domains = Domain::default_domains();
+
+    Table users {
+        { "uk", &domains("Key") }, { "name", &domains("Str") }, { "group_key", &domains("Key") },
+        { "level", &domains("U8") }, { "bio", &domains("Text") },
+    };
+    Table groups { { "key", &domains("Key") }, { "title", &domains("Str") }, { "about", &domains("Text") } };
+
+    const size_t users_count = 4000, groups_count = 100;
+
+    U8 *row = users.append_rows(users_count);
+    for (size_t i = 0; i < users_count; i++, row += users.row_size()) {
+        *(U64*)(row + users.column_offset(0)) = i;
+        set_str(users, row, 1, "user_" + std::to_string(i));
+        *(U64*)(row + users.column_offset(2)) = i % groups_count;
+        row[users.column_offset(3)] = (U8)(i % 8);
+    }
+
+    row = groups.append_rows(groups_count);
+    for (size_t i = 0; i < groups_count; i++, row += groups.row_size()) {
+        *(U64*)(row + groups.column_offset(0)) = i;
+        set_str(groups, row, 1, "group_" + std::to_string(i));
+    }
+
+    plan::Planner planner { };
+    planner.add_table("Users", users);
+    planner.add_table("Groups", groups);
+
+    Engine engine { };
+
+    const std::vector<std::string> queries = {
+        "(@Users<name, group_key>{name, uk} * @Groups<title, key>{title, gk} ?=> gk == uk)<name, title>",
+        "(Users * Groups{key: gk} ?=> group_key == gk && level > 5 && title != \"group_1\")<name, title>",
+        // Filters over the filtered rows keep the selection of the inner ones.
+        "((Users ?=> level > 5) ?=> uk < 50)<name>",
+        "((Users ?=> level > 5)<uk, name, level> ?=> uk < 50)<name>",
+    };
+
+    for (auto &text: queries) {
+        parser::Syntax_Tree tree { };
+        auto root = tree.parse_call(text).root;
+
+        auto written = planner.build(root);
+        auto optimized = planner.plan(root);
+
+        std::cout << "query: " << text << std::endl;
+        std::cout << "as written:\n" << written.explain();
+        std::cout << "explain:\n" << planner.explain("explain " + text + ";");
+
+        std::optional<Table> expected, result;
+        const double written_ms = ms([&] { expected.emplace(written.execute(engine)); });
+        const double optimized_ms = ms([&] { result.emplace(optimized.execute(engine)); });
+
+        std::cout << "  as written: " << written_ms << " ms, optimized: " << optimized_ms << " ms, rows "
+                  << expected->size() << " == " << result->size()
+                  << (rows_of(*expected) == rows_of(*result) ? ", same rows" : ", DIFFERENT rows") << "\n" << std::endl;
+    }
+
+    // Float keys are joined as values like the filter compares them: -0.0 with 0.0 and NaN with nothing.
+    Table xs { { "x", &domains("F64") } }, ys { { "y", &domains("F64") } };
+    for (F64 value: { 0.0, -0.0, 1.5, std::numeric_limits<F64>::quiet_NaN() }) {
+        *(F64*)xs.append_rows(1) = value;
+        *(F64*)ys.append_rows(1) = value;
+    }
+    planner.add_table("Xs", xs);
+    planner.add_table("Ys", ys);
+    {
+        parser::Syntax_Tree tree { };
+        auto root = tree.parse_call("(Xs * Ys ?=> x == y)").root;
+
+        const size_t written = planner.build(root).execute(engine).size(), joined = planner.plan(root).execute(engine).size();
+        std::cout << "float keys: " << written << " rows as written, " << joined << " joined"
+                  << (written == joined ? ", same rows" : ", DIFFERENT rows") << "\n" << std::endl;
+    }
+
+    auto profile = planner.explain_analyze("explain analyze " + queries[1] + ";", engine);
+    std::cout << "explain analyze:\n" << profile.to_string() << profile.to_json() << "\n" << std::endl;
+
+    // Product of the users with themselves needs 2 * 4000 * 4000 pairs of the rows.
+    Query_Memory memory { 64 << 20 };
+    try {
+        planner.plan("(Users * Users{a, b, c, d, e})<name, b>;").execute(engine, memory);
+    } catch (Query_Memory::Memory_Limit_Exceeded &error) {
+        std::cout << error.what() << " (peak " << memory.peak_bytes() << " bytes, now " << memory.bytes() << ")" << std::endl;
+    }
+
+    // Hash table of 4000 rows is charged before it's built, so the join fails without building it.
+    Query_Memory join_memory { 64 << 10 };
+    try {
+        planner.plan("(Users * Users{a, b, c, d, e} ?=> uk == a)<name, b>;").execute(engine, join_memory);
+    } catch (Query_Memory::Memory_Limit_Exceeded &error) {
+        std::cout << error.what() << " (peak " << join_memory.peak_bytes() << " bytes, now " << join_memory.bytes() << ")" << std::endl;
+    }
+
+    try {
+        planner.plan("(Users * Users)<name>;");
+    } catch (plan::Planner::Ambiguous_Column &error) {
+        std::cout << error.what() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <chrono>
+#include <common.hpp>
+#include <iostream>
+#include <parser.hpp>
+#include <prepared.hpp>
+#include <string>
+#include <vectorized.hpp>
+
+using namespace toad_db;
+using namespace toad_db::types;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double per_sec(size_t count, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return count / sec;
+}
+
+int main(void) {
+    auto domains = Domain::default_domains();
+
+    Table users { { "uk", &domains("Key") }, { "level", &domains("U8") }, { "title", &domains("Str") } };
+    const size_t rows = 4096;
+
+    U8 *row = users.append_rows(rows);
+    for (size_t i = 0; i < rows; i++, row += users.row_size()) {
+        *(U64*)row = i;
+        row[users.column_offset(1)] = (U8)(i % 8);
+
+        const std::string title = i % 3 == 0 ? "admin" : "user";
+        Domain::set_counter(row + users.column_offset(2), 64, title.size());
+        std::memcpy(row + users.column_offset(2) + 1, title.data(), title.size());
+    }
+
+    Engine engine { 1 };
+    Plan_Cache cache { };
+    cache.add_table("Users", users);
+
+    const size_t queries = 20000;
+    size_t selected_parsed = 0, selected_cached = 0, selected_prepared = 0;
+
+    std::cout << "query `Users ?=> level > N && title == \"admin\"` on " << rows << " rows, queries/sec:" << std::endl;
+
+    std::cout << "  parse and plan every time: " << per_sec(queries, [&] {
+        for (size_t i = 0; i < queries; i++) {
+            const std::string text = "level > " + std::to_string(i % 8) + " && title == \"admin\"";
+
+            parser::Syntax_Tree tree { };
+            auto root = tree.parse_call(text).root;
+            selected_parsed += vectorized::Batch_Filter { users, root }.filter(engine).size();
+        }
+    }) << std::endl;
+
+    std::cout << "  prepare by the cache:      " << per_sec(queries, [&] {
+        for (size_t i = 0; i < queries; i++) {
+            auto stmt = cache.prepare("Users ?=> level > $min && title == $title");
+            selected_cached += stmt.bind("min", i % 8).bind("title", "admin").execute(engine).size();
+        }
+    }) << std::endl;
+
+    auto stmt = cache.prepare("Users ?=>   level>$min && title==$title");
+    stmt.bind("title", "admin");
+    std::cout << "  reuse prepared statement:  " << per_sec(queries, [&] {
+        for (size_t i = 0; i < queries; i++) {
+            selected_prepared += stmt.bind("min", i % 8).execute(engine).size();
+        }
+    }) << std::endl;
+
+    std::cout << "  selected: " << selected_parsed << " == " << selected_cached << " == " << selected_prepared
+              << ", plans " << cache.size() << ", hits " << cache.hits() << ", misses " << cache.misses() << std::endl;
+
+    Table wide { { "level", &domains("U32") }, { "title", &domains("Str") } };
+    cache.add_table("Users", wide);
+    std::cout << "  after the table is replaced: " << stmt.bind("min", 0).execute(engine).size()
+              << " rows, misses " << cache.misses() << std::endl;
+
+    try {
+        stmt.bind("min", -1);
+    } catch (Prepared_Statement::Bind_Failed &error) {
+        std::cout << "  " << error.what() << std::endl;
+    }
+
+    return 0;
+}
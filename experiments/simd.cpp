@@ -0,0 +1,81 @@
+#include <chrono>
+#include <iostream>
+#include <simd.hpp>
+#include <vector>
+
+using namespace toad_db::types;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double rows_per_sec(size_t rows, size_t repeat, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeat; i++) fn();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return rows * repeat / sec;
+}
+
+template<typename T>
+void bench(const char *name) {
+    const size_t rows = 1 << 20, repeat = 16;
+
+    std::vector<T> values(rows);
+    for (size_t i = 0; i < rows; i++) values[i] = (T)(i * 7 % 100);
+
+    std::vector<U64> bitmap(simd::bitmap_words(rows));
+    std::vector<U32> selection(rows);
+    const T list[] = { 3, 14, 15, 92 };
+
+    std::cout << name << ":" << std::endl;
+
+    for (char level = 0; level <= (char)simd::detect(); level++) {
+        simd::set_level((simd::Level)level);
+
+        const double compare = rows_per_sec(rows, repeat, [&] {
+            simd::compare_const<T>(values.data(), rows, simd::Compare::Lt, 10, bitmap.data());
+        });
+        const double between = rows_per_sec(rows, repeat, [&] {
+            simd::between<T>(values.data(), rows, 10, 20, bitmap.data());
+        });
+        const double in_list = rows_per_sec(rows, repeat, [&] {
+            simd::in_list<T>(values.data(), rows, list, 4, bitmap.data());
+        });
+
+        size_t selected = 0;
+        const double sparse = rows_per_sec(rows, repeat, [&] {
+            selected = simd::bitmap_to_selection(bitmap.data(), rows, selection.data());
+        });
+
+        std::vector<U64> dense(bitmap.size());
+        simd::compare_const<T>(values.data(), rows, simd::Compare::Lt, 50, dense.data());
+        const double select = rows_per_sec(rows, repeat, [&] {
+            simd::bitmap_to_selection(dense.data(), rows, selection.data());
+        });
+
+        simd::Aggregate<T> all, filtered;
+        const double aggregate = rows_per_sec(rows, repeat, [&] {
+            all = { };
+            simd::aggregate<T>(values.data(), rows, nullptr, all);
+        });
+        simd::aggregate<T>(values.data(), rows, bitmap.data(), filtered);
+
+        std::cout << "  " << simd::to_string((simd::Level)level)
+                  << ": compare " << compare << ", between " << between
+                  << ", in " << in_list << ", selection 4% " << sparse << ", 50% " << select
+                  << ", aggregate " << aggregate << " rows/sec"
+                  << " (selected " << selected << ", sum " << (F64)all.sum
+                  << ", min " << (F64)all.min << ", max " << (F64)all.max
+                  << ", in list sum " << (F64)filtered.sum << ")" << std::endl;
+    }
+
+    simd::set_level(simd::detect());
+}
+
+int main(void) {
+    std::cout << "detected: " << simd::to_string(simd::detect()) << std::endl;
+
+    bench<U8>("U8");   bench<U16>("U16"); bench<U32>("U32"); bench<U64>("U64");
+    bench<I8>("I8");   bench<I16>("I16"); bench<I32>("I32"); bench<I64>("I64");
+    bench<F32>("F32"); bench<F64>("F64");
+
+    return 0;
+}
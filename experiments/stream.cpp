@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <parser.hpp>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace toad_db;
+
+/**
+ * Peak resident memory of the process in MiB.
+ **/
+double peak_rss(void) {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+template<typename Fn>
+double mb_per_sec(size_t bytes, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return bytes / sec / (1 << 20);
+}
+
+int main(void) {
+    char path[] = "/tmp/toad_load_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        std::perror("mkstemp");
+        return 1;
+    }
+
+    const size_t stmts = 500000;
+    size_t size = 0;
+    {
+        std::string chunk;
+        for (size_t i = 0; i < stmts; i++) {
+            const std::string n = std::to_string(i);
+            chunk += "Groups << { title: \"admin_" + n + "\", level: " + std::to_string(i % 7) + " }"
+                     " << { title: \"user;" + n + "\", level: 1 };\n";
+
+            if (chunk.size() > (1 << 20) || i + 1 == stmts) {
+                size += write(fd, chunk.data(), chunk.size());
+                chunk.clear();
+            }
+        }
+    }
+
+    std::cout << "script: " << size / (1 << 20) << " MiB, " << stmts << " statements" << std::endl;
+    std::cout << "  peak memory before parsing: " << peak_rss() << " MiB" << std::endl;
+
+    size_t inserted = 0;
+    const auto count_rows = [&inserted] (const parser::Top_Level_Statement &stmt) {
+        for (auto node = stmt.call_data.root->args[0]; node->name == "<<"; node = node->args[0]) inserted++;
+    };
+
+    size_t count = 0;
+    lseek(fd, 0, SEEK_SET);
+    double speed = mb_per_sec(size, [&] { count = parser::Syntax_Tree::parse_stream(fd, count_rows); });
+    std::cout << "  read:   " << speed << " MB/sec, " << count << " statements, "
+              << inserted << " rows, peak memory " << peak_rss() << " MiB" << std::endl;
+
+    inserted = 0;
+    speed = mb_per_sec(size, [&] { count = parser::Syntax_Tree::parse_file(path, count_rows); });
+    std::cout << "  mmap:   " << speed << " MB/sec, " << count << " statements, "
+              << inserted << " rows, peak memory " << peak_rss() << " MiB" << std::endl;
+
+    speed = mb_per_sec(size, [&] {
+        std::string source(size, '\0');
+        lseek(fd, 0, SEEK_SET);
+        for (size_t readed = 0; readed < size;) readed += read(fd, source.data() + readed, size - readed);
+
+        count = parser::Syntax_Tree::parse(source)->stmts.size();
+    });
+    std::cout << "  whole:  " << speed << " MB/sec, " << count << " statements, "
+              << "peak memory " << peak_rss() << " MiB" << std::endl;
+
+    close(fd);
+    unlink(path);
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <chrono>
+#include <common.hpp>
+#include <iostream>
+#include <planner.hpp>
+#include <string>
+#include <typed_table.hpp>
+
+using namespace toad_db;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double ms(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+using Users = Typed_Table<Field<"uk", typed::Key>, Field<"name", typed::Str>, Field<"level", typed::U8>,
+                          Field<"born", typed::Date>>;
+
+static_assert(Users::Row_Size == 8 + 65 + 1 + 8);
+static_assert(Users::Offsets[Users::idx_of<"level">()] == 73);
+
+int main(void) {
+    auto domains = Domain::default_domains();
+    Users users { domains };
+
+    const size_t count = 1000000;
+    const double append_ms = ms([&] {
+        for (size_t i = 0; i < count; i++) {
+            users.append(i, "user_" + std::to_string(i), (types::U8)(i % 100),
+                         typed::Date_Value { (types::U8)(i % 28 + 1), typed::Month_Value::jun, 2000, 0 });
+        }
+    });
+    std::cout << "appended " << users.size() << " rows in " << append_ms << " ms" << std::endl;
+
+    size_t typed_sum = 0, runtime_sum = 0;
+    const double typed_ms = ms([&] {
+        for (size_t i = 0; i < users.size(); i++) typed_sum += users[i].get<"level">() + users[i].get<"born">().day;
+    });
+
+    const Table &table = users.table();
+    const double runtime_ms = ms([&] {
+        for (const auto &row: table) {
+            auto field = row.begin();
+            ++field;
+            runtime_sum += (*++field).unwrap_basic<types::U8>();
+            runtime_sum += (*++field)["day"].unwrap_basic<types::U8>();
+        }
+    });
+
+    std::cout << "typed: " << typed_ms << " ms, runtime domains: " << runtime_ms << " ms, sums "
+              << typed_sum << (typed_sum == runtime_sum ? " == " : " != ") << runtime_sum << std::endl;
+
+    // Same rows are read by the queries.
+    plan::Planner planner { };
+    planner.add_table("Users", users.table());
+
+    Engine engine { };
+    Table result = planner.plan("(Users ?=> level == 42 && uk < 1000)<name>;").execute(engine);
+
+    std::cout << "query: " << result.size() << " rows, first `"
+              << to_string(Domain_View { result.columns()[0].domain, result.row_data(0) }) << "`" << std::endl;
+    std::cout << "typed: `" << users[42].get<"name">().view() << "`, born in "
+              << (users[42].get<"born">().month == typed::Month_Value::jun ? "jun" : "?") << std::endl;
+
+    try {
+        users[0].get<"name">() = std::string(100, 'x');
+    } catch (Toad_Exception &error) {
+        std::cout << error.what() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <bit>
+#include <bytecode.hpp>
+#include <chrono>
+#include <cmath>
+#include <common.hpp>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <parser.hpp>
+#include <vector>
+#include <vectorized.hpp>
+
+using namespace toad_db;
+using namespace toad_db::types;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double rows_per_sec(size_t rows, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return rows / sec;
+}
+
+int main(void) {
+    auto domains = Domain::default_domains();
+    const size_t rows = 1 << 22;
+
+    std::cout << "kernels (compare to constant), rows/sec:" << std::endl;
+
+    for (auto name: { "U8", "U16", "U32", "U64", "I8", "I16", "I32", "I64", "F32", "F64", "Bool" }) {
+        Table table { { "v", &domains(name) } };
+        U8 *data = table.append_rows(rows);
+        for (size_t i = 0; i < rows * table.row_size(); i++) data[i] = (U8)(i * 7 % 3);
+
+        // Every batch of the column is extracted, so the kernel reads the whole column, not one cached batch.
+        std::vector<vectorized::Column_Vector> values(rows / vectorized::Batch_Size);
+        vectorized::Bitmap bitmap;
+        size_t matched = 0;
+
+        const double extract = rows_per_sec(rows, [&] {
+            for (size_t batch = 0; batch < values.size(); batch++)
+                vectorized::extract(table, 0, batch * vectorized::Batch_Size, vectorized::Batch_Size, values[batch]);
+        });
+
+        const double kernel = rows_per_sec(rows, [&] {
+            for (auto &batch: values) {
+                vectorized::compare_const(batch, vectorized::Compare::Gt, { .i = 1 },
+                                          bytecode::Type::Int, bitmap.data());
+                for (U64 word: bitmap) matched += std::popcount(word);
+            }
+        });
+
+        std::cout << "  " << name << ": extract " << extract << ", compare " << kernel
+                  << " (" << matched << ")" << std::endl;
+    }
+
+    // Float constants out of range of the column or between its values, compared to exact comparisons.
+    {
+        const F64 two_63 = std::ldexp(1.0, 63), two_64 = std::ldexp(1.0, 64);
+        const F64 constants[] = {
+            two_64, -two_64, two_63, -two_63, std::nextafter(two_63, 0.0), 1.5, -1.5, 255.5, -0.5,
+            std::numeric_limits<F64>::infinity(), -std::numeric_limits<F64>::infinity(),
+            std::numeric_limits<F64>::quiet_NaN(),
+        };
+        const vectorized::Compare compares[] = {
+            vectorized::Compare::Eq, vectorized::Compare::Ne, vectorized::Compare::Lt,
+            vectorized::Compare::Le, vectorized::Compare::Gt, vectorized::Compare::Ge,
+        };
+
+        size_t checked = 0, wrong = 0;
+        auto check = [&]<typename T>(const char *name, std::vector<T> column) {
+            Table table { { "v", &domains(name) } };
+            for (T value: column) std::memcpy(table.append_rows(1), &value, sizeof(T));
+
+            vectorized::Column_Vector values;
+            vectorized::extract(table, 0, 0, column.size(), values);
+
+            for (F64 constant: constants) {
+                for (auto compare: compares) {
+                    vectorized::Bitmap bitmap;
+                    vectorized::compare_const(values, compare, { .f = constant }, bytecode::Type::Float, bitmap.data());
+
+                    for (size_t i = 0; i < column.size(); i++) {
+                        // Long double has 64 bits of mantissa, so it holds every value exactly.
+                        const long double v = column[i], c = constant;
+                        const bool expected = compare == vectorized::Compare::Eq ? v == c
+                                            : compare == vectorized::Compare::Ne ? v != c
+                                            : compare == vectorized::Compare::Lt ? v < c
+                                            : compare == vectorized::Compare::Le ? v <= c
+                                            : compare == vectorized::Compare::Gt ? v > c : v >= c;
+                        checked++;
+                        wrong += expected != (bool)((bitmap[i / 64] >> (i % 64)) & 1);
+                    }
+                }
+            }
+        };
+
+        check("U8", std::vector<U8> { 0, 1, 2, 255 });
+        check("I8", std::vector<I8> { -128, -2, -1, 0, 1, 2, 127 });
+        check("U64", std::vector<U64> { 0, 1, 2, 255, 256, 1ull << 63, std::numeric_limits<U64>::max() });
+        check("I64", std::vector<I64> { std::numeric_limits<I64>::min(), -2, -1, 0, 1, 2, 255, 256,
+                                        std::numeric_limits<I64>::max() });
+
+        std::cout << "float constants: " << checked << " comparisons, " << wrong << " wrong" << std::endl;
+    }
+
+    Table users { { "uk", &domains("Key") }, { "gk", &domains("Key") }, { "level", &domains("U8") } };
+    U8 *row = users.append_rows(rows);
+    for (size_t i = 0; i < rows; i++, row += users.row_size()) {
+        *(U64*)row = i;
+        *(U64*)(row + users.column_offset(1)) = i % 3 == 0 ? i : i + 1;
+        row[users.column_offset(2)] = (U8)(i % 4);
+    }
+
+    auto tree = parser::Syntax_Tree::parse("gk == uk && level > 1;");
+    auto &predicate = tree->stmts[0].call_data.root;
+
+    std::cout << "predicate `gk == uk && level > 1`, rows/sec:" << std::endl;
+
+    Engine engine { 1 };
+    vectorized::Batch_Filter filter { users, predicate };
+    size_t batch_selected = 0, row_selected = 0;
+
+    std::cout << "  batch: " << rows_per_sec(rows, [&] {
+        batch_selected = filter.filter(engine).size();
+    }) << std::endl;
+
+    auto program = bytecode::Compiler { users }.compile(predicate);
+    bytecode::Vm vm { program };
+    std::cout << "  row at a time: " << rows_per_sec(rows, [&] {
+        for (size_t i = 0; i < rows; i++) row_selected += vm.test(users.row_data(i));
+    }) << std::endl;
+
+    std::cout << "  selected: " << batch_selected << " == " << row_selected << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <common.hpp>
+#include <iostream>
+#include <limits>
+#include <parser.hpp>
+#include <planner.hpp>
+#include <string>
+#include <vector>
+#include <vectorized.hpp>
+#include <zone_map.hpp>
+
+using namespace toad_db;
+using namespace toad_db::types;
+using namespace toad_db::interact;
+
+template<typename Fn>
+double ms(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(void) {
+    auto domains = Domain::default_domains();
+    Engine engine { };
+
+    Table events { { "uk", &domains("Key") }, { "ts", &domains("Time_Stamp") }, { "level", &domains("I16") } };
+
+    // Events are appended in the order of their time stamps, levels are random.
+    const size_t rows = 64 * Table::Segment_Rows + 1000;
+    U64 ts = 1700000000000, random = 42;
+
+    U8 *row = events.append_rows(rows);
+    for (size_t i = 0; i < rows; i++, row += events.row_size()) {
+        random = random * 6364136223846793005ull + 1442695040888963407ull;
+        ts += random >> 60;
+
+        *(U64*)(row + events.column_offset(0)) = i;
+        *(U64*)(row + events.column_offset(1)) = ts;
+        *(I16*)(row + events.column_offset(2)) = (I16)(-50 + (I16)(random >> 57));
+    }
+
+    Zone_Map zones { events };
+    const double build_ms = ms([&] { zones.update(); });
+    std::cout << zones.blocks() << " blocks of " << events.size() << " rows mapped in " << build_ms << " ms" << std::endl;
+
+    // The last hour, a window in the middle, and the predicate without help of the bounds.
+    const std::vector<std::string> predicates {
+        "ts >= " + std::to_string(ts - 3600000),
+        "ts >= 1700010000000 && ts < 1700012000000 && level > 0",
+        "level == 7",
+        "ts < 1600000000000 || uk == 5",
+    };
+
+    for (auto &text: predicates) {
+        auto tree = parser::Syntax_Tree::parse(text + ";");
+        auto &predicate = tree->stmts[0].call_data.root;
+
+        std::vector<size_t> expected, selected;
+        vectorized::Batch_Filter::Stats stats { };
+
+        const double plain_ms = ms([&] { expected = vectorized::Batch_Filter { events, predicate }.filter(engine); });
+        const double zones_ms = ms([&] {
+            selected = vectorized::Batch_Filter { events, predicate, { nullptr, &zones } }.filter(engine, { }, &stats);
+        });
+
+        std::cout << text << ": " << plain_ms << " ms all blocks, " << zones_ms << " ms with zones (skipped "
+                  << stats.skipped_blocks << ", whole " << stats.whole_blocks << " of " << stats.blocks << "), rows "
+                  << expected.size() << (expected == selected ? ", same rows" : ", DIFFERENT rows") << std::endl;
+    }
+
+    // NaN isn't in the bounds, blocks with it are always filtered.
+    Table samples { { "x", &domains("F64") } };
+    for (size_t i = 0; i < 2 * Zone_Map::Block_Rows; i++)
+        *(F64*)samples.append_rows(1) = i % Zone_Map::Block_Rows == 0 ? std::numeric_limits<F64>::quiet_NaN() : 10;
+
+    Zone_Map sample_zones { samples };
+    sample_zones.update();
+    for (std::string text: { "x > 5", "x != 10", "x <= 20" }) {
+        auto tree = parser::Syntax_Tree::parse(text + ";");
+        auto &predicate = tree->stmts[0].call_data.root;
+
+        auto expected = vectorized::Batch_Filter { samples, predicate }.filter(engine);
+        auto selected = vectorized::Batch_Filter { samples, predicate, { nullptr, &sample_zones } }.filter(engine);
+        std::cout << text << " with NaNs: rows " << expected.size()
+                  << (expected == selected ? ", same rows" : ", DIFFERENT rows") << std::endl;
+    }
+
+    // Appended rows extend the last block, the planner catches the map up before the filter.
+    row = events.append_rows(1);
+    *(U64*)(row + events.column_offset(0)) = rows;
+    *(U64*)(row + events.column_offset(1)) = ts + 1;
+    *(I16*)(row + events.column_offset(2)) = 0;
+
+    plan::Planner planner { };
+    planner.add_table("Events", events);
+
+    // The first query maps the table, the next one only the appended rows.
+    const std::string query = "explain analyze (Events ?=> ts > " + std::to_string(ts) + ")<uk>;";
+    planner.explain_analyze(query, engine);
+    std::cout << "\nexplain analyze:\n" << planner.explain_analyze(query, engine).to_string() << std::endl;
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define NOB_IMPLEMENTATION
@@ -25,23 +26,34 @@ bool strstartswith(const char *str, const char* pref) {
 #define SOURCE_DIR "src"
 #define BUILD_DIR "build"
 #define EXPERIMENT_DIR "experiments"
+#define BENCH_DIR "benchmarks"
+#define BENCH_BUILD_DIR BUILD_DIR "/bench"
+#define BENCH_RESULTS BENCH_BUILD_DIR "/results.json"
 #define CCPP "clang++"
 
 #define COMPILER_FLAGS_STRING   "-Wall --std=c++23 -Werror -pedantic -g"
 #define COMPILER_FLAGS          "-Wall", "--std=c++23", "-Werror", "-pedantic", "-g"
 #define INCLUDE_DIRS_STRING     "-I" SOURCE_DIR
 #define INCLUDE_DIRS            "-I", SOURCE_DIR
+
+/* Benchmarks are optimized for the host, debug info is kept for profilers. */
+#define BENCH_FLAGS_STRING      "-Wall --std=c++23 -Werror -pedantic -O3 -march=native -DNDEBUG -g"
+#define BENCH_FLAGS             "-Wall", "--std=c++23", "-Werror", "-pedantic", "-O3", "-march=native", "-DNDEBUG", "-g"
+#define BENCH_INCLUDE_DIRS      "-I", SOURCE_DIR, "-I", BENCH_DIR
 //#define LD_FLAGS_STRING         "-lncurses"
 //#define LD_FLAGS                "-lncurses"
 
-#define LD_FLAGS_STRING         ""
-#define LD_FLAGS                ""
+#define LD_FLAGS_STRING         "-pthread"
+#define LD_FLAGS                "-pthread"
 
 Nob_File_Paths headers = { 0 };
 Nob_File_Paths sources = { 0 };
 Nob_File_Paths objects = { 0 };
 Nob_File_Paths experiments_srcs = { 0 };
 Nob_File_Paths experiments_bins = { 0 };
+Nob_File_Paths bench_objects = { 0 };
+Nob_File_Paths bench_srcs = { 0 };
+Nob_File_Paths bench_bins = { 0 };
 
 bool generate_compile_commands(void) {
     FILE *compile_commands = fopen("compile_commands.json", "w");
@@ -155,6 +167,124 @@ bool build_experiments(Nob_Cmd *cmd) {
     return true;
 }
 
+void register_benchmarks(void) {
+    for (size_t i = 0; i < sources.count; i++) {
+        const char *name = sources.items[i] + strlen(SOURCE_DIR) + 1;
+        nob_da_append(&bench_objects, nob_temp_sprintf("%s/__obj_%s.o", BENCH_BUILD_DIR, name));
+    }
+
+    Nob_File_Paths files = { 0 };
+
+    nob_read_entire_dir(BENCH_DIR, &files);
+    for (size_t i = 0; i < files.count; i++) {
+        const char *curr = files.items[i];
+        if (strendswith(curr, ".cpp")) {
+            char *source = nob_temp_sprintf("%s/%s", BENCH_DIR, curr);
+            char *binary = nob_temp_sprintf("%s/%.*s", BENCH_BUILD_DIR, (int)(strlen(curr) - 4), curr);
+
+            nob_log(NOB_INFO, "register benchmark: `%s` => `%s`.", source, binary);
+            nob_da_append(&bench_srcs, source);
+            nob_da_append(&bench_bins, binary);
+        }
+    }
+}
+
+/*
+ * Version of the sources (`git describe --always --dirty`), "unknown" out of the repository.
+ */
+const char *source_version(void) {
+    static char version[128] = "unknown";
+
+    FILE *git = popen("git describe --always --dirty 2>/dev/null", "r");
+    if (!git) return version;
+
+    char line[sizeof(version)];
+    if (fgets(line, sizeof(line), git)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0]) strcpy(version, line);
+    }
+    pclose(git);
+
+    return version;
+}
+
+/*
+ * Build sources and benchmarks with the optimizations, run the suites
+ * (or only the one `name` starts with) and merge their results to BENCH_RESULTS.
+ */
+bool bench(Nob_Cmd *cmd, const char *name) {
+    if (!nob_mkdir_if_not_exists(BENCH_BUILD_DIR)) return false;
+    register_benchmarks();
+
+    Nob_Procs procs = { 0 };
+
+    for (size_t i = 0; i < bench_objects.count; i++) {
+        Nob_File_Paths deps = { 0 };
+        nob_da_append(&deps, sources.items[i]);
+        nob_da_append_many(&deps, headers.items, headers.count);
+
+        int ret = nob_needs_rebuild(bench_objects.items[i], deps.items, deps.count);
+        nob_da_free(deps);
+        if (ret < 0) return false;
+        if (!ret) continue;
+
+        nob_cmd_append(cmd, CCPP, BENCH_FLAGS, BENCH_INCLUDE_DIRS, LD_FLAGS, "-o", bench_objects.items[i], "-c", sources.items[i]);
+        nob_da_append(&procs, nob_cmd_run_async_and_reset(cmd));
+    }
+    if (!nob_procs_wait(procs)) return false;
+    procs.count = 0;
+
+    for (size_t i = 0; i < bench_srcs.count; i++) {
+        Nob_File_Paths deps = { 0 };
+        nob_da_append(&deps, bench_srcs.items[i]);
+        nob_da_append(&deps, BENCH_DIR "/bench.hpp");
+        nob_da_append_many(&deps, bench_objects.items, bench_objects.count);
+        nob_da_append_many(&deps, headers.items, headers.count);
+
+        int ret = nob_needs_rebuild(bench_bins.items[i], deps.items, deps.count);
+        nob_da_free(deps);
+        if (ret < 0) return false;
+        if (!ret) continue;
+
+        nob_cmd_append(cmd, CCPP, BENCH_FLAGS, BENCH_INCLUDE_DIRS, LD_FLAGS, "-o", bench_bins.items[i], bench_srcs.items[i]);
+        nob_da_append_many(cmd, bench_objects.items, bench_objects.count);
+        nob_da_append(&procs, nob_cmd_run_async_and_reset(cmd));
+    }
+    if (!nob_procs_wait(procs)) return false;
+
+    /* Suites write the version to their results too. */
+    const char *version = source_version();
+    setenv("TOAD_DB_VERSION", version, 1);
+
+    Nob_String_Builder results = { 0 };
+    nob_sb_append_cstr(&results, "{\"version\": \"");
+    nob_sb_append_cstr(&results, version);
+    nob_sb_append_cstr(&results, "\", \"flags\": \"" BENCH_FLAGS_STRING "\", \"suites\": [\n");
+
+    bool first = true;
+    for (size_t i = 0; i < bench_bins.count; i++) {
+        const char *suite = bench_bins.items[i] + strlen(BENCH_BUILD_DIR) + 1;
+        if (name && !strstartswith(suite, name)) continue;
+
+        const char *output = nob_temp_sprintf("%s.json", bench_bins.items[i]);
+
+        nob_log(NOB_INFO, "Bench: `%s`.", bench_bins.items[i]);
+        nob_cmd_append(cmd, bench_bins.items[i], output);
+        if (!nob_cmd_run_sync_and_reset(cmd)) return false;
+
+        if (!first) nob_sb_append_cstr(&results, ",\n");
+        if (!nob_read_entire_file(output, &results)) return false;
+        while (results.count > 0 && results.items[results.count - 1] == '\n') results.count--;
+        first = false;
+    }
+
+    nob_sb_append_cstr(&results, "\n]}\n");
+    bool ok = nob_write_entire_file(BENCH_RESULTS, results.items, results.count);
+    nob_sb_free(results);
+
+    if (ok) nob_log(NOB_INFO, "Results: `%s`.", BENCH_RESULTS);
+    return ok;
+}
 
 int main(int argc, char **argv) {
     int result = 0;
@@ -169,6 +299,11 @@ int main(int argc, char **argv) {
     Nob_Cmd cmd = { 0 };
     Nob_Procs procs = { 0 };
 
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        if (!bench(&cmd, argc > 2 ? argv[2] : NULL)) nob_return_defer(1);
+        nob_return_defer(0);
+    }
+
     for (size_t i = 0; i < objects.count; i++) {
         const char *object = objects.items[i];
         const char *source = sources.items[i];
@@ -218,6 +353,8 @@ int main(int argc, char **argv) {
             for (size_t i = 0; i < experiments_bins.count; i++) {
                 nob_log(NOB_INFO, "   < target > `%s`", experiments_bins.items[i] + strlen(BUILD_DIR) + 1);
             }
+            nob_log(NOB_INFO, "");
+            nob_log(NOB_INFO, "   `bench [suite]` builds `" BENCH_DIR "/*.cpp` optimized and writes `" BENCH_RESULTS "`.");
         }
     }
 
@@ -227,5 +364,8 @@ defer:
     nob_da_free(headers);
     nob_da_free(experiments_bins);
     nob_da_free(experiments_srcs);
+    nob_da_free(bench_objects);
+    nob_da_free(bench_srcs);
+    nob_da_free(bench_bins);
     return result;
 }
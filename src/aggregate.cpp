@@ -0,0 +1,596 @@
+#include <aggregate.hpp>
+#include <bit>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace toad_db::interact {
+    using namespace types;
+    using bytecode::Type;
+    using bytecode::Value;
+
+    static constexpr size_t Initial_Slots = 1 << 10;
+    static constexpr U64 Tag_Mask = 0xFFFFFFFF00000000ull;
+
+    Group_Table::Group_Table(size_t key_size, size_t entry_size):
+        _key_size(key_size), _entry_size(entry_size), _slots(Initial_Slots, 0) { }
+
+    U8* Group_Table::find_or_insert(U64 hash, const U8 *key, bool &inserted) {
+        /* Load factor is at most 1/2, so probe sequences are short. */
+        if ((_size + 1) * 2 > _slots.size()) grow();
+
+        const U64 tag = hash & Tag_Mask;
+        const size_t mask = _slots.size() - 1;
+
+        for (size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+            const U64 slot = _slots[pos];
+
+            if (slot == 0) {
+                _slots[pos] = tag | (_size + 1);
+                _entries.resize((_size + 1) * _entry_size);
+
+                U8 *entry = this->entry(_size++);
+                std::memcpy(entry, &hash, sizeof(U64));
+                std::memcpy(entry + sizeof(U64), key, _key_size);
+
+                inserted = true;
+                return entry;
+            }
+
+            if ((slot & Tag_Mask) == tag) {
+                U8 *entry = this->entry((slot & ~Tag_Mask) - 1);
+                if (std::memcmp(entry + sizeof(U64), key, _key_size) == 0) {
+                    inserted = false;
+                    return entry;
+                }
+            }
+        }
+    }
+
+    void Group_Table::grow(void) {
+        _slots.assign(_slots.size() * 2, 0);
+        const size_t mask = _slots.size() - 1;
+
+        for (size_t idx = 0; idx < _size; idx++) {
+            U64 hash;
+            std::memcpy(&hash, entry(idx), sizeof(U64));
+
+            size_t pos = hash & mask;
+            while (_slots[pos] != 0) pos = (pos + 1) & mask;
+            _slots[pos] = (hash & Tag_Mask) | (idx + 1);
+        }
+    }
+
+    size_t Group_Table::memory(void) const {
+        return _entries.capacity() + _slots.capacity() * sizeof(U64);
+    }
+
+    void Group_Table::clear(void) {
+        _size = 0;
+        _entries = std::vector<U8>();
+        _slots = std::vector<U64>(Initial_Slots, 0);
+    }
+
+
+    /**
+     * Type of the state of aggregate over column of the basic variant.
+     **/
+    static Type type_of(Domain::Variant variant) {
+        switch (variant) {
+        case Domain::Variant::I8:
+        case Domain::Variant::I16:
+        case Domain::Variant::I32:
+        case Domain::Variant::I64: return Type::Int;
+        case Domain::Variant::F32:
+        case Domain::Variant::F64: return Type::Float;
+        default:                   return Type::Uint;
+        }
+    }
+
+    template<typename T>
+    static T read(const U8 *data) {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    static void write(U8 *data, T value) {
+        std::memcpy(data, &value, sizeof(T));
+    }
+
+    static Value load(Domain::Variant variant, const U8 *data) {
+        Value value;
+
+        switch (variant) {
+        case Domain::Variant::U8:   value.u = read<U8>(data);  break;
+        case Domain::Variant::U16:  value.u = read<U16>(data); break;
+        case Domain::Variant::U32:  value.u = read<U32>(data); break;
+        case Domain::Variant::U64:  value.u = read<U64>(data); break;
+        case Domain::Variant::I8:   value.i = read<I8>(data);  break;
+        case Domain::Variant::I16:  value.i = read<I16>(data); break;
+        case Domain::Variant::I32:  value.i = read<I32>(data); break;
+        case Domain::Variant::I64:  value.i = read<I64>(data); break;
+        case Domain::Variant::F32:  value.f = read<F32>(data); break;
+        case Domain::Variant::F64:  value.f = read<F64>(data); break;
+        case Domain::Variant::Bool: value.u = read<U8>(data);  break;
+        default:
+            throw Domain::Invalid_Variant_Value(variant);
+        }
+
+        return value;
+    }
+
+    static void store(Domain::Variant variant, U8 *data, Value value) {
+        switch (variant) {
+        case Domain::Variant::U8:   write<U8>(data, (U8)value.u);    break;
+        case Domain::Variant::U16:  write<U16>(data, (U16)value.u);  break;
+        case Domain::Variant::U32:  write<U32>(data, (U32)value.u);  break;
+        case Domain::Variant::U64:  write<U64>(data, value.u);       break;
+        case Domain::Variant::I8:   write<I8>(data, (I8)value.i);    break;
+        case Domain::Variant::I16:  write<I16>(data, (I16)value.i);  break;
+        case Domain::Variant::I32:  write<I32>(data, (I32)value.i);  break;
+        case Domain::Variant::I64:  write<I64>(data, value.i);       break;
+        case Domain::Variant::F32:  write<F32>(data, (F32)value.f);  break;
+        case Domain::Variant::F64:  write<F64>(data, value.f);       break;
+        case Domain::Variant::Bool: write<U8>(data, (U8)value.u);    break;
+        default:
+            throw Domain::Invalid_Variant_Value(variant);
+        }
+    }
+
+    /**
+     * Integers are summed modulo 2^64.
+     **/
+    static void add(Value &acc, Value value, Type type) {
+        if (type == Type::Float) acc.f += value.f;
+        else acc.u += value.u;
+    }
+
+    /**
+     * NaNs are never less or greater, so they are ignored by min and max.
+     **/
+    static bool less(Value a, Value b, Type type) {
+        switch (type) {
+        case Type::Int:   return a.i < b.i;
+        case Type::Float: return a.f < b.f;
+        default:          return a.u < b.u;
+        }
+    }
+
+    /**
+     * State slots are 8 bytes aligned inside the entry.
+     **/
+    static Value& state_of(U8 *entry, size_t offset) {
+        return *(Value*)(entry + offset);
+    }
+
+    static const Value& state_of(const U8 *entry, size_t offset) {
+        return *(const Value*)(entry + offset);
+    }
+
+    Group_By::Group_By(Domain::Domains &domains, const Table &table,
+                       const std::vector<std::string> &keys,
+                       const std::vector<Aggregate> &aggregates, Options options):
+        _table(table), _options(options), _aggregates(aggregates) {
+
+        for (auto &key: keys) {
+            const size_t column = table.column_idx(key);
+            _keys.push_back(column);
+            _key_offsets.push_back(_key_size);
+            _key_size += table.columns()[column].domain->size_of();
+        }
+
+        size_t state_offset = sizeof(U64) + (_key_size + 7) / 8 * 8;
+
+        for (auto &aggregate: aggregates) {
+            Slot slot { aggregate.function, Domain::Variant::U64, Type::Uint, 0, state_offset, &domains("U64") };
+
+            if (aggregate.function != Function::Count) {
+                const size_t column = table.column_idx(aggregate.column);
+                const Domain *domain = table.columns()[column].domain;
+
+                // Codes of the dictionary-encoded column are basic, but values aren't them.
+                if (const auto &dictionary = table.columns()[column].dictionary)
+                    throw Not_Aggregatable_Column(aggregate.column, dictionary->domain()->domain_name);
+
+                if (!Domain::is_basic(domain->variant))
+                    throw Not_Aggregatable_Column(aggregate.column, domain->domain_name);
+
+                slot.variant = domain->variant;
+                slot.type = type_of(domain->variant);
+                slot.column_offset = table.column_offset(column);
+
+                switch (aggregate.function) {
+                case Function::Sum:
+                    slot.result = &domains(slot.type == Type::Int   ? "I64"
+                                         : slot.type == Type::Float ? "F64" : "U64");
+                    break;
+                case Function::Min:
+                case Function::Max:
+                    slot.result = table.columns()[column].domain;
+                    break;
+                case Function::Avg:
+                    slot.result = &domains("F64");
+                    break;
+                case Function::Count:
+                    break;
+                }
+            }
+
+            state_offset += aggregate.function == Function::Avg ? 2 * sizeof(Value) : sizeof(Value);
+            _slots.push_back(slot);
+        }
+
+        _entry_size = state_offset;
+
+        size_t partitions = 1;
+        while (partitions < _options.partitions) partitions <<= 1;
+        _options.partitions = partitions;
+        _partition_shift = 64 - std::countr_zero(partitions);
+    }
+
+    void Group_By::init_state(U8 *entry) const {
+        for (auto &slot: _slots) {
+            Value &state = state_of(entry, slot.state_offset);
+
+            switch (slot.function) {
+            case Function::Count:
+            case Function::Sum:
+                state.u = 0;
+                break;
+            case Function::Avg:
+                state.u = 0;
+                state_of(entry, slot.state_offset + sizeof(Value)).u = 0;
+                break;
+            case Function::Min:
+                if (slot.type == Type::Int) state.i = std::numeric_limits<I64>::max();
+                else if (slot.type == Type::Float) state.f = std::numeric_limits<F64>::infinity();
+                else state.u = std::numeric_limits<U64>::max();
+                break;
+            case Function::Max:
+                if (slot.type == Type::Int) state.i = std::numeric_limits<I64>::min();
+                else if (slot.type == Type::Float) state.f = -std::numeric_limits<F64>::infinity();
+                else state.u = 0;
+                break;
+            }
+        }
+    }
+
+    void Group_By::update(U8 *entry, const U8 *row) const {
+        for (auto &slot: _slots) {
+            Value &state = state_of(entry, slot.state_offset);
+
+            if (slot.function == Function::Count) {
+                state.u++;
+                continue;
+            }
+
+            const Value value = load(slot.variant, row + slot.column_offset);
+
+            switch (slot.function) {
+            case Function::Sum:
+                add(state, value, slot.type);
+                break;
+            case Function::Avg:
+                add(state, value, slot.type);
+                state_of(entry, slot.state_offset + sizeof(Value)).u++;
+                break;
+            case Function::Min:
+                if (less(value, state, slot.type)) state = value;
+                break;
+            case Function::Max:
+                if (less(state, value, slot.type)) state = value;
+                break;
+            case Function::Count:
+                break;
+            }
+        }
+    }
+
+    void Group_By::merge(U8 *entry, const U8 *other) const {
+        for (auto &slot: _slots) {
+            Value &state = state_of(entry, slot.state_offset);
+            const Value &partial = state_of(other, slot.state_offset);
+
+            switch (slot.function) {
+            case Function::Count:
+                state.u += partial.u;
+                break;
+            case Function::Sum:
+                add(state, partial, slot.type);
+                break;
+            case Function::Avg:
+                add(state, partial, slot.type);
+                state_of(entry, slot.state_offset + sizeof(Value)).u
+                    += state_of(other, slot.state_offset + sizeof(Value)).u;
+                break;
+            case Function::Min:
+                if (less(partial, state, slot.type)) state = partial;
+                break;
+            case Function::Max:
+                if (less(state, partial, slot.type)) state = partial;
+                break;
+            }
+        }
+    }
+
+    void Group_By::insert(Group_Table &table, const U8 *other) const {
+        bool inserted;
+        U8 *entry = table.find_or_insert(read<U64>(other), other + sizeof(U64), inserted);
+
+        if (inserted) std::memcpy(entry, other, _entry_size);
+        else merge(entry, other);
+    }
+
+    void Group_By::write_entries(Spill_File &spill, const U8 *entries, size_t count) {
+        if (!spill.file) {
+            spill.file.reset(std::tmpfile());
+            if (!spill.file) throw Spill_Failed(std::strerror(errno));
+        }
+
+        if (std::fwrite(entries, _entry_size, count, spill.file.get()) != count)
+            throw Spill_Failed(std::strerror(errno));
+        spill.entries += count;
+    }
+
+    void Group_By::spill(Group_Table &table) {
+        std::vector<std::vector<U32>> parts(_options.partitions);
+        for (size_t idx = 0; idx < table.size(); idx++)
+            parts[partition_of(read<U64>(table.entry(idx)))].push_back((U32)idx);
+
+        for (size_t partition = 0; partition < parts.size(); partition++) {
+            if (parts[partition].empty()) continue;
+
+            auto &spill = *_spills[partition];
+            std::lock_guard lock { spill.mutex };
+            for (auto idx: parts[partition]) write_entries(spill, table.entry(idx), 1);
+        }
+
+        {
+            std::lock_guard lock { _stats_mutex };
+            _stats.spills++;
+            _stats.spilled_entries += table.size();
+        }
+
+        table.clear();
+    }
+
+    void Group_By::merge_spill(Spill_File &spill, size_t level, size_t budget, Group_Table &table, size_t &charged,
+                               const std::function<void (Group_Table&)> &done) {
+        /* Partitions of the next level, when the groups don't fit into the budget. */
+        std::vector<std::unique_ptr<Spill_File>> parts;
+
+        const auto split = [&](const U8 *entry) {
+            write_entries(*parts[partition_of(read<U64>(entry), level + 1)], entry, 1);
+        };
+
+        const auto split_table = [&] {
+            for (size_t i = 0; i < _options.partitions; i++) parts.push_back(std::make_unique<Spill_File>());
+            for (size_t idx = 0; idx < table.size(); idx++) split(table.entry(idx));
+
+            table.clear();
+            track(table, charged);
+        };
+
+        const auto insert_entry = [&](const U8 *entry) {
+            if (!parts.empty()) return split(entry);
+
+            insert(table, entry);
+            track(table, charged);
+            if (table.memory() > budget && table.size() > 1 && can_split(level)) split_table();
+        };
+
+        // Entries merged before the file may be over the budget alone.
+        if (table.memory() > budget && table.size() > 1 && can_split(level)) split_table();
+
+        if (spill.file) {
+            if (std::fflush(spill.file.get()) != 0 || std::fseek(spill.file.get(), 0, SEEK_SET) != 0)
+                throw Spill_Failed(std::strerror(errno));
+
+            constexpr size_t Chunk_Entries = 4096;
+            std::vector<U8> chunk(Chunk_Entries * _entry_size);
+
+            for (size_t left = spill.entries; left > 0;) {
+                const size_t count = std::min(left, Chunk_Entries);
+                if (std::fread(chunk.data(), _entry_size, count, spill.file.get()) != count)
+                    throw Spill_Failed("unexpected end of spill file");
+
+                for (size_t i = 0; i < count; i++) insert_entry(chunk.data() + i * _entry_size);
+                left -= count;
+            }
+
+            spill.file.reset();
+        }
+
+        if (!parts.empty()) {
+            {
+                std::lock_guard lock { _stats_mutex };
+                _stats.repartitions++;
+            }
+
+            for (auto &part: parts) merge_spill(*part, level + 1, budget, table, charged, done);
+            return;
+        }
+
+        done(table);
+        table.clear();
+        track(table, charged);
+    }
+
+    void Group_By::track(const Group_Table &table, size_t &charged) {
+        const size_t memory = table.memory();
+        if (memory == charged) return;
+
+        // Differences are modulo 2^64, so shrinking tables are subtracted.
+        const size_t now = _resident.fetch_add(memory - charged, std::memory_order_relaxed) + (memory - charged);
+        charged = memory;
+
+        size_t peak = _peak.load(std::memory_order_relaxed);
+        while (now > peak && !_peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) { }
+    }
+
+    void Group_By::untrack(size_t &charged) {
+        _resident.fetch_sub(charged, std::memory_order_relaxed);
+        charged = 0;
+    }
+
+    void Group_By::write_row(const U8 *entry, U8 *row, const Table &result) const {
+        for (size_t k = 0; k < _keys.size(); k++) {
+            std::memcpy(row + result.column_offset(k), entry + sizeof(U64) + _key_offsets[k],
+                        _table.columns()[_keys[k]].domain->size_of());
+        }
+
+        for (size_t a = 0; a < _slots.size(); a++) {
+            const Slot &slot = _slots[a];
+            const Value &state = state_of(entry, slot.state_offset);
+            U8 *out = row + result.column_offset(_keys.size() + a);
+
+            switch (slot.function) {
+            case Function::Count:
+                write<U64>(out, state.u);
+                break;
+            case Function::Sum:
+                if (slot.type == Type::Float) write<F64>(out, state.f);
+                else write<U64>(out, state.u);
+                break;
+            case Function::Min:
+            case Function::Max:
+                store(slot.variant, out, state);
+                break;
+            case Function::Avg: {
+                const U64 count = state_of(entry, slot.state_offset + sizeof(Value)).u;
+                const F64 sum = slot.type == Type::Float ? state.f
+                              : slot.type == Type::Int   ? (F64)state.i : (F64)state.u;
+                write<F64>(out, count == 0 ? std::nan("") : sum / count);
+            } break;
+            }
+        }
+    }
+
+    Table Group_By::run(Engine &engine) {
+        const size_t threads = engine.threads_count();
+        const size_t budget = std::max<size_t>(_options.memory_budget / threads, 1);
+
+        _stats = { };
+        _resident = 0;
+        _peak = 0;
+        _spills.clear();
+        for (size_t i = 0; i < _options.partitions; i++) _spills.push_back(std::make_unique<Spill_File>());
+
+        std::vector<std::unique_ptr<Group_Table>> locals;
+        std::vector<size_t> charged(threads, 0);
+        for (size_t i = 0; i < threads; i++) {
+            locals.push_back(std::make_unique<Group_Table>(_key_size, _entry_size));
+            track(*locals.back(), charged[i]);
+        }
+
+        /* Pre-aggregation. */
+        engine.for_each_morsel(_table.size(), [&](size_t worker, size_t, Engine::Morsel morsel) {
+            Group_Table &local = *locals[worker];
+            std::vector<U8> buffer(_key_size);
+
+            for (size_t row = morsel.begin; row < morsel.end; row++) {
+                const U8 *data = _table.row_data(row);
+                const U8 *key = buffer.data();
+
+                if (_keys.size() == 1) {
+                    key = data + _table.column_offset(_keys[0]);
+                } else {
+                    for (size_t k = 0; k < _keys.size(); k++) {
+                        std::memcpy(buffer.data() + _key_offsets[k], data + _table.column_offset(_keys[k]),
+                                    _table.columns()[_keys[k]].domain->size_of());
+                    }
+                }
+
+                bool inserted;
+                U8 *entry = local.find_or_insert(hash_bytes(key, _key_size), key, inserted);
+                if (inserted) init_state(entry);
+                update(entry, data);
+
+                if (!inserted) continue;
+                track(local, charged[worker]);
+                if (local.memory() > budget) {
+                    spill(local);
+                    track(local, charged[worker]);
+                }
+            }
+        });
+
+        /* Groups didn't fit, so the rest of them is spilled too and the merge has all of the budget. */
+        std::vector<Thread_Pool::Task> tasks;
+        if (_stats.spills > 0) {
+            for (size_t w = 0; w < threads; w++) {
+                tasks.push_back([&, w](size_t) {
+                    if (locals[w]->size()) spill(*locals[w]);
+                    locals[w].reset();
+                    untrack(charged[w]);
+                });
+            }
+            engine.pool().run(tasks);
+            locals.clear();
+        }
+
+        /* Entries of every local table by partition. */
+        std::vector<std::vector<std::vector<U32>>> parts(locals.size());
+        tasks.clear();
+        for (size_t w = 0; w < locals.size(); w++) {
+            tasks.push_back([&, w](size_t) {
+                parts[w].resize(_options.partitions);
+                for (size_t idx = 0; idx < locals[w]->size(); idx++)
+                    parts[w][partition_of(read<U64>(locals[w]->entry(idx)))].push_back((U32)idx);
+            });
+        }
+        engine.pool().run(tasks);
+
+        std::vector<Table::Column_Field> fields;
+        for (auto key: _keys) fields.push_back(_table.columns()[key]);
+        for (size_t a = 0; a < _slots.size(); a++) fields.push_back({ _aggregates[a].name, _slots[a].result });
+
+        Table result { fields };
+        std::mutex result_mutex;
+
+        /* Merge, rows of the partition are written before it's table is freed. */
+        const auto write_rows = [&](Group_Table &table) {
+            if (table.size() == 0) return;
+
+            std::lock_guard lock { result_mutex };
+            const size_t first = result.size();
+            result.append_rows(table.size());
+            for (size_t i = 0; i < table.size(); i++) write_row(table.entry(i), result.row_data(first + i), result);
+        };
+
+        tasks.clear();
+        for (size_t p = 0; p < _options.partitions; p++) {
+            tasks.push_back([&, p](size_t) {
+                Group_Table table { _key_size, _entry_size };
+                size_t table_charged = 0;
+                track(table, table_charged);
+
+                for (size_t w = 0; w < locals.size(); w++) {
+                    for (auto idx: parts[w][p]) insert(table, locals[w]->entry(idx));
+                }
+                track(table, table_charged);
+
+                merge_spill(*_spills[p], 0, budget, table, table_charged, write_rows);
+                untrack(table_charged);
+            });
+        }
+        engine.pool().run(tasks);
+
+        for (size_t w = 0; w < locals.size(); w++) untrack(charged[w]);
+        locals.clear();
+
+        _stats.groups = result.size();
+        _stats.peak_bytes = _peak.load();
+
+        if (_keys.empty() && _stats.groups == 0) {
+            std::vector<U64> entry((_entry_size + sizeof(U64) - 1) / sizeof(U64));
+            init_state((U8*)entry.data());
+            write_row((U8*)entry.data(), result.append_rows(1), result);
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,268 @@
+#ifndef aggregate_hpp_INCLUDED
+#define aggregate_hpp_INCLUDED
+
+#include <bytecode.hpp>
+#include <common.hpp>
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <interpreter.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace toad_db::interact {
+
+    /**
+     * # Open addressing hash table of the groups.
+     *
+     * Entries have fixed size and are stored contiguously:
+     *
+     * ```
+     *  | hash (U64) | key bytes | pad to 8 | state (8 bytes per slot) ... |
+     * ```
+     *
+     * Slots are linear probed `U64`s: high 32 bits of the hash as the tag and
+     * `entry idx + 1` in low 32 bits (zero is empty slot), so mismatches are
+     * rejected without touching the entries.
+     **/
+    class Group_Table {
+        public:
+            /**
+             * @param key_size - size of the key bytes.
+             * @param entry_size - size of the whole entry.
+             **/
+            Group_Table(size_t key_size, size_t entry_size);
+
+            /**
+             * Find entry by the key or insert new one.
+             *
+             * @param inserted - set to true if entry is new, it's state must be initialized.
+             * @return entry.
+             **/
+            types::U8* find_or_insert(types::U64 hash, const types::U8 *key, bool &inserted);
+
+            size_t size(void) const { return _size; }
+
+            types::U8* entry(size_t idx) { return _entries.data() + idx * _entry_size; }
+            const types::U8* entry(size_t idx) const { return _entries.data() + idx * _entry_size; }
+
+            /**
+             * Bytes allocated by entries and slots.
+             **/
+            size_t memory(void) const;
+
+            /**
+             * Remove all entries and free their memory.
+             **/
+            void clear(void);
+
+        private:
+            size_t _key_size, _entry_size;
+            size_t _size = 0;
+            std::vector<types::U8> _entries;
+            std::vector<types::U64> _slots;
+
+            void grow(void);
+    };
+
+    /**
+     * # Hash aggregation.
+     *
+     * Groups rows by the raw bytes of key columns (any domain, including `Add`
+     * and `Mul` ones) and computes aggregates over the basic columns:
+     *
+     * ```cpp
+     * Group_By group_by { domains, users, { "group_key" }, {
+     *     { Group_By::Function::Count, "",      "users" },
+     *     { Group_By::Function::Avg,   "level", "avg_level" },
+     * } };
+     *
+     * Table groups = group_by.run(engine); // | group_key | users | avg_level |
+     * ```
+     *
+     * Every worker pre-aggregates it's morsels into own table. When worker's
+     * table is over it's part of the memory budget, entries are spilled to the
+     * temporary files, one per hash partition, and if anything is spilled, the
+     * rest of the tables are spilled too. Then partitions are merged in
+     * parallel: entries with the same partition bits go to the same final
+     * table, it's written to the result and freed before the worker takes the
+     * next partition. Partition with the groups over the part of the budget
+     * is split by the next bits of the hash into new files, they are merged
+     * one by one. So hash tables take about the budget at once, whatever the
+     * count of the groups is.
+     *
+     * Order of the groups in the result is not specified.
+     **/
+    class Group_By {
+        public:
+            enum class Function: char {
+                Count, Sum, Min, Max, Avg
+            };
+
+            struct Aggregate {
+                Function function;
+
+                /**
+                 * Name of the aggregated column (ignored by Count).
+                 **/
+                std::string column;
+
+                /**
+                 * Name of the result column.
+                 **/
+                std::string name;
+            };
+
+            struct Options {
+                /**
+                 * Max bytes of the hash tables of all workers before spill.
+                 **/
+                size_t memory_budget = (size_t)256 << 20;
+
+                /**
+                 * Count of the partitions (power of two).
+                 **/
+                size_t partitions = 64;
+            };
+
+            struct Stats {
+                size_t groups = 0;
+                size_t spills = 0;
+                size_t spilled_entries = 0;
+
+                /**
+                 * Count of the partitions split again in the merge.
+                 **/
+                size_t repartitions = 0;
+
+                /**
+                 * Peak of the bytes of all hash tables at once.
+                 **/
+                size_t peak_bytes = 0;
+            };
+
+            class Not_Aggregatable_Column: public Toad_Exception {
+                public:
+                    Not_Aggregatable_Column(const std::string &column, const std::string &domain):
+                        Toad_Exception("Column `" + column + "` of domain `" + domain
+                                        + "` can't be aggregated, only basic domains can") { }
+            };
+
+            class Spill_Failed: public Toad_Exception {
+                public:
+                    Spill_Failed(const std::string &why):
+                        Toad_Exception("Failed to spill groups: " + why) { }
+            };
+
+            /**
+             * @param domains - domains for the result columns (`U64`, `I64`, `F64`).
+             * @param table - table to aggregate.
+             * @param keys - names of the key columns.
+             * @param aggregates - aggregates to compute.
+             * @throws Table::Table_Has_Not_Such_Column if there is no such column.
+             * @throws Not_Aggregatable_Column if aggregated column is not basic or is dictionary-encoded.
+             **/
+            Group_By(Domain::Domains &domains, const Table &table,
+                     const std::vector<std::string> &keys,
+                     const std::vector<Aggregate> &aggregates, Options options) noexcept(false);
+
+            Group_By(Domain::Domains &domains, const Table &table,
+                     const std::vector<std::string> &keys,
+                     const std::vector<Aggregate> &aggregates) noexcept(false):
+                Group_By(domains, table, keys, aggregates, Options { }) { }
+
+            /**
+             * Aggregate the table.
+             *
+             * @return table with key columns and then aggregates columns.
+             *         Without keys, there is exactly one row.
+             * @throws Spill_Failed if temporary files can't be written.
+             **/
+            Table run(Engine &engine) noexcept(false);
+
+            const Stats& stats(void) const { return _stats; }
+
+        private:
+            /**
+             * State of one aggregate, `Avg` has two slots: sum and count.
+             **/
+            struct Slot {
+                Function function;
+                Domain::Variant variant;
+                bytecode::Type type;
+                size_t column_offset;
+                size_t state_offset;
+                Domain *result;
+            };
+
+            /**
+             * Temporary file with entries of one partition.
+             **/
+            struct Spill_File {
+                std::mutex mutex;
+                std::unique_ptr<FILE, int(*)(FILE*)> file { nullptr, fclose };
+                size_t entries = 0;
+            };
+
+            const Table &_table;
+            Options _options;
+            Stats _stats;
+
+            std::vector<size_t> _keys;
+            std::vector<size_t> _key_offsets;
+            std::vector<Aggregate> _aggregates;
+            std::vector<Slot> _slots;
+
+            size_t _key_size = 0, _entry_size = 0;
+            size_t _partition_shift = 64;
+
+            std::vector<std::unique_ptr<Spill_File>> _spills;
+            std::mutex _stats_mutex;
+            std::atomic<size_t> _resident { 0 }, _peak { 0 };
+
+            /**
+             * Partition of the hash by the bits of the level, level 0 is of the high bits.
+             **/
+            size_t partition_of(types::U64 hash, size_t level = 0) const {
+                return _partition_shift == 64 ? 0 : (hash << (level * (64 - _partition_shift))) >> _partition_shift;
+            }
+
+            /**
+             * Partitions of the level can be split by the bits of the next one.
+             **/
+            bool can_split(size_t level) const {
+                return _partition_shift != 64 && (level + 2) * (64 - _partition_shift) <= 64;
+            }
+
+            void init_state(types::U8 *entry) const;
+            void update(types::U8 *entry, const types::U8 *row) const;
+            void merge(types::U8 *entry, const types::U8 *other) const;
+
+            void insert(Group_Table &table, const types::U8 *other) const;
+            void spill(Group_Table &table);
+            void write_entries(Spill_File &spill, const types::U8 *entries, size_t count);
+
+            /**
+             * Merge the spilled entries into the table, and pass it to `done`
+             * (one or more times, when it's split) and clear it.
+             *
+             * @param level - level of the bits of the partition of the file.
+             * @param budget - max bytes of the table, then partition is split.
+             * @param charged - bytes of the table charged to the resident ones.
+             **/
+            void merge_spill(Spill_File &spill, size_t level, size_t budget, Group_Table &table, size_t &charged,
+                             const std::function<void (Group_Table&)> &done);
+
+            /**
+             * Charge the change of the memory of the table (@see Stats::peak_bytes).
+             **/
+            void track(const Group_Table &table, size_t &charged);
+            void untrack(size_t &charged);
+
+            void write_row(const types::U8 *entry, types::U8 *row, const Table &result) const;
+    };
+}
+
+#endif // aggregate_hpp_INCLUDED
@@ -0,0 +1,69 @@
+#include <arena.hpp>
+
+namespace toad_db {
+    void* Arena::allocate_slow(size_t size, size_t align) {
+        const size_t chunk_size = size + align > _chunk_size / 4 ? size + align : _chunk_size;
+        if (_memory) _memory->acquire(chunk_size);
+
+        _chunks.push_back(Chunk { std::make_unique_for_overwrite<types::U8[]>(chunk_size), chunk_size });
+        _allocated += chunk_size;
+
+        types::U8 *chunk = _chunks.rbegin()->data.get();
+        types::U8 *ptr = align_up(chunk, align);
+
+        // Big allocations don't replace current chunk, it may have free space.
+        if (chunk_size == _chunk_size) {
+            _curr = ptr + size;
+            _end = chunk + chunk_size;
+        }
+
+        return ptr;
+    }
+
+    void Arena::reset(void) {
+        auto regular = std::find_if(_chunks.begin(), _chunks.end(),
+                                    [this] (const Chunk &chunk) { return chunk.size == _chunk_size; });
+
+        if (regular == _chunks.end()) {
+            clear();
+            return;
+        }
+
+        Chunk kept = std::move(*regular);
+        _chunks.clear();
+        _chunks.push_back(std::move(kept));
+
+        if (_memory) _memory->release(_allocated - _chunk_size);
+
+        _curr = _chunks[0].data.get();
+        _end = _curr + _chunk_size;
+        _allocated = _chunk_size;
+    }
+
+    Arena& Arena::operator=(Arena &&other) noexcept {
+        if (this == &other) return *this;
+
+        clear();
+        _chunk_size = other._chunk_size;
+        _allocated = std::exchange(other._allocated, 0);
+        _memory = std::exchange(other._memory, nullptr);
+        _chunks = std::move(other._chunks);
+        _curr = std::exchange(other._curr, nullptr);
+        _end = std::exchange(other._end, nullptr);
+        other._chunks.clear();
+
+        return *this;
+    }
+
+    void Arena::absorb(Arena &&other) {
+        if (_memory != other._memory && _memory) _memory->acquire(other._allocated);
+
+        for (auto &chunk: other._chunks) _chunks.push_back(std::move(chunk));
+        _allocated += other._allocated;
+
+        // Chunks are kept, so they are released only from the memory they were charged to.
+        other._chunks.clear();
+        if (_memory == other._memory) other._allocated = 0;
+        other.clear();
+    }
+}
@@ -0,0 +1,268 @@
+#ifndef arena_hpp_INCLUDED
+#define arena_hpp_INCLUDED
+
+#include <atomic>
+#include <common.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace toad_db {
+
+    /**
+     * # Memory of one statement.
+     *
+     * Temporaries of the statement (tables of the joins and products,
+     * selections of the rows, hash tables and the arena of the executor)
+     * are charged to it before they are allocated and released when
+     * they are dropped, at the latest at the end of the statement:
+     *
+     * ```cpp
+     * Query_Memory memory { 256 << 20 };
+     * Table result = query.execute(engine, memory);
+     * std::cout << memory.peak_bytes() << " bytes, " << memory.allocations() << " allocations";
+     * ```
+     *
+     * Counters are atomic, so workers of the engine can charge it too.
+     **/
+    class Query_Memory {
+        public:
+            static constexpr size_t Unlimited = SIZE_MAX;
+
+            class Memory_Limit_Exceeded: public Toad_Exception {
+                public:
+                    Memory_Limit_Exceeded(size_t bytes, size_t limit):
+                        Toad_Exception("Query needs more than " + std::to_string(limit) + " bytes of memory. (needs "
+                                        + std::to_string(bytes) + " bytes)") { }
+            };
+
+            /**
+             * Charged bytes, released when dropped.
+             **/
+            class Reservation {
+                public:
+                    Reservation() = default;
+                    Reservation(Query_Memory &memory, size_t bytes) noexcept(false): _memory(&memory) { add(bytes); }
+
+                    Reservation(Reservation &&other) noexcept:
+                        _memory(std::exchange(other._memory, nullptr)), _bytes(std::exchange(other._bytes, 0)) { }
+
+                    Reservation& operator=(Reservation &&other) noexcept {
+                        if (this == &other) return *this;
+
+                        release();
+                        _memory = std::exchange(other._memory, nullptr);
+                        _bytes = std::exchange(other._bytes, 0);
+                        return *this;
+                    }
+
+                    Reservation(const Reservation&) = delete;
+                    Reservation& operator=(const Reservation&) = delete;
+
+                    ~Reservation() { release(); }
+
+                    /**
+                     * Charge more bytes.
+                     *
+                     * @throws Memory_Limit_Exceeded if the limit of the memory is exceeded.
+                     **/
+                    void add(size_t bytes) noexcept(false) {
+                        if (_memory == nullptr || bytes == 0) return;
+
+                        _memory->acquire(bytes);
+                        _bytes += bytes;
+                    }
+
+                    void release(void) {
+                        if (_memory) _memory->release(_bytes);
+                        _bytes = 0;
+                    }
+
+                    size_t bytes(void) const { return _bytes; }
+
+                private:
+                    Query_Memory *_memory = nullptr;
+                    size_t _bytes = 0;
+            };
+
+            /**
+             * @param limit - max bytes charged at once.
+             **/
+            explicit Query_Memory(size_t limit = Unlimited): _limit(limit) { }
+
+            Query_Memory(const Query_Memory&) = delete;
+            Query_Memory& operator=(const Query_Memory&) = delete;
+
+            /**
+             * Charge the allocation of `bytes`.
+             *
+             * @throws Memory_Limit_Exceeded if the limit would be exceeded, nothing is charged then.
+             **/
+            void acquire(size_t bytes) noexcept(false) {
+                const size_t now = _bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+                if (now > _limit || now < bytes) {
+                    _bytes.fetch_sub(bytes, std::memory_order_relaxed);
+                    throw Memory_Limit_Exceeded(now < bytes ? Unlimited : now, _limit);
+                }
+
+                _allocations.fetch_add(1, std::memory_order_relaxed);
+
+                size_t peak = _peak.load(std::memory_order_relaxed);
+                while (now > peak && !_peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) { }
+            }
+
+            void release(size_t bytes) {
+                _bytes.fetch_sub(bytes, std::memory_order_relaxed);
+            }
+
+            /**
+             * Charge `bytes` until the reservation is dropped.
+             **/
+            Reservation reserve(size_t bytes) noexcept(false) {
+                return Reservation { *this, bytes };
+            }
+
+            size_t limit(void) const { return _limit; }
+
+            /**
+             * Bytes charged now.
+             **/
+            size_t bytes(void) const { return _bytes.load(std::memory_order_relaxed); }
+
+            size_t peak_bytes(void) const { return _peak.load(std::memory_order_relaxed); }
+
+            /**
+             * Count of the charged allocations.
+             **/
+            size_t allocations(void) const { return _allocations.load(std::memory_order_relaxed); }
+
+        private:
+            size_t _limit;
+            std::atomic<size_t> _bytes { 0 }, _peak { 0 }, _allocations { 0 };
+    };
+
+    /**
+     * # Bump allocator.
+     *
+     * Memory is cut from the big chunks and released all at once with the
+     * arena, so many small objects of the same lifetime (like the nodes of
+     * the syntax tree) cost no `malloc`/`free` pair each:
+     *
+     * ```cpp
+     * Arena arena { };
+     * auto *node = arena.make<Node>(kind, name);
+     * node->args = arena.copy<Node*>(args);
+     * ```
+     *
+     * Destructors are not called, so only trivially destructible types
+     * can be allocated.
+     *
+     * Chunks of the arena made with the `Query_Memory` are charged to it.
+     **/
+    class Arena {
+        public:
+            static constexpr size_t Default_Chunk_Size = (size_t)64 << 10;
+
+            Arena(): Arena(Default_Chunk_Size) { }
+
+            /**
+             * @param chunk_size - size of the chunks, bigger allocations get own chunk.
+             **/
+            explicit Arena(size_t chunk_size): _chunk_size(chunk_size) { }
+
+            explicit Arena(Query_Memory &memory, size_t chunk_size = Default_Chunk_Size):
+                _chunk_size(chunk_size), _memory(&memory) { }
+
+            Arena(Arena &&other) noexcept { *this = std::move(other); }
+            Arena& operator=(Arena &&other) noexcept;
+
+            ~Arena() { clear(); }
+
+            Arena(const Arena&) = delete;
+            Arena& operator=(const Arena&) = delete;
+
+            void* allocate(size_t size, size_t align) {
+                types::U8 *ptr = align_up(_curr, align);
+
+                if (ptr == nullptr || ptr + size > _end) return allocate_slow(size, align);
+
+                _curr = ptr + size;
+                return ptr;
+            }
+
+            template<typename T, typename... Args>
+            T* make(Args&&... args) {
+                static_assert(std::is_trivially_destructible_v<T>, "arena doesn't call destructors");
+                return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            }
+
+            /**
+             * Copy values to the arena.
+             **/
+            template<typename T>
+            std::span<T> copy(std::span<const T> values) {
+                static_assert(std::is_trivially_copyable_v<T>, "arena copies values by bytes");
+                if (values.empty()) return { };
+
+                T *ptr = (T*)allocate(values.size_bytes(), alignof(T));
+                std::copy(values.begin(), values.end(), ptr);
+                return { ptr, values.size() };
+            }
+
+            /**
+             * Bytes of all chunks.
+             **/
+            size_t allocated(void) const { return _allocated; }
+
+            /**
+             * Release all chunks.
+             **/
+            void clear(void) {
+                if (_memory) _memory->release(_allocated);
+
+                _chunks.clear();
+                _curr = _end = nullptr;
+                _allocated = 0;
+            }
+
+            /**
+             * Free all allocations, but keep one chunk for the next ones,
+             * so arena reused in a loop doesn't call `malloc` at all.
+             **/
+            void reset(void);
+
+            /**
+             * Take all chunks of the other arena, so values allocated by it
+             * live as long as this arena. The other arena is left empty.
+             *
+             * @throws Query_Memory::Memory_Limit_Exceeded if chunks don't fit the memory of this arena.
+             **/
+            void absorb(Arena &&other) noexcept(false);
+
+        private:
+            struct Chunk {
+                std::unique_ptr<types::U8[]> data;
+                size_t size;
+            };
+
+            size_t _chunk_size = Default_Chunk_Size;
+            size_t _allocated = 0;
+            Query_Memory *_memory = nullptr;
+            std::vector<Chunk> _chunks;
+            types::U8 *_curr = nullptr, *_end = nullptr;
+
+            static types::U8* align_up(types::U8 *ptr, size_t align) {
+                return (types::U8*)(((std::uintptr_t)ptr + align - 1) & ~(std::uintptr_t)(align - 1));
+            }
+
+            void* allocate_slow(size_t size, size_t align);
+    };
+}
+
+#endif // arena_hpp_INCLUDED
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <bloom.hpp>
+#include <interpreter.hpp>
+
+namespace toad_db::interact {
+    using namespace types;
+
+    /**
+     * Odd constants of the bits of the block (as in the split block filters of Parquet).
+     **/
+    static constexpr U32 Salts[8] = {
+        0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du,
+        0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u,
+    };
+
+    Blocked_Bloom::Blocked_Bloom(size_t keys, size_t bits_per_key):
+        _blocks(std::max<size_t>(1, (keys * bits_per_key + 255) / 256), Block { }) { }
+
+    Blocked_Bloom::Block Blocked_Bloom::mask_of(U64 hash) {
+        Block ret;
+        for (size_t i = 0; i < ret.size(); i++) ret[i] = (U32)1 << (((U32)hash * Salts[i]) >> 27);
+        return ret;
+    }
+
+    void Blocked_Bloom::insert(U64 hash) {
+        Block &block = _blocks[block_of(hash)];
+        const Block mask = mask_of(hash);
+        for (size_t i = 0; i < block.size(); i++) block[i] |= mask[i];
+    }
+
+    bool Blocked_Bloom::may_contain(U64 hash) const {
+        const Block &block = _blocks[block_of(hash)];
+        const Block mask = mask_of(hash);
+
+        bool ret = true;
+        for (size_t i = 0; i < block.size(); i++) ret &= (block[i] & mask[i]) == mask[i];
+        return ret;
+    }
+
+    Segment_Blooms::Segment_Blooms(const Table &table): _table(&table), _columns(table.columns().size()) { }
+
+    void Segment_Blooms::add_column(size_t column, size_t bits_per_key) {
+        auto &filters = _columns.at(column);
+        if (filters.bits_per_key == bits_per_key) return;
+
+        filters.bits_per_key = bits_per_key;
+        filters.filters.clear();
+    }
+
+    void Segment_Blooms::update(void) {
+        const size_t sealed = _table->size() / Table::Segment_Rows;
+
+        for (size_t column = 0; column < _columns.size(); column++) {
+            auto &filters = _columns[column];
+            if (!filters.bits_per_key) continue;
+
+            Domain &domain = *_table->columns()[column].domain;
+            const size_t offset = _table->column_offset(column);
+
+            while (filters.filters.size() < sealed) {
+                const size_t begin = filters.filters.size() * Table::Segment_Rows;
+
+                Blocked_Bloom filter { Table::Segment_Rows, filters.bits_per_key };
+                for (size_t row = begin; row < begin + Table::Segment_Rows; row++) {
+                    auto key = key_of(domain, _table->row_data(row) + offset);
+                    filter.insert(hash_bytes((const U8*)key.data(), key.size()));
+                }
+                filters.filters.push_back(std::move(filter));
+            }
+        }
+    }
+
+    bool Segment_Blooms::may_contain(size_t segment, size_t column, std::string_view key) const {
+        return _columns[column].filters[segment].may_contain(hash_bytes((const U8*)key.data(), key.size()));
+    }
+
+    std::string_view Segment_Blooms::key_of(Domain &domain, const U8 *value) {
+        if (!domain.is_string()) {
+            // -0.0 has the key of 0.0, NaN is kept as is, it isn't equal to any value.
+            const U8 *bytes = Domain::equality_bytes(domain.variant, value);
+            return { (const char*)(bytes ? bytes : value), domain.size_of() };
+        }
+
+        const size_t counter = Domain::counter_size_of(domain.array.capacity);
+        const size_t length = std::min<size_t>(Domain::get_counter((U8*)value, domain.array.capacity), domain.array.capacity);
+        return { (const char*)value, counter + length };
+    }
+
+    size_t Segment_Blooms::bytes(void) const {
+        size_t ret = 0;
+        for (auto &column: _columns) {
+            for (auto &filter: column.filters) ret += filter.bytes();
+        }
+        return ret;
+    }
+}
@@ -0,0 +1,126 @@
+#ifndef bloom_hpp_INCLUDED
+#define bloom_hpp_INCLUDED
+
+#include <array>
+#include <common.hpp>
+#include <string_view>
+#include <vector>
+
+namespace toad_db::interact {
+
+    /**
+     * # Blocked Bloom filter.
+     *
+     * Every key sets 8 bits in one block of 256 bits (32 bytes), one bit
+     * in every 32-bit word of the block, so the key is checked by one cache
+     * line. Filter has no false negatives, false positives are about 1% with
+     * 10 bits per key.
+     **/
+    class Blocked_Bloom {
+        public:
+            /**
+             * @param keys - count of the keys to insert.
+             * @param bits_per_key - size of the filter.
+             **/
+            Blocked_Bloom(size_t keys, size_t bits_per_key);
+
+            void insert(types::U64 hash);
+            bool may_contain(types::U64 hash) const;
+
+            size_t bytes(void) const { return _blocks.size() * sizeof(Block); }
+
+        private:
+            using Block = std::array<types::U32, 8>;
+
+            std::vector<Block> _blocks;
+
+            /* Block of the high bits of the hash, bits in the block are of the low ones. */
+            size_t block_of(types::U64 hash) const {
+                return (size_t)(((hash >> 32) * _blocks.size()) >> 32);
+            }
+
+            static Block mask_of(types::U64 hash);
+    };
+
+    /**
+     * # Bloom filters of the sealed segments.
+     *
+     * Filters are built for the columns they are added for, one per sealed
+     * segment (@see compression::Compressed_Segments), so equality filters
+     * and join probes skip the segments without the value:
+     *
+     * ```
+     *  segment:   0          1          2          3
+     *  name:      bloom      bloom      bloom      not sealed
+     *  name == "j.doe":  skipped  skipped  filtered   filtered
+     * ```
+     *
+     * Key of the value is its bytes, strings are taken up to their length,
+     * so the key is equal iff the values are equal by `==`.
+     *
+     * ```cpp
+     * Segment_Blooms blooms { table };
+     * blooms.add_column(2);
+     * blooms.update();
+     *
+     * auto rows = vectorized::Batch_Filter { table, predicate, { nullptr, nullptr, &blooms } }.filter(engine);
+     * ```
+     **/
+    class Segment_Blooms {
+        public:
+            static constexpr size_t Bits_Per_Key = 10;
+
+            /**
+             * Table must outlive the filters.
+             **/
+            explicit Segment_Blooms(const Table &table);
+
+            /**
+             * Build filters of the column, they are built by the next update.
+             *
+             * @throws std::out_of_range if there is no such column.
+             **/
+            void add_column(size_t column, size_t bits_per_key = Bits_Per_Key) noexcept(false);
+
+            bool has(size_t column) const { return _columns[column].bits_per_key != 0; }
+
+            /**
+             * Build filters of the segments sealed since the last update.
+             **/
+            void update(void);
+
+            /**
+             * Count of the segments with the filter of the column.
+             **/
+            size_t sealed(size_t column) const { return _columns[column].filters.size(); }
+
+            /**
+             * Value may be in the column of the segment, segment must have the filter.
+             *
+             * @param key - key of the value (@see key_of).
+             **/
+            bool may_contain(size_t segment, size_t column, std::string_view key) const;
+
+            /**
+             * Key of the value of the domain, equal values have equal keys
+             * (@see Domain::equality_bytes).
+             **/
+            static std::string_view key_of(Domain &domain, const types::U8 *value);
+
+            /**
+             * Bytes of all filters.
+             **/
+            size_t bytes(void) const;
+
+        private:
+            struct Column_Filters {
+                size_t bits_per_key = 0;
+                std::vector<Blocked_Bloom> filters;
+            };
+
+            const Table *_table;
+            std::vector<Column_Filters> _columns;
+    };
+}
+
+#endif // bloom_hpp_INCLUDED
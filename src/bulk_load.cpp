@@ -0,0 +1,305 @@
+#include <array>
+#include <bulk_load.hpp>
+#include <charconv>
+
+namespace toad_db::parser {
+    using namespace types;
+
+    namespace {
+        enum Char_Class: U8 {
+            Other = 0, Space, Digit, Name_Char
+        };
+
+        constexpr std::array<Char_Class, 256> char_classes = [] {
+            std::array<Char_Class, 256> ret { };
+
+            for (char c: { ' ', '\n', '\r', '\t' }) ret[(U8)c] = Space;
+            for (int c = 'a'; c <= 'z'; c++) ret[c] = Name_Char;
+            for (int c = 'A'; c <= 'Z'; c++) ret[c] = Name_Char;
+            for (int c = '0'; c <= '9'; c++) ret[c] = Digit;
+            ret['_'] = Name_Char;
+
+            return ret;
+        }();
+
+        Char_Class class_of(char c) { return char_classes[(U8)c]; }
+
+        /**
+         * Literal of the row as it's written in the statement.
+         **/
+        struct Literal {
+            enum Kind: char {
+                None = 0, Str, Char, Num, True, False
+            } kind = None;
+
+            /**
+             * Text without quotes for `Str` and `Char`.
+             **/
+            std::string_view text;
+        };
+
+        struct Cursor {
+            const char *curr, *end;
+
+            void skip_spaces(void) {
+                while (curr < end && class_of(*curr) == Space) curr++;
+            }
+
+            bool eat(char c) {
+                skip_spaces();
+                if (curr == end || *curr != c) return false;
+
+                curr++;
+                return true;
+            }
+
+            bool eat(std::string_view str) {
+                skip_spaces();
+                if (std::string_view { curr, (size_t)(end - curr) }.starts_with(str) == false) return false;
+
+                curr += str.size();
+                return true;
+            }
+
+            std::string_view name(void) {
+                skip_spaces();
+
+                const char *start = curr;
+                if (curr == end || class_of(*curr) != Name_Char) return { };
+                while (curr < end && class_of(*curr) >= Digit) curr++;
+
+                return { start, (size_t)(curr - start) };
+            }
+
+            Literal literal(void) {
+                skip_spaces();
+                if (curr == end) return { };
+
+                const char *start = curr;
+
+                if (*curr == '"' || *curr == '\'') {
+                    const char *close = (const char*)std::memchr(curr + 1, *curr, end - curr - 1);
+                    if (close == nullptr) return { };
+
+                    curr = close + 1;
+                    return { *start == '"' ? Literal::Str : Literal::Char,
+                             { start + 1, (size_t)(close - start - 1) } };
+                }
+
+                if (*curr == '+' || *curr == '-') curr++;
+                if (curr < end && class_of(*curr) == Digit) {
+                    while (curr < end) {
+                        const char c = *curr;
+                        const bool sign = (c == '+' || c == '-') && (curr[-1] == 'e' || curr[-1] == 'E');
+                        if (class_of(c) != Digit && c != '.' && c != 'e' && c != 'E' && !sign) break;
+                        curr++;
+                    }
+                    return { Literal::Num, { start, (size_t)(curr - start) } };
+                }
+
+                curr = start;
+                const std::string_view word = name();
+                if (word == "true") return { Literal::True, word };
+                if (word == "false") return { Literal::False, word };
+
+                return { };
+            }
+        };
+
+        /**
+         * Result of the decoding of a literal to a column.
+         **/
+        enum class Decoded: char {
+            Ok = 0,
+
+            /**
+             * Literal doesn't suit the column at all (`"str"` to `U32`),
+             * statement is left for the general parser.
+             **/
+            Declined,
+
+            No_Such_Column, Out_Of_Range, Not_Number, Too_Long, Not_One_Char,
+        };
+
+        const char* to_message(Decoded decoded) {
+            switch (decoded) {
+            case Decoded::Out_Of_Range: return "value is out of range of the column domain";
+            case Decoded::Not_Number:   return "not valid number for the column domain";
+            case Decoded::Too_Long:     return "string is longer than capacity of the column domain";
+            case Decoded::Not_One_Char: return "char literal must be exactly one char";
+            default:                    return "";
+            }
+        }
+
+        template<typename Type>
+        Decoded decode_number(std::string_view text, U8 *out) {
+            // `from_chars` doesn't accept the plus sign.
+            if (text[0] == '+') text.remove_prefix(1);
+
+            Type value;
+            auto [ptr, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+
+            if (error == std::errc::result_out_of_range) return Decoded::Out_Of_Range;
+            if (error != std::errc() || ptr != text.data() + text.size()) return Decoded::Not_Number;
+
+            std::memcpy(out, &value, sizeof(Type));
+            return Decoded::Ok;
+        }
+
+        Decoded decode(const Domain &domain, const Literal &literal, U8 *out) {
+            using Variant = Domain::Variant;
+
+            if (Domain::is_array(domain.variant)) {
+                if (literal.kind != Literal::Str || (*domain.domains)[domain.array.idx].variant != Variant::I8)
+                    return Decoded::Declined;
+
+                const size_t capacity = domain.array.capacity;
+                if (literal.text.size() > capacity) return Decoded::Too_Long;
+
+                Domain::set_counter(out, capacity, literal.text.size());
+                std::memcpy(out + Domain::counter_size_of(capacity), literal.text.data(), literal.text.size());
+                return Decoded::Ok;
+            }
+
+            if (domain.variant == Variant::Bool) {
+                if (literal.kind != Literal::True && literal.kind != Literal::False) return Decoded::Declined;
+
+                *(Bool*)out = literal.kind == Literal::True;
+                return Decoded::Ok;
+            }
+
+            if (literal.kind == Literal::Char) {
+                if (domain.variant != Variant::I8 && domain.variant != Variant::U8) return Decoded::Declined;
+                if (literal.text.size() != 1) return Decoded::Not_One_Char;
+
+                *out = (U8)literal.text[0];
+                return Decoded::Ok;
+            }
+
+            if (literal.kind != Literal::Num) return Decoded::Declined;
+
+            switch (domain.variant) {
+            case Variant::U8:  return decode_number<U8>(literal.text, out);
+            case Variant::U16: return decode_number<U16>(literal.text, out);
+            case Variant::U32: return decode_number<U32>(literal.text, out);
+            case Variant::U64: return decode_number<U64>(literal.text, out);
+            case Variant::I8:  return decode_number<I8>(literal.text, out);
+            case Variant::I16: return decode_number<I16>(literal.text, out);
+            case Variant::I32: return decode_number<I32>(literal.text, out);
+            case Variant::I64: return decode_number<I64>(literal.text, out);
+            case Variant::F32: return decode_number<F32>(literal.text, out);
+            case Variant::F64: return decode_number<F64>(literal.text, out);
+            default:           return Decoded::Declined;
+            }
+        }
+    }
+
+    void Bulk_Loader::add_table(const std::string &name, Table &table) {
+        Target target { name, &table, { } };
+
+        for (size_t i = 0; i < table.columns().size(); i++) {
+            const auto &column = table.columns()[i];
+            target.columns.push_back(Column { column.name, table.column_offset(i), column.domain, column.dictionary != nullptr });
+        }
+
+        if (Target *old = find_target(name)) {
+            *old = std::move(target);
+        } else {
+            _targets.push_back(std::move(target));
+        }
+    }
+
+    Bulk_Loader::Target* Bulk_Loader::find_target(std::string_view name) {
+        for (auto &target: _targets) {
+            if (target.name == name) return &target;
+        }
+
+        return nullptr;
+    }
+
+    bool Bulk_Loader::load_stmt(std::string_view stmt) {
+        Cursor cursor { stmt.data(), stmt.data() + stmt.size() };
+
+        Target *target = find_target(cursor.name());
+        if (target == nullptr || !cursor.eat("<<")) return false;
+
+        const size_t row_size = target->table->row_size();
+        size_t rows = 0;
+
+        // Data errors are thrown only after the whole statement is recognized,
+        // `level: 300 - 100` is not an error for `U8` column.
+        Decoded error = Decoded::Ok;
+        std::string_view error_part;
+
+        _rows.clear();
+
+        do {
+            if (!cursor.eat('{')) return false;
+
+            _rows.resize(_rows.size() + row_size);
+            U8 *row = _rows.data() + rows++ * row_size;
+
+            if (cursor.eat('}')) continue;
+
+            // Rows are usually written in the order of the columns.
+            size_t expected = 0;
+
+            do {
+                const std::string_view field = cursor.name();
+                if (field.empty() || !cursor.eat(':')) return false;
+
+                const char *literal_start = cursor.curr;
+                const Literal literal = cursor.literal();
+                if (literal.kind == Literal::None) return false;
+
+                size_t idx = expected;
+                if (idx >= target->columns.size() || target->columns[idx].name != field) {
+                    for (idx = 0; idx < target->columns.size() && target->columns[idx].name != field; idx++);
+                }
+
+                if (idx == target->columns.size()) {
+                    if (error == Decoded::Ok) {
+                        error = Decoded::No_Such_Column;
+                        error_part = field;
+                    }
+                    continue;
+                }
+                expected = idx + 1;
+
+                const Column &column = target->columns[idx];
+                const Decoded decoded = column.encoded ? Decoded::Declined : decode(*column.domain, literal, row + column.offset);
+
+                if (decoded == Decoded::Declined) return false;
+                if (decoded != Decoded::Ok && error == Decoded::Ok) {
+                    error = decoded;
+                    error_part = trim_left({ literal_start, cursor.curr });
+                }
+            } while (cursor.eat(','));
+
+            if (!cursor.eat('}')) return false;
+        } while (cursor.eat("<<"));
+
+        cursor.eat(';');
+        cursor.skip_spaces();
+        if (cursor.curr != cursor.end) return false;
+
+        if (error == Decoded::No_Such_Column) {
+            throw Bulk_Load_Failed("table `" + target->name + "` has not column `" + std::string(error_part) + "`",
+                                   error_help(stmt, error_part));
+        }
+        if (error != Decoded::Ok) throw Bulk_Load_Failed(to_message(error), error_help(stmt, error_part));
+
+        std::memcpy(target->table->append_rows(rows), _rows.data(), _rows.size());
+        _loaded_rows += rows;
+
+        return true;
+    }
+
+    size_t Bulk_Loader::load_stream(int fd, const Syntax_Tree::Stmt_Callback &fallback) {
+        return Syntax_Tree::parse_stream(fd, fallback, [this] (std::string_view stmt) { return load_stmt(stmt); });
+    }
+
+    size_t Bulk_Loader::load_file(const std::string &path, const Syntax_Tree::Stmt_Callback &fallback) {
+        return Syntax_Tree::parse_file(path, fallback, [this] (std::string_view stmt) { return load_stmt(stmt); });
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef bulk_load_hpp_INCLUDED
+#define bulk_load_hpp_INCLUDED
+
+#include <common.hpp>
+#include <parser.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace toad_db::parser {
+
+    /**
+     * # Direct loader of the literal inserts.
+     *
+     * Data dumps are long scripts of inserts with literal rows:
+     *
+     * ```
+     * Groups << { title: "admin", level: 2 } << { title: "user", level: 1 };
+     * ```
+     *
+     * Loader recognizes such statements without the syntax tree and decodes
+     * literals right to the row encoding of the target table: numbers by
+     * `std::from_chars`, strings by copy of the bytes after the length counter.
+     * Other statements (and inserts it doesn't understand, like `level: 1 + 1`)
+     * go to the general parser:
+     *
+     * ```cpp
+     * Bulk_Loader loader { };
+     * loader.add_table("Groups", groups);
+     * loader.load_file("dump.toad", [&](auto &stmt) { execute(stmt); });
+     * ```
+     *
+     * Understood literals are numbers (with sign, fraction and exponent for
+     * floats), `true`/`false` for `Bool`, `'c'` for `I8`/`U8` and strings for
+     * arrays of `I8`. Columns missing in the row are zeroed.
+     **/
+    class Bulk_Loader {
+        public:
+            class Bulk_Load_Failed: public Parsing_Exception {
+                public:
+                    Bulk_Load_Failed(const std::string &why, const std::string &error_help):
+                        Parsing_Exception("Failed to load row: " + why + "\n" + error_help) { }
+            };
+
+            /**
+             * Register the table as a target of inserts by the name.
+             * Table must outlive the loader.
+             **/
+            void add_table(const std::string &name, Table &table);
+
+            /**
+             * Load the statement if it's an insert of literal rows to a known table.
+             *
+             * Rows of the statement are appended all at once, so nothing is
+             * appended if statement is declined or fails.
+             *
+             * @return false if the statement is not such insert.
+             * @throws Bulk_Load_Failed if there is no such column or the value doesn't fit it.
+             **/
+            bool load_stmt(std::string_view stmt) noexcept(false);
+
+            /**
+             * Load the script from the file descriptor, statements not taken by
+             * the loader are parsed and passed to the `fallback`.
+             * @see Syntax_Tree::parse_stream
+             *
+             * @return count of statements.
+             **/
+            size_t load_stream(int fd, const Syntax_Tree::Stmt_Callback &fallback) noexcept(false);
+
+            /**
+             * Same as `load_stream` for the mapped file.
+             * @see Syntax_Tree::parse_file
+             **/
+            size_t load_file(const std::string &path, const Syntax_Tree::Stmt_Callback &fallback) noexcept(false);
+
+            /**
+             * Count of rows appended by the loader.
+             **/
+            size_t loaded_rows(void) const { return _loaded_rows; }
+
+        private:
+            struct Column {
+                std::string name;
+                size_t offset;
+                Domain *domain;
+
+                /**
+                 * Values of the dictionary-encoded column are inserted by the table.
+                 **/
+                bool encoded;
+            };
+
+            struct Target {
+                std::string name;
+                Table *table;
+                std::vector<Column> columns;
+            };
+
+            std::vector<Target> _targets;
+
+            /**
+             * Rows of the current statement in the table encoding.
+             **/
+            std::vector<types::U8> _rows;
+
+            size_t _loaded_rows = 0;
+
+            Target* find_target(std::string_view name);
+    };
+}
+
+#endif // bulk_load_hpp_INCLUDED
@@ -0,0 +1,557 @@
+#include <bytecode.hpp>
+#include <charconv>
+#include <iostream>
+
+namespace toad_db::interact::bytecode {
+    using namespace types;
+
+    std::string to_string(Type type) {
+        switch (type) {
+        case Type::Int:   return "Int";
+        case Type::Uint:  return "Uint";
+        case Type::Float: return "Float";
+        case Type::Bool:  return "Bool";
+        case Type::Str:   return "Str";
+        }
+        return "";
+    }
+
+    static const char* op_name(Op op) {
+        static const char* names[] = {
+            "load_u8", "load_u16", "load_u32", "load_u64",
+            "load_i8", "load_i16", "load_i32", "load_i64",
+            "load_f32", "load_f64", "load_bool",
+            "load_variant", "const",
+            "int_to_float", "uint_to_float",
+            "add_i", "add_u", "add_f", "sub_i", "sub_u", "sub_f",
+            "mul_i", "mul_u", "mul_f", "div_i", "div_u", "div_f",
+            "eq", "eq_f", "ne", "ne_f",
+            "lt_i", "lt_u", "lt_f", "le_i", "le_u", "le_f",
+            "gt_i", "gt_u", "gt_f", "ge_i", "ge_u", "ge_f",
+            "eq_iu", "ne_iu", "lt_iu", "le_iu", "gt_iu", "ge_iu",
+            "and", "or",
+            "eq_str_const", "ne_str_const", "eq_str", "ne_str",
+        };
+        return names[(size_t)op];
+    }
+
+    std::ostream& operator<<(std::ostream& os, const Program& program) {
+        for (auto &ins: program.code) {
+            os << "r" << (int)ins.dst << " = " << op_name(ins.op);
+
+            switch (ins.op) {
+            case Op::Load_U8: case Op::Load_U16: case Op::Load_U32: case Op::Load_U64:
+            case Op::Load_I8: case Op::Load_I16: case Op::Load_I32: case Op::Load_I64:
+            case Op::Load_F32: case Op::Load_F64: case Op::Load_Bool: case Op::Load_Variant:
+                os << " [" << ins.a << "]";
+                break;
+            case Op::Load_Const:
+                os << " " << program.consts[ins.a].i;
+                break;
+            case Op::Int_To_Float: case Op::Uint_To_Float:
+                os << " r" << ins.a;
+                break;
+            case Op::Eq_Str_Const: case Op::Ne_Str_Const:
+                os << " [" << ins.a << "] \"" << program.strings[ins.b] << "\"";
+                break;
+            case Op::Eq_Str: case Op::Ne_Str:
+                os << " [" << ins.a << "] [" << ins.b << "]";
+                break;
+            default:
+                os << " r" << ins.a << " r" << ins.b;
+            }
+            os << std::endl;
+        }
+        return os << "ret r" << (int)program.result << " (" << to_string(program.result_type) << ")" << std::endl;
+    }
+
+    void store(Value value, Type type, Domain_View dest) {
+        const auto as = [&]<typename T>() -> T {
+            switch (type) {
+            case Type::Float: return (T)value.f;
+            case Type::Int:   return (T)value.i;
+            default:          return (T)value.u;
+            }
+        };
+
+        switch (dest.domain->variant) {
+        case Domain::Variant::U8:   dest.set_basic(as.operator()<U8>()); break;
+        case Domain::Variant::U16:  dest.set_basic(as.operator()<U16>()); break;
+        case Domain::Variant::U32:  dest.set_basic(as.operator()<U32>()); break;
+        case Domain::Variant::U64:  dest.set_basic(as.operator()<U64>()); break;
+        case Domain::Variant::I8:   dest.set_basic(as.operator()<I8>()); break;
+        case Domain::Variant::I16:  dest.set_basic(as.operator()<I16>()); break;
+        case Domain::Variant::I32:  dest.set_basic(as.operator()<I32>()); break;
+        case Domain::Variant::I64:  dest.set_basic(as.operator()<I64>()); break;
+        case Domain::Variant::F32:  dest.set_basic(as.operator()<F32>()); break;
+        case Domain::Variant::F64:  dest.set_basic(as.operator()<F64>()); break;
+        case Domain::Variant::Bool: dest.set_basic<Bool>(value.u != 0); break;
+        default:
+            throw Unsupported_Expression(dest.domain->domain_name, "result can be stored only to basic domain");
+        }
+    }
+
+
+    U8 Compiler::alloc_register(void) {
+        if (_program.registers > 0xFF)
+            throw Compile_Exception("Expression is too big (out of registers)");
+        return (U8)_program.registers++;
+    }
+
+    Compiler::Operand Compiler::emit(Op op, Type type, U32 a, U32 b, U8 x, U8 y) {
+        Operand ret { alloc_register(), type };
+        _program.code.push_back({ op, ret.reg, x, y, a, b });
+        return ret;
+    }
+
+    Program Compiler::compile(const Node::pointer &root) {
+        _program = Program { };
+
+        auto result = compile_node(root, nullptr);
+        if (result.type == Type::Str)
+            throw Unsupported_Expression(root->name, "string can be only compared");
+
+        _program.result = result.reg;
+        _program.result_type = result.type;
+
+        return std::move(_program);
+    }
+
+    /**
+     * Unwrap `{expr}` and `(expr)` nodes.
+     **/
+    static const Compiler::Node::pointer& unwrap(const Compiler::Node::pointer &node) {
+        using Kind = Compiler::Node::Kind;
+
+        if (node->kind == Kind::Expression && node->args.size() == 1)
+            return unwrap(node->args[0]);
+
+        if (node->kind == Kind::Bound_Operator && node->name == "(" && node->args.size() == 2)
+            return unwrap(node->args[0]);
+
+        return node;
+    }
+
+    const Domain* Compiler::domain_of(const Node::pointer &node) const {
+        auto &unwrapped = unwrap(node);
+        if (unwrapped->kind != Node::Kind::Name) return nullptr;
+
+        for (auto &column: _table.columns()) {
+            if (column.name == unwrapped->name) return column.domain;
+        }
+
+        return nullptr;
+    }
+
+    Compiler::Operand Compiler::compile_node(const Node::pointer &node, const Domain *hint) {
+        auto &unwrapped = unwrap(node);
+
+        switch (unwrapped->kind) {
+        case Node::Kind::Name:
+            return compile_name(unwrapped, hint);
+
+        case Node::Kind::Num_Literal:
+        case Node::Kind::Char_Literal:
+        case Node::Kind::Str_Literal:
+            return compile_literal(unwrapped);
+
+        case Node::Kind::Operator:
+            return compile_binary(unwrapped);
+
+        default:
+            throw Unsupported_Expression(unwrapped->name, "not an operator, name or literal");
+        }
+    }
+
+    Compiler::Operand Compiler::compile_name(const Node::pointer &node, const Domain *hint) {
+        if (node->args.size() != 0)
+            throw Unsupported_Expression(node->name, "function calls are not supported");
+
+        if (node->name.starts_with("$")) return compile_param(node, hint);
+
+        if (node->name == "true" || node->name == "false") {
+            _program.consts.push_back({ .u = node->name == "true" });
+            auto ret = emit(Op::Load_Const, Type::Bool, _program.consts.size() - 1);
+            ret.is_const = true;
+            ret.const_idx = _program.consts.size() - 1;
+            return ret;
+        }
+
+        const auto &columns = _table.columns();
+        for (size_t i = 0; i < columns.size(); i++) {
+            if (columns[i].name != node->name) continue;
+
+            if (columns[i].dictionary)
+                throw Unsupported_Expression(node->name, "dictionary-encoded column is only compared by `==` and `!=`");
+
+            Domain *domain = columns[i].domain;
+            const U32 offset = _table.column_offset(i);
+
+            switch (domain->variant) {
+            case Domain::Variant::U8:   return emit(Op::Load_U8,   Type::Uint,  offset);
+            case Domain::Variant::U16:  return emit(Op::Load_U16,  Type::Uint,  offset);
+            case Domain::Variant::U32:  return emit(Op::Load_U32,  Type::Uint,  offset);
+            case Domain::Variant::U64:  return emit(Op::Load_U64,  Type::Uint,  offset);
+            case Domain::Variant::I8:   return emit(Op::Load_I8,   Type::Int,   offset);
+            case Domain::Variant::I16:  return emit(Op::Load_I16,  Type::Int,   offset);
+            case Domain::Variant::I32:  return emit(Op::Load_I32,  Type::Int,   offset);
+            case Domain::Variant::I64:  return emit(Op::Load_I64,  Type::Int,   offset);
+            case Domain::Variant::F32:  return emit(Op::Load_F32,  Type::Float, offset);
+            case Domain::Variant::F64:  return emit(Op::Load_F64,  Type::Float, offset);
+            case Domain::Variant::Bool: return emit(Op::Load_Bool, Type::Bool,  offset);
+
+            case Domain::Variant::Add:
+                return emit(Op::Load_Variant, Type::Uint, offset, 0,
+                            (U8)Domain::counter_size_of(domain->complex_fields.size()));
+
+            case Domain::Variant::Array:
+                if (domain->is_string()) {
+                    Operand ret { 0, Type::Str };
+                    ret.is_column = true;
+                    ret.offset = offset;
+                    ret.counter_size = (U8)Domain::counter_size_of(domain->array.capacity);
+                    return ret;
+                }
+                [[fallthrough]];
+
+            default:
+                throw Unsupported_Expression(node->name,
+                        "column of domain `" + domain->domain_name + "` can't be used in expressions");
+            }
+        }
+
+        if (hint != nullptr && hint->variant == Domain::Variant::Add) {
+            for (size_t i = 0; i < hint->complex_fields.size(); i++) {
+                const auto &field = hint->complex_fields[i];
+                if (field.field_name != node->name || field.has_type) continue;
+
+                _program.consts.push_back({ .u = i });
+                auto ret = emit(Op::Load_Const, Type::Uint, _program.consts.size() - 1);
+                ret.is_const = true;
+                ret.const_idx = _program.consts.size() - 1;
+                return ret;
+            }
+        }
+
+        throw Unknown_Name(node->name);
+    }
+
+    Compiler::Operand Compiler::compile_literal(const Node::pointer &node) {
+        std::string_view text = node->name;
+
+        switch (node->kind) {
+        case Node::Kind::Str_Literal: {
+            if (text.size() < 2)
+                throw Unsupported_Expression(text, "not terminated string literal");
+
+            _program.strings.push_back(std::string(text.substr(1, text.size() - 2)));
+
+            Operand ret { 0, Type::Str };
+            ret.string = _program.strings.size() - 1;
+            return ret;
+        }
+
+        case Node::Kind::Char_Literal: {
+            if (text.size() < 3)
+                throw Unsupported_Expression(text, "empty char literal");
+
+            _program.consts.push_back({ .i = text[1] });
+        } break;
+
+        default: {
+            if (text.starts_with("+")) text.remove_prefix(1);
+
+            I64 value = 0;
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (error != std::errc { } || end != text.data() + text.size())
+                throw Unsupported_Expression(node->name, "invalid number literal");
+
+            _program.consts.push_back({ .i = value });
+        }
+        }
+
+        auto ret = emit(Op::Load_Const, Type::Int, _program.consts.size() - 1);
+        ret.is_const = true;
+        ret.const_idx = _program.consts.size() - 1;
+        return ret;
+    }
+
+    Compiler::Operand Compiler::compile_param(const Node::pointer &node, const Domain *hint) {
+        if (hint == nullptr)
+            throw Unsupported_Expression(node->name, "type of the parameter is unknown, use it with a column");
+
+        Type type;
+        if (Domain::is_uint(hint->variant))                    type = Type::Uint;
+        else if (Domain::is_sint(hint->variant))               type = Type::Int;
+        else if (Domain::is_float(hint->variant))              type = Type::Float;
+        else if (Domain::is_bool(hint->variant))               type = Type::Bool;
+        else if (Domain::is_array(hint->variant)
+                 && (*hint->domains)[hint->array.idx].variant == Domain::Variant::I8) type = Type::Str;
+        else throw Unsupported_Expression(node->name,
+                    "parameter can't be used with domain `" + hint->domain_name + "`");
+
+        auto param = std::find_if(_program.params.begin(), _program.params.end(),
+                                  [&](const Param &param) { return param.name == node->name; });
+        if (param == _program.params.end()) {
+            _program.params.push_back(Param { std::string(node->name), type });
+            param = _program.params.end() - 1;
+        } else if (param->type != type) {
+            throw Unsupported_Expression(node->name, "parameter is used as " + to_string(param->type)
+                                                     + " and as " + to_string(type));
+        }
+        const U32 param_idx = param - _program.params.begin();
+
+        if (type == Type::Str) {
+            _program.strings.push_back("");
+            _program.param_uses.push_back({ param_idx, (U32)_program.strings.size() - 1 });
+
+            Operand ret { 0, Type::Str };
+            ret.string = _program.strings.size() - 1;
+            return ret;
+        }
+
+        _program.consts.push_back({ .u = 0 });
+        _program.param_uses.push_back({ param_idx, (U32)_program.consts.size() - 1 });
+
+        return emit(Op::Load_Const, type, _program.consts.size() - 1);
+    }
+
+    Compiler::Operand Compiler::convert(Operand operand, Type type) {
+        if (operand.type == type) return operand;
+
+        if (type == Type::Float) {
+            if (operand.type == Type::Int)
+                return emit(Op::Int_To_Float, Type::Float, operand.reg);
+            if (operand.type == Type::Uint)
+                return emit(Op::Uint_To_Float, Type::Float, operand.reg);
+        }
+
+        if ((type == Type::Int || type == Type::Uint)
+            && (operand.type == Type::Int || operand.type == Type::Uint)) {
+            operand.type = type;
+            return operand;
+        }
+
+        throw Compile_Exception("Can't convert " + to_string(operand.type) + " to " + to_string(type));
+    }
+
+    /**
+     * Typed opcodes of the binary operator: [Int, Uint, Float], and of the
+     * comparison of Int with Uint: [Int op Uint, Uint op Int (operands swapped)].
+     **/
+    struct Binary_Ops {
+        std::string_view name;
+        Op ops[3];
+        bool is_compare;
+        Op mixed[2];
+    };
+
+    static const Binary_Ops binary_ops[] = {
+        { "+",  { Op::Add_I,  Op::Add_U,  Op::Add_F }, false, { } },
+        { "-",  { Op::Sub_I,  Op::Sub_U,  Op::Sub_F }, false, { } },
+        { "*",  { Op::Mul_I,  Op::Mul_U,  Op::Mul_F }, false, { } },
+        { "/",  { Op::Div_I,  Op::Div_U,  Op::Div_F }, false, { } },
+        { "==", { Op::Eq_Int, Op::Eq_Int, Op::Eq_F  }, true,  { Op::Eq_IU, Op::Eq_IU } },
+        { "!=", { Op::Ne_Int, Op::Ne_Int, Op::Ne_F  }, true,  { Op::Ne_IU, Op::Ne_IU } },
+        { "<",  { Op::Lt_I,   Op::Lt_U,   Op::Lt_F  }, true,  { Op::Lt_IU, Op::Gt_IU } },
+        { "<=", { Op::Le_I,   Op::Le_U,   Op::Le_F  }, true,  { Op::Le_IU, Op::Ge_IU } },
+        { ">",  { Op::Gt_I,   Op::Gt_U,   Op::Gt_F  }, true,  { Op::Gt_IU, Op::Lt_IU } },
+        { ">=", { Op::Ge_I,   Op::Ge_U,   Op::Ge_F  }, true,  { Op::Ge_IU, Op::Le_IU } },
+    };
+
+    Compiler::Operand Compiler::compile_binary(const Node::pointer &node) {
+        if (node->args.size() != 2)
+            throw Unsupported_Expression(node->name, "expected two operands");
+
+        auto lhs = compile_node(node->args[0], domain_of(node->args[1]));
+        auto rhs = compile_node(node->args[1], domain_of(node->args[0]));
+
+        if (node->name == "&&" || node->name == "||") {
+            if (lhs.type != Type::Bool || rhs.type != Type::Bool)
+                throw Unsupported_Expression(node->name, "operands must be Bool");
+
+            return emit(node->name == "&&" ? Op::And : Op::Or, Type::Bool, lhs.reg, rhs.reg);
+        }
+
+        auto op = std::find_if(std::begin(binary_ops), std::end(binary_ops),
+                               [&](auto &op) { return op.name == node->name; });
+        if (op == std::end(binary_ops))
+            throw Unsupported_Expression(node->name, "unknown operator");
+
+        if (lhs.type == Type::Str || rhs.type == Type::Str) {
+            if (lhs.type != rhs.type || (node->name != "==" && node->name != "!="))
+                throw Unsupported_Expression(node->name, "strings can be only compared with strings");
+
+            const bool eq = node->name == "==";
+            if (!lhs.is_column) std::swap(lhs, rhs);
+
+            if (!lhs.is_column) {
+                _program.consts.push_back({ .u = (_program.strings[lhs.string] == _program.strings[rhs.string]) == eq });
+                return emit(Op::Load_Const, Type::Bool, _program.consts.size() - 1);
+            }
+
+            if (!rhs.is_column)
+                return emit(eq ? Op::Eq_Str_Const : Op::Ne_Str_Const, Type::Bool,
+                            lhs.offset, rhs.string, lhs.counter_size);
+
+            return emit(eq ? Op::Eq_Str : Op::Ne_Str, Type::Bool,
+                        lhs.offset, rhs.offset, lhs.counter_size, rhs.counter_size);
+        }
+
+        if (lhs.type == Type::Bool || rhs.type == Type::Bool) {
+            if (lhs.type != rhs.type || (node->name != "==" && node->name != "!="))
+                throw Unsupported_Expression(node->name, "Bool can be only compared with Bool");
+
+            return emit(op->ops[0], Type::Bool, lhs.reg, rhs.reg);
+        }
+
+        /* Not negative integer constant takes type of the other operand. */
+        const auto fits_uint = [&](const Operand &operand) {
+            return operand.is_const && operand.type == Type::Int
+                && _program.consts[operand.const_idx].i >= 0;
+        };
+
+        Type type = Type::Int;
+        if (lhs.type == Type::Float || rhs.type == Type::Float) type = Type::Float;
+        else if (lhs.type == Type::Uint && (rhs.type == Type::Uint || fits_uint(rhs))) type = Type::Uint;
+        else if (rhs.type == Type::Uint && fits_uint(lhs)) type = Type::Uint;
+
+        /* Uint may be above every Int, so they are compared by the mixed ops (`u > -1` is true for any `u`). */
+        if (op->is_compare && type == Type::Int && (lhs.type == Type::Uint || rhs.type == Type::Uint)) {
+            if (lhs.type == Type::Uint) return emit(op->mixed[1], Type::Bool, rhs.reg, lhs.reg);
+            return emit(op->mixed[0], Type::Bool, lhs.reg, rhs.reg);
+        }
+
+        /* Arithmetic of Int with Uint is of Int, it wraps around as the U64 to I64 conversion. */
+        lhs = convert(lhs, type);
+        rhs = convert(rhs, type);
+
+        const size_t typed = type == Type::Int ? 0 : type == Type::Uint ? 1 : 2;
+        return emit(op->ops[typed], op->is_compare ? Type::Bool : type, lhs.reg, rhs.reg);
+    }
+
+
+    template<typename T>
+    static inline T load(const U8 *data) {
+        T ret;
+        std::memcpy(&ret, data, sizeof(T));
+        return ret;
+    }
+
+    static inline size_t load_counter(const U8 *data, U8 size) {
+        switch (size) {
+        case sizeof(U8):  return load<U8>(data);
+        case sizeof(U16): return load<U16>(data);
+        default:          return load<U32>(data);
+        }
+    }
+
+    Vm::Vm(const Program &program, std::span<const Argument> args):
+        _program(&program), _registers(program.registers),
+        _consts(program.consts), _strings(program.strings) {
+
+        if (args.size() < program.params.size()) throw Unbound_Param(program.params[args.size()].name);
+
+        for (auto &use: program.param_uses) {
+            if (program.params[use.param].type == Type::Str) {
+                _strings[use.slot] = args[use.param].string;
+            } else {
+                _consts[use.slot] = args[use.param].value;
+            }
+        }
+    }
+
+    Value Vm::eval(const U8 *row) {
+        const Program &program = *_program;
+        Value *r = _registers.data();
+
+        for (const auto &ins: program.code) {
+            Value &dst = r[ins.dst];
+
+            switch (ins.op) {
+            case Op::Load_U8:   dst.u = load<U8>(row + ins.a); break;
+            case Op::Load_U16:  dst.u = load<U16>(row + ins.a); break;
+            case Op::Load_U32:  dst.u = load<U32>(row + ins.a); break;
+            case Op::Load_U64:  dst.u = load<U64>(row + ins.a); break;
+            case Op::Load_I8:   dst.i = load<I8>(row + ins.a); break;
+            case Op::Load_I16:  dst.i = load<I16>(row + ins.a); break;
+            case Op::Load_I32:  dst.i = load<I32>(row + ins.a); break;
+            case Op::Load_I64:  dst.i = load<I64>(row + ins.a); break;
+            case Op::Load_F32:  dst.f = load<F32>(row + ins.a); break;
+            case Op::Load_F64:  dst.f = load<F64>(row + ins.a); break;
+            case Op::Load_Bool: dst.u = row[ins.a] != 0; break;
+
+            case Op::Load_Variant: dst.u = load_counter(row + ins.a, ins.x); break;
+            case Op::Load_Const:   dst = _consts[ins.a]; break;
+
+            case Op::Int_To_Float:  dst.f = (F64)r[ins.a].i; break;
+            case Op::Uint_To_Float: dst.f = (F64)r[ins.a].u; break;
+
+            case Op::Add_I: dst.i = r[ins.a].i + r[ins.b].i; break;
+            case Op::Add_U: dst.u = r[ins.a].u + r[ins.b].u; break;
+            case Op::Add_F: dst.f = r[ins.a].f + r[ins.b].f; break;
+            case Op::Sub_I: dst.i = r[ins.a].i - r[ins.b].i; break;
+            case Op::Sub_U: dst.u = r[ins.a].u - r[ins.b].u; break;
+            case Op::Sub_F: dst.f = r[ins.a].f - r[ins.b].f; break;
+            case Op::Mul_I: dst.i = r[ins.a].i * r[ins.b].i; break;
+            case Op::Mul_U: dst.u = r[ins.a].u * r[ins.b].u; break;
+            case Op::Mul_F: dst.f = r[ins.a].f * r[ins.b].f; break;
+            case Op::Div_I:
+                if (r[ins.b].i == 0) throw Division_By_Zero();
+                dst.i = r[ins.a].i / r[ins.b].i;
+                break;
+            case Op::Div_U:
+                if (r[ins.b].u == 0) throw Division_By_Zero();
+                dst.u = r[ins.a].u / r[ins.b].u;
+                break;
+            case Op::Div_F: dst.f = r[ins.a].f / r[ins.b].f; break;
+
+            case Op::Eq_Int: dst.u = r[ins.a].u == r[ins.b].u; break;
+            case Op::Eq_F:   dst.u = r[ins.a].f == r[ins.b].f; break;
+            case Op::Ne_Int: dst.u = r[ins.a].u != r[ins.b].u; break;
+            case Op::Ne_F:   dst.u = r[ins.a].f != r[ins.b].f; break;
+            case Op::Lt_I:   dst.u = r[ins.a].i <  r[ins.b].i; break;
+            case Op::Lt_U:   dst.u = r[ins.a].u <  r[ins.b].u; break;
+            case Op::Lt_F:   dst.u = r[ins.a].f <  r[ins.b].f; break;
+            case Op::Le_I:   dst.u = r[ins.a].i <= r[ins.b].i; break;
+            case Op::Le_U:   dst.u = r[ins.a].u <= r[ins.b].u; break;
+            case Op::Le_F:   dst.u = r[ins.a].f <= r[ins.b].f; break;
+            case Op::Gt_I:   dst.u = r[ins.a].i >  r[ins.b].i; break;
+            case Op::Gt_U:   dst.u = r[ins.a].u >  r[ins.b].u; break;
+            case Op::Gt_F:   dst.u = r[ins.a].f >  r[ins.b].f; break;
+            case Op::Ge_I:   dst.u = r[ins.a].i >= r[ins.b].i; break;
+            case Op::Ge_U:   dst.u = r[ins.a].u >= r[ins.b].u; break;
+            case Op::Ge_F:   dst.u = r[ins.a].f >= r[ins.b].f; break;
+
+            case Op::Eq_IU:  dst.u = r[ins.a].i >= 0 && r[ins.a].u == r[ins.b].u; break;
+            case Op::Ne_IU:  dst.u = r[ins.a].i <  0 || r[ins.a].u != r[ins.b].u; break;
+            case Op::Lt_IU:  dst.u = r[ins.a].i <  0 || r[ins.a].u <  r[ins.b].u; break;
+            case Op::Le_IU:  dst.u = r[ins.a].i <  0 || r[ins.a].u <= r[ins.b].u; break;
+            case Op::Gt_IU:  dst.u = r[ins.a].i >= 0 && r[ins.a].u >  r[ins.b].u; break;
+            case Op::Ge_IU:  dst.u = r[ins.a].i >= 0 && r[ins.a].u >= r[ins.b].u; break;
+
+            case Op::And: dst.u = r[ins.a].u && r[ins.b].u; break;
+            case Op::Or:  dst.u = r[ins.a].u || r[ins.b].u; break;
+
+            case Op::Eq_Str_Const:
+            case Op::Ne_Str_Const: {
+                const std::string &str = _strings[ins.b];
+                const size_t len = load_counter(row + ins.a, ins.x);
+                const bool eq = len == str.size()
+                                && std::memcmp(row + ins.a + ins.x, str.data(), len) == 0;
+                dst.u = eq == (ins.op == Op::Eq_Str_Const);
+            } break;
+
+            case Op::Eq_Str:
+            case Op::Ne_Str: {
+                const size_t len = load_counter(row + ins.a, ins.x);
+                const bool eq = len == load_counter(row + ins.b, ins.y)
+                                && std::memcmp(row + ins.a + ins.x, row + ins.b + ins.y, len) == 0;
+                dst.u = eq == (ins.op == Op::Eq_Str);
+            } break;
+            }
+        }
+
+        return r[program.result];
+    }
+}
@@ -0,0 +1,298 @@
+#ifndef bytecode_hpp_INCLUDED
+#define bytecode_hpp_INCLUDED
+
+#include <common.hpp>
+#include <ostream>
+#include <parser.hpp>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace toad_db::interact {
+
+    /**
+     * # Bytecode of the TQL expressions.
+     *
+     * Expressions are compiled once against the schema of the table:
+     * names are resolved to column offsets and domain variants to typed
+     * opcodes. So evaluation of the row do no string lookups, no refcounting
+     * and no virtual calls, just one switch per instruction.
+     *
+     * The code is register based, every instruction writes to `dst` register:
+     *
+     * ```
+     * level > 1    =>    r0 = load_u8 [level]
+     *                    r1 = const 1
+     *                    r2 = gt_u r0 r1
+     * ```
+     **/
+    namespace bytecode {
+        /**
+         * Value of the register.
+         * Which member is active defined by type of the instruction.
+         **/
+        union Value {
+            types::I64 i;
+            types::U64 u;
+            types::F64 f;
+        };
+
+        /**
+         * Type of the register.
+         **/
+        enum class Type: char {
+            Int, Uint, Float, Bool,
+
+            /**
+             * Arrays of I8, can be only compared.
+             **/
+            Str,
+        };
+
+        std::string to_string(Type type);
+
+        enum class Op: types::U8 {
+            /* dst = column at offset a (widened to 64 bits). */
+            Load_U8, Load_U16, Load_U32, Load_U64,
+            Load_I8, Load_I16, Load_I32, Load_I64,
+            Load_F32, Load_F64, Load_Bool,
+
+            /* dst = variant of the Add domain at offset a, x is size of the counter. */
+            Load_Variant,
+
+            /* dst = consts[a]. */
+            Load_Const,
+
+            /* dst = (F64)a. */
+            Int_To_Float, Uint_To_Float,
+
+            /* dst = a op b. */
+            Add_I, Add_U, Add_F,
+            Sub_I, Sub_U, Sub_F,
+            Mul_I, Mul_U, Mul_F,
+            Div_I, Div_U, Div_F,
+
+            /* dst = a op b, for Int and Uint equality is the same. */
+            Eq_Int, Eq_F, Ne_Int, Ne_F,
+            Lt_I, Lt_U, Lt_F,
+            Le_I, Le_U, Le_F,
+            Gt_I, Gt_U, Gt_F,
+            Ge_I, Ge_U, Ge_F,
+
+            /* dst = a op b, a is Int and b is Uint, negative a is less than every b. */
+            Eq_IU, Ne_IU, Lt_IU, Le_IU, Gt_IU, Ge_IU,
+
+            /* dst = a op b, on Bool registers. */
+            And, Or,
+
+            /**
+             * dst = string at offset a with counter size x (== | !=) strings[b].
+             **/
+            Eq_Str_Const, Ne_Str_Const,
+
+            /**
+             * dst = string at offset a with counter size x (== | !=) string
+             * at offset b with counter size y.
+             **/
+            Eq_Str, Ne_Str,
+        };
+
+        /**
+         * Parameter `$name` of the prepared expression.
+         *
+         * Type of the parameter is the type of the column it's used with,
+         * `level > $min` gets `Uint` for `U8` level.
+         **/
+        struct Param {
+            std::string name;
+            Type type;
+        };
+
+        /**
+         * Value bound to the parameter, converted to it's type.
+         * `string` is used by `Str` parameters.
+         **/
+        struct Argument {
+            Value value { };
+            std::string string;
+        };
+
+        struct Instruction {
+            Op op;
+            types::U8 dst;
+            types::U8 x, y;
+            types::U32 a, b;
+        };
+
+        /**
+         * Compiled expression.
+         **/
+        struct Program {
+            std::vector<Instruction> code;
+            std::vector<Value> consts;
+            std::vector<std::string> strings;
+
+            std::vector<Param> params;
+
+            /**
+             * Const (or string for `Str`) at `slot` gets the value of the argument `param`.
+             **/
+            struct Param_Use {
+                types::U32 param;
+                types::U32 slot;
+            };
+            std::vector<Param_Use> param_uses;
+
+            /**
+             * Count of used registers.
+             **/
+            size_t registers = 0;
+
+            /**
+             * Register and type of the result.
+             **/
+            types::U8 result = 0;
+            Type result_type = Type::Bool;
+        };
+
+        std::ostream& operator<<(std::ostream& os, const Program& program);
+
+        /**
+         * Store value of the register to the value of basic domain.
+         *
+         * @param value - register.
+         * @param type - type of the register.
+         * @param dest - value to store into.
+         **/
+        void store(Value value, Type type, Domain_View dest) noexcept(false);
+
+        /**
+         * # Compiler of expressions.
+         *
+         * ```cpp
+         * Compiler compiler { table };
+         * auto program = compiler.compile(tree->parse_call("level > 1 && title == \"admin\"").root);
+         *
+         * Vm vm { program };
+         * for (auto row = 0; row < table.size(); row++)
+         *     if (vm.test(table.row_data(row))) ...;
+         * ```
+         **/
+        class Compiler {
+            public:
+                using Node = parser::Top_Level_Statement::Expression_Data::Expression_Node;
+
+                /**
+                 * @param table - table which rows the program would evaluate.
+                 **/
+                explicit Compiler(const Table &table): _table(table) { }
+
+                /**
+                 * Compile expression.
+                 *
+                 * @param root - root of the expression.
+                 * @throws Compile_Exception if expression can't be compiled.
+                 **/
+                Program compile(const Node::pointer &root) noexcept(false);
+
+            private:
+                struct Operand {
+                    types::U8 reg;
+                    Type type;
+
+                    /* Constant known at compile time (value is consts[const_idx]). */
+                    bool is_const = false;
+                    types::U32 const_idx = 0;
+
+                    /* For the strings, they are not loaded to the registers. */
+                    bool is_column = false;
+                    types::U32 offset = 0;
+                    types::U8 counter_size = 0;
+                    types::U32 string = 0;
+                };
+
+                const Table &_table;
+                Program _program;
+
+                types::U8 alloc_register(void);
+                Operand emit(Op op, Type type, types::U32 a = 0, types::U32 b = 0,
+                             types::U8 x = 0, types::U8 y = 0);
+
+                Operand compile_node(const Node::pointer &node, const Domain *hint);
+                Operand compile_name(const Node::pointer &node, const Domain *hint);
+                Operand compile_literal(const Node::pointer &node);
+                Operand compile_param(const Node::pointer &node, const Domain *hint);
+                Operand compile_binary(const Node::pointer &node);
+
+                const Domain* domain_of(const Node::pointer &node) const;
+                Operand convert(Operand operand, Type type);
+        };
+
+        /**
+         * Virtual machine executing compiled program on the rows.
+         **/
+        class Vm {
+            public:
+                /**
+                 * @param args - values of the parameters of the program, in the order of `program.params`.
+                 **/
+                explicit Vm(const Program &program, std::span<const Argument> args = { }) noexcept(false);
+
+                /**
+                 * Evaluate program on the row.
+                 *
+                 * @param row - raw data of the row.
+                 * @return value of the result register.
+                 **/
+                Value eval(const types::U8 *row) noexcept(false);
+
+                /**
+                 * Evaluate predicate on the row.
+                 **/
+                bool test(const types::U8 *row) noexcept(false) {
+                    return eval(row).u != 0;
+                }
+
+            private:
+                const Program *_program;
+                std::vector<Value> _registers;
+
+                /**
+                 * Constants of the program with bound arguments.
+                 **/
+                std::vector<Value> _consts;
+                std::vector<std::string> _strings;
+        };
+
+        class Compile_Exception: public Toad_Exception {
+            public:
+                Compile_Exception(const std::string &what):
+                    Toad_Exception("Compile: " + what) { }
+        };
+
+        class Unknown_Name: public Compile_Exception {
+            public:
+                Unknown_Name(std::string_view name):
+                    Compile_Exception("Unknown name `" + std::string(name) + "`") { }
+        };
+
+        class Unsupported_Expression: public Compile_Exception {
+            public:
+                Unsupported_Expression(std::string_view name, const std::string &why):
+                    Compile_Exception("Unsupported expression `" + std::string(name) + "`: " + why) { }
+        };
+
+        class Unbound_Param: public Toad_Exception {
+            public:
+                Unbound_Param(const std::string &name):
+                    Toad_Exception("Parameter `" + name + "` is not bound") { }
+        };
+
+        class Division_By_Zero: public Toad_Exception {
+            public:
+                Division_By_Zero(): Toad_Exception("Division by zero") { }
+        };
+    }
+}
+
+#endif // bytecode_hpp_INCLUDED
@@ -1,5 +1,6 @@
 #include <common.hpp>
 #include <iostream>
+#include <map>
 //#include <ncurses.h>
 
 namespace toad_db {
@@ -7,22 +8,76 @@ namespace toad_db {
         return os << to_string(variant);
     }
 
+    std::string Error_Log::report(size_t max_idxs) const {
+        std::map<Error_Code, std::vector<size_t>> by_code;
+        for (auto &entry: _entries) by_code[entry.code].push_back(entry.idx);
+
+        std::string ret = std::to_string(_entries.size()) + " failed";
+        for (auto &[code, idxs]: by_code) {
+            ret += (code == by_code.begin()->first ? ": " : "; ");
+            ret += std::string(to_string(code)) + " x" + std::to_string(idxs.size()) + " (";
+
+            for (size_t i = 0; i < idxs.size() && i < max_idxs; i++) ret += (i ? ", " : "") + std::to_string(idxs[i]);
+            ret += idxs.size() > max_idxs ? ", ...)" : ")";
+        }
+
+        return ret;
+    }
+
+    Table Table::encode(std::span<const std::string> columns) const {
+        std::vector<Column_Field> fields = _columns_fields;
+        std::vector<std::vector<types::U32>> codes(fields.size());
+
+        for (auto &name: columns) {
+            const size_t column = column_idx(name);
+            if (fields[column].dictionary) continue;
+
+            auto dictionary = std::make_shared<Dictionary>(fields[column].domain);
+            codes[column].reserve(size());
+            for (size_t row = 0; row < size(); row++) {
+                const Domain_View value { fields[column].domain, row_data(row) + _columns_offsets[column] };
+                codes[column].push_back(*dictionary->try_intern(value));
+            }
+
+            dictionary->fit();
+            fields[column] = Column_Field::encoded(name, std::move(dictionary));
+        }
+
+        Table ret { fields };
+        if (size() == 0) return ret;
+
+        ret.append_rows(size());
+        for (size_t row = 0; row < size(); row++) {
+            for (size_t column = 0; column < fields.size(); column++) {
+                types::U8 *out = ret.row_data(row) + ret.column_offset(column);
+
+                if (codes[column].empty()) {
+                    std::memcpy(out, row_data(row) + _columns_offsets[column], fields[column].domain->size_of());
+                } else {
+                    fields[column].dictionary->set_code(out, codes[column][row]);
+                }
+            }
+        }
+
+        return ret;
+    }
+
     Table& operator<<(Table& table, const std::vector<Domain_View> &row_value) {
         table.insert_row(row_value); 
         return table;
     }
 
     std::ostream& operator<<(std::ostream& os, const Table& table) {
-        std::cout << "Table:" << std::endl;
+        os << "Table:" << std::endl;
         const std::string indent = "   ";
 
         for (auto &row: table) {
-            std::cout << indent << "row:" << std::endl;
+            os << indent << "row:" << std::endl;
 
             for (auto field: row) {
-                std::cout << indent << indent << to_string(field) << std::endl;
+                os << indent << indent << to_string(field) << std::endl;
             }
-            std::cout << std::endl;
+            os << std::endl;
         }
 
         return os;
@@ -2,15 +2,25 @@
 #define __COMMON_GUARS_H__
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cstddef>
 #include <iterator>
 #include <ranges>
 #include <span>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <expected>
 #include <initializer_list>
 #include <memory>
+#include <optional>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 
@@ -43,6 +53,75 @@ namespace toad_db {
                 std::runtime_error("Toad: `" + reason + "`.") { }
     };
 
+    /**
+     * Error of the operations that don't throw (`try_*`). It's one byte,
+     * the message is made only when the errors are reported (@see Error_Log).
+     **/
+    enum class Error_Code: char {
+        Invalid_Domain_Name,
+        Unwrap_Invalid_Variant,
+        Incompetible_Domains,
+        Array_Length_Out_Of_Bounds,
+        Wrong_Values_Count,
+        Dictionary_Is_Full,
+    };
+
+    constexpr std::string_view to_string(Error_Code code) {
+        switch (code) {
+        case Error_Code::Invalid_Domain_Name:        return "no domain with such name";
+        case Error_Code::Unwrap_Invalid_Variant:     return "value is of other variant";
+        case Error_Code::Incompetible_Domains:       return "value of incompetible domain";
+        case Error_Code::Array_Length_Out_Of_Bounds: return "array length out of bounds";
+        case Error_Code::Wrong_Values_Count:         return "count of values differs from count of columns";
+        case Error_Code::Dictionary_Is_Full:         return "dictionary of the column is full";
+        }
+        return "unknown error";
+    }
+
+    template<typename Type>
+    using Expected = std::expected<Type, Error_Code>;
+
+    /**
+     * # Errors of the bulk operation.
+     *
+     * Rejected items are recorded by the idx and the code, so failures
+     * cost nothing but the record and are reported once afterwards:
+     *
+     * ```cpp
+     * Error_Log errors;
+     * for (size_t i = 0; i < rows.size(); i++) {
+     *     if (auto inserted = table.try_insert_row(rows[i]); !inserted) errors.record(i, inserted.error());
+     * }
+     * if (!errors.empty()) std::cerr << errors.report() << std::endl;
+     * ```
+     **/
+    class Error_Log {
+        public:
+            struct Entry {
+                size_t idx;
+                Error_Code code;
+            };
+
+            void record(size_t idx, Error_Code code) { _entries.push_back({ idx, code }); }
+
+            bool empty(void) const { return _entries.empty(); }
+            size_t size(void) const { return _entries.size(); }
+            const std::vector<Entry>& entries(void) const { return _entries; }
+
+            void clear(void) { _entries.clear(); }
+
+            /**
+             * Count of the errors by the code with the first idxs of every code:
+             * `2 failed: array length out of bounds x2 (3, 7)`.
+             *
+             * @param max_idxs - max count of idxs shown per code.
+             **/
+            std::string report(size_t max_idxs = 8) const;
+
+        private:
+            std::vector<Entry> _entries;
+    };
+
     struct Domain {
         /**
          * Name of the domain, it's way to identify domen.
@@ -86,12 +165,22 @@ namespace toad_db {
              * @throws Invalid_Domen_Name if there is no such domain
              **/
             Domain_Idx by_name(const std::string& name) const noexcept(false) {
-                auto it = std::find_if(data.begin(), data.end(), 
-                            [=](const auto &domain) { 
-                                return domain.domain_name == name;  
+                auto idx = try_by_name(name);
+                if (!idx) throw Invalid_Domain_Name(name);
+
+                return *idx;
+            }
+
+            /**
+             * Same as `by_name`, but doesn't throw.
+             **/
+            Expected<Domain_Idx> try_by_name(std::string_view name) const noexcept {
+                auto it = std::find_if(data.begin(), data.end(),
+                            [=](const auto &domain) {
+                                return domain.domain_name == name;
                             });
 
-                if (it == data.end()) throw Invalid_Domain_Name(name);
+                if (it == data.end()) return std::unexpected(Error_Code::Invalid_Domain_Name);
 
                 return it - data.begin();
             }
@@ -231,6 +320,26 @@ namespace toad_db {
             return variant == Variant::Bool;
         }
 
+        /**
+         * Bytes of the value compared for equality, -0.0 of the floats is
+         * replaced by 0.0, so equal values have equal bytes.
+         *
+         * @return nullptr for NaN, it's not equal to any value.
+         **/
+        static const types::U8* equality_bytes(Variant variant, const types::U8 *value) {
+            static constexpr types::U8 zero[sizeof(types::F64)] { };
+
+            if (variant == Variant::F32) {
+                const types::F32 number = *(const types::F32*)value;
+                return number != number ? nullptr : number == 0 ? zero : value;
+            }
+            if (variant == Variant::F64) {
+                const types::F64 number = *(const types::F64*)value;
+                return number != number ? nullptr : number == 0 ? zero : value;
+            }
+            return value;
+        }
+
         constexpr bool is_string(void) {
             return is_array(variant) && domains->at(array.idx).variant == Variant::I8;
         }
@@ -671,6 +780,19 @@ namespace toad_db {
             return *(Type*)data;
         }
 
+        /**
+         * Same as `unwrap_basic`, but doesn't throw.
+         *
+         * @return pointer to the value or `Error_Code::Unwrap_Invalid_Variant`.
+         **/
+        template<typename Type>
+        Expected<Type*> try_unwrap_basic() const noexcept {
+            if (Domain::type2variant<Type>() != domain->variant)
+                return std::unexpected(Error_Code::Unwrap_Invalid_Variant);
+
+            return (Type*)data;
+        }
+
         /**
          * Unwrap and set new value to the domen value.
          *
@@ -937,22 +1059,51 @@ namespace toad_db {
         };
 
         void assign(const Domain_View &new_value) noexcept(false) {
-            Domain::Variant orig_variant = new_value.domain->variant;
-            Domain::Variant dest_variant = domain->variant;
-            const std::string &orig_name = new_value.domain->domain_name;
-            const std::string &dest_name = new_value.domain->domain_name;
+            auto assigned = try_assign(new_value);
+            if (assigned) return;
 
+            switch (assigned.error()) {
+            case Error_Code::Array_Length_Out_Of_Bounds:
+                if (Domain::is_array(domain->variant))
+                    throw Array_Length_Out_Of_Bounds(new_value.get_length(), domain->array.capacity);
+
+                throw Toad_Exception(std::string(to_string(assigned.error())));
+
+            default:
+                throw Assign_Incompetible_Domains(domain->domain_name, new_value.domain->domain_name);
+            }
+        }
+
+        /**
+         * Same as `assign`, but doesn't throw. Domains are checked once
+         * for the whole value, not for every nested field.
+         *
+         * @return `Error_Code::Incompetible_Domains` or `Error_Code::Array_Length_Out_Of_Bounds`,
+         *         value may be partially assigned then.
+         **/
+        Expected<void> try_assign(const Domain_View &new_value) {
             if (!Domain::is_competible(*domain, *new_value.domain))
-                throw Assign_Incompetible_Domains(dest_name, orig_name);
+                return std::unexpected(Error_Code::Incompetible_Domains);
+
+            return copy_from(new_value);
+        }
+
+        private:
+        /**
+         * Assign the value of the competible domain.
+         **/
+        Expected<void> copy_from(const Domain_View &new_value) {
+            const Domain::Variant variant = domain->variant;
 
-            if (Domain::is_basic(orig_variant)) { //TODO: support for the different sized values.
+            if (Domain::is_basic(variant)) { //TODO: support for the different sized values.
                 std::memcpy(data, new_value.data, domain->size_of());
-                return;
+                return { };
             }
 
-            if (Domain::is_array(dest_variant)) {
-                if (new_value.get_length() > domain->array.capacity)
-                    throw Array_Length_Out_Of_Bounds(new_value.get_length(), domain->array.capacity);
+            if (Domain::is_array(variant)) {
+                const size_t length = Domain::get_counter(new_value.data, new_value.domain->array.capacity);
+                if (length > domain->array.capacity)
+                    return std::unexpected(Error_Code::Array_Length_Out_Of_Bounds);
 
                 Domain *elem_domain = &domain->domains->at(domain->array.idx);
                 Domain *new_elem_domain = &domain->domains->at(new_value.domain->array.idx);
@@ -965,49 +1116,58 @@ namespace toad_db {
                 Domain_View new_elem { new_elem_domain,
                             new_value.data + Domain::counter_size_of(new_value.domain->array.capacity) };
 
-                Domain::set_counter(data, domain->array.capacity, new_value.get_length()); 
+                Domain::set_counter(data, domain->array.capacity, length);
+
+                // Elements of the same size are copied at once.
+                if (Domain::is_basic(elem_domain->variant) && elem_size == new_elem_size) {
+                    std::memcpy(elem.data, new_elem.data, length * elem_size);
+                    return { };
+                }
 
-                for (size_t i = 0; i < new_value.get_length(); i++) {
-                    elem.assign(new_elem); 
+                for (size_t i = 0; i < length; i++) {
+                    if (auto copied = elem.copy_from(new_elem); !copied) return copied;
                     elem.data += elem_size;
                     new_elem.data += new_elem_size;
                 }
-            } 
+                return { };
+            }
 
-            if (dest_variant == Domain::Variant::Add) {
+            if (variant == Domain::Variant::Add) {
                 size_t new_variant = Domain::get_counter(new_value.data,
                                                          new_value.domain->complex_fields.size());
                 Domain::set_counter(data, domain->complex_fields.size(), new_variant);
 
                 const auto &field = domain->complex_fields[new_variant];
                 const auto &new_field = new_value.domain->complex_fields[new_variant];
+                if (!field.has_type) return { };
 
-                Domain_View elem { &domain->domains->at(field.domain_idx), 
+                Domain_View elem { &domain->domains->at(field.domain_idx),
                                    data + Domain::counter_size_of(domain->complex_fields.size()) };
                 Domain_View new_elem { &domain->domains->at(new_field.domain_idx),
-                                       data + Domain::counter_size_of(new_value.domain->complex_fields.size()) }; 
+                                       new_value.data + Domain::counter_size_of(new_value.domain->complex_fields.size()) };
 
-                elem.assign(new_elem); 
+                return elem.copy_from(new_elem);
             }
 
-            if (dest_variant == Domain::Variant::Mul) {
-                Domain_View elem { nullptr, data}; 
-                Domain_View new_elem { nullptr, new_value.data};
+            Domain_View elem { nullptr, data };
+            Domain_View new_elem { nullptr, new_value.data };
 
-                for (size_t i = 0; i < domain->complex_fields.size(); i++) {
-                    const auto &field = domain->complex_fields[i];
-                    const auto &new_field = new_value.domain->complex_fields[i];
+            for (size_t i = 0; i < domain->complex_fields.size(); i++) {
+                const auto &field = domain->complex_fields[i];
+                const auto &new_field = new_value.domain->complex_fields[i];
 
-                    elem.domain = &domain->domains->at(field.domain_idx);
-                    new_elem.domain = &domain->domains->at(new_field.domain_idx);
+                elem.domain = &domain->domains->at(field.domain_idx);
+                new_elem.domain = &domain->domains->at(new_field.domain_idx);
 
-                    elem.assign(new_elem);
+                if (auto copied = elem.copy_from(new_elem); !copied) return copied;
 
-                    elem.data += elem.domain->size_of();
-                    new_elem.data += new_elem.domain->size_of();
-                }
+                elem.data += elem.domain->size_of();
+                new_elem.data += new_elem.domain->size_of();
             }
+            return { };
         }
+
+        public:
         /**
          * Push value to the array.
          *
@@ -1152,34 +1312,202 @@ namespace toad_db {
 
 
 
+    /**
+     * # Pool of the buffers of the values.
+     *
+     * Buffers are grouped by the size classes (powers of two) and freed
+     * buffers are kept in the free lists of the thread, so values created
+     * and dropped in a loop reuse the same buffers instead of `malloc`/`free`.
+     * Buffer freed by other thread goes to the lists of that thread.
+     *
+     * Buffers taken from the system are counted, so benchmarks see the
+     * allocations which bypass `operator new`.
+     **/
+    class Value_Pool {
+        public:
+            /**
+             * Max count of the free buffers kept per size class and thread.
+             **/
+            static constexpr size_t Max_Free_Buffers = 256;
+
+            /**
+             * Buffer of at least `size` bytes.
+             **/
+            static types::U8* allocate(size_t size) {
+                const size_t size_class = class_of(size);
+
+                if (_destroyed || _free.lists[size_class].empty()) {
+                    if (auto *ret = (types::U8*)std::malloc((size_t)1 << size_class)) {
+                        _mallocs.fetch_add(1, std::memory_order_relaxed);
+                        _malloc_bytes.fetch_add((size_t)1 << size_class, std::memory_order_relaxed);
+                        return ret;
+                    }
+                    throw std::bad_alloc();
+                }
+
+                auto &free = _free.lists[size_class];
+                types::U8 *ret = free.back();
+                free.pop_back();
+                return ret;
+            }
+
+            /**
+             * Return the buffer of `allocate(size)` to the pool.
+             **/
+            static void deallocate(types::U8 *data, size_t size) {
+                // Values may outlive the lists of the exiting thread.
+                if (_destroyed) {
+                    std::free(data);
+                    return;
+                }
+
+                auto &free = _free.lists[class_of(size)];
+
+                if (free.size() < Max_Free_Buffers) free.push_back(data);
+                else                                std::free(data);
+            }
+
+            /**
+             * Count and bytes of the buffers taken by `malloc` (not from the free lists) by all threads.
+             **/
+            static size_t mallocs(void) { return _mallocs.load(std::memory_order_relaxed); }
+            static size_t malloc_bytes(void) { return _malloc_bytes.load(std::memory_order_relaxed); }
+
+        private:
+            static size_t class_of(size_t size) {
+                return std::bit_width(size - 1);
+            }
+
+            struct Free_Lists {
+                std::array<std::vector<types::U8*>, 64> lists;
+
+                ~Free_Lists() {
+                    for (auto &list: lists) {
+                        for (auto *data: list) std::free(data);
+                    }
+                    _destroyed = true;
+                }
+            };
+
+            static inline thread_local Free_Lists _free;
+            static inline thread_local bool _destroyed = false;
+
+            static inline std::atomic<size_t> _mallocs { 0 };
+            static inline std::atomic<size_t> _malloc_bytes { 0 };
+    };
+
     /**
      * Contains value of specific domain.
      *
      * This container owns value of the domain and
      * allows to interct with that through the Domain_View.
+     *
+     * Values bigger than `Min_Size_To_Alloc` take buffers from the
+     * `Value_Pool`, or from the arena given to the constructor:
+     *
+     * ```cpp
+     * Arena arena { };
+     * for (auto &name: names) {
+     *     Domain_Value value { &domains("Str"), arena };
+     *     value.view().set_string(name);
+     * }
+     * ```
+     *
+     * Moved values take the buffer of the other value and leave it empty
+     * (its view has no domain) until a value is assigned to it, copies get
+     * own buffers from the pool.
      **/
     template<size_t Min_Size_To_Alloc = 8>
     class Domain_Value {
         Domain *domain;
         size_t size;
+
+        /**
+         * Buffer is owned by the arena, so it's not returned to the pool.
+         **/
+        bool borrowed = false;
+
         union {
             std::array<types::U8, Min_Size_To_Alloc> small_data { 0 };
             types::U8* big_data;
         };
 
+        bool is_big(void) const { return size > Min_Size_To_Alloc; }
+
+        types::U8* data(void) { return is_big() ? big_data : small_data.data(); }
+        const types::U8* data(void) const { return is_big() ? big_data : small_data.data(); }
+
+        void release(void) {
+            if (is_big() && !borrowed) Value_Pool::deallocate(big_data, size);
+            size = 0;
+        }
+
+        void take(Domain_Value &other) {
+            domain = other.domain;
+            size = other.size;
+            borrowed = other.borrowed;
+
+            if (is_big()) big_data = other.big_data;
+            else          small_data = other.small_data;
+
+            // Other value is left empty without the domain, so it doesn't release
+            // the buffer and its view isn't of the domain bigger than the value.
+            other.domain = nullptr;
+            other.size = 0;
+            other.borrowed = false;
+        }
+
         public:
-            Domain_Value<Min_Size_To_Alloc>(Domain* domain): domain(domain) {
+            /**
+             * Value of the domain, or empty value without the domain if it's null.
+             **/
+            Domain_Value(Domain* domain): domain(domain) {
+                size = domain ? domain->size_of() : 0;
+
+                if (is_big()) {
+                    big_data = Value_Pool::allocate(size);
+                    std::memset(big_data, 0, size);
+                }
+            }
+
+            /**
+             * Value with the buffer allocated by the arena (@see Arena),
+             * the arena must outlive the value.
+             **/
+            template<typename Arena>
+            Domain_Value(Domain* domain, Arena &arena): domain(domain) {
                 size = domain->size_of();
 
-                if (size > Min_Size_To_Alloc) {
-                    big_data = (types::U8*)std::malloc(size);
+                if (is_big()) {
+                    big_data = (types::U8*)arena.allocate(size, alignof(std::max_align_t));
+                    borrowed = true;
+                    std::memset(big_data, 0, size);
                 }
             }
 
-            ~Domain_Value<Min_Size_To_Alloc>(void) {
-                if (size > Min_Size_To_Alloc) {
-                    free(big_data);
-                } 
+            Domain_Value(const Domain_Value &other): Domain_Value(other.domain) {
+                std::memcpy(data(), other.data(), size);
+            }
+
+            Domain_Value(Domain_Value &&other) noexcept {
+                take(other);
+            }
+
+            Domain_Value& operator=(const Domain_Value &other) {
+                if (this != &other) *this = Domain_Value { other };
+                return *this;
+            }
+
+            Domain_Value& operator=(Domain_Value &&other) noexcept {
+                if (this == &other) return *this;
+
+                release();
+                take(other);
+                return *this;
+            }
+
+            ~Domain_Value(void) {
+                release();
             }
 
             class Wrong_Domain_Value_Constructor: public Toad_Exception {
@@ -1197,7 +1525,7 @@ namespace toad_db {
              * @return Domain_View to the owning value.
              **/
             Domain_View view(void) {
-                return Domain_View { domain, size > Min_Size_To_Alloc ? big_data : small_data.data() };
+                return Domain_View { domain, data() };
             }
     };
 
@@ -1220,6 +1548,190 @@ namespace toad_db {
     }
 
 
+    /**
+     * # Dictionary of the column values.
+     *
+     * Distinct values are stored once, rows of the encoded column store
+     * only the codes, idxs of the values in the dictionary:
+     *
+     * ```
+     *  values: [ "admin", "guest", "user" ]      (3 x 65 bytes of `Str`)
+     *  codes:  | 2 | 2 | 0 | 1 | 2 | ...          (1 byte per row)
+     * ```
+     *
+     * Size of the code is `Domain::counter_size_of(capacity - 1)`, so the
+     * column with at most 256 distinct values takes one byte per row.
+     * Codes of the same dictionary are equal iff the values are equal (byte
+     * by byte, like the keys of the hash join), so filters and joins compare
+     * the codes. Dictionary can be shared by the columns of several tables
+     * to join them by the codes.
+     **/
+    class Dictionary {
+        public:
+            /**
+             * Max count of values, codes are of 4 bytes.
+             **/
+            static constexpr size_t Max_Capacity = (size_t)1 << 32;
+
+            /**
+             * @param domain - domain of the values.
+             * @param capacity - max count of the values, it's fixed by the size of the codes.
+             **/
+            explicit Dictionary(Domain *domain, size_t capacity = Max_Capacity):
+                _domain(domain), _capacity(capacity) { }
+
+            Domain* domain(void) const { return _domain; }
+            size_t capacity(void) const { return _capacity; }
+
+            /**
+             * Count of the values.
+             **/
+            size_t size(void) const { return _codes.size(); }
+
+            size_t code_size(void) const { return Domain::counter_size_of(_capacity - 1); }
+
+            /**
+             * Basic domain of the codes (`U8`, `U16` or `U32`), it's the
+             * domain of the encoded column in the table.
+             **/
+            Domain* code_domain(void) const {
+                static constexpr std::string_view names[] = { "", "U8", "U16", "", "U32" };
+                return &(*_domain->domains)(std::string(names[code_size()]));
+            }
+
+            types::U32 code_at(const types::U8 *data) const {
+                return (types::U32)Domain::get_counter((types::U8*)data, _capacity - 1);
+            }
+
+            void set_code(types::U8 *data, types::U32 code) const {
+                Domain::set_counter(data, _capacity - 1, code);
+            }
+
+            /**
+             * Value of the code, view is valid until values are added.
+             **/
+            Domain_View value(types::U32 code) const {
+                return Domain_View { _domain, _values.data() + code * _domain->size_of() };
+            }
+
+            /**
+             * Code of the value of the dictionary domain.
+             **/
+            std::optional<types::U32> find(const types::U8 *value) const {
+                if (!_domain->is_string()) return code_of(key(value));
+
+                // Copy of the string is cleared after its length, it takes a buffer from the pool.
+                Domain_Value<> canonical { _domain };
+                types::U8 *data = canonical.view().data;
+                std::memcpy(data, value, _domain->size_of());
+                clear_unused(data);
+
+                return code_of(key(data));
+            }
+
+            /**
+             * Code of the string for the dictionary of strings (@see Domain::is_string).
+             **/
+            std::optional<types::U32> find(std::string_view string) const {
+                if (!_domain->is_string() || string.size() > _domain->array.capacity) return std::nullopt;
+
+                // Value is zeroed, so the bytes after the string are cleared already.
+                Domain_Value<> value { _domain };
+                types::U8 *data = value.view().data;
+                Domain::set_counter(data, _domain->array.capacity, string.size());
+                std::memcpy(data + Domain::counter_size_of(_domain->array.capacity), string.data(), string.size());
+
+                return code_of(key(data));
+            }
+
+            /**
+             * Code of the value, value is added if it's new.
+             *
+             * @return `Error_Code::Dictionary_Is_Full` or error of `Domain_View::try_assign`.
+             **/
+            Expected<types::U32> try_intern(const Domain_View &value) {
+                _scratch.assign(_domain->size_of(), 0);
+
+                if (value.domain == _domain) {
+                    std::memcpy(_scratch.data(), value.data, _domain->size_of());
+                } else {
+                    auto assigned = Domain_View { _domain, _scratch.data() }.try_assign(value);
+                    if (!assigned) return std::unexpected(assigned.error());
+                }
+
+                clear_unused(_scratch.data());
+                return intern(_scratch.data());
+            }
+
+            /**
+             * Shrink the capacity to the max count of values with the codes of
+             * the least size, it's done before the codes are written.
+             **/
+            void fit(void) {
+                _capacity = (size_t)1 << (8 * Domain::counter_size_of(size() ? size() - 1 : 0));
+            }
+
+            /**
+             * Estimated bytes of the values and of the index of them.
+             **/
+            size_t memory_bytes(void) const {
+                return _values.capacity() + _codes.bucket_count() * sizeof(void*)
+                       + _codes.size() * (sizeof(std::string) + sizeof(types::U32) + sizeof(void*) + _domain->size_of());
+            }
+
+        private:
+            struct Key_Hash {
+                using is_transparent = void;
+
+                size_t operator()(std::string_view key) const { return std::hash<std::string_view> { }(key); }
+            };
+
+            Domain *_domain;
+            size_t _capacity;
+
+            std::vector<types::U8> _values;
+            std::unordered_map<std::string, types::U32, Key_Hash, std::equal_to<>> _codes;
+
+            std::vector<types::U8> _scratch;
+
+            std::string_view key(const types::U8 *value) const {
+                return { (const char*)value, _domain->size_of() };
+            }
+
+            /**
+             * Zero bytes of the string after its length, they are left by the
+             * longer strings, so equal values have equal bytes.
+             **/
+            void clear_unused(types::U8 *value) const {
+                if (!_domain->is_string()) return;
+
+                const size_t capacity = _domain->array.capacity, counter = Domain::counter_size_of(capacity);
+                const size_t length = std::min<size_t>(Domain::get_counter(value, capacity), capacity);
+                std::memset(value + counter + length, 0, capacity - length);
+            }
+
+            std::optional<types::U32> code_of(std::string_view key) const {
+                auto it = _codes.find(key);
+                if (it == _codes.end()) return std::nullopt;
+
+                return it->second;
+            }
+
+            /**
+             * @param value - value with cleared unused bytes (@see clear_unused).
+             **/
+            Expected<types::U32> intern(const types::U8 *value) {
+                if (auto code = code_of(key(value))) return *code;
+                if (size() >= _capacity) return std::unexpected(Error_Code::Dictionary_Is_Full);
+
+                const types::U32 code = (types::U32)size();
+                _values.insert(_values.end(), value, value + _domain->size_of());
+                _codes.emplace(std::string(key(value)), code);
+                return code;
+            }
+    };
+
+
     /**
      * Table.
      **/
@@ -1227,28 +1739,142 @@ namespace toad_db {
         struct Column_Field {
             std::string name;
             Domain *domain;
+
+            /**
+             * Column is dictionary-encoded, then `domain` is the domain of
+             * the codes and values are of the domain of the dictionary.
+             **/
+            std::shared_ptr<Dictionary> dictionary { };
+
+            static Column_Field encoded(std::string name, std::shared_ptr<Dictionary> dictionary) {
+                Domain *domain = dictionary->code_domain();
+                return { std::move(name), domain, std::move(dictionary) };
+            }
         };
 
         private:
             std::vector<Column_Field> _columns_fields;
+            std::vector<size_t> _columns_offsets;
             size_t _row_size;
 
             std::vector<types::U8> _data { };
+
+            /**
+             * Row of `try_insert_row` before it's appended.
+             **/
+            std::vector<types::U8> _staged_row { };
+
+            void init_layout(void) {
+                _row_size = 0;
+
+                for (auto collumn_field: _columns_fields) {
+                    _columns_offsets.push_back(_row_size);
+                    _row_size += collumn_field.domain->size_of();
+                }
+            }
         public:
 
+        /**
+         * Count of rows in one segment.
+         *
+         * Segment is a fixed range of rows `[idx * Segment_Rows, (idx + 1) * Segment_Rows)`.
+         * It's the unit that parallel scans split into morsels.
+         **/
+        static constexpr size_t Segment_Rows = 1 << 16;
+
         class Failed_To_Insert_Row: public Toad_Exception {
             public:
                 Failed_To_Insert_Row(Toad_Exception& problem):
                     Toad_Exception(std::string("Failed to insert row: ") + problem.what()) {} 
+
+                Failed_To_Insert_Row(Error_Code code):
+                    Toad_Exception("Failed to insert row: " + std::string(to_string(code))) {}
+        };
+
+        class Table_Has_Not_Such_Column: public Toad_Exception {
+            public:
+                Table_Has_Not_Such_Column(const std::string &name):
+                    Toad_Exception("Table has not such column: `" + name + "`") {} 
         };
 
 
         Table(std::initializer_list<Column_Field> fields): _columns_fields(fields)  { 
-            _row_size = 0;
+            init_layout();
+        }
+
+        Table(const std::vector<Column_Field> &fields): _columns_fields(fields)  { 
+            init_layout();
+        }
+
+        /**
+         * Count of rows in the table.
+         **/
+        size_t size(void) const {
+            return _row_size == 0 ? 0 : _data.size() / _row_size;
+        }
+
+        /**
+         * Size in bytes of one row.
+         **/
+        size_t row_size(void) const {
+            return _row_size;
+        }
+
+        /**
+         * Count of segments (last one can be not full).
+         **/
+        size_t segments_count(void) const {
+            return (size() + Segment_Rows - 1) / Segment_Rows;
+        }
+
+        const std::vector<Column_Field>& columns(void) const {
+            return _columns_fields;
+        }
+
+        /**
+         * Offset in bytes of the column inside the row.
+         **/
+        size_t column_offset(size_t idx) const {
+            return _columns_offsets[idx];
+        }
 
-            for (auto collumn_field: _columns_fields) {
-                _row_size += collumn_field.domain->size_of();
+        /**
+         * Get column idx by it's name.
+         *
+         * @throws Table_Has_Not_Such_Column if there is no column with such name.
+         **/
+        size_t column_idx(const std::string &name) const noexcept(false) {
+            for (size_t i = 0; i < _columns_fields.size(); i++) {
+                if (_columns_fields[i].name == name) return i;
             }
+            throw Table_Has_Not_Such_Column(name);
+        }
+
+        /**
+         * Raw data of the row.
+         *
+         * @param idx - idx of the row.
+         **/
+        types::U8* row_data(size_t idx) {
+            return _data.data() + idx * _row_size;
+        }
+
+        const types::U8* row_data(size_t idx) const {
+            return _data.data() + idx * _row_size;
+        }
+
+        /**
+         * Append zeroed rows to the end of the table.
+         *
+         * Used by operators that write rows directly in the table encoding.
+         *
+         * @param count - count of rows to append.
+         * @return raw data of the first appended row.
+         **/
+        types::U8* append_rows(size_t count) {
+            size_t first = size();
+            _data.resize(_data.size() + count * _row_size);
+            return row_data(first);
         }
 
 
@@ -1258,30 +1884,71 @@ namespace toad_db {
          * @row_value - vector of domain value to insert to the row.
          **/
         void insert_row(const std::vector<Domain_View> &row_value) {
-            auto row_field = row_value.begin();
-
-            auto row_data = std::unique_ptr<types::U8>(new types::U8[_row_size]);
+            auto inserted = try_insert_row(row_value);
+            if (inserted) return;
 
-            Domain_View out { nullptr, row_data.get() };
-            Domain_View in { row_field->domain, row_field->data };
+            if (inserted.error() == Error_Code::Wrong_Values_Count) throw Failed_To_Insert_Row(inserted.error());
 
+            // Row is assigned again by the throwing path, only to make the detailed message.
+            std::vector<types::U8> row_data(_row_size);
             try {
-                for (auto &column_field: _columns_fields) {
-                    out.domain = column_field.domain;
-
-                    out.assign(in); 
-
-                    out.data += out.domain->size_of();
-                    in.data   = (++row_field)->data;
-                    in.domain = row_field->domain;
+                for (size_t i = 0; i < _columns_fields.size(); i++) {
+                    if (_columns_fields[i].dictionary) continue;
+                    Domain_View { _columns_fields[i].domain, row_data.data() + _columns_offsets[i] }.assign(row_value[i]);
                 }
             } catch (Toad_Exception& te) {
                 throw Failed_To_Insert_Row(te);
             }
 
-            _data.insert(_data.begin() + _data.size(), row_data.get(), row_data.get() + _row_size);
+            throw Failed_To_Insert_Row(inserted.error());
         }
 
+        /**
+         * Same as `insert_row`, but doesn't throw. Row is staged apart from
+         * the table (values may be views of its rows) and appended if all
+         * of the values fit. Values of the dictionary-encoded columns are
+         * interned after the other ones are assigned, so rows rejected by
+         * them don't add values to the dictionaries.
+         *
+         * @return `Error_Code::Wrong_Values_Count`, `Error_Code::Dictionary_Is_Full`
+         *         or error of `Domain_View::try_assign`.
+         **/
+        Expected<void> try_insert_row(std::span<const Domain_View> row_value) {
+            if (row_value.size() != _columns_fields.size())
+                return std::unexpected(Error_Code::Wrong_Values_Count);
+
+            _staged_row.assign(_row_size, 0);
+
+            for (size_t i = 0; i < _columns_fields.size(); i++) {
+                const Column_Field &field = _columns_fields[i];
+                if (field.dictionary) continue;
+
+                auto assigned = Domain_View { field.domain, _staged_row.data() + _columns_offsets[i] }.try_assign(row_value[i]);
+                if (!assigned) return assigned;
+            }
+
+            for (size_t i = 0; i < _columns_fields.size(); i++) {
+                const Column_Field &field = _columns_fields[i];
+                if (!field.dictionary) continue;
+
+                auto code = field.dictionary->try_intern(row_value[i]);
+                if (!code) return std::unexpected(code.error());
+                field.dictionary->set_code(_staged_row.data() + _columns_offsets[i], *code);
+            }
+
+            _data.insert(_data.end(), _staged_row.begin(), _staged_row.end());
+            return { };
+        }
+
+        /**
+         * Copy of the table with the columns dictionary-encoded (@see Dictionary),
+         * codes are of the least size for the count of distinct values.
+         *
+         * @param columns - names of the columns to encode.
+         * @throws Table_Has_Not_Such_Column if there is no column with such name.
+         **/
+        Table encode(std::span<const std::string> columns) const noexcept(false);
+
         friend Table& operator<<(Table& table, const std::vector<Domain_View> &row_value);
         friend std::ostream& operator<<(std::ostream& os, const Table& table);
 
@@ -1299,11 +1966,15 @@ namespace toad_db {
                 Row_Iter(_Iter data, std::vector<Column_Field>::const_iterator field):
                     _data(data), _field(field) { }
 
+                /**
+                 * Values of the dictionary-encoded columns are decoded there.
+                 **/
                 reference operator*(void) const {
+                    if (_field->dictionary) return _field->dictionary->value(_field->dictionary->code_at((const types::U8*) _data.base()));
                     return Domain_View { _field->domain, (types::U8*) _data.base() };
                 }
                 pointer operator->(void) const {
-                    return std::make_unique<value_type>(Domain_View { _field->domain, (types::U8*) _data.base() });
+                    return std::make_unique<value_type>(operator*());
                 }
 
                 Row_Iter& operator++(void) {
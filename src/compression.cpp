@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <bit>
+#include <compression.hpp>
+
+namespace toad_db::interact::compression {
+    using namespace types;
+    using vectorized::Batch_Size;
+
+    static constexpr size_t words_of(size_t bits) { return (bits + 63) / 64; }
+
+    /**
+     * Value of the basic domain widened to 64 bits, signed ones are sign extended.
+     **/
+    static U64 widen(Domain::Variant variant, const U8 *data) {
+        switch (variant) {
+        case Domain::Variant::U16: return *(const U16*)data;
+        case Domain::Variant::U32: return *(const U32*)data;
+        case Domain::Variant::U64: return *(const U64*)data;
+        case Domain::Variant::I8:  return (U64)(I64)*(const I8*)data;
+        case Domain::Variant::I16: return (U64)(I64)*(const I16*)data;
+        case Domain::Variant::I32: return (U64)(I64)*(const I32*)data;
+        case Domain::Variant::I64: return (U64)*(const I64*)data;
+        default:                   return *data;
+        }
+    }
+
+    template<typename T>
+    static void narrow(const U64 *values, size_t count, T *out) {
+        for (size_t i = 0; i < count; i++) out[i] = (T)values[i];
+    }
+
+    static void narrow(Domain::Variant variant, const U64 *values, size_t count, Column_Vector &out) {
+        switch (variant) {
+        case Domain::Variant::U16: narrow(values, count, out.as<U16>()); break;
+        case Domain::Variant::U32: narrow(values, count, out.as<U32>()); break;
+        case Domain::Variant::U64: narrow(values, count, out.as<U64>()); break;
+        case Domain::Variant::I8:  narrow(values, count, out.as<I8>());  break;
+        case Domain::Variant::I16: narrow(values, count, out.as<I16>()); break;
+        case Domain::Variant::I32: narrow(values, count, out.as<I32>()); break;
+        case Domain::Variant::I64: narrow(values, count, out.as<I64>()); break;
+        default:                   narrow(values, count, out.as<U8>());  break;
+        }
+    }
+
+    static void pack(U64 *words, size_t idx, size_t width, U64 value) {
+        if (width == 0) return;
+
+        const size_t bit = idx * width, word = bit / 64, shift = bit % 64;
+        words[word] |= value << shift;
+        if (shift + width > 64) words[word + 1] |= value >> (64 - shift);
+    }
+
+    static U64 unpack_one(const U64 *words, size_t idx, size_t width) {
+        if (width == 0) return 0;
+
+        const size_t bit = idx * width, word = bit / 64, shift = bit % 64;
+        U64 value = words[word] >> shift;
+        if (shift + width > 64) value |= words[word + 1] << (64 - shift);
+
+        return width == 64 ? value : value & (((U64)1 << width) - 1);
+    }
+
+    /**
+     * Set bits `[from, to)` of the bitmap.
+     **/
+    static void set_bits(U64 *bitmap, size_t from, size_t to) {
+        for (; from < to && from % 64; from++) bitmap[from / 64] |= (U64)1 << (from % 64);
+        for (; from + 64 <= to; from += 64) bitmap[from / 64] = ~(U64)0;
+        for (; from < to; from++) bitmap[from / 64] |= (U64)1 << (from % 64);
+    }
+
+    Compressed_Column Compressed_Column::compress(const Table &table, size_t column, size_t begin, size_t count) {
+        const Domain *domain = table.columns().at(column).domain;
+        if (!Domain::is_basic(domain->variant)) throw vectorized::Not_Basic_Column(domain->domain_name);
+
+        const size_t offset = table.column_offset(column), size = domain->size_of();
+
+        Compressed_Column ret { };
+        ret._variant = domain->variant;
+        ret._size = size;
+        ret._count = count;
+
+        if (Domain::is_float(domain->variant) || count == 0) {
+            ret._words.resize(words_of(count * size * 8));
+            for (size_t i = 0; i < count; i++)
+                std::memcpy((U8*)ret._words.data() + i * size, table.row_data(begin + i) + offset, size);
+            return ret;
+        }
+
+        const bool is_signed = Domain::is_sint(domain->variant);
+        const auto less = [&](U64 lhs, U64 rhs) { return is_signed ? (I64)lhs < (I64)rhs : lhs < rhs; };
+
+        std::vector<U64> values(count);
+        for (size_t i = 0; i < count; i++) values[i] = widen(domain->variant, table.row_data(begin + i) + offset);
+
+        U64 min = values[0], max = values[0];
+        U64 min_delta = ~(U64)0, max_delta = 0;
+        size_t runs = 1;
+        bool sorted = true;
+
+        for (size_t i = 1; i < count; i++) {
+            if (less(values[i], min)) min = values[i];
+            if (less(max, values[i])) max = values[i];
+
+            runs += values[i] != values[i - 1];
+            sorted = sorted && !less(values[i], values[i - 1]);
+
+            if (sorted) {
+                min_delta = std::min(min_delta, values[i] - values[i - 1]);
+                max_delta = std::max(max_delta, values[i] - values[i - 1]);
+            }
+        }
+        if (count == 1) min_delta = 0;
+
+        ret._min = min;
+        ret._max = max;
+
+        const size_t frame_width = std::bit_width(max - min);
+        const size_t delta_width = sorted ? std::bit_width(max_delta - min_delta) : 64;
+
+        const size_t plain_bytes = count * size;
+        const size_t run_bytes = runs * (sizeof(U64) + sizeof(U32));
+        const size_t frame_bytes = words_of(count * frame_width) * sizeof(U64);
+        const size_t delta_bytes = words_of(count * delta_width) * sizeof(U64) + (count + Batch_Size - 1) / Batch_Size * sizeof(U64);
+
+        const size_t best = std::min({ plain_bytes, run_bytes, frame_bytes, delta_bytes });
+
+        if (best == plain_bytes) {
+            ret._words.resize(words_of(count * size * 8));
+            for (size_t i = 0; i < count; i++) std::memcpy((U8*)ret._words.data() + i * size, &values[i], size);
+        } else if (best == run_bytes) {
+            ret._encoding = Run_Length;
+            for (size_t i = 0; i < count; i++) {
+                if (i > 0 && values[i] == values[i - 1]) {
+                    ret._run_ends.back() = i + 1;
+                } else {
+                    ret._run_values.push_back(values[i]);
+                    ret._run_ends.push_back(i + 1);
+                }
+            }
+        } else if (best == frame_bytes) {
+            ret._encoding = Frame_Of_Reference;
+            ret._base = min;
+            ret._width = frame_width;
+            ret._words.resize(words_of(count * frame_width) + 1);
+            for (size_t i = 0; i < count; i++) pack(ret._words.data(), i, frame_width, values[i] - min);
+        } else {
+            ret._encoding = Delta;
+            ret._base = min_delta;
+            ret._width = delta_width;
+            ret._words.resize(words_of(count * delta_width) + 1);
+            for (size_t i = 1; i < count; i++) pack(ret._words.data(), i, delta_width, values[i] - values[i - 1] - min_delta);
+            for (size_t i = 0; i < count; i += Batch_Size) ret._checkpoints.push_back(values[i]);
+        }
+
+        return ret;
+    }
+
+    size_t Compressed_Column::bytes(void) const {
+        return (_words.size() + _run_values.size() + _checkpoints.size()) * sizeof(U64) + _run_ends.size() * sizeof(U32);
+    }
+
+    void Compressed_Column::unpack(size_t begin, size_t count, U64 *out) const {
+        switch (_encoding) {
+        case Run_Length: {
+            size_t run = std::upper_bound(_run_ends.begin(), _run_ends.end(), begin) - _run_ends.begin();
+            for (size_t i = 0; i < count; i++) {
+                if (begin + i >= _run_ends[run]) run++;
+                out[i] = _run_values[run];
+            }
+        } break;
+
+        case Frame_Of_Reference:
+            for (size_t i = 0; i < count; i++) out[i] = _base + unpack_one(_words.data(), begin + i, _width);
+            break;
+
+        case Delta: {
+            size_t idx = begin / Batch_Size * Batch_Size;
+            U64 value = _checkpoints[idx / Batch_Size];
+            for (idx++; idx <= begin; idx++) value += _base + unpack_one(_words.data(), idx, _width);
+
+            out[0] = value;
+            for (size_t i = 1; i < count; i++) out[i] = value += _base + unpack_one(_words.data(), begin + i, _width);
+        } break;
+
+        case Plain: {
+            const size_t size = _size;
+            for (size_t i = 0; i < count; i++) out[i] = widen(_variant, (const U8*)_words.data() + (begin + i) * size);
+        } break;
+        }
+    }
+
+    void Compressed_Column::decompress(size_t begin, size_t count, Column_Vector &out) const {
+        out.variant = _variant;
+        out.count = count;
+
+        if (_encoding == Plain) {
+            const size_t size = _size;
+            std::memcpy(out.data, (const U8*)_words.data() + begin * size, count * size);
+            return;
+        }
+
+        U64 values[Batch_Size];
+        unpack(begin, count, values);
+        narrow(_variant, values, count, out);
+    }
+
+    void Compressed_Column::compare_const(size_t begin, size_t count, Compare compare,
+                                          bytecode::Value constant, bytecode::Type type, U64 *bitmap) const {
+        if (_encoding == Plain) {
+            Column_Vector values;
+            decompress(begin, count, values);
+            vectorized::compare_const(values, compare, constant, type, bitmap);
+            return;
+        }
+
+        std::fill(bitmap, bitmap + simd::bitmap_words(count), 0);
+
+        // Result of every value is known by `min` and `max` of the segment.
+        Column_Vector bounds;
+        const U64 min_max[] = { _min, _max };
+        bounds.variant = _variant;
+        bounds.count = 2;
+        narrow(_variant, min_max, 2, bounds);
+
+        const auto match = vectorized::compare_range(bounds, compare, constant, type);
+        if (match != vectorized::Range_Match::Some) {
+            if (match == vectorized::Range_Match::All) set_bits(bitmap, 0, count);
+            return;
+        }
+
+        if (_encoding != Run_Length) {
+            Column_Vector values;
+            decompress(begin, count, values);
+            vectorized::compare_const(values, compare, constant, type, bitmap);
+            return;
+        }
+
+        // Every run is compared once.
+        const size_t first = std::upper_bound(_run_ends.begin(), _run_ends.end(), begin) - _run_ends.begin();
+        size_t last = first;
+        while (last < _run_ends.size() && _run_ends[last] < begin + count) last++;
+
+        Column_Vector runs;
+        runs.variant = _variant;
+        runs.count = last - first + 1;
+        narrow(_variant, _run_values.data() + first, runs.count, runs);
+
+        U64 results[simd::bitmap_words(Batch_Size)];
+        vectorized::compare_const(runs, compare, constant, type, results);
+
+        for (size_t run = first, from = begin; run <= last; run++) {
+            const size_t to = std::min<size_t>(_run_ends[run], begin + count);
+            if (results[(run - first) / 64] >> ((run - first) % 64) & 1) set_bits(bitmap, from - begin, to - begin);
+            from = to;
+        }
+    }
+
+    Compressed_Segments::Compressed_Segments(const Table &table): _table(&table) {
+        for (auto &column: table.columns()) _compressed.push_back(Domain::is_basic(column.domain->variant));
+    }
+
+    void Compressed_Segments::update(void) {
+        while (sealed() < _table->size() / Table::Segment_Rows) {
+            const size_t begin = sealed() * Table::Segment_Rows;
+
+            std::vector<Compressed_Column> columns(_compressed.size());
+            for (size_t i = 0; i < columns.size(); i++) {
+                if (_compressed[i]) columns[i] = Compressed_Column::compress(*_table, i, begin, Table::Segment_Rows);
+            }
+            _segments.push_back(std::move(columns));
+        }
+    }
+
+    size_t Compressed_Segments::bytes(void) const {
+        size_t ret = 0;
+        for (auto &segment: _segments) {
+            for (auto &column: segment) ret += column.bytes();
+        }
+        return ret;
+    }
+
+    size_t Compressed_Segments::plain_bytes(void) const {
+        size_t row_size = 0;
+        for (size_t i = 0; i < _compressed.size(); i++) {
+            if (_compressed[i]) row_size += _table->columns()[i].domain->size_of();
+        }
+        return sealed() * Table::Segment_Rows * row_size;
+    }
+}
@@ -0,0 +1,185 @@
+#ifndef compression_hpp_INCLUDED
+#define compression_hpp_INCLUDED
+
+#include <bytecode.hpp>
+#include <common.hpp>
+#include <vector>
+#include <vectorized.hpp>
+
+namespace toad_db::interact {
+
+    /**
+     * # Lightweight compression of the sealed segments.
+     *
+     * Segment is sealed when all `Table::Segment_Rows` rows of it are
+     * inserted, rows of it are not appended anymore. Every basic column of
+     * the sealed segment is compressed by the encoding chosen by its values:
+     *
+     * ```
+     *  Run_Length:          ok     = [ true x 40000, false x 25536 ]     -> 2 runs
+     *  Frame_Of_Reference:  level  = 100 + [ 3, 0, 7, 1, ... ]           -> 3 bits per value
+     *  Delta:               uk     = 5000 + prefix sum of [ 1, 1, 2, ... ] -> 2 bits per value
+     * ```
+     *
+     * Scans decompress values batch by batch to the same vectors as
+     * `vectorized::extract`, and comparisons with constants are evaluated
+     * once per run, or aren't evaluated at all if the constant is out of
+     * `[min, max]` of the segment.
+     *
+     * Compressed columns are kept beside the rows, the table isn't
+     * shrunk: they are an additional copy of the columns read by the
+     * filters over the scans, and cost `bytes()` more memory.
+     **/
+    namespace compression {
+        using vectorized::Column_Vector;
+        using vectorized::Compare;
+
+        class Compressed_Column {
+            public:
+                enum Encoding {
+                    /**
+                     * Values as is, floats and values without gain of the other encodings.
+                     **/
+                    Plain,
+
+                    /**
+                     * Values of the runs of equal values and ends of the runs.
+                     **/
+                    Run_Length,
+
+                    /**
+                     * `value - min` packed by the bits enough for `max - min`.
+                     **/
+                    Frame_Of_Reference,
+
+                    /**
+                     * Values are non-decreasing, `value - previous` packed like
+                     * `Frame_Of_Reference`, value before every batch is kept
+                     * to decompress batches independently.
+                     **/
+                    Delta,
+                };
+
+                /**
+                 * Compress values of the basic column of the rows `[begin, begin + count)`.
+                 *
+                 * @throws vectorized::Not_Basic_Column if column is not of basic domain.
+                 **/
+                static Compressed_Column compress(const Table &table, size_t column,
+                                                  size_t begin, size_t count) noexcept(false);
+
+                Encoding encoding(void) const { return _encoding; }
+                size_t size(void) const { return _count; }
+
+                /**
+                 * Bytes of the compressed values.
+                 **/
+                size_t bytes(void) const;
+
+                /**
+                 * Decompress values of the rows `[begin, begin + count)` of the segment.
+                 *
+                 * @param count - count of rows (at most vectorized::Batch_Size).
+                 **/
+                void decompress(size_t begin, size_t count, Column_Vector &out) const;
+
+                /**
+                 * Same as `vectorized::compare_const` over the decompressed values.
+                 **/
+                void compare_const(size_t begin, size_t count, Compare compare, bytecode::Value constant,
+                                   bytecode::Type type, types::U64 *bitmap) const;
+
+            private:
+                Domain::Variant _variant = Domain::Variant::U8;
+                size_t _size = 1;
+                Encoding _encoding = Plain;
+                size_t _count = 0;
+
+                /* Values widened to 64 bits, signed ones are sign extended. */
+                types::U64 _min = 0, _max = 0;
+
+                /* Frame of the packed values and the bits of every packed value. */
+                types::U64 _base = 0;
+                size_t _width = 0;
+
+                /* Packed values, or the values as is for Plain. */
+                std::vector<types::U64> _words;
+
+                std::vector<types::U64> _run_values;
+                std::vector<types::U32> _run_ends;
+
+                std::vector<types::U64> _checkpoints;
+
+                void unpack(size_t begin, size_t count, types::U64 *out) const;
+        };
+
+        /**
+         * # Compressed sealed segments of the table.
+         *
+         * Segments are compressed once: `update` takes only segments sealed
+         * since the previous call (like `plan::Table_Statistics`), the last
+         * not full segment is read from the table.
+         *
+         * ```cpp
+         * Compressed_Segments compressed { table };
+         * compressed.update();
+         *
+         * auto rows = vectorized::Batch_Filter { table, predicate, { &compressed } }.filter(engine);
+         * ```
+         **/
+        class Compressed_Segments {
+            public:
+                /**
+                 * Table must outlive the segments.
+                 **/
+                explicit Compressed_Segments(const Table &table);
+
+                /**
+                 * Compress segments sealed since the last update.
+                 **/
+                void update(void);
+
+                /**
+                 * Count of the compressed segments.
+                 **/
+                size_t sealed(void) const { return _segments.size(); }
+
+                /**
+                 * Rows `[begin, begin + count)` are in one compressed segment.
+                 **/
+                bool covers(size_t begin, size_t count) const {
+                    return begin / Table::Segment_Rows < sealed() && begin / Table::Segment_Rows == (begin + count - 1) / Table::Segment_Rows;
+                }
+
+                const Compressed_Column& column(size_t segment, size_t column) const { return _segments[segment][column]; }
+
+                /**
+                 * @param begin, count - rows covered by the segments (@see covers).
+                 **/
+                void decompress(size_t column, size_t begin, size_t count, Column_Vector &out) const {
+                    _segments[begin / Table::Segment_Rows][column].decompress(begin % Table::Segment_Rows, count, out);
+                }
+
+                void compare_const(size_t column, size_t begin, size_t count, Compare compare,
+                                   bytecode::Value constant, bytecode::Type type, types::U64 *bitmap) const {
+                    _segments[begin / Table::Segment_Rows][column].compare_const(begin % Table::Segment_Rows, count,
+                                                                                  compare, constant, type, bitmap);
+                }
+
+                /**
+                 * Bytes of the compressed columns and of the same columns in the rows.
+                 **/
+                size_t bytes(void) const;
+                size_t plain_bytes(void) const;
+
+            private:
+                const Table *_table;
+                std::vector<bool> _compressed;
+
+                /* Compressed columns of every sealed segment, not compressed ones are empty. */
+                std::vector<std::vector<Compressed_Column>> _segments;
+        };
+    }
+}
+
+#endif // compression_hpp_INCLUDED
@@ -0,0 +1,447 @@
+#include <generator.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace toad_db::interact {
+    using namespace types;
+    using Variant = Domain::Variant;
+
+    /**
+     * splitmix64, every value of the row is generated by its own stream.
+     **/
+    struct Data_Generator::Random {
+        U64 state;
+
+        Random(U64 seed, U64 row, U64 column): state(seed) {
+            state = mix(state ^ (row * 0x9E3779B97F4A7C15ull));
+            state = mix(state ^ (column * 0xC2B2AE3D27D4EB4Full));
+        }
+
+        static U64 mix(U64 x) {
+            x += 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+
+        U64 next(void) {
+            return mix(state++);
+        }
+
+        /**
+         * Uniform in `[0, 1)`.
+         **/
+        double unit(void) {
+            return (next() >> 11) * 0x1.0p-53;
+        }
+
+        /**
+         * Uniform in `[0, n)`.
+         **/
+        U64 below(U64 n) {
+            return n == 0 ? 0 : next() % n;
+        }
+    };
+
+    namespace {
+        constexpr double Epoch_2000 = 10957, Epoch_2033 = 23010;
+
+        /**
+         * Zipf rank in `[0, n)` by the inverse of the continuous
+         * approximation of its CDF.
+         **/
+        U64 zipf(double u, U64 n, double skew) {
+            double x;
+            if (std::abs(skew - 1) < 1e-9) {
+                x = std::pow((double)n + 1, u);
+            } else {
+                const double e = 1 - skew;
+                x = std::pow(u * (std::pow((double)n + 1, e) - 1) + 1, 1 / e);
+            }
+
+            const U64 rank = (U64)x;
+            return std::clamp<U64>(rank, 1, n) - 1;
+        }
+
+        /**
+         * Rank in `[0, n)` by the distribution.
+         **/
+        template<typename Random>
+        U64 rank_of(const Distribution &distribution, Random &random, size_t row, U64 n) {
+            switch (distribution.kind) {
+            case Distribution::Uniform:  return random.below(n);
+            case Distribution::Zipf:     return zipf(random.unit(), n, distribution.skew);
+            case Distribution::Sequence: return row % n;
+            }
+            return 0;
+        }
+
+        /**
+         * Count of the values in `[min, max]`.
+         **/
+        U64 range_of(const Distribution &distribution) {
+            const double range = std::floor(distribution.max) - std::ceil(distribution.min) + 1;
+            return range < 1 ? 1 : (U64)range;
+        }
+
+        template<typename Random>
+        I64 integer_of(const Distribution &distribution, Random &random, size_t row) {
+            const I64 min = (I64)std::ceil(distribution.min);
+            if (distribution.kind == Distribution::Sequence) return min + (I64)row;
+
+            return min + (I64)rank_of(distribution, random, row, range_of(distribution));
+        }
+
+        template<typename Type>
+        void store(U8 *out, Type value) {
+            std::memcpy(out, &value, sizeof(Type));
+        }
+
+        void store_integer(Variant variant, I64 value, U8 *out) {
+            switch (variant) {
+            case Variant::U8:   store<U8>(out, (U8)value); break;
+            case Variant::U16:  store<U16>(out, (U16)value); break;
+            case Variant::U32:  store<U32>(out, (U32)value); break;
+            case Variant::U64:  store<U64>(out, (U64)value); break;
+            case Variant::I8:   store<I8>(out, (I8)value); break;
+            case Variant::I16:  store<I16>(out, (I16)value); break;
+            case Variant::I32:  store<I32>(out, (I32)value); break;
+            case Variant::I64:  store<I64>(out, value); break;
+            case Variant::F32:  store<F32>(out, (F32)value); break;
+            case Variant::F64:  store<F64>(out, (F64)value); break;
+            case Variant::Bool: store<Bool>(out, value != 0); break;
+            default: break;
+            }
+        }
+
+        /**
+         * Civil date of the day counted from 1970-01-01.
+         **/
+        void civil_from_days(I64 days, I64 &year, unsigned &month, unsigned &day) {
+            days += 719468;
+            const I64 era = (days >= 0 ? days : days - 146096) / 146097;
+            const unsigned doe = (unsigned)(days - era * 146097);
+            const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const unsigned mp = (5 * doy + 2) / 153;
+
+            day = doy - (153 * mp + 2) / 5 + 1;
+            month = mp < 10 ? mp + 3 : mp - 9;
+            year = (I64)yoe + era * 400 + (month <= 2);
+        }
+
+        bool is_date(const Domain &domain) {
+            return domain.variant == Variant::Mul && domain.domain_name == "Date";
+        }
+
+        bool is_string(const Domain &domain) {
+            return Domain::is_array(domain.variant) && (*domain.domains)[domain.array.idx].variant == Variant::I8;
+        }
+
+        template<typename Type>
+        void append_number(std::string &out, const U8 *data) {
+            Type value;
+            std::memcpy(&value, data, sizeof(Type));
+
+            char buffer[64];
+            auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, end);
+        }
+
+        /**
+         * Literal of the encoded value as it's written in the inserts.
+         **/
+        void append_literal(const Domain &domain, const U8 *data, std::string &out) {
+            const Domain::Domains &domains = *domain.domains;
+
+            switch (domain.variant) {
+            case Variant::U8:   append_number<U8>(out, data); return;
+            case Variant::U16:  append_number<U16>(out, data); return;
+            case Variant::U32:  append_number<U32>(out, data); return;
+            case Variant::U64:  append_number<U64>(out, data); return;
+            case Variant::I8:   append_number<I8>(out, data); return;
+            case Variant::I16:  append_number<I16>(out, data); return;
+            case Variant::I32:  append_number<I32>(out, data); return;
+            case Variant::I64:  append_number<I64>(out, data); return;
+            case Variant::F32:  append_number<F32>(out, data); return;
+            case Variant::F64:  append_number<F64>(out, data); return;
+            case Variant::Bool: out += *data ? "true" : "false"; return;
+
+            case Variant::Array: {
+                const size_t capacity = domain.array.capacity;
+                const size_t len = Domain::get_counter((U8*)data, capacity);
+                const U8 *elems = data + Domain::counter_size_of(capacity);
+
+                if (is_string(domain)) {
+                    out += '"';
+                    out.append((const char*)elems, len);
+                    out += '"';
+                    return;
+                }
+
+                const Domain &elem = domains[domain.array.idx];
+                out += '[';
+                for (size_t i = 0; i < len; i++) {
+                    if (i) out += ", ";
+                    append_literal(elem, elems + i * elem.size_of(), out);
+                }
+                out += ']';
+                return;
+            }
+
+            case Variant::Add: {
+                const size_t count = domain.complex_fields.size();
+                const auto &field = domain.complex_fields[Domain::get_counter((U8*)data, count)];
+
+                out += domain.domain_name;
+                out += "::";
+                out += field.field_name;
+                if (field.has_type) {
+                    out += '(';
+                    append_literal(domains[field.domain_idx], data + Domain::counter_size_of(count), out);
+                    out += ')';
+                }
+                return;
+            }
+
+            case Variant::Mul: {
+                out += "{ ";
+                for (size_t i = 0; i < domain.complex_fields.size(); i++) {
+                    const auto &field = domain.complex_fields[i];
+                    const Domain &field_domain = domains[field.domain_idx];
+
+                    if (i) out += ", ";
+                    out += field.field_name;
+                    out += ": ";
+                    append_literal(field_domain, data, out);
+                    data += field_domain.size_of();
+                }
+                out += " }";
+                return;
+            }
+            }
+        }
+    }
+
+    Data_Generator::Data_Generator(Domain::Domains &domains, const parser::Top_Level_Statement::Table_Data &table,
+                                   U64 seed): _table_name(table.table_name), _seed(seed) {
+        for (auto &field: table.fields) {
+            Domain &domain = domains(std::string(field.type));
+
+            _columns.push_back({ std::string(field.name), &domain });
+            _distributions.push_back(default_distribution(domain));
+        }
+    }
+
+    Distribution Data_Generator::default_distribution(const Domain &domain) {
+        Distribution ret { };
+
+        if (domain.domain_name == "Key") {
+            ret.kind = Distribution::Sequence;
+            ret.min = 0;
+        } else if (Domain::is_bool(domain.variant)) {
+            ret.max = 1;
+        } else if (Domain::is_array(domain.variant)) {
+            ret.max_length = std::min<size_t>(16, domain.array.capacity);
+            ret.min_length = std::min<size_t>(1, ret.max_length);
+        } else if (is_date(domain)) {
+            ret.min = Epoch_2000;
+            ret.max = Epoch_2033;
+        } else if (Domain::is_sint(domain.variant)) {
+            ret.min = -100;
+        }
+
+        return ret;
+    }
+
+    void Data_Generator::set_distribution(const std::string &column, const Distribution &distribution) {
+        for (size_t i = 0; i < _columns.size(); i++) {
+            if (_columns[i].name != column) continue;
+
+            _distributions[i] = distribution;
+            return;
+        }
+
+        throw Table::Table_Has_Not_Such_Column(column);
+    }
+
+    void Data_Generator::fill(const Domain &domain, const Distribution &distribution, Random &random,
+                              size_t row, U8 *out) const {
+        const Domain::Domains &domains = *domain.domains;
+
+        if (Domain::is_float(domain.variant) && distribution.kind == Distribution::Uniform) {
+            const double value = distribution.min + random.unit() * (distribution.max - distribution.min);
+
+            if (domain.variant == Variant::F32) store<F32>(out, (F32)value);
+            else                                store<F64>(out, value);
+            return;
+        }
+
+        if (Domain::is_basic(domain.variant)) {
+            store_integer(domain.variant, integer_of(distribution, random, row), out);
+            return;
+        }
+
+        if (Domain::is_array(domain.variant)) {
+            const size_t capacity = domain.array.capacity;
+            U8 *elems = out + Domain::counter_size_of(capacity);
+
+            // Categorical strings: the same rank is the same string.
+            Random by_rank = random;
+            if (is_string(domain) && distribution.kind != Distribution::Uniform) {
+                by_rank = Random { _seed, (U64)integer_of(distribution, random, row), ~0ull };
+            }
+
+            const size_t min_length = std::min<size_t>(distribution.min_length, capacity);
+            const size_t max_length = std::clamp<size_t>(distribution.max_length, min_length, capacity);
+            const size_t len = min_length + by_rank.below(max_length - min_length + 1);
+            Domain::set_counter(out, capacity, len);
+
+            if (is_string(domain)) {
+                // Four letters of one random value.
+                U64 bits = 0;
+                for (size_t i = 0; i < len; i++, bits >>= 16) {
+                    if (i % 4 == 0) bits = by_rank.next();
+                    elems[i] = 'a' + (((bits & 0xFFFF) * 26) >> 16);
+                }
+                return;
+            }
+
+            const Domain &elem = domains[domain.array.idx];
+            const Distribution elem_distribution = default_distribution(elem);
+            for (size_t i = 0; i < len; i++) fill(elem, elem_distribution, by_rank, row, elems + i * elem.size_of());
+            return;
+        }
+
+        if (is_date(domain)) {
+            I64 year;
+            unsigned month, day;
+            civil_from_days(integer_of(distribution, random, row), year, month, day);
+
+            static constexpr const char *Months[] = {
+                "jan", "feb", "mar", "apr", "may", "jun", "jul", "aug", "sep", "oct", "nov", "dec",
+            };
+
+            for (auto &field: domain.complex_fields) {
+                const Domain &field_domain = domains[field.domain_idx];
+
+                if (field.field_name == "day") {
+                    store_integer(field_domain.variant, day, out);
+                } else if (field.field_name == "year") {
+                    store_integer(field_domain.variant, year, out);
+                } else if (field.field_name == "time") {
+                    store_integer(field_domain.variant, random.below(24 * 60 * 60), out);
+                } else if (field.field_name == "month" && field_domain.variant == Variant::Add) {
+                    // Variants of `Month` are found by the name, they are not in the calendar order.
+                    const size_t count = field_domain.complex_fields.size();
+                    size_t variant = 0;
+                    while (variant < count && field_domain.complex_fields[variant].field_name != Months[month - 1])
+                        variant++;
+
+                    Domain::set_counter(out, count, variant < count ? variant : month - 1);
+                } else {
+                    fill(field_domain, default_distribution(field_domain), random, row, out);
+                }
+
+                out += field_domain.size_of();
+            }
+            return;
+        }
+
+        if (domain.variant == Variant::Add) {
+            const size_t count = domain.complex_fields.size();
+            const size_t variant = count ? rank_of(distribution, random, row, count) : 0;
+            Domain::set_counter(out, count, variant);
+
+            if (count && domain.complex_fields[variant].has_type) {
+                const Domain &payload = domains[domain.complex_fields[variant].domain_idx];
+                fill(payload, default_distribution(payload), random, row, out + Domain::counter_size_of(count));
+            }
+            return;
+        }
+
+        for (auto &field: domain.complex_fields) {
+            const Domain &field_domain = domains[field.domain_idx];
+
+            fill(field_domain, default_distribution(field_domain), random, row, out);
+            out += field_domain.size_of();
+        }
+    }
+
+    void Data_Generator::fill_row(size_t row, U8 *out, size_t row_size) const {
+        // Unused bytes of the strings and variants are zeroed, so rows are the same for the same seed.
+        std::memset(out, 0, row_size);
+
+        for (size_t i = 0; i < _columns.size(); i++) {
+            Random random { _seed, row, i };
+
+            fill(*_columns[i].domain, _distributions[i], random, row, out);
+            out += _columns[i].domain->size_of();
+        }
+    }
+
+    void Data_Generator::generate(Table &table, size_t rows, Engine &engine) const {
+        const size_t first = table.size();
+        const size_t row_size = table.row_size();
+
+        U8 *data = table.append_rows(rows);
+        engine.for_each_morsel(rows, [&](size_t, size_t, Engine::Morsel morsel) {
+            for (size_t i = morsel.begin; i < morsel.end; i++) fill_row(first + i, data + i * row_size, row_size);
+        });
+    }
+
+    void Data_Generator::append_row(size_t row, std::vector<U8> &buffer, std::string &out) const {
+        fill_row(row, buffer.data(), buffer.size());
+
+        const U8 *data = buffer.data();
+        out += "{ ";
+        for (size_t i = 0; i < _columns.size(); i++) {
+            if (i) out += ", ";
+            out += _columns[i].name;
+            out += ": ";
+            append_literal(*_columns[i].domain, data, out);
+            data += _columns[i].domain->size_of();
+        }
+        out += " }";
+    }
+
+    std::string Data_Generator::insert_script(size_t first_row, size_t rows) const {
+        size_t row_size = 0;
+        for (auto &column: _columns) row_size += column.domain->size_of();
+
+        std::vector<U8> buffer(row_size);
+        std::string ret;
+
+        for (size_t i = 0; i < rows; i++) {
+            ret += i % Rows_Per_Insert == 0 ? _table_name : "";
+            ret += " << ";
+            append_row(first_row + i, buffer, ret);
+
+            if (i % Rows_Per_Insert == Rows_Per_Insert - 1 || i + 1 == rows) ret += ";\n";
+        }
+
+        return ret;
+    }
+
+    void Data_Generator::write_script(std::ostream &out, size_t rows, Engine &engine) const {
+        // Chunks of a few morsels are formatted in parallel and written in order,
+        // so the memory is bounded by the chunk and not by the whole script.
+        const size_t chunk_rows = Engine::Morsel_Rows * std::max<size_t>(engine.threads_count(), 1) * 4;
+
+        for (size_t first = 0; first < rows; first += chunk_rows) {
+            const size_t count = std::min(chunk_rows, rows - first);
+
+            auto morsels = Engine::split(count);
+            std::vector<std::string> parts(morsels.size());
+
+            engine.for_each_morsel(count, [&](size_t, size_t idx, Engine::Morsel morsel) {
+                parts[idx] = insert_script(first + morsel.begin, morsel.end - morsel.begin);
+            });
+
+            for (auto &part: parts) out << part;
+        }
+    }
+}
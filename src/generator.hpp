@@ -0,0 +1,134 @@
+#ifndef generator_hpp_INCLUDED
+#define generator_hpp_INCLUDED
+
+#include <common.hpp>
+#include <interpreter.hpp>
+#include <ostream>
+#include <parser.hpp>
+#include <string>
+#include <vector>
+
+namespace toad_db::interact {
+
+    /**
+     * How values of the column are generated.
+     *
+     *  - numbers are taken from `[min, max]`;
+     *  - variants of the Add domains (like `Month`) by their idx, the first
+     *    ones are the most frequent for `Zipf`;
+     *  - `Date` by the day in `[min, max]` counted from 1970-01-01;
+     *  - strings (arrays of `I8`) are of the length in `[min_length, max_length]`,
+     *    for `Zipf` and `Sequence` string is chosen by the rank in `[min, max]`,
+     *    so strings repeat like the values of the categorical column.
+     *
+     * Fields of the other complex domains and elements of the other arrays
+     * take the default distributions of their domains.
+     **/
+    struct Distribution {
+        enum Kind {
+            Uniform,
+
+            /**
+             * Rank `k` of `[1, n]` with probability proportional to `1 / k^skew`.
+             **/
+            Zipf,
+
+            /**
+             * `min + row`, variants and ranks are repeated by the row.
+             **/
+            Sequence,
+        } kind = Uniform;
+
+        double min = 0, max = 100;
+        double skew = 1;
+
+        size_t min_length = 1, max_length = 16;
+    };
+
+    /**
+     * # Generator of the synthetic rows.
+     *
+     * Columns and their domains are taken from the table definition, so the
+     * generated data matches the schema:
+     *
+     * ```cpp
+     * auto domains = Domain::default_domains();
+     * auto definition = Syntax_Tree { }.parse_table("table Users { uk(Key), name(Str), born(Date), };");
+     *
+     * Data_Generator generator { domains, definition };
+     * generator.set_distribution("name", { Distribution::Zipf, 0, 10000, 1.1 });
+     *
+     * Table users = generator.make_table();
+     * generator.generate(users, 100'000'000, engine);
+     * generator.write_script(file, 1'000'000, engine);
+     * ```
+     *
+     * Values of the row depend only on the seed, the idx of the row and of the
+     * column, so rows are generated by morsels in parallel and the result
+     * doesn't depend on the count of threads.
+     **/
+    class Data_Generator {
+        public:
+            /**
+             * Count of rows in one insert statement of the script.
+             **/
+            static constexpr size_t Rows_Per_Insert = 64;
+
+            /**
+             * Domains must outlive the generator and must not be added after it's created.
+             *
+             * @throws Domain::Domains::Invalid_Domain_Name if domain of the column is unknown.
+             **/
+            Data_Generator(Domain::Domains &domains, const parser::Top_Level_Statement::Table_Data &table,
+                           types::U64 seed = 0x70AD) noexcept(false);
+
+            static Distribution default_distribution(const Domain &domain);
+
+            /**
+             * @throws Table::Table_Has_Not_Such_Column if there is no such column.
+             **/
+            void set_distribution(const std::string &column, const Distribution &distribution) noexcept(false);
+
+            const std::string& table_name(void) const { return _table_name; }
+            const std::vector<Table::Column_Field>& columns(void) const { return _columns; }
+
+            /**
+             * Empty table of the columns.
+             **/
+            Table make_table(void) const { return Table { _columns }; }
+
+            /**
+             * Append generated rows, rows of the table are counted so
+             * the next call continues the sequences.
+             **/
+            void generate(Table &table, size_t rows, Engine &engine) const;
+
+            /**
+             * Insert statements of the rows `[first_row, first_row + rows)`:
+             *
+             * ```
+             * Users << { uk: 0, name: "kqd", born: { day: 3, month: Month::feb, ... } } << ...;
+             * ```
+             **/
+            std::string insert_script(size_t first_row, size_t rows) const;
+
+            /**
+             * Write insert statements of `rows` rows, chunks are formatted in parallel.
+             **/
+            void write_script(std::ostream &out, size_t rows, Engine &engine) const;
+
+        private:
+            std::string _table_name;
+            std::vector<Table::Column_Field> _columns;
+            std::vector<Distribution> _distributions;
+            types::U64 _seed;
+
+            struct Random;
+
+            void fill_row(size_t row, types::U8 *out, size_t row_size) const;
+            void fill(const Domain &domain, const Distribution &distribution, Random &random, size_t row, types::U8 *out) const;
+            void append_row(size_t row, std::vector<types::U8> &buffer, std::string &out) const;
+    };
+}
+
+#endif // generator_hpp_INCLUDED
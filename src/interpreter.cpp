@@ -1 +1,124 @@
+#include <interpreter.hpp>
 
+namespace toad_db::interact {
+    std::vector<Engine::Morsel> Engine::split(size_t count) {
+        std::vector<Morsel> morsels;
+        morsels.reserve((count + Morsel_Rows - 1) / Morsel_Rows);
+
+        for (size_t segment = 0; segment < count; segment += Table::Segment_Rows) {
+            const size_t segment_end = std::min(count, segment + Table::Segment_Rows);
+
+            for (size_t begin = segment; begin < segment_end; begin += Morsel_Rows) {
+                morsels.push_back({ begin, std::min(segment_end, begin + Morsel_Rows) });
+            }
+        }
+
+        return morsels;
+    }
+
+    std::vector<size_t> Engine::concat(const std::vector<std::vector<size_t>> &parts) {
+        size_t total = 0;
+        for (auto &part: parts) total += part.size();
+
+        std::vector<size_t> ret;
+        ret.reserve(total);
+        for (auto &part: parts) ret.insert(ret.end(), part.begin(), part.end());
+
+        return ret;
+    }
+
+    Table Engine::project(const Table &table, const std::vector<size_t> &columns) {
+        std::vector<size_t> rows(table.size());
+        for (size_t i = 0; i < rows.size(); i++) rows[i] = i;
+
+        return project(table, columns, rows);
+    }
+
+    Table Engine::project(const Table &table, const std::vector<size_t> &columns,
+                          const std::vector<size_t> &rows) {
+        std::vector<Table::Column_Field> fields;
+        std::vector<size_t> sizes;
+        for (auto column: columns) {
+            fields.push_back(table.columns().at(column));
+            sizes.push_back(fields.back().domain->size_of());
+        }
+
+        Table ret { fields };
+        if (rows.size() == 0) return ret;
+
+        ret.append_rows(rows.size());
+
+        for_each_morsel(rows.size(), [&](size_t, size_t, Morsel morsel) {
+            for (size_t i = morsel.begin; i < morsel.end; i++) {
+                const types::U8 *in = table.row_data(rows[i]);
+                types::U8 *out = ret.row_data(i);
+
+                for (size_t c = 0; c < columns.size(); c++) {
+                    std::memcpy(out + ret.column_offset(c),
+                                in + table.column_offset(columns[c]), sizes[c]);
+                }
+            }
+        });
+
+        return ret;
+    }
+
+    Engine::Join_Pairs Engine::hash_join(const Table &build, size_t build_column,
+                                         const Table &probe, size_t probe_column,
+                                         const std::vector<bool> *skipped_segments) {
+        const Domain *build_domain = build.columns().at(build_column).domain;
+        const Domain *probe_domain = probe.columns().at(probe_column).domain;
+
+        if (!Domain::is_competible(*build_domain, *probe_domain)
+            || build_domain->size_of() != probe_domain->size_of())
+            throw Join_Incompetible_Columns(build_domain->domain_name, probe_domain->domain_name);
+
+        const size_t key_size = build_domain->size_of();
+        const size_t build_offset = build.column_offset(build_column);
+        const size_t probe_offset = probe.column_offset(probe_column);
+
+        const size_t buckets = buckets_of(build.size());
+        const size_t mask = buckets - 1;
+
+        /* heads[bucket] and next[row] are `row idx + 1`, zero is end of chain. */
+        std::vector<size_t> heads(buckets, 0);
+        std::vector<size_t> next(build.size(), 0);
+
+        // Float keys are compared as values: -0.0 joins 0.0 and NaN joins nothing.
+        const Domain::Variant variant = build_domain->variant;
+
+        for (size_t row = 0; row < build.size(); row++) {
+            const types::U8 *key = Domain::equality_bytes(variant, build.row_data(row) + build_offset);
+            if (!key) continue;
+
+            const size_t bucket = hash_bytes(key, key_size) & mask;
+            next[row] = heads[bucket];
+            heads[bucket] = row + 1;
+        }
+
+        const size_t morsels = split(probe.size()).size();
+        std::vector<std::vector<size_t>> build_parts(morsels), probe_parts(morsels);
+
+        for_each_morsel(probe.size(), [&](size_t, size_t idx, Morsel morsel) {
+            const size_t segment = morsel.begin / Table::Segment_Rows;
+            if (skipped_segments && segment < skipped_segments->size() && (*skipped_segments)[segment]) return;
+
+            for (size_t row = morsel.begin; row < morsel.end; row++) {
+                const types::U8 *key = Domain::equality_bytes(variant, probe.row_data(row) + probe_offset);
+                if (!key) continue;
+
+                const size_t bucket = hash_bytes(key, key_size) & mask;
+
+                for (size_t curr = heads[bucket]; curr != 0; curr = next[curr - 1]) {
+                    if (std::memcmp(Domain::equality_bytes(variant, build.row_data(curr - 1) + build_offset), key, key_size) != 0)
+                        continue;
+
+                    build_parts[idx].push_back(curr - 1);
+                    probe_parts[idx].push_back(row);
+                }
+            }
+        });
+
+        return { concat(build_parts), concat(probe_parts), (heads.size() + next.size()) * sizeof(size_t) };
+    }
+}
@@ -1,9 +1,241 @@
 #ifndef interpreter_hpp_INCLUDED
 #define interpreter_hpp_INCLUDED
 
+#include <common.hpp>
+#include <thread_pool.hpp>
+
 namespace toad_db::interact {
+
+    /**
+     * Hash of the raw value bytes.
+     *
+     * Used by hash based operators, values of the same domain are equal
+     * when their bytes are equal.
+     **/
+    inline types::U64 hash_bytes(const types::U8 *data, size_t size) {
+        using namespace types;
+
+        U64 hash = 0x9E3779B97F4A7C15ull ^ size;
+        while (size >= sizeof(U64)) {
+            U64 word;
+            std::memcpy(&word, data, sizeof(U64));
+            hash = (hash ^ word) * 0xBF58476D1CE4E5B9ull;
+            hash ^= hash >> 31;
+            data += sizeof(U64); size -= sizeof(U64);
+        }
+
+        U64 tail = 0;
+        std::memcpy(&tail, data, size);
+        hash = (hash ^ tail) * 0x94D049BB133111EBull;
+
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    /**
+     * # Execution engine.
+     *
+     * Runs table operators in parallel. Scans are split into morsels, small
+     * ranges of rows inside one segment of the table (@see Table::Segment_Rows),
+     * and morsels are scheduled on the work stealing thread pool.
+     *
+     * Operators keep per-thread (or per-morsel) partial state and merge it when
+     * all morsels are finished, so results do not depend on the scheduling:
+     *
+     * ```cpp
+     * Engine engine { };
+     *
+     * auto rows = engine.filter(table, [&](const U8 *row) { return row[level_offset] > 1; });
+     * auto sum  = engine.aggregate(table, I64(0),
+     *                 [&](I64 &acc, const Table &table, Engine::Morsel morsel) {
+     *                     for (size_t i = morsel.begin; i < morsel.end; i++)
+     *                         acc += *(I64*)(table.row_data(i) + value_offset);
+     *                 },
+     *                 [](I64 &acc, const I64 &partial) { acc += partial; });
+     * ```
+     **/
     class Engine {
+        public:
+            /**
+             * Max count of rows in one morsel.
+             **/
+            static constexpr size_t Morsel_Rows = 1 << 14;
+
+            /**
+             * Range of rows `[begin, end)`, never crosses segment boundary.
+             **/
+            struct Morsel {
+                size_t begin;
+                size_t end;
+            };
+
+            /**
+             * Pairs of the matched rows produced by hash join.
+             * `build[i]` matched with `probe[i]`.
+             **/
+            struct Join_Pairs {
+                std::vector<size_t> build;
+                std::vector<size_t> probe;
+
+                /**
+                 * Size of the hash table (buckets and chains) in bytes.
+                 **/
+                size_t hash_table_bytes = 0;
+            };
+
+            /**
+             * @param threads - count of threads to use (by default all hardware threads).
+             **/
+            explicit Engine(size_t threads = std::thread::hardware_concurrency()):
+                _pool(threads) { }
+
+            /**
+             * Count of threads (size of per-thread states).
+             **/
+            size_t threads_count(void) const { return _pool.size(); }
+
+            Thread_Pool& pool(void) { return _pool; }
+
+            /**
+             * Split `count` rows into morsels.
+             **/
+            static std::vector<Morsel> split(size_t count);
+
+            /**
+             * Call `fn(worker, morsel_idx, morsel)` for all morsels of `count` rows in parallel.
+             **/
+            template<typename Fn>
+            void for_each_morsel(size_t count, Fn fn) {
+                auto morsels = split(count);
+
+                std::vector<Thread_Pool::Task> tasks;
+                tasks.reserve(morsels.size());
+                for (size_t i = 0; i < morsels.size(); i++) {
+                    tasks.push_back([&fn, i, morsel = morsels[i]](size_t worker) {
+                        fn(worker, i, morsel);
+                    });
+                }
+
+                _pool.run(tasks);
+            }
+
+            /**
+             * Parallel scan with per-morsel partial states.
+             *
+             * Partial states are merged in morsel order, so the result doesn't
+             * depend on the scheduling of the morsels (float sums too).
+             *
+             * @param table - table to scan.
+             * @param init - initial value of every partial state.
+             * @param scan - `scan(State&, const Table&, Morsel)` accumulates morsel to the state.
+             * @param merge - `merge(State& result, const State& partial)` merges partial states.
+             * @return merged state.
+             **/
+            template<typename State, typename Scan, typename Merge>
+            State aggregate(const Table &table, const State &init, Scan scan, Merge merge) {
+                std::vector<State> partial(split(table.size()).size(), init);
+
+                for_each_morsel(table.size(), [&](size_t, size_t idx, Morsel morsel) {
+                    scan(partial[idx], table, morsel);
+                });
+
+                State result = init;
+                for (auto &state: partial) merge(result, state);
+
+                return result;
+            }
+
+            /**
+             * Parallel filter.
+             *
+             * @param table - table to filter.
+             * @param pred - `pred(const U8 *row)` predicate on raw row data.
+             * @return idxs of matched rows in ascending order.
+             **/
+            template<typename Pred>
+            std::vector<size_t> filter(const Table &table, Pred pred) {
+                std::vector<std::vector<size_t>> selected(split(table.size()).size());
+
+                for_each_morsel(table.size(), [&](size_t, size_t idx, Morsel morsel) {
+                    auto &out = selected[idx];
+                    for (size_t row = morsel.begin; row < morsel.end; row++) {
+                        if (pred(table.row_data(row))) out.push_back(row);
+                    }
+                });
+
+                return concat(selected);
+            }
+
+            /**
+             * Parallel projection.
+             *
+             * @param table - source table.
+             * @param columns - idxs of the columns to take.
+             * @return new table with all rows but only provided columns.
+             **/
+            Table project(const Table &table, const std::vector<size_t> &columns);
+
+            /**
+             * Parallel projection of selected rows.
+             *
+             * @param table - source table.
+             * @param columns - idxs of the columns to take.
+             * @param rows - idxs of the rows to take (@see filter).
+             * @return new table.
+             **/
+            Table project(const Table &table, const std::vector<size_t> &columns,
+                          const std::vector<size_t> &rows);
+
+            /**
+             * Equi hash join, build is single threaded, probe is parallel.
+             *
+             * Columns are compared by raw bytes, so they must be of the same domain,
+             * floats are compared as values (@see Domain::equality_bytes).
+             *
+             * @param build - table to build hash table on (should be the smaller one).
+             * @param build_column - idx of the key column in build table.
+             * @param probe - table to probe.
+             * @param probe_column - idx of the key column in probe table.
+             * @param skipped_segments - segments of the probe table without keys of the build, they aren't probed.
+             * @return pairs of matched rows, ordered by probe row.
+             **/
+            Join_Pairs hash_join(const Table &build, size_t build_column,
+                                 const Table &probe, size_t probe_column,
+                                 const std::vector<bool> *skipped_segments = nullptr);
+
+            /**
+             * Size of the hash table of `hash_join` over `build_rows` rows in bytes,
+             * so it can be charged before it's built.
+             **/
+            static size_t hash_table_bytes(size_t build_rows) {
+                return (buckets_of(build_rows) + build_rows) * sizeof(size_t);
+            }
+
+            class Join_Incompetible_Columns: public Toad_Exception {
+                public:
+                    Join_Incompetible_Columns(const std::string &build, const std::string &probe):
+                        Toad_Exception("Can't join column of domain `" + build + "`"
+                                        + " with column of domain `" + probe + "`") { }
+            };
+
+            /**
+             * Concat per-morsel results in morsel order.
+             **/
+            static std::vector<size_t> concat(const std::vector<std::vector<size_t>> &parts);
+
+        private:
+            Thread_Pool _pool;
 
+            /**
+             * Buckets of the hash table, power of two of at least two per row.
+             **/
+            static size_t buckets_of(size_t build_rows) {
+                size_t ret = 16;
+                while (ret < build_rows * 2) ret <<= 1;
+                return ret;
+            }
     };
 }
 
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <lexer.hpp>
+#include <parser.hpp>
+
+namespace toad_db::parser {
+    using namespace types;
+
+    namespace {
+        enum Char_Class: U8 {
+            Other = 0, Space, Digit, Name_Char, Quote, Stmt_End, Param
+        };
+
+        constexpr std::array<Char_Class, 256> char_classes = [] {
+            std::array<Char_Class, 256> ret { };
+
+            for (char c: { ' ', '\n', '\r', '\t' }) ret[(U8)c] = Space;
+            for (int c = 'a'; c <= 'z'; c++) ret[c] = Name_Char;
+            for (int c = 'A'; c <= 'Z'; c++) ret[c] = Name_Char;
+            for (int c = '0'; c <= '9'; c++) ret[c] = Digit;
+            ret['_'] = Name_Char;
+            ret['"'] = ret['\''] = Quote;
+            ret[';'] = Stmt_End;
+            ret['$'] = Param;
+
+            return ret;
+        }();
+
+        Char_Class class_of(char c) { return char_classes[(U8)c]; }
+
+        bool is_name(char c) {
+            const auto cls = class_of(c);
+            return cls == Name_Char || cls == Digit;
+        }
+
+        /**
+         * Token ends an operand, so the next `+` or `-` is binary operator.
+         **/
+        bool ends_operand(const std::vector<Token> &tokens) {
+            if (tokens.empty()) return false;
+
+            const auto &last = *tokens.rbegin();
+            if (last.kind != Token::Special) return true;
+
+            return last.symbol->closes && !last.symbol->is_operator();
+        }
+    }
+
+    Symbol& Symbol_Table::add(std::string_view name) {
+        auto &bucket = _by_char[(U8)name[0]];
+        for (auto idx: bucket) {
+            if (_symbols[idx].name == name) return _symbols[idx];
+        }
+
+        _symbols.push_back(Symbol { .name = std::string(name) });
+        _symbols.rbegin()->is_word = std::all_of(name.begin(), name.end(), is_name);
+
+        bucket.push_back(_symbols.size() - 1);
+        std::stable_sort(bucket.begin(), bucket.end(), [this] (U32 lhs, U32 rhs) {
+            return _symbols[lhs].name.size() > _symbols[rhs].name.size();
+        });
+
+        return *_symbols.rbegin();
+    }
+
+    const Symbol* Symbol_Table::match(std::string_view view) const {
+        if (view.empty()) return nullptr;
+
+        for (auto idx: _by_char[(U8)view[0]]) {
+            const auto &symbol = _symbols[idx];
+            if (!symbol.is_word && view.starts_with(symbol.name)) return &symbol;
+        }
+
+        return nullptr;
+    }
+
+    const Symbol* Symbol_Table::word(std::string_view name) const {
+        if (name.empty()) return nullptr;
+
+        for (auto idx: _by_char[(U8)name[0]]) {
+            const auto &symbol = _symbols[idx];
+            if (symbol.is_word && symbol.name == name) return &symbol;
+        }
+
+        return nullptr;
+    }
+
+    std::vector<Token> tokenize(std::string_view view, const Symbol_Table &table) {
+        std::vector<Token> tokens;
+        tokenize(view, table, tokens);
+        return tokens;
+    }
+
+    void tokenize(std::string_view view, const Symbol_Table &table, std::vector<Token> &tokens) {
+        tokens.clear();
+        tokens.reserve(view.size() / 4 + 1);
+
+        const char *curr = view.data(), *end = view.data() + view.size();
+
+        const auto push = [&tokens] (Token::Kind kind, const char *start, const char *stop,
+                                     const Symbol *symbol = nullptr) {
+            tokens.push_back(Token { kind, std::string_view { start, (size_t)(stop - start) }, symbol });
+        };
+
+        while (true) {
+            while (curr < end && class_of(*curr) == Space) curr++;
+
+            if (curr == end || class_of(*curr) == Stmt_End) {
+                push(Token::End, curr, curr);
+                return;
+            }
+
+            const char *start = curr;
+
+            switch (class_of(*curr)) {
+            case Quote: {
+                const char quote = *curr++;
+                while (curr < end && *curr != quote) curr++;
+                if (curr < end) curr++;
+
+                push(quote == '"' ? Token::Str_Literal : Token::Char_Literal, start, curr);
+            } continue;
+
+            case Digit: {
+                while (curr < end && class_of(*curr) == Digit) curr++;
+                push(Token::Num_Literal, start, curr);
+            } continue;
+
+            case Param: {
+                curr++;
+                while (curr < end && is_name(*curr)) curr++;
+                if (curr - start == 1) throw Unexpected_Call(error_help(view, { start, 1 }));
+
+                push(Token::Name, start, curr);
+            } continue;
+
+            case Name_Char: {
+                while (curr < end && is_name(*curr)) curr++;
+
+                const Symbol *symbol = table.word({ start, (size_t)(curr - start) });
+                push(symbol ? Token::Special : Token::Name, start, curr, symbol);
+            } continue;
+
+            default: break;
+            }
+
+            if ((*curr == '+' || *curr == '-') && curr + 1 < end
+                && class_of(curr[1]) == Digit && !ends_operand(tokens)) {
+                curr++;
+                while (curr < end && class_of(*curr) == Digit) curr++;
+                push(Token::Num_Literal, start, curr);
+                continue;
+            }
+
+            const Symbol *symbol = table.match({ curr, (size_t)(end - curr) });
+            if (symbol == nullptr) {
+                throw Unexpected_Call(error_help(view, { curr, 1 }));
+            }
+
+            curr += symbol->name.size();
+            push(Token::Special, start, curr, symbol);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef lexer_hpp_INCLUDED
+#define lexer_hpp_INCLUDED
+
+#include <array>
+#include <common.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace toad_db::parser {
+
+    /**
+     * # Symbol of the language.
+     *
+     * Operators (`+`, `with`) and nodes of bound operators (`(`, `,`, `then`).
+     * One spelling can have several roles, `<` is both the less operator
+     * and the opening of projection `<a, b>`, parser decides by position.
+     **/
+    struct Symbol {
+        static constexpr size_t None = (size_t)-1;
+
+        std::string name;
+
+        /**
+         * Order of the operator, `None` if symbol is not operator.
+         **/
+        size_t order = None;
+
+        /**
+         * Idx of the bound operator opened by the symbol (or `None`).
+         **/
+        size_t opens = None;
+
+        /**
+         * Symbol is the last node of some bound operator (`)`, `]`...).
+         **/
+        bool closes = false;
+
+        /**
+         * Symbol consists of name chars, so it's matched only as whole word.
+         **/
+        bool is_word = false;
+
+        bool is_operator(void) const { return order != None; }
+        bool is_open(void) const { return opens != None; }
+    };
+
+    /**
+     * # Table of symbols.
+     *
+     * Symbols are indexed by the first char, each bucket is sorted by the
+     * length, so the longest match is found by few compares:
+     *
+     * ```
+     *  '<' -> [ "<=", "<" ]
+     *  '=' -> [ "==", "=" ]
+     *  'w' -> [ "with" ]
+     * ```
+     **/
+    class Symbol_Table {
+        public:
+            /**
+             * Find symbol by the name or add the new one.
+             **/
+            Symbol& add(std::string_view name);
+
+            /**
+             * Longest not word symbol at the start of the view.
+             *
+             * @return symbol or nullptr.
+             **/
+            const Symbol* match(std::string_view view) const;
+
+            /**
+             * Word symbol equal to the name.
+             *
+             * @return symbol or nullptr.
+             **/
+            const Symbol* word(std::string_view name) const;
+
+        private:
+            std::vector<Symbol> _symbols;
+            std::array<std::vector<types::U32>, 256> _by_char;
+    };
+
+    struct Token {
+        enum Kind: char {
+            /**
+             * Name or parameter of the prepared statement (`$min_level`).
+             **/
+            Name = 0,
+            Str_Literal, Char_Literal, Num_Literal,
+
+            /**
+             * Operator or node of bound operator, see `.symbol`.
+             **/
+            Special,
+
+            /**
+             * `;` or end of the view.
+             **/
+            End,
+        } kind;
+
+        std::string_view text;
+
+        const Symbol *symbol = nullptr;
+    };
+
+    /**
+     * Split the statement to the tokens in one pass.
+     *
+     * Sign is part of the number literal only if previous token doesn't end
+     * an operand: `a -1` is subtraction, `a * -1` is multiplication by `-1`.
+     *
+     * @return tokens, the last one is `End`.
+     * @throws Unexpected_Call if there is not valid char.
+     **/
+    std::vector<Token> tokenize(std::string_view view, const Symbol_Table &table) noexcept(false);
+
+    /**
+     * Same as above, but tokens are written to the `tokens` (old ones are
+     * removed), so the buffer can be reused by the statements.
+     **/
+    void tokenize(std::string_view view, const Symbol_Table &table, std::vector<Token> &tokens) noexcept(false);
+}
+
+#endif // lexer_hpp_INCLUDED
@@ -1,10 +1,16 @@
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
 #include <memory>
 #include <ostream>
 #include <parser.hpp>
 #include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
 namespace toad_db::parser {
@@ -48,6 +54,18 @@ namespace toad_db::parser {
                     os << "  (CALL):\n";
                     os << "    (Expr: `" << to_string(stmt.call_data)  << "`)\n";
                 } break;
+                case Top_Level_Statement::Explain: {
+                    os << "  (EXPLAIN):\n";
+                    os << "    (Expr: `" << to_string(stmt.call_data)  << "`)\n";
+                } break;
+                case Top_Level_Statement::Explain_Analyze: {
+                    os << "  (EXPLAIN ANALYZE):\n";
+                    os << "    (Expr: `" << to_string(stmt.call_data)  << "`)\n";
+                } break;
+                case Top_Level_Statement::Analyze: {
+                    os << "  (ANALYZE):\n";
+                    os << "    (Expr: `" << to_string(stmt.call_data)  << "`)\n";
+                } break;
 
                 case Top_Level_Statement::Function_Define:
                 default: {
@@ -87,6 +105,7 @@ namespace toad_db::parser {
     }
 
     std::string to_string(const Top_Level_Statement::Expression_Data &data) {
+        if (data.root == nullptr) return "{}";
         return to_string(data.root);
     }
 
@@ -106,8 +125,42 @@ namespace toad_db::parser {
         return { str.begin(), str.begin() + end };
     }
 
+    size_t find_stmt_end(std::string_view str) {
+        const char *begin = str.data(), *end = begin + str.size();
+
+        const auto find = [] (const char *from, const char *to, char c) {
+            if (from == to) return to;
+
+            const char *found = (const char*)std::memchr(from, c, to - from);
+            return found ? found : to;
+        };
+
+        // Jumps by `memchr` between `;` and quotes instead of a loop over all
+        // chars. Quotes are searched only till the `;`, so statements
+        // without literals are not scanned twice.
+        const char *stmt_end = find(begin, end, ';');
+        const char *dquote = find(begin, stmt_end, '"');
+        const char *squote = find(begin, stmt_end, '\'');
+
+        while (true) {
+            const char *quote = std::min(dquote, squote);
+            if (quote == stmt_end) return stmt_end == end ? std::string_view::npos : stmt_end - begin;
+
+            const char *curr = find(quote + 1, end, *quote);
+            if (curr == end) return std::string_view::npos;
+            curr++;
+
+            if (stmt_end < curr) stmt_end = find(curr, end, ';');
+            if (dquote < curr) dquote = find(curr, stmt_end, '"');
+            if (squote < curr) squote = find(curr, stmt_end, '\'');
+        }
+    }
+
     std::string_view read_stmt(std::string_view str) {
-        return read_until(trim_left(str), ';');
+        str = trim_left(str);
+
+        const size_t end = find_stmt_end(str);
+        return str.substr(0, end == std::string_view::npos ? str.size() : end + 1);
     }
 
     Top_Level_Statement::Variant Syntax_Tree::read_variant(std::string_view stmt) {
@@ -123,6 +176,19 @@ namespace toad_db::parser {
             return Top_Level_Statement::Variant::Function_Define;
         }
 
+        if (stmt.starts_with("explain") && (stmt.size() == 7 || !is_name_char(stmt[7]))) {
+            const std::string_view query = trim_left(stmt.substr(7));
+
+            if (query.starts_with("analyze") && (query.size() == 7 || !is_name_char(query[7])))
+                return Top_Level_Statement::Variant::Explain_Analyze;
+
+            return Top_Level_Statement::Variant::Explain;
+        }
+
+        if (stmt.starts_with("analyze") && (stmt.size() == 7 || !is_name_char(stmt[7]))) {
+            return Top_Level_Statement::Variant::Analyze;
+        }
+
         return Top_Level_Statement::Variant::Call;
     }
 
@@ -132,6 +198,9 @@ namespace toad_db::parser {
         case Top_Level_Statement::Domain_Define: return "domain definition";
         case Top_Level_Statement::Function_Define: return "function definition";
         case Top_Level_Statement::Call: return "call statement";
+        case Top_Level_Statement::Explain: return "explain statement";
+        case Top_Level_Statement::Explain_Analyze: return "explain analyze statement";
+        case Top_Level_Statement::Analyze: return "analyze statement";
         case Top_Level_Statement::None: return "none";
         }
     }
@@ -358,265 +427,664 @@ namespace toad_db::parser {
     }
 
 
-    std::pair<std::string_view, Top_Level_Statement::Expression_Data::kind>
-        Syntax_Tree::read_literal(std::string_view view) {
-        using Kind = Top_Level_Statement::Expression_Data::kind;
+    Symbol_Table Syntax_Tree::make_symbols(const std::vector<Operator> &operators,
+                                           const std::vector<Bound_Operator> &bound_operators) {
+        Symbol_Table table;
 
-        view = trim_left(view);
-        if (view.size() > 0 && (view[0] == '"' || view[0] == '\'')) {
-            return { 
-                {view.begin(), read_until({view.begin()+1, view.end()}, view[0]).end()}, 
-                view[0] == '"' ? Kind::Str_Literal : Kind::Char_Literal }; 
+        for (auto &op: operators) {
+            table.add(op.name).order = op.order;
         }
 
+        for (size_t i = 0; i < bound_operators.size(); i++) {
+            auto &nodes = bound_operators[i].nodes;
 
-        if (view.size() > 0 && (view[0] == '+' || view[0] == '-' || std::isdigit(view[0]))) {
-            size_t end = 1;
-            while (end < view.size() && std::isdigit(view[end])) { end++; }
-
-            if (end == 1 && !std::isdigit(view[0])) {
-                return {{ view.begin(), view.begin()}, Kind::Err};
+            table.add(nodes[0].name).opens = i;
+            for (size_t j = 1; j < nodes.size(); j++) {
+                auto &symbol = table.add(nodes[j].name);
+                symbol.closes = symbol.closes || nodes[j].variant == Bound_Operator::Close;
             }
-            return {{ view.begin(), view.begin() + end}, Kind::Num_Literal };
         }
 
-        return {{ view.begin(), view.begin() }, Kind::Err };
+        return table;
     }
 
+    namespace {
+        /**
+         * # Pratt parser over the tokens of one statement.
+         *
+         * Operators are parsed by precedence climbing with explicit stacks of
+         * operands and pending operators. Bound operators push the frame to
+         * the stack of delimiters and pop it at the closing node, so every
+         * token is visited once and nesting depth is not limited by the
+         * native stack:
+         *
+         * ```
+         *  tokens:  [ a , ( b + c ) ]
+         *  frames:  stmt | '[' | '('         -- at `c`
+         *  operands:       b c
+         *  pending:        +
+         * ```
+         *
+         * Arguments of unfinished nodes are collected on one stack and are
+         * copied to the arena of the tree when node is finished. Buffers are
+         * reused by the statements of the script.
+         **/
+        class Expression_Parser {
+            public:
+                using Expression_Data = Top_Level_Statement::Expression_Data;
+                using Node = Expression_Data::Expression_Node;
+                using Kind = Expression_Data::kind;
+                using pointer = Expression_Data::pointer;
+                using Bound_Operator = Syntax_Tree::Bound_Operator;
+
+                Expression_Parser(Syntax_Tree &tree): Expression_Parser(tree, tree.arena) { }
+
+                /**
+                 * Nodes are allocated in the `arena` instead of the arena of
+                 * the tree, so several parsers can share one tree.
+                 **/
+                Expression_Parser(const Syntax_Tree &tree, Arena &arena): _tree(tree), _arena(arena) { }
+
+                /**
+                 * @return `Expression` root node.
+                 **/
+                pointer parse(std::string_view view);
+
+            private:
+                /**
+                 * Bound operator under construction.
+                 **/
+                struct Frame {
+                    /**
+                     * nullptr for the whole statement.
+                     **/
+                    const Bound_Operator *op;
+                    pointer node;
+
+                    /**
+                     * Function which argument is the operator: `f (a)`,
+                     * and start of it's arguments.
+                     **/
+                    pointer call;
+                    size_t call_args;
+
+                    std::string_view open, prev;
+
+                    /**
+                     * First node that can follow current part.
+                     **/
+                    size_t from;
+
+                    /**
+                     * Sizes of the stacks at the part start.
+                     **/
+                    size_t operands, pending, args;
+                };
+
+                struct Pending {
+                    pointer node;
+                    pointer left;
+                    size_t order;
+
+                    /**
+                     * Size of operands after the operator, the right operand
+                     * is there only if stack is greater.
+                     **/
+                    size_t operands;
+                };
+
+                const Syntax_Tree &_tree;
+                Arena &_arena;
+                std::string_view _full_view;
+                std::vector<Token> _tokens;
+                size_t _pos = 0;
+
+                std::vector<Frame> _frames;
+                std::vector<pointer> _operands;
+                std::vector<Pending> _pending;
+                std::vector<pointer> _args;
+
+                /**
+                 * Node of the current bound operator (like `>` of `<a, b>`)
+                 * is not an operator.
+                 **/
+                static bool is_node_of(const Token &token, const Bound_Operator *bound) {
+                    if (bound == nullptr) return false;
+
+                    return std::any_of(bound->nodes.begin() + 1, bound->nodes.end(),
+                                       [&token] (auto &node) { return node.name == token.text; });
+                }
 
-    std::string_view Syntax_Tree::read_operator(std::string_view view) {
-        view = trim_left(view);
+                static bool is_operator(const Token &token, const Frame &frame) {
+                    return token.kind == Token::Special && token.symbol->is_operator()
+                        && !is_node_of(token, frame.op);
+                }
 
-        auto op = std::find_if(operators.begin(), operators.end(), [&view] (auto &op)
-                               { return view.starts_with(op.name); });
+                static bool is_literal(const Token &token) {
+                    return token.kind == Token::Str_Literal || token.kind == Token::Char_Literal
+                        || token.kind == Token::Num_Literal;
+                }
 
-        if (op == operators.end()) {
-            return { view.begin(), view.begin() };
-        }
+                static bool is_open(const Token &token) {
+                    return token.kind == Token::Special && token.symbol->is_open();
+                }
 
-        return { view.begin(), view.begin() + op->name.size() };
-    }
+                /**
+                 * Opening operator (`<`) written right after the operand and
+                 * followed by the list of names is the bound operator, not
+                 * the comparison: `Users<name, level>`, but `a < b`.
+                 **/
+                bool is_projection(size_t pos) const {
+                    const Token &token = _tokens[pos];
+                    if (pos == 0 || !is_open(token) || !token.symbol->is_operator()) return false;
 
-    Syntax_Tree::Operator Syntax_Tree::get_operator(std::string_view view) {
-        view = trim_left(view);
+                    const std::string_view prev = _tokens[pos - 1].text;
+                    if (prev.data() + prev.size() != token.text.data()) return false;
 
-        auto op = std::find_if(operators.begin(), operators.end(), [&view] (auto &op)
-                               { return view == op.name; });
+                    const Bound_Operator &op = _tree.bound_operators[token.symbol->opens];
 
-        if (op == operators.end()) {
-            throw Parsing_Exception("Value: `" + std::string(view) + "` -- is not operator!");
-        }
+                    for (pos++; _tokens[pos].kind == Token::Name; pos += 2) {
+                        const Token &next = _tokens[pos + 1];
+                        if (next.kind != Token::Special) return false;
 
-        return *op;
-    }
+                        auto node = std::find_if(op.nodes.begin() + 1, op.nodes.end(),
+                                                 [&next] (auto &node) { return node.name == next.text; });
+                        if (node == op.nodes.end()) return false;
+                        if (node->variant == Bound_Operator::Close) return true;
+                    }
 
+                    return false;
+                }
 
-    std::string_view Syntax_Tree::read_node(std::string_view view, const Bound_Operator &op, size_t &idx) {
-        int level = 0;
-        auto start = view.begin();
+                /**
+                 * Operator glued only to the following operand is prefix
+                 * even after other operator: `a * @b` is `a * (@b)`, but
+                 * `a@ * b` is `(a@) * b`.
+                 **/
+                bool is_prefix(size_t pos) const {
+                    const Token &prev = _tokens[pos - 1], &token = _tokens[pos], &next = _tokens[pos + 1];
+                    if (next.kind != Token::Name && !is_literal(next) && !is_open(next)) return false;
+
+                    return prev.text.data() + prev.text.size() != token.text.data()
+                        && token.text.data() + token.text.size() == next.text.data();
+                }
 
-        while (view.begin() < view.end()) {
-            if (level == 0) {
-                size_t prev = idx;
+                /**
+                 * Bound operator that is taken as argument by the preceding
+                 * name or group: `f (a)`, `Users{a, b}`, `(a * b)<x>`.
+                 **/
+                bool opens_arguments(size_t pos) const {
+                    const Token &token = _tokens[pos];
+                    return is_open(token) && (!token.symbol->is_operator() || is_projection(pos));
+                }
+
+                pointer make_node(Kind kind, std::string_view name, std::span<const pointer> args = { }) {
+                    return _arena.make<Node>(kind, name, _arena.copy(args));
+                }
 
-                while (++idx < op.nodes.size()) {
-                    if (view.starts_with(op.nodes[idx].name)) {
-                        if (op.nodes[idx].variant == Bound_Operator::Variant::Multiple) idx--;
-                        return { start, view.begin() };
+                pointer make_node(const Token &token) {
+                    switch (token.kind) {
+                    case Token::Str_Literal: return make_node(Kind::Str_Literal, token.text);
+                    case Token::Char_Literal: return make_node(Kind::Char_Literal, token.text);
+                    case Token::Num_Literal: return make_node(Kind::Num_Literal, token.text);
+                    default: return make_node(Kind::Name, token.text);
                     }
+                }
 
-                    if (op.nodes[idx].variant != Bound_Operator::Variant::Multiple) break;
+                pointer wrap(pointer expr) {
+                    return make_node(Kind::Expression, std::string_view { },
+                                     { &expr, expr ? (size_t)1 : 0 });
                 }
 
-                idx = prev;
-            }
+                /**
+                 * Move arguments from `args` stack to the node.
+                 **/
+                void finish(pointer node, size_t args) {
+                    node->args = _arena.copy<pointer>(std::span(_args).subspan(args));
+                    _args.resize(args);
+                }
 
-            if (view.starts_with(op.nodes.begin()->name)) level++;
-            if (view.starts_with(op.nodes.rbegin()->name)) level--;
+                void open(pointer call, size_t call_args) {
+                    const Token &token = _tokens[_pos++];
+
+                    _frames.push_back(Frame {
+                        .op = &_tree.bound_operators[token.symbol->opens],
+                        .node = make_node(Kind::Bound_Operator, token.text),
+                        .call = call, .call_args = call_args,
+                        .open = token.text, .prev = token.text,
+                        .from = 1,
+                        .operands = _operands.size(), .pending = _pending.size(), .args = _args.size(),
+                    });
+                }
 
-            view = { view.begin()+1, view.end() };
-        }
+                /**
+                 * Read arguments of the function, names and literals are
+                 * collected at once, bound operator opens the frame.
+                 *
+                 * @return true if frame was opened.
+                 **/
+                bool read_arguments(pointer call, size_t call_args) {
+                    while (true) {
+                        const Token &token = _tokens[_pos];
+
+                        if (opens_arguments(_pos)) {
+                            open(call, call_args);
+                            return true;
+                        }
 
-        if (level != 0) return { view.begin(), view.begin() };
-        idx++;
+                        if (token.kind != Token::Name && !is_literal(token)) {
+                            finish(call, call_args);
+                            return false;
+                        }
 
-        return { start, view.begin() };
-    }
+                        _args.push_back(make_node(token));
+                        _pos++;
+                    }
+                }
 
-    std::vector<std::string_view> Syntax_Tree::read_bound_operator(std::string_view view) {
-        auto full_view = view;
-        view = trim_left(view);
-        auto op = std::find_if(bound_operators.begin(), bound_operators.end(),
-                               [view](auto op){ return view.starts_with(op.nodes[0].name); });
+                void reduce_top(void) {
+                    Pending pending = *_pending.rbegin();
+                    _pending.pop_back();
 
-        if (op == bound_operators.end()) return { };
+                    pointer args[2];
+                    size_t count = 0;
 
-        std::vector<std::string_view> ret { };
+                    if (pending.left) args[count++] = pending.left;
+                    if (_operands.size() > pending.operands) {
+                        args[count++] = *_operands.rbegin();
+                        _operands.pop_back();
+                    }
 
-        size_t i = 0;
-        while (i < op->nodes.size()) {
-            auto node = op->nodes[i];
-            ret.push_back({ view.begin(), view.begin() + node.name.size() });
-            view = { view.begin() + node.name.size(), view.end() };
+                    pending.node->args = _arena.copy<pointer>({ args, count });
+                    _operands.push_back(pending.node);
+                }
 
-            if (op->nodes[i].variant == Bound_Operator::Close) break;
+                /**
+                 * Reduce operators of the part with order not less than `order`.
+                 * Operator without right operand is reduced anyway: `a @ * b`.
+                 **/
+                void reduce(size_t order, const Frame &frame) {
+                    if (_pending.size() > frame.pending && _operands.size() == _pending.rbegin()->operands)
+                        reduce_top();
 
-            auto expr = read_node(view, *op, i);
+                    while (_pending.size() > frame.pending && _pending.rbegin()->order >= order)
+                        reduce_top();
+                }
 
-            if (op->nodes[i].variant == Bound_Operator::Once && expr.size() == 0) {
-                throw Expected_Bound_Operator_Node_Expr(op->nodes[i].name, error_help(full_view, expr));
-            }
+                /**
+                 * Pop the frame of finished bound operator.
+                 *
+                 * @return true if operand is expected after it.
+                 **/
+                bool close(void) {
+                    Frame frame = *_frames.rbegin();
+                    _frames.pop_back();
+
+                    finish(frame.node, frame.args);
+
+                    if (!frame.call) {
+                        _operands.push_back(frame.node);
+                        if (!opens_arguments(_pos)) return false;
+
+                        // Group followed by bound operator takes it as argument after
+                        // the closing node: `('(' {a * b} (N:')') ('<' {x} (N:'>')))`.
+                        const size_t args = _args.size();
+                        _args.insert(_args.end(), frame.node->args.begin(), frame.node->args.end());
+                        return read_arguments(frame.node, args);
+                    }
 
-            view = { expr.end(), view.end() };
+                    _args.push_back(frame.node);
+                    return read_arguments(frame.call, frame.call_args);
+                }
 
-            ret.push_back(expr);
-        }
+                /**
+                 * End of the part of the bound operator at the current token.
+                 *
+                 * @return true if operand is expected after it.
+                 **/
+                bool end_part(pointer expr);
+        };
 
-        return ret;
-    }
+        Expression_Parser::pointer Expression_Parser::parse(std::string_view view) {
+            _full_view = view;
+            tokenize(view, _tree.symbols, _tokens);
+            _pos = 0;
 
+            _frames.clear();
+            _operands.clear();
+            _pending.clear();
+            _args.clear();
 
-    Top_Level_Statement::Expression_Data Syntax_Tree::parse_call(std::string_view view) {
-        using Expression_Data = Top_Level_Statement::Expression_Data;
-        std::string_view full_view = view;
-
-        std::vector<Expression_Data::pointer> stack;
-        Expression_Data::pointer curr;
-        Expression_Data root {};
-
-        const auto push_node = [&root, &curr, this](auto node) -> void {
-            if (root.root->args.size() == 0) {
-                root.root->args.push_back(node);
-                curr = node;
-                return;
-            }
-            if (node->kind != Expression_Data::kind::Operator) {
-                curr->args.push_back(node);
-                return;
+            _frames.push_back(Frame { .op = nullptr });
+            bool operand = true;
+
+            while (true) {
+                const Frame &frame = *_frames.rbegin();
+                const Token &token = _tokens[_pos];
+
+                if (operand) {
+                    operand = false;
+
+                    if (is_open(token)) {
+                        open(nullptr, 0);
+                        operand = true;
+                        continue;
+                    }
+
+                    if (token.kind == Token::Name || is_literal(token)) {
+                        auto node = make_node(token);
+                        _operands.push_back(node);
+                        _pos++;
+
+                        if (token.kind == Token::Name) operand = read_arguments(node, _args.size());
+                        continue;
+                    }
+
+                    if (is_operator(token, frame) && ((_operands.size() == frame.operands
+                        && _pending.size() == frame.pending) || is_prefix(_pos))) {
+                        _pending.push_back(Pending {
+                            make_node(Kind::Operator, token.text), nullptr,
+                            token.symbol->order, _operands.size()
+                        });
+                        _pos++;
+                        operand = true;
+                        continue;
+                    }
+                }
+
+                if (is_operator(token, frame)) {
+                    reduce(token.symbol->order, frame);
+
+                    pointer left = nullptr;
+                    if (_operands.size() > frame.operands) {
+                        left = *_operands.rbegin();
+                        _operands.pop_back();
+                    }
+
+                    _pending.push_back(Pending {
+                        make_node(Kind::Operator, token.text), left,
+                        token.symbol->order, _operands.size()
+                    });
+                    _pos++;
+                    operand = true;
+                    continue;
+                }
+
+                reduce(0, frame);
+
+                pointer expr = nullptr;
+                if (_operands.size() > frame.operands) {
+                    expr = *_operands.rbegin();
+                    _operands.pop_back();
+                }
+
+                if (frame.op == nullptr) {
+                    if (token.kind != Token::End) throw Unexpected_Call(error_help(_full_view, token.text));
+                    return wrap(expr);
+                }
+
+                operand = end_part(expr);
             }
+        }
 
-            auto prev = root.root;
-            curr = root.root->args[0];
-            while (curr->kind == Expression_Data::kind::Operator
-                   && this->get_operator(curr->name).order < this->get_operator(node->name).order) {
+        bool Expression_Parser::end_part(pointer expr) {
+            Frame &frame = *_frames.rbegin();
+            const Bound_Operator &op = *frame.op;
+            const Token &token = _tokens[_pos];
 
-                if (curr->args.size() == 0) {
-                    prev = curr;
-                    curr = NULL;
+            if (frame.from == op.nodes.size()) {
+                if (!expr) throw Expected_Bound_Operator_Node_Expr(std::string(frame.prev), error_help(_full_view, token.text));
+
+                _args.push_back(wrap(expr));
+                return close();
+            }
+
+            size_t matched = frame.from;
+            while (matched < op.nodes.size() && (token.kind != Token::Special || op.nodes[matched].name != token.text)) {
+                if (op.nodes[matched].variant != Bound_Operator::Multiple) {
+                    matched = op.nodes.size();
                     break;
                 }
+                matched++;
+            }
+
+            if (matched == op.nodes.size()) {
+                size_t expected = frame.from;
+                while (op.nodes[expected].variant == Bound_Operator::Multiple) expected++;
 
-                prev = curr;
-                curr = *curr->args.rbegin();
+                throw Expected_Bound_Operator_Node(op.nodes[expected].name, std::string(frame.open),
+                                                   error_help(_full_view, token.text));
             }
 
-            if (curr == NULL) {
-                prev->args.push_back(node);
-            } else {
-                *prev->args.rbegin() = node;
-                node->args.push_back(curr);
+            const auto variant = op.nodes[matched].variant;
+
+            if (!expr && !(frame.prev.data() == frame.open.data() && variant == Bound_Operator::Close)) {
+                throw Expected_Bound_Operator_Node_Expr(std::string(frame.prev), error_help(_full_view, token.text));
             }
-            curr = node;
-        };
 
+            _args.push_back(wrap(expr));
+            _args.push_back(make_node(Kind::Name, token.text));
+            _pos++;
 
-        while (view.size() > 0 && view[0] != ';') {
-            view = trim_left(view); 
+            if (variant == Bound_Operator::Close) return close();
 
-            auto bop_views = read_bound_operator(view);
-            if (bop_views.size() > 0) {
-                auto node = Expression_Data::make_pointer(
-                    Expression_Data::kind::Bound_Operator, 
-                    bop_views[0]
-                );
-                view = { bop_views[0].end(), view.end() };
+            frame.prev = token.text;
+            frame.from = variant == Bound_Operator::Multiple ? matched : matched + 1;
+            return true;
+        }
+    }
 
+    Top_Level_Statement::Expression_Data Syntax_Tree::parse_call(std::string_view view) {
+        return { Expression_Parser { *this }.parse(view) };
+    }
 
-                bool is_expr = true;
-                for (auto expr : std::span(bop_views.begin()+1, bop_views.size()-1)) {
-                    if (is_expr) {
-                        node->args.push_back( parse_call(expr).root  );
-                    } else {
-                        node->args.push_back(Expression_Data::make_pointer(
-                            Expression_Data::kind::Name,
-                            expr
-                        ));
-                    }
-					is_expr = !is_expr;
-                    view = { expr.end(), view.end() };
-                }
+    static Top_Level_Statement parse_stmt(Syntax_Tree &tree, Expression_Parser &parser, std::string_view stmt) {
+        switch (tree.read_variant(stmt)) {
+        case Top_Level_Statement::Table_Define: return { tree.parse_table(stmt) };
+        case Top_Level_Statement::Domain_Define: return { tree.parse_domain(stmt) };
+        case Top_Level_Statement::Call: return { Top_Level_Statement::Expression_Data { parser.parse(stmt) } };
+        case Top_Level_Statement::Explain:
+            return { Top_Level_Statement::Explain, { parser.parse(stmt.substr(sizeof("explain") - 1)) } };
+        case Top_Level_Statement::Explain_Analyze: {
+            const std::string_view query = trim_left(stmt.substr(sizeof("explain") - 1)).substr(sizeof("analyze") - 1);
+            return { Top_Level_Statement::Explain_Analyze, { parser.parse(query) } };
+        }
+        case Top_Level_Statement::Analyze:
+            return { Top_Level_Statement::Analyze, { parser.parse(stmt.substr(sizeof("analyze") - 1)) } };
 
+        case Top_Level_Statement::Function_Define:
+        case Top_Level_Statement::None:
+        default:
+            throw Parsing_Exception("Unimplemented statement type");
+        }
+    }
 
-                push_node(node); 
-                view = trim_left(view);
-                continue;
-            }
+    /**
+     * Parse all statements of the view to the `stmts`.
+     **/
+    static void parse_stmts(Syntax_Tree &tree, Expression_Parser &parser, std::string_view code,
+                            std::vector<Top_Level_Statement> &stmts) {
+        while (true) {
+            std::string_view stmt = read_stmt(code);
+            if (stmt.size() == 0) break;
 
-            auto [literal, kind] = read_literal(view);
-            if (kind != Expression_Data::kind::Err) {
-                push_node( Expression_Data::make_pointer(kind, literal) );
-                view = { literal.end(), view.end() };
-                continue;
+            stmts.push_back(parse_stmt(tree, parser, stmt));
+
+            code = { stmt.end(), code.end() };
+        }
+    }
+
+    std::unique_ptr<Syntax_Tree> Syntax_Tree::parse(const std::string &source) {
+        auto tree = std::make_unique<Syntax_Tree>();
+        Expression_Parser parser { *tree };
+
+        tree->content = source;
+
+        parse_stmts(*tree, parser, tree->content, tree->stmts);
+
+        return tree;
+    }
+
+    std::unique_ptr<Syntax_Tree> Syntax_Tree::parse(const std::string &source, interact::Thread_Pool &pool) {
+        // Several chunks per thread, so threads that got simple statements
+        // steal the rest.
+        const size_t chunk_size = std::max((size_t)256 << 10, source.size() / (pool.size() * 4) + 1);
+        if (pool.size() == 1 || source.size() < 2 * chunk_size) return parse(source);
+
+        auto tree = std::make_unique<Syntax_Tree>();
+        tree->content = source;
+
+        const std::string_view code = tree->content;
+
+        std::vector<std::string_view> chunks;
+        for (size_t begin = 0; begin < code.size();) {
+            size_t end = begin;
+            while (end < code.size() && end - begin < chunk_size) {
+                const size_t stmt_end = find_stmt_end(code.substr(end));
+                end = stmt_end == std::string_view::npos ? code.size() : end + stmt_end + 1;
             }
 
+            chunks.push_back(code.substr(begin, end - begin));
+            begin = end;
+        }
+
+        struct Chunk {
+            std::vector<Top_Level_Statement> stmts;
+            Arena arena;
+            std::exception_ptr error;
+        };
+        std::vector<Chunk> parsed(chunks.size());
+
+        std::vector<interact::Thread_Pool::Task> tasks;
+        for (size_t i = 0; i < chunks.size(); i++) {
+            tasks.push_back([&tree, &chunks, &parsed, i] (size_t) {
+                Expression_Parser parser { *tree, parsed[i].arena };
+
+                try {
+                    parse_stmts(*tree, parser, chunks[i], parsed[i].stmts);
+                } catch (...) {
+                    parsed[i].error = std::current_exception();
+                }
+            });
+        }
+
+        pool.run(tasks);
+
+        size_t count = 0;
+        for (auto &chunk: parsed) {
+            if (chunk.error) std::rethrow_exception(chunk.error);
+            count += chunk.stmts.size();
+        }
+
+        tree->stmts.reserve(count);
+        for (auto &chunk: parsed) {
+            for (auto &stmt: chunk.stmts) tree->stmts.push_back(std::move(stmt));
+            tree->arena.absorb(std::move(chunk.arena));
+        }
+
+        return tree;
+    }
+
+    size_t Syntax_Tree::parse_stream(int fd, const Stmt_Callback &callback, const Stmt_Filter &filter) {
+        Syntax_Tree tree { };
+        Expression_Parser parser { tree };
+
+        std::vector<char> buffer((size_t)1 << 20);
+        size_t begin = 0, end = 0, count = 0;
+        bool eof = false;
 
-            auto op = read_operator(view);
-            if (op.size() > 0) {
-                push_node( Expression_Data::make_pointer(Expression_Data::kind::Operator, op) );
-                view = { op.end(), view.end() };
+        while (true) {
+            std::string_view view = trim_left({ buffer.data() + begin, end - begin });
+            begin = view.data() - buffer.data();
+
+            const size_t stmt_end = find_stmt_end(view);
+
+            if (stmt_end == std::string_view::npos && !eof) {
+                std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+                end -= begin;
+                begin = 0;
+
+                if (end == buffer.size()) buffer.resize(buffer.size() * 2);
+
+                ssize_t readed = read(fd, buffer.data() + end, buffer.size() - end);
+                if (readed < 0) {
+                    if (errno == EINTR) continue;
+                    throw Script_Read_Failed(std::strerror(errno));
+                }
+
+                eof = readed == 0;
+                end += readed;
                 continue;
             }
 
-            auto name = read_name(view);
-            if (name.size() > 0) {
-                push_node( Expression_Data::make_pointer(Expression_Data::kind::Name, name) );
-                view = { name.end(), view.end() };
-                continue;
+            if (view.empty()) return count;
+
+            std::string_view stmt = view.substr(0, stmt_end == std::string_view::npos ? view.size() : stmt_end + 1);
+
+            if (!filter || !filter(stmt)) {
+                callback(parse_stmt(tree, parser, stmt));
+                tree.arena.reset();
             }
+            count++;
 
-            view = trim_left(view); 
-            if (view.size() != 0 && view[0] != ';')
-                throw Unexpected_Call(error_help(full_view, { view.begin(), view.begin() })); 
+            begin = stmt.end() - buffer.data();
         }
-
-        return { root };
     }
 
-    std::unique_ptr<Syntax_Tree> Syntax_Tree::parse(const std::string &source) {
-        auto tree = std::make_unique<Syntax_Tree>(Syntax_Tree {});
+    size_t Syntax_Tree::parse_file(const std::string &path, const Stmt_Callback &callback,
+                                   const Stmt_Filter &filter) {
+        struct File {
+            int fd;
+            ~File() { if (fd >= 0) close(fd); }
+        } file { open(path.c_str(), O_RDONLY) };
 
-        tree->content = source;
+        if (file.fd < 0) throw Script_Read_Failed(path + ": " + std::strerror(errno));
 
-        std::string_view code = {tree->content.begin(), tree->content.end()};
+        struct stat info;
+        if (fstat(file.fd, &info) < 0) throw Script_Read_Failed(path + ": " + std::strerror(errno));
 
-        while (code.size() >= 0) {
-            std::string_view stmt = read_stmt(code);
-            if (stmt.size() == 0) break;
+        const size_t size = info.st_size;
+        if (size == 0) return 0;
 
-            switch (tree->read_variant(stmt)) {
-            case Top_Level_Statement::Table_Define: {
-                tree->stmts.push_back(Top_Level_Statement { tree->parse_table(stmt) });
-            } break;
+        struct Mapping {
+            void *data;
+            size_t size;
+            ~Mapping() { if (data != MAP_FAILED) munmap(data, size); }
+        } mapping { mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.fd, 0), size };
 
-            case Top_Level_Statement::Domain_Define: {
-                tree->stmts.push_back(Top_Level_Statement { tree->parse_domain(stmt) });
-            } break;
+        if (mapping.data == MAP_FAILED) throw Script_Read_Failed(path + ": " + std::strerror(errno));
+        madvise(mapping.data, size, MADV_SEQUENTIAL);
 
-            case Top_Level_Statement::Call: {
-                tree->stmts.push_back(Top_Level_Statement { tree->parse_call(stmt) });
-            } break;
+        Syntax_Tree tree { };
+        Expression_Parser parser { tree };
 
-            case Top_Level_Statement::Function_Define:
+        const char *data = (const char*)mapping.data;
+        std::string_view code { data, size };
 
+        // Pages of parsed statements are dropped by chunks of this size.
+        const size_t release_size = (size_t)8 << 20;
+        size_t released = 0, count = 0;
 
-            case Top_Level_Statement::None:
-                throw Parsing_Exception("Unimplemented statement type");
+        while (true) {
+            std::string_view stmt = read_stmt(code);
+            if (stmt.size() == 0) return count;
 
+            if (!filter || !filter(stmt)) {
+                callback(parse_stmt(tree, parser, stmt));
+                tree.arena.reset();
             }
+            count++;
 
             code = { stmt.end(), code.end() };
-        }
 
-        return tree;
+            const size_t parsed = stmt.end() - data;
+            if (parsed - released >= release_size) {
+                const size_t page = sysconf(_SC_PAGESIZE);
+                const size_t until = parsed / page * page;
+
+                madvise((char*)mapping.data + released, until - released, MADV_DONTNEED);
+                released = until;
+            }
+        }
     }
 }
@@ -1,10 +1,15 @@
 #ifndef parser_hpp_INCLUDED
 #define parser_hpp_INCLUDED
 
+#include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <common.hpp>
+#include <arena.hpp>
+#include <lexer.hpp>
+#include <thread_pool.hpp>
 /**
  * file = [stmt|\n+]
  * 
@@ -92,6 +97,37 @@ namespace toad_db::parser {
              */
             Call,
 
+            /**
+             * # Plan of the query.
+             * Query is not executed, the plan after the optimization
+             * is shown instead (@see interact::plan::Planner):
+             *    explain (@Users * @Groups ?=> gk == uk)<name, title>;
+             *
+             * Uses `call_data` with the query without `explain`.
+             */
+            Explain,
+
+            /**
+             * # Profile of the query.
+             * Query is executed by the plan and the rows, time and memory
+             * of every operator are shown instead of the result:
+             *    explain analyze (@Users * @Groups ?=> gk == uk)<name, title>;
+             *
+             * Uses `call_data` with the query without `explain analyze`.
+             */
+            Explain_Analyze,
+
+            /**
+             * # Statistics of the tables.
+             * Statistics used by the planner are rebuilt from all rows
+             * of the table, or of all tables without the name:
+             *    analyze Users;
+             *    analyze;
+             *
+             * Uses `call_data` with the name of the table (or empty).
+             */
+            Analyze,
+
             /**
              * For type save error handling.
              * :)
@@ -198,8 +234,11 @@ namespace toad_db::parser {
             struct Expression_Node {
                 /**
                  * pointer to the node.
+                 *
+                 * Nodes are allocated in the arena of the Syntax_Tree
+                 * and live as long as the tree.
                  */
-                using pointer = std::shared_ptr<Expression_Node>; 
+                using pointer = Expression_Node*;
 
 
                 /**
@@ -246,19 +285,20 @@ namespace toad_db::parser {
 
                 /**
                  * The args applyed to the function or operator [to the name].
+                 * Span is in the same arena as the node.
                  */
-                std::vector<pointer> args;
+                std::span<pointer> args;
 
                 /**
                  * Build node with no arguments.
                  */
                 Expression_Node(Kind kind, std::string_view name):
-                    kind(kind), name(name), args({}) {}
+                    kind(kind), name(name), args() {}
 
                 /**
                  * Build node with provided arguments.
                  */
-                Expression_Node(Kind kind, std::string_view name, std::vector<pointer> args):
+                Expression_Node(Kind kind, std::string_view name, std::span<pointer> args):
                     kind(kind), name(name), args(args) {}
             };
 
@@ -269,46 +309,17 @@ namespace toad_db::parser {
             using pointer = Expression_Node::pointer;
 
             /**
-             * Node's pointer constructor.
-             */
-            template<typename... _Args>
-            static pointer make_pointer(_Args... args) {
-                return std::make_shared<Expression_Node>(Expression_Node(args...));
-            }
-
-
-			/*
-            static pointer most_right(pointer node) {
-                if (node->args.size() == 0) return node;
-                return most_right(*node->args.rbegin());
-            }
-            */
-
-            /**
-             * The root of expression tree.
+             * The root of expression tree, it's always `Expression` node.
+             * nullptr only for default constructed data.
              */
-            pointer root; 
+            pointer root = nullptr;
 
-            /**
-             * Construct empty expression tree.
-             */
-            Expression_Data() {
-                root = make_pointer(
-                    kind::Expression, 
-                    std::string_view { }
-                );
-            }
+            Expression_Data() = default;
 
             /**
-             * Construct expression tree from root element.
+             * Construct expression tree from `Expression` root node.
              */
-            Expression_Data(pointer ptr) {
-                root = make_pointer(
-                    kind::Expression, 
-                    std::string_view{ ptr->name.begin(), ptr->name.begin() },
-                    std::vector{ ptr }
-                );
-            }
+            Expression_Data(pointer root): root(root) {}
         };
 
         /**
@@ -334,6 +345,9 @@ namespace toad_db::parser {
             case Table_Define: std::construct_at(&table_data, v.table_data); break;
             case Domain_Define: std::construct_at(&domain_data, v.domain_data); break; 
             case Function_Define:
+            case Explain:
+            case Explain_Analyze:
+            case Analyze:
             case Call: std::construct_at(&call_data, v.call_data); break; 
             case None:
             }
@@ -342,11 +356,14 @@ namespace toad_db::parser {
         /**
          * Move constructor.
          */
-        Top_Level_Statement(const Top_Level_Statement&& v): variant(v.variant) {
+        Top_Level_Statement(Top_Level_Statement&& v) noexcept: variant(v.variant) {
             switch (v.variant) {
             case Table_Define: std::construct_at(&table_data, std::move(v.table_data)); break;
             case Domain_Define: std::construct_at(&domain_data, std::move(v.domain_data)); break; 
             case Function_Define:
+            case Explain:
+            case Explain_Analyze:
+            case Analyze:
             case Call: std::construct_at(&call_data, std::move(v.call_data)); break;
             case None:
             }
@@ -355,21 +372,28 @@ namespace toad_db::parser {
         /**
          * Construct statement from Table_Data [would be Table_Define variant].
          */
-        Top_Level_Statement(const Table_Data &data): variant(Table_Define) {
-            std::construct_at(&table_data, data);
+        Top_Level_Statement(Table_Data data): variant(Table_Define) {
+            std::construct_at(&table_data, std::move(data));
         }
 
         /**
          * Construct statement from Domain_Data [would be Domain_Define variant].
          */
-        Top_Level_Statement(const Domain_Data &data): variant(Domain_Define) {
-            std::construct_at(&domain_data, data);
+        Top_Level_Statement(Domain_Data data): variant(Domain_Define) {
+            std::construct_at(&domain_data, std::move(data));
         }
 
         /**
          * Construct statement from Expression_Data [would be Call variant].
          */
-        Top_Level_Statement(const Expression_Data &data): variant(Call) {
+        Top_Level_Statement(Expression_Data data): variant(Call) {
+            std::construct_at(&call_data, data);
+        }
+
+        /**
+         * Construct statement from Expression_Data of the given variant (Call, Explain, Explain_Analyze or Analyze).
+         */
+        Top_Level_Statement(Variant variant, Expression_Data data): variant(variant) {
             std::construct_at(&call_data, data);
         }
 
@@ -381,6 +405,9 @@ namespace toad_db::parser {
             case Table_Define: table_data.~Table_Data(); break;
             case Domain_Define: domain_data.~Domain_Data(); break;
             case Function_Define:
+            case Explain:
+            case Explain_Analyze:
+            case Analyze:
             case Call: call_data.~Expression_Data(); break;
             case None:
             }
@@ -394,18 +421,26 @@ namespace toad_db::parser {
         std::string content;
         std::vector<Top_Level_Statement> stmts;
 
+        /**
+         * Nodes of the expressions of all statements (including ones
+         * returned by `parse_call`), freed with the tree.
+         **/
+        Arena arena;
+
         struct Operator {
             std::string name;
             size_t order;
         };
 
         std::vector<Operator> operators = {
-            { "with", 5 },
-            { "==", 1 }, { "!=", 1 }, { "<=", 1 }, { ">=", 1 }, { ":=", 0 },
-            { "**", 5 }, { "as", 5 },
-            { "@", 6 },
-            { "+", 3 }, { "-", 3 }, { "*", 4 }, { "/", 4 }, { "^", 5 }, { "=", 0 },
-            { ">", 1}, { "<", 1 }, 
+            { "with", 7 },
+            { "==", 3 }, { "!=", 3 }, { "<=", 3 }, { ">=", 3 }, { ":=", 0 },
+            { "&&", 2 }, { "||", 1 },
+            { "**", 7 }, { "as", 7 },
+            { "@", 8 },
+            { "+", 5 }, { "-", 5 }, { "*", 6 }, { "/", 6 }, { "^", 7 }, { "=", 0 },
+            { ">", 3}, { "<", 3 }, 
+            { "<<", 0 }, { ":", 0 }, { "?=>", 0 },
         };
 
         struct Bound_Operator {
@@ -429,27 +464,87 @@ namespace toad_db::parser {
             {{{"{", Bound_Operator::Once}, {",", Bound_Operator::Multiple}, {"}", Bound_Operator::Close}}},
         };
 
+        /**
+         * Symbols of `operators` and `bound_operators` for the lexer,
+         * so changes of the lists after construction are not visible.
+         **/
+        Symbol_Table symbols = make_symbols(operators, bound_operators);
+
+        static Symbol_Table make_symbols(const std::vector<Operator> &operators,
+                                         const std::vector<Bound_Operator> &bound_operators);
+
         Top_Level_Statement::Variant read_variant(std::string_view stmt);
 
         Top_Level_Statement::Table_Data parse_table(std::string_view view);
 
         Top_Level_Statement::Domain_Data parse_domain(std::string_view view);
 
+        /**
+         * Parse the expression by the Pratt parser over the tokens.
+         * Operators with the same order are left associative, operator
+         * without right operand gets only one argument: `Table@`.
+         * Names followed by operands are function calls: `(N:'f' (N:'a') (L:'1'))`.
+         *
+         * @throws Unexpected_Call if there are tokens after the expression.
+         * @throws Expected_Bound_Operator_Node if bound operator is not closed.
+         **/
         Top_Level_Statement::Expression_Data parse_call(std::string_view view);
 
         static std::unique_ptr<Syntax_Tree> parse(const std::string &source);
 
-        private:
-            std::pair<std::string_view, Top_Level_Statement::Expression_Data::kind>
-                read_literal(std::string_view view);
+        /**
+         * Parse the script by the threads of the pool.
+         *
+         * Script is split to chunks at the ends of the statements (`;` in
+         * literals are skipped, like by `read_stmt`), chunks are parsed
+         * concurrently, each to it's own arena, and statements are stitched
+         * back in the order of the script. So the tree is the same as of
+         * `parse(source)` and executes in the same order. Small scripts are
+         * parsed by the calling thread.
+         *
+         * @throws the error of the first failed statement of the script.
+         **/
+        static std::unique_ptr<Syntax_Tree> parse(const std::string &source, interact::Thread_Pool &pool);
 
-            std::string_view read_operator(std::string_view view);
+        /**
+         * Callback of the streaming parser. The statement and it's views
+         * to the source are valid only during the call.
+         **/
+        using Stmt_Callback = std::function<void (const Top_Level_Statement &stmt)>;
 
-            Operator get_operator(std::string_view view);
+        /**
+         * Hook on the raw text of the statement before parsing, statement
+         * is taken by the hook (not parsed and not passed to the callback)
+         * if it returns true. @see Bulk_Loader.
+         **/
+        using Stmt_Filter = std::function<bool (std::string_view stmt)>;
 
-            std::string_view read_node(std::string_view view, const Bound_Operator &op, size_t &idx);
+        /**
+         * Parse the script statement by statement while reading it from
+         * the file descriptor (file, pipe, socket):
+         *
+         * ```cpp
+         * Syntax_Tree::parse_stream(STDIN_FILENO, [&](auto &stmt) { execute(stmt); });
+         * ```
+         *
+         * Only the current statement is kept in memory, so memory doesn't
+         * depend on the script size, only on the size of the biggest statement.
+         *
+         * @return count of statements (taken by the filter too).
+         * @throws Script_Read_Failed if `read` fails.
+         **/
+        static size_t parse_stream(int fd, const Stmt_Callback &callback,
+                                   const Stmt_Filter &filter = { }) noexcept(false);
 
-            std::vector<std::string_view> read_bound_operator(std::string_view view);
+        /**
+         * Same as `parse_stream`, but file is mapped to the memory and
+         * statements are parsed in place. Pages of the parsed statements
+         * are released while parsing.
+         *
+         * @throws Script_Read_Failed if file can't be opened or mapped.
+         **/
+        static size_t parse_file(const std::string &path, const Stmt_Callback &callback,
+                                 const Stmt_Filter &filter = { }) noexcept(false);
     };
 
 
@@ -460,12 +555,27 @@ namespace toad_db::parser {
 
     std::string_view read_until(std::string_view str, char sep='\n');
 
+    /**
+     * Read statement till `;` (included), `;` in literals are skipped.
+     **/
     std::string_view read_stmt(std::string_view str);
 
+    /**
+     * Idx of `;` that ends the first statement of the view.
+     *
+     * @return idx or `std::string_view::npos` if statement is not finished.
+     **/
+    size_t find_stmt_end(std::string_view str);
+
 	std::string_view read_name(std::string_view str);
 
 	bool is_name_char(char c);
 
+    /**
+     * Lines of the view with `error` part underlined.
+     **/
+    std::string error_help(std::string_view full_view, std::string_view error);
+
     Top_Level_Statement::Table_Data parse_table(std::string_view view);
 
 
@@ -615,6 +725,21 @@ namespace toad_db::parser {
                 "But get:\n" + help_error
             ) {}
     };
+
+    class Expected_Bound_Operator_Node: public Parsing_Exception {
+        public:
+            Expected_Bound_Operator_Node(std::string node_name, std::string open_name, std::string help_error):
+                Parsing_Exception(
+                    "Expected `" + node_name + "` of operator `" + open_name + "`;\n"
+                    "But get:\n" + help_error
+                ) {}
+    };
+
+    class Script_Read_Failed: public Toad_Exception {
+        public:
+            Script_Read_Failed(const std::string &why):
+                Toad_Exception("Failed to read script: " + why) {}
+    };
 }
 
 #endif // parser_hpp_INCLUDED
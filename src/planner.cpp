@@ -0,0 +1,1846 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iterator>
+#include <planner.hpp>
+#include <sstream>
+#include <vectorized.hpp>
+
+namespace toad_db::interact::plan {
+    using namespace types;
+    using Kind = Expression_Node::Kind;
+
+    std::string to_string(Node::Kind kind) {
+        switch (kind) {
+        case Node::Scan:    return "Scan";
+        case Node::Filter:  return "Filter";
+        case Node::Project: return "Project";
+        case Node::Rename:  return "Rename";
+        case Node::Product: return "Product";
+        case Node::Join:    return "Join";
+        }
+        return "";
+    }
+
+    static size_t order_of(std::string_view op) {
+        static const parser::Syntax_Tree tree { };
+
+        for (auto &operator_: tree.operators) {
+            if (operator_.name == op) return operator_.order;
+        }
+        return 0;
+    }
+
+    std::string to_string(const Expression_Node *node) {
+        switch (node->kind) {
+        case Kind::Expression:
+            return node->args.size() == 1 ? to_string(node->args[0]) : "";
+
+        case Kind::Operator: {
+            if (node->args.size() == 1) return std::string(node->name) + to_string(node->args[0]);
+
+            const auto operand = [node] (const Expression_Node *arg) {
+                const bool lower = arg->kind == Kind::Operator && arg->args.size() == 2
+                                   && order_of(arg->name) < order_of(node->name);
+                return lower ? "(" + to_string(arg) + ")" : to_string(arg);
+            };
+            return operand(node->args[0]) + " " + std::string(node->name) + " " + operand(node->args[1]);
+        }
+
+        case Kind::Bound_Operator: {
+            std::string ret { node->name };
+            for (auto arg: node->args) {
+                if (arg->kind != Kind::Name) ret += to_string(arg);
+                else if (arg->name == ",") ret += ", ";
+                else if (parser::is_name_char(arg->name[0])) ret += " " + std::string(arg->name) + " ";
+                else ret += arg->name;
+            }
+            return ret;
+        }
+
+        default: {
+            std::string ret { node->name };
+            for (auto arg: node->args) ret += " " + to_string(arg);
+            return ret;
+        }
+        }
+    }
+
+    namespace {
+        using Names = std::vector<std::string>;
+
+        bool contains(const Names &names, std::string_view name) {
+            return std::find(names.begin(), names.end(), name) != names.end();
+        }
+
+        std::ptrdiff_t find_column(const std::vector<Column> &schema, std::string_view name) {
+            for (size_t i = 0; i < schema.size(); i++) {
+                if (schema[i].name == name) return i;
+            }
+            return -1;
+        }
+
+        /**
+         * Columns are the keys of the hash join: values are compared byte by
+         * byte, so codes only of the same dictionary.
+         **/
+        bool same_keys(const Column &left, const Column &right) {
+            return Domain::is_competible(*left.domain, *right.domain) && left.domain->size_of() == right.domain->size_of()
+                && left.dictionary == right.dictionary;
+        }
+
+        Names names_of(const std::vector<Column> &schema) {
+            Names ret;
+            for (auto &column: schema) ret.push_back(column.name);
+            return ret;
+        }
+
+        /**
+         * Name that refers to the column: not a function, parameter or bool constant.
+         **/
+        bool is_column_ref(const Expression_Node *node) {
+            return node->kind == Kind::Name && node->args.empty() && !node->name.starts_with("$")
+                && node->name != "true" && node->name != "false";
+        }
+
+        /**
+         * Calls `fn` for all column references of the predicate. Names
+         * inside bound operators are their nodes (`,` `)`), not references.
+         **/
+        template<typename Fn>
+        void for_each_ref(const Expression_Node *node, Fn &&fn) {
+            if (is_column_ref(node)) return fn(node->name);
+
+            for (auto arg: node->args) {
+                if (node->kind == Kind::Bound_Operator && arg->kind == Kind::Name) continue;
+                for_each_ref(arg, fn);
+            }
+        }
+
+        Names refs_of(const std::vector<Expression_Node::pointer> &predicates) {
+            Names ret;
+            for (auto predicate: predicates) {
+                for_each_ref(predicate, [&ret] (std::string_view name) {
+                    if (!contains(ret, name)) ret.emplace_back(name);
+                });
+            }
+            return ret;
+        }
+
+        bool refers_only(const Expression_Node *predicate, const std::vector<Column> &schema) {
+            bool ret = true;
+            for_each_ref(predicate, [&] (std::string_view name) { ret = ret && find_column(schema, name) >= 0; });
+            return ret;
+        }
+
+        const Expression_Node* unwrap(const Expression_Node *node) {
+            if (node->kind == Kind::Expression && node->args.size() == 1) return unwrap(node->args[0]);
+            if (node->kind == Kind::Bound_Operator && node->name == "(" && node->args.size() == 2)
+                return unwrap(node->args[0]);
+
+            return node;
+        }
+
+        std::string_view store(Arena &arena, std::string_view str) {
+            auto chars = arena.copy<char>(std::span<const char> { str.data(), str.size() });
+            return { chars.data(), chars.size() };
+        }
+
+        /**
+         * Copy of the predicate in the arena, column references are renamed by `rename`.
+         **/
+        template<typename Rename>
+        Expression_Node::pointer copy(Arena &arena, const Expression_Node *node, Rename &&rename) {
+            std::vector<Expression_Node::pointer> args;
+            for (auto arg: node->args) {
+                if (node->kind == Kind::Bound_Operator && arg->kind == Kind::Name) {
+                    args.push_back(arena.make<Expression_Node>(arg->kind, store(arena, arg->name)));
+                } else {
+                    args.push_back(copy(arena, arg, rename));
+                }
+            }
+
+            const std::string_view name = is_column_ref(node) ? rename(node->name) : node->name;
+            return arena.make<Expression_Node>(node->kind, store(arena, name),
+                                               arena.copy<Expression_Node::pointer>(args));
+        }
+
+        Expression_Node::pointer copy(Arena &arena, const Expression_Node *node) {
+            return copy(arena, node, [] (std::string_view name) { return name; });
+        }
+
+        /**
+         * Conjuncts of the predicate: `a && (b && c)` is `a`, `b`, `c`.
+         **/
+        void split(Expression_Node::pointer node, std::vector<Expression_Node::pointer> &out) {
+            const Expression_Node *unwrapped = unwrap(node);
+
+            if (unwrapped->kind == Kind::Operator && unwrapped->name == "&&" && unwrapped->args.size() == 2) {
+                split(unwrapped->args[0], out);
+                split(unwrapped->args[1], out);
+                return;
+            }
+
+            out.push_back(node);
+        }
+
+        void check_unique(const std::vector<Column> &schema) {
+            for (size_t i = 0; i < schema.size(); i++) {
+                if (find_column(schema, schema[i].name) != (std::ptrdiff_t)i)
+                    throw Planner::Ambiguous_Column(schema[i].name);
+            }
+        }
+
+        const Column& column_of(const std::vector<Column> &schema, std::string_view name) {
+            const auto idx = find_column(schema, name);
+            if (idx < 0) throw Planner::Unknown_Column(name);
+
+            return schema[idx];
+        }
+
+        void update_schema(Node &node) {
+            std::vector<Column> schema;
+
+            switch (node.kind) {
+            case Node::Scan:
+                for (auto column: node.columns) {
+                    auto &field = node.table->columns()[column];
+                    schema.push_back({ field.name, field.domain, field.dictionary });
+                }
+                break;
+
+            case Node::Filter:
+                schema = node.inputs[0]->schema;
+                for (auto &name: refs_of(node.predicates)) column_of(schema, name);
+                break;
+
+            case Node::Project:
+                for (auto &name: node.names) schema.push_back(column_of(node.inputs[0]->schema, name));
+                break;
+
+            case Node::Rename:
+                schema = node.inputs[0]->schema;
+                for (auto &[from, to]: node.renames) {
+                    auto idx = find_column(node.inputs[0]->schema, from);
+                    if (idx < 0) throw Planner::Unknown_Column(from);
+
+                    schema[idx].name = to;
+                }
+                break;
+
+            case Node::Join:
+                column_of(node.inputs[0]->schema, node.left_key);
+                column_of(node.inputs[1]->schema, node.right_key);
+                [[fallthrough]];
+
+            case Node::Product:
+                schema = node.inputs[0]->schema;
+                schema.insert(schema.end(), node.inputs[1]->schema.begin(), node.inputs[1]->schema.end());
+                break;
+            }
+
+            check_unique(schema);
+            node.schema = std::move(schema);
+        }
+
+        Node::pointer make_node(Node::Kind kind, Node::pointer input) {
+            auto node = std::make_unique<Node>(kind);
+            node->inputs.push_back(std::move(input));
+            return node;
+        }
+
+        Node::pointer make_project(Node::pointer input, Names names) {
+            auto node = make_node(Node::Project, std::move(input));
+            node->names = std::move(names);
+            update_schema(*node);
+            return node;
+        }
+
+        Node::pointer make_filter(Node::pointer input, std::vector<Expression_Node::pointer> predicates) {
+            auto node = make_node(Node::Filter, std::move(input));
+            node->predicates = std::move(predicates);
+            update_schema(*node);
+            return node;
+        }
+
+        /**
+         * Translation of the query expression to the plan, as it's written.
+         **/
+        class Builder {
+            public:
+                Builder(const std::unordered_map<std::string, const Table*> &tables,
+                        std::unordered_map<std::string, Zone_Map> &zone_maps,
+                        std::unordered_map<std::string, Segment_Blooms> &blooms,
+                        std::unordered_map<std::string, compression::Compressed_Segments> &compressed, Arena &arena):
+                    _tables(tables), _zone_maps(zone_maps), _blooms(blooms), _compressed(compressed), _arena(arena) { }
+
+                Node::pointer build(const Expression_Node *node) {
+                    switch (node->kind) {
+                    case Kind::Expression:
+                        if (node->args.size() != 1) throw Planner::Unsupported_Query("empty expression");
+                        return build(node->args[0]);
+
+                    case Kind::Operator:
+                        if (node->name == "@" && node->args.size() == 1) return build(node->args[0]);
+
+                        if (node->name == "*" && node->args.size() == 2) {
+                            auto product = std::make_unique<Node>(Node::Product);
+                            product->inputs.push_back(build(node->args[0]));
+                            product->inputs.push_back(build(node->args[1]));
+                            update_schema(*product);
+                            return product;
+                        }
+
+                        if (node->name == "?=>" && node->args.size() == 2) {
+                            std::vector<Expression_Node::pointer> predicates;
+                            split(copy(_arena, node->args[1]), predicates);
+                            return make_filter(build(node->args[0]), std::move(predicates));
+                        }
+                        break;
+
+                    case Kind::Name: {
+                        auto table = _tables.find(std::string(node->name));
+                        if (table == _tables.end()) throw Planner::Unknown_Table(node->name);
+
+                        auto scan = std::make_unique<Node>(Node::Scan);
+                        scan->table_name = node->name;
+                        scan->table = table->second;
+                        scan->zones = &_zone_maps.at(table->first);
+                        scan->blooms = &_blooms.at(table->first);
+                        if (auto compressed = _compressed.find(table->first); compressed != _compressed.end())
+                            scan->compressed = &compressed->second;
+                        for (size_t i = 0; i < scan->table->columns().size(); i++) scan->columns.push_back(i);
+                        update_schema(*scan);
+
+                        return postfix(std::move(scan), node->args);
+                    }
+
+                    case Kind::Bound_Operator:
+                        // `(query)` and then projections and renames.
+                        if (node->name == "(" && node->args.size() >= 2 && node->args[1]->name == ")")
+                            return postfix(build(node->args[0]), node->args.subspan(2));
+                        break;
+
+                    default:
+                        break;
+                    }
+
+                    throw Planner::Unsupported_Query("`" + to_string(node) + "` is not a table");
+                }
+
+            private:
+                const std::unordered_map<std::string, const Table*> &_tables;
+                std::unordered_map<std::string, Zone_Map> &_zone_maps;
+                std::unordered_map<std::string, Segment_Blooms> &_blooms;
+                std::unordered_map<std::string, compression::Compressed_Segments> &_compressed;
+                Arena &_arena;
+
+                static std::vector<const Expression_Node*> items_of(const Expression_Node *list) {
+                    std::vector<const Expression_Node*> ret;
+                    for (auto arg: list->args) {
+                        if (arg->kind == Kind::Expression) ret.push_back(unwrap(arg));
+                    }
+                    return ret;
+                }
+
+                Node::pointer postfix(Node::pointer input, std::span<Expression_Node::pointer> args) {
+                    for (auto arg: args) {
+                        if (arg->kind != Kind::Bound_Operator || (arg->name != "<" && arg->name != "{"))
+                            throw Planner::Unsupported_Query("`" + to_string(arg) + "` after the table");
+
+                        input = arg->name == "<" ? project(std::move(input), arg) : rename(std::move(input), arg);
+                    }
+                    return input;
+                }
+
+                Node::pointer project(Node::pointer input, const Expression_Node *list) {
+                    Names names;
+                    for (auto item: items_of(list)) names.emplace_back(item->name);
+
+                    return make_project(std::move(input), std::move(names));
+                }
+
+                /**
+                 * `{a, b}` renames all columns by position, `{x: a}` only the given ones.
+                 **/
+                Node::pointer rename(Node::pointer input, const Expression_Node *list) {
+                    auto node = make_node(Node::Rename, std::move(input));
+                    const auto &schema = node->inputs[0]->schema;
+                    const auto items = items_of(list);
+
+                    const bool by_position = std::all_of(items.begin(), items.end(), is_column_ref);
+                    if (by_position && items.size() != schema.size()) {
+                        throw Planner::Unsupported_Query("`" + to_string(list) + "` must name all "
+                                                         + std::to_string(schema.size()) + " columns");
+                    }
+
+                    for (size_t i = 0; i < items.size(); i++) {
+                        if (by_position) {
+                            if (schema[i].name != items[i]->name)
+                                node->renames.emplace_back(schema[i].name, items[i]->name);
+                            continue;
+                        }
+
+                        const Expression_Node *item = items[i];
+                        if (item->kind != Kind::Operator || item->name != ":" || item->args.size() != 2
+                            || !is_column_ref(unwrap(item->args[0])) || !is_column_ref(unwrap(item->args[1])))
+                            throw Planner::Unsupported_Query("`" + to_string(item) + "` in rename");
+
+                        node->renames.emplace_back(unwrap(item->args[0])->name, unwrap(item->args[1])->name);
+                    }
+
+                    update_schema(*node);
+                    return node;
+                }
+        };
+
+        /**
+         * Cardinalities and selectivities estimated by the statistics of the
+         * tables. Values of the different columns are assumed independent.
+         **/
+        class Estimator {
+            public:
+                /**
+                 * Selectivity of the predicates that can't be estimated.
+                 **/
+                static constexpr double Default_Selectivity = 1.0 / 3;
+
+                struct Column_Estimate {
+                    double distinct;
+
+                    /**
+                     * Statistics of the column of the table, nullptr if unknown.
+                     **/
+                    const Column_Statistics *statistics;
+                };
+
+                explicit Estimator(const Planner &planner): _planner(planner) { }
+
+                /**
+                 * Estimate `.estimated_rows` of the node and of all its inputs.
+                 **/
+                double rows(Node &node) {
+                    for (auto &input: node.inputs) rows(*input);
+
+                    switch (node.kind) {
+                    case Node::Scan:
+                        node.estimated_rows = _planner.statistics(node.table_name).rows();
+                        break;
+
+                    case Node::Filter: {
+                        const Node &input = *node.inputs[0];
+
+                        node.estimated_rows = input.estimated_rows;
+                        for (auto predicate: node.predicates) {
+                            node.estimated_rows *= selectivity(predicate, [&] (std::string_view name) {
+                                return column(input, name);
+                            });
+                        }
+                    } break;
+
+                    case Node::Project:
+                    case Node::Rename:
+                        node.estimated_rows = node.inputs[0]->estimated_rows;
+                        break;
+
+                    case Node::Product:
+                        node.estimated_rows = node.inputs[0]->estimated_rows * node.inputs[1]->estimated_rows;
+                        break;
+
+                    case Node::Join:
+                        node.estimated_rows = node.inputs[0]->estimated_rows * node.inputs[1]->estimated_rows
+                                              / std::max({ column(*node.inputs[0], node.left_key).distinct,
+                                                           column(*node.inputs[1], node.right_key).distinct, 1.0 });
+                        break;
+                    }
+
+                    return node.estimated_rows;
+                }
+
+                /**
+                 * Column of the estimated node, traced down to the scanned table.
+                 **/
+                Column_Estimate column(const Node &node, std::string_view name) const {
+                    const double rows = std::max(node.estimated_rows, 1.0);
+
+                    const Node *curr = &node;
+                    std::string origin { name };
+
+                    while (curr->kind != Node::Scan) {
+                        if (curr->kind == Node::Rename) {
+                            auto rename = std::find_if(curr->renames.begin(), curr->renames.end(),
+                                                       [&origin] (auto &rename) { return rename.second == origin; });
+                            if (rename != curr->renames.end()) origin = rename->first;
+                        }
+
+                        const bool right = curr->inputs.size() == 2 && find_column(curr->inputs[0]->schema, origin) < 0;
+                        curr = curr->inputs[right].get();
+                    }
+
+                    const auto idx = find_column(curr->schema, origin);
+                    if (idx < 0) return { rows, nullptr };
+
+                    const auto &statistics = _planner.statistics(curr->table_name).column(curr->columns[idx]);
+                    return { std::clamp(statistics.distinct_count(), 1.0, rows), &statistics };
+                }
+
+                /**
+                 * Fraction of the rows for which the predicate is true.
+                 *
+                 * @param column - `Column_Estimate (std::string_view name)` of the referenced columns.
+                 **/
+                template<typename Column_Of>
+                static double selectivity(const Expression_Node *predicate, Column_Of &&column) {
+                    predicate = unwrap(predicate);
+                    if (predicate->kind != Kind::Operator || predicate->args.size() != 2) return Default_Selectivity;
+
+                    if (predicate->name == "&&" || predicate->name == "||") {
+                        const double lhs = selectivity(predicate->args[0], column);
+                        const double rhs = selectivity(predicate->args[1], column);
+                        return predicate->name == "&&" ? lhs * rhs : lhs + rhs - lhs * rhs;
+                    }
+
+                    vectorized::Compare compare;
+                    if (!to_compare(predicate->name, compare)) return Default_Selectivity;
+
+                    const Expression_Node *lhs = unwrap(predicate->args[0]), *rhs = unwrap(predicate->args[1]);
+                    if (!is_column_ref(lhs)) {
+                        std::swap(lhs, rhs);
+                        compare = vectorized::flip(compare);
+                    }
+                    if (!is_column_ref(lhs)) return Default_Selectivity;
+
+                    const Column_Estimate estimate = column(lhs->name);
+
+                    double equal;
+                    if (is_column_ref(rhs)) equal = 1 / std::max(estimate.distinct, column(rhs->name).distinct);
+                    else if (rhs->kind >= Kind::Str_Literal && rhs->kind <= Kind::Num_Literal) equal = 1 / estimate.distinct;
+                    else return Default_Selectivity;
+
+                    if (compare == vectorized::Compare::Eq) return equal;
+                    if (compare == vectorized::Compare::Ne) return 1 - equal;
+
+                    // Ranges are estimated only for the numbers by the histogram.
+                    if (rhs->kind != Kind::Num_Literal || !estimate.statistics || estimate.statistics->histogram.empty())
+                        return Default_Selectivity;
+
+                    const Histogram &histogram = estimate.statistics->histogram;
+                    const double value = std::strtod(std::string(rhs->name).c_str(), nullptr);
+
+                    // Histogram is of the numbers, NaNs are out of every range.
+                    const double numbers = (double)estimate.statistics->numbers
+                                         / (double)(estimate.statistics->numbers + estimate.statistics->nans);
+
+                    switch (compare) {
+                    case vectorized::Compare::Lt: return numbers * histogram.fraction_below(value, false);
+                    case vectorized::Compare::Le: return numbers * histogram.fraction_below(value, true);
+                    case vectorized::Compare::Gt: return numbers * (1 - histogram.fraction_below(value, true));
+                    case vectorized::Compare::Ge: return numbers * (1 - histogram.fraction_below(value, false));
+                    default:                      return Default_Selectivity;
+                    }
+                }
+
+            private:
+                const Planner &_planner;
+
+                static bool to_compare(std::string_view op, vectorized::Compare &out) {
+                    static const std::pair<std::string_view, vectorized::Compare> compares[] = {
+                        { "==", vectorized::Compare::Eq }, { "!=", vectorized::Compare::Ne },
+                        { "<",  vectorized::Compare::Lt }, { "<=", vectorized::Compare::Le },
+                        { ">",  vectorized::Compare::Gt }, { ">=", vectorized::Compare::Ge },
+                    };
+
+                    for (auto &[name, compare]: compares) {
+                        if (name == op) {
+                            out = compare;
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+        };
+
+        /**
+         * # Join order by dynamic programming.
+         *
+         * Inputs of the joins and products of one region and all their
+         * predicates are collected, then the cheapest plan of every subset
+         * of the inputs is made of the cheapest plans of its two parts, so
+         * all bushy trees are enumerated in `O(3^n)`. Cost of the plan is the
+         * count of rows of all its joins (before the rest of predicates are
+         * applied) and hash tables.
+         * Parts without the join predicate between them are combined only
+         * if there is no other way.
+         **/
+        class Join_Order {
+            public:
+                Join_Order(Estimator &estimator, std::vector<Node::pointer> inputs,
+                           const std::vector<Expression_Node::pointer> &predicates):
+                    _inputs(std::move(inputs)) {
+
+                    for (auto &input: _inputs) estimator.rows(*input);
+
+                    for (auto node: predicates) {
+                        Predicate predicate { node };
+                        for_each_ref(node, [&] (std::string_view name) { predicate.mask |= mask_of(name); });
+
+                        predicate.selectivity = Estimator::selectivity(node, [&] (std::string_view name) {
+                            const auto idx = input_of(name);
+                            return idx < 0 ? Estimator::Column_Estimate { 1, nullptr }
+                                           : estimator.column(*_inputs[idx], name);
+                        });
+
+                        equality_of(predicate);
+                        _predicates.push_back(predicate);
+                    }
+                }
+
+                /**
+                 * Cheapest plan of all inputs.
+                 **/
+                Node::pointer best(void) {
+                    const U64 all = ((U64)1 << _inputs.size()) - 1;
+                    _plans.assign(all + 1, Plan { });
+
+                    for (U64 set = 1; set <= all; set++) {
+                        Plan &plan = _plans[set];
+
+                        plan.rows = 1;
+                        for (size_t i = 0; i < _inputs.size(); i++) {
+                            if (set >> i & 1) plan.rows *= _inputs[i]->estimated_rows;
+                        }
+                        for (auto &predicate: _predicates) {
+                            if (predicate.mask != 0 && (predicate.mask & ~set) == 0) plan.rows *= predicate.selectivity;
+                        }
+
+                        if ((set & (set - 1)) != 0 && !choose(set, true)) choose(set, false);
+                    }
+
+                    auto ret = make(all);
+
+                    std::vector<Expression_Node::pointer> constants;
+                    for (auto &predicate: _predicates) {
+                        if (predicate.mask == 0) constants.push_back(predicate.node);
+                    }
+
+                    return constants.empty() ? std::move(ret) : make_filter(std::move(ret), std::move(constants));
+                }
+
+            private:
+                struct Predicate {
+                    Expression_Node::pointer node;
+
+                    /**
+                     * Inputs the predicate refers to.
+                     **/
+                    U64 mask = 0;
+                    double selectivity = 1;
+
+                    /**
+                     * `x == y` of the columns of two inputs of the compatible
+                     * domains: inputs of `x` and `y` and their names.
+                     **/
+                    bool equality = false;
+                    size_t left = 0, right = 0;
+                    std::string_view left_name, right_name;
+                };
+
+                struct Plan {
+                    double rows = 0, cost = 0;
+
+                    /**
+                     * Inputs of the left part, 0 for a single input.
+                     **/
+                    U64 left = 0;
+                };
+
+                std::vector<Node::pointer> _inputs;
+                std::vector<Predicate> _predicates;
+                std::vector<Plan> _plans;
+
+                std::ptrdiff_t input_of(std::string_view name) const {
+                    for (size_t i = 0; i < _inputs.size(); i++) {
+                        if (find_column(_inputs[i]->schema, name) >= 0) return i;
+                    }
+                    return -1;
+                }
+
+                U64 mask_of(std::string_view name) const {
+                    const auto idx = input_of(name);
+                    return idx < 0 ? 0 : (U64)1 << idx;
+                }
+
+                void equality_of(Predicate &predicate) const {
+                    const Expression_Node *node = unwrap(predicate.node);
+                    if (node->kind != Kind::Operator || node->name != "==" || node->args.size() != 2) return;
+
+                    const Expression_Node *lhs = unwrap(node->args[0]), *rhs = unwrap(node->args[1]);
+                    if (!is_column_ref(lhs) || !is_column_ref(rhs)) return;
+
+                    const auto left = input_of(lhs->name), right = input_of(rhs->name);
+                    if (left < 0 || right < 0 || left == right) return;
+
+                    const Column &left_column = column_of(_inputs[left]->schema, lhs->name);
+                    const Column &right_column = column_of(_inputs[right]->schema, rhs->name);
+                    if (!same_keys(left_column, right_column)) return;
+
+                    predicate.equality = true;
+                    predicate.left = left;
+                    predicate.right = right;
+                    predicate.left_name = lhs->name;
+                    predicate.right_name = rhs->name;
+                }
+
+                static bool joins(const Predicate &predicate, U64 left, U64 right) {
+                    if (!predicate.equality) return false;
+
+                    const U64 lhs = (U64)1 << predicate.left, rhs = (U64)1 << predicate.right;
+                    return ((lhs & left) && (rhs & right)) || ((lhs & right) && (rhs & left));
+                }
+
+                /**
+                 * Choose the cheapest split of the set to two parts.
+                 *
+                 * @param connected - only the parts joined by a predicate.
+                 * @return false if there is no such split.
+                 **/
+                bool choose(U64 set, bool connected) {
+                    Plan &plan = _plans[set];
+                    const U64 lowest = set & (~set + 1);
+
+                    // Parts are symmetric, so the left one takes the lowest input.
+                    for (U64 left = (set - 1) & set; left != 0; left = (left - 1) & set) {
+                        if ((left & lowest) == 0) continue;
+                        const U64 right = set ^ left;
+
+                        // Only one equality is the key of the join, others filter its result.
+                        double key = 1;
+                        bool joined = false;
+                        for (auto &predicate: _predicates) {
+                            if (!joins(predicate, left, right)) continue;
+
+                            key = std::min(key, predicate.selectivity);
+                            joined = true;
+                        }
+                        if (connected && !joined) continue;
+
+                        const Plan &lhs = _plans[left], &rhs = _plans[right];
+                        const double cost = lhs.cost + rhs.cost + lhs.rows * rhs.rows * key + std::min(lhs.rows, rhs.rows);
+
+                        if (plan.left == 0 || cost < plan.cost) {
+                            plan.cost = cost;
+                            plan.left = left;
+                        }
+                    }
+
+                    return plan.left != 0;
+                }
+
+                /**
+                 * Plan of the set. Predicate is placed at the smallest set with
+                 * all its inputs: the most selective equality of the parts becomes
+                 * the key of the join, others filter the result of it.
+                 **/
+                Node::pointer make(U64 set) {
+                    const U64 left = _plans[set].left, right = set ^ left;
+
+                    std::vector<const Predicate*> predicates;
+                    for (auto &predicate: _predicates) {
+                        const bool here = predicate.mask != 0 && (predicate.mask & ~set) == 0
+                                          && (left == 0 || ((predicate.mask & ~left) != 0 && (predicate.mask & ~right) != 0));
+                        if (here) predicates.push_back(&predicate);
+                    }
+
+                    Node::pointer node;
+                    if (left == 0) {
+                        node = std::move(_inputs[std::countr_zero(set)]);
+                    } else {
+                        node = std::make_unique<Node>(Node::Product);
+                        node->inputs.push_back(make(left));
+                        node->inputs.push_back(make(right));
+
+                        const Predicate *key = nullptr;
+                        for (auto predicate: predicates) {
+                            if (joins(*predicate, left, right) && (!key || predicate->selectivity < key->selectivity))
+                                key = predicate;
+                        }
+
+                        if (key) {
+                            const bool swapped = (left >> key->left & 1) == 0;
+
+                            node->kind = Node::Join;
+                            node->left_key = swapped ? key->right_name : key->left_name;
+                            node->right_key = swapped ? key->left_name : key->right_name;
+                            std::erase(predicates, key);
+                        }
+
+                        update_schema(*node);
+                    }
+
+                    if (predicates.empty()) return node;
+
+                    std::vector<Expression_Node::pointer> nodes;
+                    for (auto predicate: predicates) nodes.push_back(predicate->node);
+                    return make_filter(std::move(node), std::move(nodes));
+                }
+        };
+
+        /**
+         * Predicate `lhs == rhs` of two columns.
+         **/
+        Expression_Node::pointer make_equality(Arena &arena, std::string_view lhs, std::string_view rhs) {
+            Expression_Node::pointer args[] = {
+                arena.make<Expression_Node>(Kind::Name, store(arena, lhs)),
+                arena.make<Expression_Node>(Kind::Name, store(arena, rhs)),
+            };
+            return arena.make<Expression_Node>(Kind::Operator, "==", arena.copy<Expression_Node::pointer>(args));
+        }
+
+        /**
+         * Rules of the rewriting, @see plan.
+         **/
+        class Optimizer {
+            public:
+                Optimizer(Arena &arena, Estimator &estimator, bool reorder_joins):
+                    _arena(arena), _estimator(estimator), _reorder_joins(reorder_joins) { }
+
+                void optimize(Node::pointer &root) {
+                    const Names names = names_of(root->schema);
+
+                    push_filters(root, { });
+                    if (_reorder_joins) reorder(root);
+                    merge(root);
+                    prune(root, names);
+                    merge(root);
+
+                    if (names_of(root->schema) != names) root = make_project(std::move(root), names);
+
+                    _estimator.rows(*root);
+                    build_sides(*root);
+                }
+
+            private:
+                Arena &_arena;
+                Estimator &_estimator;
+                bool _reorder_joins;
+
+                /**
+                 * Push the predicates (of the filters above) down the node.
+                 **/
+                void push_filters(Node::pointer &node, std::vector<Expression_Node::pointer> predicates) {
+                    switch (node->kind) {
+                    case Node::Filter:
+                        predicates.insert(predicates.end(), node->predicates.begin(), node->predicates.end());
+                        node = std::move(node->inputs[0]);
+                        return push_filters(node, std::move(predicates));
+
+                    case Node::Project:
+                        return push_filters(node->inputs[0], std::move(predicates));
+
+                    case Node::Rename:
+                        for (auto &predicate: predicates) {
+                            predicate = copy(_arena, predicate, [&node] (std::string_view name) {
+                                for (auto &[from, to]: node->renames) {
+                                    if (to == name) return std::string_view { from };
+                                }
+                                return name;
+                            });
+                        }
+                        return push_filters(node->inputs[0], std::move(predicates));
+
+                    case Node::Product:
+                    case Node::Join: {
+                        std::vector<Expression_Node::pointer> left, right, rest;
+
+                        for (auto predicate: predicates) {
+                            if (refers_only(predicate, node->inputs[0]->schema)) left.push_back(predicate);
+                            else if (refers_only(predicate, node->inputs[1]->schema)) right.push_back(predicate);
+                            else if (node->kind == Node::Product && to_join(*node, predicate)) continue;
+                            else rest.push_back(predicate);
+                        }
+
+                        push_filters(node->inputs[0], std::move(left));
+                        push_filters(node->inputs[1], std::move(right));
+                        update_schema(*node);
+
+                        if (!rest.empty()) node = make_filter(std::move(node), std::move(rest));
+                        return;
+                    }
+
+                    case Node::Scan:
+                        if (!predicates.empty()) node = make_filter(std::move(node), std::move(predicates));
+                        return;
+                    }
+                }
+
+                /**
+                 * Turn the product to the join if predicate is `x == y` for `x`
+                 * and `y` of the different sides with the same domain.
+                 **/
+                static bool to_join(Node &product, const Expression_Node *predicate) {
+                    predicate = unwrap(predicate);
+                    if (predicate->kind != Kind::Operator || predicate->name != "==" || predicate->args.size() != 2)
+                        return false;
+
+                    const Expression_Node *lhs = unwrap(predicate->args[0]), *rhs = unwrap(predicate->args[1]);
+                    if (!is_column_ref(lhs) || !is_column_ref(rhs)) return false;
+
+                    const auto &left = product.inputs[0]->schema, &right = product.inputs[1]->schema;
+                    if (find_column(left, lhs->name) < 0) std::swap(lhs, rhs);
+
+                    const auto left_idx = find_column(left, lhs->name), right_idx = find_column(right, rhs->name);
+                    if (left_idx < 0 || right_idx < 0) return false;
+
+                    if (!same_keys(left[left_idx], right[right_idx])) return false;
+
+                    product.kind = Node::Join;
+                    product.left_key = lhs->name;
+                    product.right_key = rhs->name;
+                    return true;
+                }
+
+                /**
+                 * Joins and products with the filters between them, their
+                 * inputs are reordered together.
+                 **/
+                static bool is_region(const Node &node) {
+                    if (node.kind == Node::Filter) return node.inputs[0]->kind == Node::Product || node.inputs[0]->kind == Node::Join;
+                    return node.kind == Node::Product || node.kind == Node::Join;
+                }
+
+                static size_t inputs_of(const Node &node) {
+                    if (!is_region(node)) return 1;
+                    if (node.kind == Node::Filter) return inputs_of(*node.inputs[0]);
+
+                    return inputs_of(*node.inputs[0]) + inputs_of(*node.inputs[1]);
+                }
+
+                /**
+                 * Inputs and predicates of the region, keys of the joins become `x == y`.
+                 **/
+                void collect(Node::pointer node, std::vector<Node::pointer> &inputs,
+                             std::vector<Expression_Node::pointer> &predicates) {
+                    if (!is_region(*node)) {
+                        inputs.push_back(std::move(node));
+                        return;
+                    }
+
+                    if (node->kind == Node::Filter) {
+                        predicates.insert(predicates.end(), node->predicates.begin(), node->predicates.end());
+                        return collect(std::move(node->inputs[0]), inputs, predicates);
+                    }
+
+                    if (node->kind == Node::Join) predicates.push_back(make_equality(_arena, node->left_key, node->right_key));
+
+                    collect(std::move(node->inputs[0]), inputs, predicates);
+                    collect(std::move(node->inputs[1]), inputs, predicates);
+                }
+
+                /**
+                 * Order the joins of three and more inputs by the cost (@see Join_Order).
+                 **/
+                void reorder(Node::pointer &node) {
+                    const size_t count = inputs_of(*node);
+
+                    if (count < 3 || count > Planner::Max_Reordered_Inputs) {
+                        for (auto &input: node->inputs) reorder(input);
+                        if (!node->inputs.empty()) update_schema(*node);
+                        return;
+                    }
+
+                    std::vector<Node::pointer> inputs;
+                    std::vector<Expression_Node::pointer> predicates;
+                    collect(std::move(node), inputs, predicates);
+
+                    for (auto &input: inputs) reorder(input);
+                    node = Join_Order { _estimator, std::move(inputs), predicates }.best();
+                }
+
+                /**
+                 * Hash tables of the joins are built on the smaller estimated input.
+                 **/
+                static void build_sides(Node &node) {
+                    for (auto &input: node.inputs) build_sides(*input);
+
+                    if (node.kind == Node::Join) node.build_left = node.inputs[0]->estimated_rows <= node.inputs[1]->estimated_rows;
+                }
+
+                /**
+                 * Merge projections and renames bottom up.
+                 **/
+                void merge(Node::pointer &node) {
+                    for (auto &input: node->inputs) merge(input);
+
+                    while (merge_top(node));
+                }
+
+                /**
+                 * @return true if the node was rewritten.
+                 **/
+                bool merge_top(Node::pointer &node) {
+                    if (node->kind == Node::Rename) {
+                        Node &input = *node->inputs[0];
+
+                        std::erase_if(node->renames, [] (auto &rename) { return rename.first == rename.second; });
+                        if (node->renames.empty()) {
+                            node = std::move(node->inputs[0]);
+                            return true;
+                        }
+
+                        if (input.kind != Node::Rename) return false;
+
+                        // {a: b} then {b: c, x: y} is {a: c, x: y}.
+                        auto renames = std::move(input.renames);
+                        for (auto &[from, to]: node->renames) {
+                            auto inner = std::find_if(renames.begin(), renames.end(),
+                                                      [&from] (auto &rename) { return rename.second == from; });
+                            if (inner != renames.end()) inner->second = to;
+                            else renames.emplace_back(from, to);
+                        }
+
+                        node->renames = std::move(renames);
+                        node->inputs[0] = std::move(input.inputs[0]);
+                        update_schema(*node);
+                        return true;
+                    }
+
+                    if (node->kind != Node::Project) return false;
+                    Node &input = *node->inputs[0];
+
+                    if (names_of(input.schema) == node->names) {
+                        node = std::move(node->inputs[0]);
+                        return true;
+                    }
+
+                    switch (input.kind) {
+                    case Node::Project:
+                        node->inputs[0] = std::move(input.inputs[0]);
+                        update_schema(*node);
+                        return true;
+
+                    case Node::Scan: {
+                        std::vector<size_t> columns;
+                        for (auto &name: node->names) columns.push_back(input.columns[find_column(input.schema, name)]);
+
+                        input.columns = std::move(columns);
+                        update_schema(input);
+                        node = std::move(node->inputs[0]);
+                        return true;
+                    }
+
+                    case Node::Rename: {
+                        // Projection goes under the rename: <b> of {a: b} is {a: b} of <a>.
+                        Names names;
+                        std::vector<std::pair<std::string, std::string>> renames;
+
+                        for (auto &name: node->names) {
+                            auto rename = std::find_if(input.renames.begin(), input.renames.end(),
+                                                       [&name] (auto &rename) { return rename.second == name; });
+                            names.push_back(rename == input.renames.end() ? name : rename->first);
+                            if (rename != input.renames.end()) renames.push_back(*rename);
+                        }
+
+                        auto rename = make_node(Node::Rename, make_project(std::move(input.inputs[0]), std::move(names)));
+                        rename->renames = std::move(renames);
+                        update_schema(*rename);
+
+                        merge(rename->inputs[0]);
+                        node = std::move(rename);
+                        return true;
+                    }
+
+                    default:
+                        return false;
+                    }
+                }
+
+                /**
+                 * Leave only the columns needed above (`required`) and by the
+                 * filters and joins. Filter gets projection above it, if it
+                 * needs more columns than the operators above.
+                 **/
+                void prune(Node::pointer &node, const Names &required) {
+                    switch (node->kind) {
+                    case Node::Scan: {
+                        std::vector<size_t> columns;
+                        for (size_t i = 0; i < node->columns.size(); i++) {
+                            if (contains(required, node->schema[i].name)) columns.push_back(node->columns[i]);
+                        }
+
+                        // Count of rows is kept by at least one column.
+                        if (columns.empty()) columns.push_back(node->columns[0]);
+                        node->columns = std::move(columns);
+                    } break;
+
+                    case Node::Filter: {
+                        Names needed = required;
+                        for (auto &name: refs_of(node->predicates)) {
+                            if (!contains(needed, name)) needed.push_back(name);
+                        }
+
+                        prune(node->inputs[0], needed);
+                        update_schema(*node);
+
+                        Names names;
+                        for (auto &column: node->schema) {
+                            if (contains(required, column.name)) names.push_back(column.name);
+                        }
+
+                        if (!names.empty() && names.size() < node->schema.size())
+                            node = make_project(std::move(node), std::move(names));
+                    } return;
+
+                    case Node::Project: {
+                        Names names;
+                        for (auto &name: node->names) {
+                            if (contains(required, name)) names.push_back(name);
+                        }
+
+                        node->names = names.empty() ? Names { node->names[0] } : std::move(names);
+                        prune(node->inputs[0], node->names);
+                    } break;
+
+                    case Node::Rename: {
+                        Names names;
+                        for (auto &column: node->inputs[0]->schema) {
+                            auto rename = std::find_if(node->renames.begin(), node->renames.end(),
+                                                       [&column] (auto &rename) { return rename.first == column.name; });
+                            const std::string &name = rename == node->renames.end() ? column.name : rename->second;
+                            if (contains(required, name)) names.push_back(column.name);
+                        }
+
+                        prune(node->inputs[0], names);
+                        std::erase_if(node->renames, [&] (auto &rename) {
+                            return find_column(node->inputs[0]->schema, rename.first) < 0;
+                        });
+                    } break;
+
+                    case Node::Product:
+                    case Node::Join:
+                        for (size_t side = 0; side < 2; side++) {
+                            const std::string &key = side == 0 ? node->left_key : node->right_key;
+
+                            Names names;
+                            for (auto &column: node->inputs[side]->schema) {
+                                if (contains(required, column.name) || column.name == key) names.push_back(column.name);
+                            }
+
+                            prune(node->inputs[side], names);
+                        }
+                        break;
+                    }
+
+                    update_schema(*node);
+                }
+        };
+
+        /**
+         * Operator of the node as one line: `Join uk == gk, build right`.
+         **/
+        std::string describe(const Node &node) {
+            std::string out = to_string(node.kind);
+
+            const auto list = [&out] (const char *open, const Names &names, const char *close) {
+                out += std::string(" ") + open;
+                for (size_t i = 0; i < names.size(); i++) out += (i ? ", " : "") + names[i];
+                out += close;
+            };
+
+            switch (node.kind) {
+            case Node::Scan:
+                out += " " + node.table_name;
+                list("<", names_of(node.schema), ">");
+                break;
+
+            case Node::Filter:
+                for (size_t i = 0; i < node.predicates.size(); i++)
+                    out += (i ? " && " : " ") + to_string(node.predicates[i]);
+                break;
+
+            case Node::Project:
+                list("<", node.names, ">");
+                break;
+
+            case Node::Rename: {
+                Names renames;
+                for (auto &[from, to]: node.renames) renames.push_back(from + ": " + to);
+                list("{", renames, "}");
+            } break;
+
+            case Node::Join:
+                out += " " + node.left_key + " == " + node.right_key + (node.build_left ? ", build left" : ", build right");
+                break;
+
+            case Node::Product:
+                break;
+            }
+
+            return out;
+        }
+
+        std::string estimate_of(double rows) {
+            return "~" + std::to_string((U64)std::llround(rows)) + " rows";
+        }
+
+        void explain(const Node &node, size_t depth, std::string &out) {
+            out += std::string(depth * 2, ' ') + describe(node);
+
+            if (node.estimated_rows >= 0) out += "  (" + estimate_of(node.estimated_rows) + ")";
+            out += "\n";
+            for (auto &input: node.inputs) explain(*input, depth + 1, out);
+        }
+
+        /**
+         * Wall time and CPU time of the process (all threads) since the construction.
+         **/
+        struct Timer {
+            std::chrono::steady_clock::time_point wall = std::chrono::steady_clock::now();
+            std::clock_t cpu = std::clock();
+
+            void stop(double &wall_ms, double &cpu_ms) const {
+                wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall).count();
+                cpu_ms = 1000.0 * (std::clock() - cpu) / CLOCKS_PER_SEC;
+            }
+        };
+
+        std::string ms_of(double ms) {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(3) << ms << " ms";
+            return out.str();
+        }
+
+        void profile_text(const Operator_Profile &profile, size_t depth, std::string &out) {
+            out += std::string(depth * 2, ' ') + profile.description + "  (";
+            if (profile.estimated_rows >= 0) out += estimate_of(profile.estimated_rows) + "; ";
+
+            out += std::to_string(profile.rows_in) + " -> " + std::to_string(profile.rows_out) + " rows, "
+                 + ms_of(profile.wall_ms) + ", cpu " + ms_of(profile.cpu_ms)
+                 + ", " + std::to_string(profile.bytes) + " bytes";
+
+            if (profile.hash_table_bytes) out += ", hash table " + std::to_string(profile.hash_table_bytes) + " bytes";
+            if (profile.blocks) {
+                out += ", skipped " + std::to_string(profile.skipped_blocks) + "/" + std::to_string(profile.blocks)
+                     + " blocks";
+            }
+            if (profile.bloom_blocks) {
+                out += ", bloom skipped " + std::to_string(profile.bloom_skipped_blocks) + "/"
+                     + std::to_string(profile.bloom_blocks) + " blocks, false positives "
+                     + std::to_string(profile.bloom_false_positives) + "/"
+                     + std::to_string(profile.bloom_blocks - profile.bloom_skipped_blocks);
+            }
+            if (profile.spilled_bytes) out += ", spilled " + std::to_string(profile.spilled_bytes) + " bytes";
+            out += ")\n";
+
+            for (auto &input: profile.inputs) profile_text(input, depth + 1, out);
+        }
+
+        std::string json_string(std::string_view str) {
+            std::string ret = "\"";
+            for (char c: str) {
+                if (c == '"' || c == '\\') {
+                    ret += '\\';
+                    ret += c;
+                } else if ((unsigned char)c < 0x20) {
+                    const char digits[] = "0123456789abcdef";
+                    ret += "\\u00";
+                    ret += digits[c >> 4];
+                    ret += digits[c & 0xF];
+                } else {
+                    ret += c;
+                }
+            }
+            return ret + "\"";
+        }
+
+        void profile_json(const Operator_Profile &profile, std::ostringstream &out) {
+            out << "{\"operator\": " << json_string(to_string(profile.kind))
+                << ", \"description\": " << json_string(profile.description)
+                << ", \"estimated_rows\": " << profile.estimated_rows
+                << ", \"rows_in\": " << profile.rows_in << ", \"rows_out\": " << profile.rows_out
+                << ", \"wall_ms\": " << profile.wall_ms << ", \"cpu_ms\": " << profile.cpu_ms
+                << ", \"total_wall_ms\": " << profile.total_wall_ms << ", \"total_cpu_ms\": " << profile.total_cpu_ms
+                << ", \"bytes\": " << profile.bytes << ", \"hash_table_bytes\": " << profile.hash_table_bytes
+                << ", \"spilled_bytes\": " << profile.spilled_bytes << ", \"blocks\": " << profile.blocks
+                << ", \"skipped_blocks\": " << profile.skipped_blocks << ", \"bloom_blocks\": " << profile.bloom_blocks
+                << ", \"bloom_skipped_blocks\": " << profile.bloom_skipped_blocks
+                << ", \"bloom_false_positives\": " << profile.bloom_false_positives << ", \"inputs\": [";
+
+            for (size_t i = 0; i < profile.inputs.size(); i++) {
+                if (i) out << ", ";
+                profile_json(profile.inputs[i], out);
+            }
+            out << "]}";
+        }
+
+        /**
+         * Rows of the executed operator: `.columns` of the `.rows` of the
+         * table. Scans, filters and projections only narrow the relation,
+         * tables are made only when rows of two inputs are combined.
+         **/
+        struct Relation {
+            std::unique_ptr<Table> owned;
+            const Table *table = nullptr;
+            std::vector<size_t> columns;
+
+            /**
+             * Idxs of the rows of the table, all rows if not `filtered`.
+             **/
+            bool filtered = false;
+            std::vector<size_t> rows;
+
+            /**
+             * Bytes of the owned table and the rows, charged to the memory of the query.
+             **/
+            Query_Memory::Reservation reservation;
+
+            size_t size(void) const { return filtered ? rows.size() : table->size(); }
+            size_t row(size_t idx) const { return filtered ? rows[idx] : idx; }
+        };
+
+        class Executor {
+            public:
+                /**
+                 * @param memory - memory the temporaries are charged to.
+                 * @param profile - measures of the operators, nullptr to not measure.
+                 **/
+                Executor(Engine &engine, Query_Memory &memory, Operator_Profile *profile = nullptr):
+                    _engine(engine), _memory(memory), _profile(profile), _arena(memory) { }
+
+                Relation run(const Node &node) {
+                    if (!_profile) return evaluate(node);
+
+                    Operator_Profile *parent = _current;
+                    Operator_Profile &profile = parent ? parent->inputs.emplace_back() : *_profile;
+
+                    profile.kind = node.kind;
+                    profile.description = describe(node);
+                    profile.estimated_rows = node.estimated_rows;
+                    profile.inputs.reserve(node.inputs.size());
+
+                    _current = &profile;
+                    const Timer timer { };
+                    Relation ret = evaluate(node);
+                    timer.stop(profile.total_wall_ms, profile.total_cpu_ms);
+                    _current = parent;
+
+                    profile.rows_out = ret.size();
+                    profile.wall_ms = profile.total_wall_ms;
+                    profile.cpu_ms = profile.total_cpu_ms;
+
+                    for (auto &input: profile.inputs) {
+                        profile.rows_in += input.rows_out;
+                        profile.wall_ms -= input.total_wall_ms;
+                        profile.cpu_ms -= input.total_cpu_ms;
+                    }
+
+                    // Clocks are not precise enough for the operators which only pass the relation.
+                    profile.wall_ms = std::max(profile.wall_ms, 0.0);
+                    profile.cpu_ms = std::max(profile.cpu_ms, 0.0);
+
+                    return ret;
+                }
+
+                /**
+                 * Relation as the table with the columns of the schema.
+                 **/
+                Table result(Relation relation, const std::vector<Column> &schema) {
+                    relation = exact(whole(std::move(relation), schema), schema);
+
+                    bool same = relation.owned && relation.columns.size() == relation.table->columns().size();
+                    for (size_t i = 0; same && i < relation.columns.size(); i++) same = relation.columns[i] == i;
+
+                    if (same) return std::move(*relation.owned);
+
+                    Query_Memory::Reservation reservation { _memory, 0 };
+                    return gather(schema, relation.size(), { { &relation, nullptr } }, reservation);
+                }
+
+            private:
+                Engine &_engine;
+                Query_Memory &_memory;
+
+                Operator_Profile *_profile;
+
+                /**
+                 * Profile of the running operator.
+                 **/
+                Operator_Profile *_current = nullptr;
+
+                /**
+                 * Predicates joined by `&&`.
+                 **/
+                Arena _arena;
+
+                void touched(size_t bytes) {
+                    if (_current) _current->bytes += bytes;
+                }
+
+                Relation evaluate(const Node &node) {
+                    switch (node.kind) {
+                    case Node::Scan:
+                        return Relation { nullptr, node.table, node.columns, false, { }, { _memory, 0 } };
+
+                    case Node::Filter: {
+                        Relation input = exact(run(*node.inputs[0]), node.inputs[0]->schema);
+
+                        Expression_Node::pointer predicate = node.predicates[0];
+                        for (size_t i = 1; i < node.predicates.size(); i++) {
+                            Expression_Node::pointer args[] = { predicate, node.predicates[i] };
+                            predicate = _arena.make<Expression_Node>(Kind::Operator, "&&",
+                                                                     _arena.copy<Expression_Node::pointer>(args));
+                        }
+
+                        size_t size = 0;
+                        for (auto &name: refs_of(node.predicates)) size += column_of(node.inputs[0]->schema, name).domain->size_of();
+
+                        // Blocks of the scanned table are skipped by its zone map and Bloom filters,
+                        // its sealed segments are read from the compressed columns.
+                        vectorized::Batch_Filter::Segments segments { };
+                        vectorized::Batch_Filter::Stats stats { };
+                        if (node.inputs[0]->kind == Node::Scan && node.inputs[0]->zones) {
+                            node.inputs[0]->zones->update();
+                            segments.zones = node.inputs[0]->zones;
+                        }
+                        if (node.inputs[0]->kind == Node::Scan && node.inputs[0]->blooms) {
+                            node.inputs[0]->blooms->update();
+                            segments.blooms = node.inputs[0]->blooms;
+                        }
+                        if (node.inputs[0]->kind == Node::Scan && node.inputs[0]->compressed) {
+                            node.inputs[0]->compressed->update();
+                            segments.compressed = node.inputs[0]->compressed;
+                        }
+
+                        auto rows = vectorized::Batch_Filter { *input.table, predicate, segments }.filter(_engine, { }, &stats);
+
+                        // Rows of the blocks known by the bounds aren't read.
+                        const size_t scanned = input.table->size();
+                        const size_t known = (stats.skipped_blocks + stats.whole_blocks) * Zone_Map::Block_Rows;
+                        touched((scanned - std::min(known, scanned)) * size);
+
+                        // Rows of the filtered input are selected by the filter too, both are ascending.
+                        if (input.filtered) {
+                            std::vector<size_t> selected;
+                            std::set_intersection(rows.begin(), rows.end(), input.rows.begin(), input.rows.end(),
+                                                  std::back_inserter(selected));
+                            rows = std::move(selected);
+                        }
+                        input.rows = std::move(rows);
+                        if (_current) {
+                            _current->blocks += stats.blocks;
+                            _current->skipped_blocks += stats.skipped_blocks;
+                            _current->bloom_blocks += stats.bloom_blocks;
+                            _current->bloom_skipped_blocks += stats.bloom_skipped_blocks;
+                            _current->bloom_false_positives += stats.bloom_false_positives;
+                        }
+                        input.filtered = true;
+                        input.reservation.add(input.rows.capacity() * sizeof(size_t));
+                        return input;
+                    }
+
+                    case Node::Project: {
+                        Relation input = run(*node.inputs[0]);
+
+                        std::vector<size_t> columns;
+                        for (auto &name: node.names)
+                            columns.push_back(input.columns[find_column(node.inputs[0]->schema, name)]);
+
+                        input.columns = std::move(columns);
+                        return input;
+                    }
+
+                    case Node::Rename:
+                        return run(*node.inputs[0]);
+
+                    case Node::Product: {
+                        Relation left = run(*node.inputs[0]), right = run(*node.inputs[1]);
+
+                        // Pairs are charged before they are made, so too big products fail early.
+                        size_t pairs = 0, bytes = 0;
+                        if (__builtin_mul_overflow(left.size(), right.size(), &pairs)
+                            || __builtin_mul_overflow(pairs, 2 * sizeof(size_t), &bytes))
+                            throw Query_Memory::Memory_Limit_Exceeded(Query_Memory::Unlimited, _memory.limit());
+
+                        auto reservation = _memory.reserve(bytes);
+
+                        std::vector<size_t> left_rows, right_rows;
+                        left_rows.reserve(left.size() * right.size());
+                        right_rows.reserve(left.size() * right.size());
+
+                        for (size_t l = 0; l < left.size(); l++) {
+                            for (size_t r = 0; r < right.size(); r++) {
+                                left_rows.push_back(l);
+                                right_rows.push_back(r);
+                            }
+                        }
+
+                        return combine(node.schema, left, left_rows, right, right_rows);
+                    }
+
+                    case Node::Join: {
+                        // Hash join takes all rows of the tables.
+                        Relation left = whole(run(*node.inputs[0]), node.inputs[0]->schema);
+                        Relation right = whole(run(*node.inputs[1]), node.inputs[1]->schema);
+
+                        const size_t left_key = left.columns[find_column(node.inputs[0]->schema, node.left_key)];
+                        const size_t right_key = right.columns[find_column(node.inputs[1]->schema, node.right_key)];
+
+                        touched((left.size() + right.size()) * column_of(node.inputs[0]->schema, node.left_key).domain->size_of());
+
+                        if (node.build_left) {
+                            auto skipped = skipped_segments(*node.inputs[1], right, right_key, left, left_key);
+                            auto table = charge_hash_table(left.size());
+                            auto pairs = _engine.hash_join(*left.table, left_key, *right.table, right_key, &skipped);
+                            auto reservation = charge(pairs);
+                            table.release();
+                            false_positives(skipped, pairs.probe);
+
+                            return combine(node.schema, left, pairs.build, right, pairs.probe);
+                        }
+
+                        auto skipped = skipped_segments(*node.inputs[0], left, left_key, right, right_key);
+                        auto table = charge_hash_table(right.size());
+                        auto pairs = _engine.hash_join(*right.table, right_key, *left.table, left_key, &skipped);
+                        auto reservation = charge(pairs);
+                        table.release();
+                        false_positives(skipped, pairs.probe);
+
+                        return combine(node.schema, left, pairs.probe, right, pairs.build);
+                    }
+                    }
+
+                    return { };
+                }
+
+                /**
+                 * Max count of the build keys checked by the Bloom filters of the
+                 * probe, filters of 1% false positives pass almost every segment for more.
+                 **/
+                static constexpr size_t Max_Bloom_Keys = 256;
+
+                /**
+                 * Segments of the scanned probe table without the keys of the small
+                 * build by the Bloom filters of the probe key.
+                 *
+                 * @return flags of the checked segments, empty if nothing is checked.
+                 **/
+                std::vector<bool> skipped_segments(const Node &probe_node, const Relation &probe, size_t probe_key,
+                                                   const Relation &build, size_t build_key) {
+                    const Node *scan = &probe_node;
+                    while (scan->kind == Node::Project || scan->kind == Node::Rename) scan = scan->inputs[0].get();
+
+                    if (scan->kind != Node::Scan || !scan->blooms || probe.owned || probe.filtered
+                        || probe.table != scan->table || build.size() > Max_Bloom_Keys)
+                        return { };
+
+                    Segment_Blooms &blooms = *scan->blooms;
+                    blooms.update();
+                    if (!blooms.has(probe_key)) return { };
+
+                    Domain &domain = *build.table->columns()[build_key].domain;
+                    const size_t offset = build.table->column_offset(build_key);
+
+                    std::vector<bool> ret(std::min(blooms.sealed(probe_key), probe.table->size() / Table::Segment_Rows), true);
+                    for (size_t segment = 0; segment < ret.size(); segment++) {
+                        for (size_t row = 0; row < build.size() && ret[segment]; row++) {
+                            auto key = Segment_Blooms::key_of(domain, build.table->row_data(row) + offset);
+                            ret[segment] = !blooms.may_contain(segment, probe_key, key);
+                        }
+                    }
+
+                    if (_current) {
+                        _current->bloom_blocks += ret.size();
+                        _current->bloom_skipped_blocks += std::count(ret.begin(), ret.end(), true);
+                    }
+                    return ret;
+                }
+
+                /**
+                 * Count probed segments without matched rows.
+                 *
+                 * @param probe - matched rows of the probe in ascending order.
+                 **/
+                void false_positives(const std::vector<bool> &skipped, const std::vector<size_t> &probe) {
+                    if (!_current) return;
+
+                    for (size_t segment = 0; segment < skipped.size(); segment++) {
+                        if (skipped[segment]) continue;
+
+                        const auto first = std::lower_bound(probe.begin(), probe.end(), segment * Table::Segment_Rows);
+                        _current->bloom_false_positives += first == probe.end() || *first >= (segment + 1) * Table::Segment_Rows;
+                    }
+                }
+
+                /**
+                 * Charge the hash table of the join before it's built, so too big
+                 * builds fail early. It's held until the pairs are charged.
+                 **/
+                Query_Memory::Reservation charge_hash_table(size_t build_rows) {
+                    if (_current) _current->hash_table_bytes = Engine::hash_table_bytes(build_rows);
+                    return _memory.reserve(Engine::hash_table_bytes(build_rows));
+                }
+
+                /**
+                 * Charge the pairs of the join.
+                 **/
+                Query_Memory::Reservation charge(const Engine::Join_Pairs &pairs) {
+                    return _memory.reserve((pairs.build.capacity() + pairs.probe.capacity()) * sizeof(size_t));
+                }
+
+                struct Side {
+                    const Relation *relation;
+
+                    /**
+                     * Idxs of the rows of the relation, for every row of the result.
+                     **/
+                    const std::vector<size_t> *rows;
+                };
+
+                /**
+                 * @param reservation - bytes of the new table are charged to it before it's filled.
+                 **/
+                Table gather(const std::vector<Column> &schema, size_t count, std::initializer_list<Side> sides,
+                             Query_Memory::Reservation &reservation) {
+                    std::vector<Table::Column_Field> fields;
+                    for (auto &column: schema) fields.push_back({ column.name, column.domain, column.dictionary });
+
+                    Table ret { fields };
+                    if (count == 0) return ret;
+
+                    reservation.add(count * ret.row_size());
+                    ret.append_rows(count);
+
+                    // Values are read and written once.
+                    touched(2 * count * ret.row_size());
+
+                    _engine.for_each_morsel(count, [&](size_t, size_t, Engine::Morsel morsel) {
+                        size_t out_column = 0;
+
+                        for (auto &side: sides) {
+                            const Relation &relation = *side.relation;
+
+                            for (auto column: relation.columns) {
+                                const size_t in_offset = relation.table->column_offset(column);
+                                const size_t out_offset = ret.column_offset(out_column++);
+                                const size_t size = schema[out_column - 1].domain->size_of();
+
+                                for (size_t i = morsel.begin; i < morsel.end; i++) {
+                                    const size_t row = relation.row(side.rows ? (*side.rows)[i] : i);
+                                    std::memcpy(ret.row_data(i) + out_offset,
+                                                relation.table->row_data(row) + in_offset, size);
+                                }
+                            }
+                        }
+                    });
+
+                    return ret;
+                }
+
+                Relation combine(const std::vector<Column> &schema,
+                                 const Relation &left, const std::vector<size_t> &left_rows,
+                                 const Relation &right, const std::vector<size_t> &right_rows) {
+                    Relation ret { .reservation = { _memory, 0 } };
+                    ret.owned = std::make_unique<Table>(gather(schema, left_rows.size(),
+                                                               { { &left, &left_rows }, { &right, &right_rows } },
+                                                               ret.reservation));
+                    ret.table = ret.owned.get();
+                    for (size_t i = 0; i < schema.size(); i++) ret.columns.push_back(i);
+
+                    return ret;
+                }
+
+                Relation materialize(Relation relation, const std::vector<Column> &schema) {
+                    Relation ret { .reservation = { _memory, 0 } };
+                    ret.owned = std::make_unique<Table>(gather(schema, relation.size(), { { &relation, nullptr } },
+                                                               ret.reservation));
+                    ret.table = ret.owned.get();
+                    for (size_t i = 0; i < schema.size(); i++) ret.columns.push_back(i);
+
+                    return ret;
+                }
+
+                /**
+                 * Relation with all rows of the table.
+                 **/
+                Relation whole(Relation relation, const std::vector<Column> &schema) {
+                    return relation.filtered ? materialize(std::move(relation), schema) : std::move(relation);
+                }
+
+                /**
+                 * Relation which columns in the table have the names of the
+                 * schema, so predicates can be compiled against the table.
+                 **/
+                Relation exact(Relation relation, const std::vector<Column> &schema) {
+                    for (size_t i = 0; i < schema.size(); i++) {
+                        if (relation.table->columns()[relation.columns[i]].name != schema[i].name)
+                            return materialize(std::move(relation), schema);
+                    }
+
+                    return relation;
+                }
+        };
+
+    }
+
+    std::string Query::explain(void) const {
+        std::string ret;
+        plan::explain(*_root, 0, ret);
+        return ret;
+    }
+
+    Table Query::execute(Engine &engine) const {
+        Query_Memory memory { _memory_limit };
+        return execute(engine, memory);
+    }
+
+    Table Query::execute(Engine &engine, Query_Memory &memory) const {
+        Executor executor { engine, memory };
+        return executor.result(executor.run(*_root), _root->schema);
+    }
+
+    Table Query::execute(Engine &engine, Profile &profile) const {
+        profile = Profile { };
+
+        Query_Memory memory { _memory_limit };
+        const Timer timer { };
+        Executor executor { engine, memory, &profile.root };
+        Table ret = executor.result(executor.run(*_root), _root->schema);
+        timer.stop(profile.wall_ms, profile.cpu_ms);
+
+        profile.peak_bytes = memory.peak_bytes();
+        profile.allocations = memory.allocations();
+
+        return ret;
+    }
+
+    std::string Profile::to_string(void) const {
+        std::string ret;
+        profile_text(root, 0, ret);
+        return ret + "Total: " + ms_of(wall_ms) + ", cpu " + ms_of(cpu_ms) + ", peak " + std::to_string(peak_bytes)
+                   + " bytes in " + std::to_string(allocations) + " allocations\n";
+    }
+
+    std::string Profile::to_json(void) const {
+        std::ostringstream out;
+        out << "{\"wall_ms\": " << wall_ms << ", \"cpu_ms\": " << cpu_ms << ", \"peak_bytes\": " << peak_bytes
+            << ", \"allocations\": " << allocations << ", \"root\": ";
+        profile_json(root, out);
+        out << "}";
+        return out.str();
+    }
+
+    void Planner::add_table(const std::string &name, const Table &table) {
+        _tables[name] = &table;
+        _statistics.insert_or_assign(name, Table_Statistics { table });
+        _zone_maps.insert_or_assign(name, Zone_Map { table });
+        _blooms.insert_or_assign(name, Segment_Blooms { table });
+        _compressed.erase(name);
+    }
+
+    void Planner::drop_table(const std::string &name) {
+        _tables.erase(name);
+        _statistics.erase(name);
+        _zone_maps.erase(name);
+        _blooms.erase(name);
+        _compressed.erase(name);
+    }
+
+    void Planner::add_bloom_filter(const std::string &table, const std::string &column, size_t bits_per_key) {
+        auto blooms = _blooms.find(table);
+        if (blooms == _blooms.end()) throw Unknown_Table(table);
+
+        const auto &columns = _tables.at(table)->columns();
+        auto field = std::find_if(columns.begin(), columns.end(), [&](auto &field) { return field.name == column; });
+        if (field == columns.end()) throw Unknown_Column(column);
+
+        blooms->second.add_column(field - columns.begin(), bits_per_key);
+    }
+
+    void Planner::add_compression(const std::string &table) {
+        auto entry = _tables.find(table);
+        if (entry == _tables.end()) throw Unknown_Table(table);
+
+        _compressed.try_emplace(table, *entry->second);
+    }
+
+    const Table_Statistics& Planner::statistics(const std::string &name) const {
+        auto statistics = _statistics.find(name);
+        if (statistics == _statistics.end()) throw Unknown_Table(name);
+
+        statistics->second.update();
+        return statistics->second;
+    }
+
+    void Planner::analyze_table(const std::string &name) {
+        auto statistics = _statistics.find(name);
+        if (statistics == _statistics.end()) throw Unknown_Table(name);
+
+        statistics->second.analyze();
+    }
+
+    void Planner::analyze(std::string_view stmt) {
+        auto tree = parser::Syntax_Tree::parse(std::string(stmt));
+
+        if (tree->stmts.size() != 1) throw parser::Parsing_Exception("Expected one analyze statement");
+
+        const auto &analyze = tree->stmts[0];
+        if (analyze.variant != parser::Top_Level_Statement::Analyze)
+            throw Unsupported_Query(parser::to_string(analyze.variant));
+
+        const Expression_Node *root = analyze.call_data.root;
+        if (root->kind == Kind::Expression && root->args.empty()) {
+            for (auto &entry: _statistics) entry.second.analyze();
+            return;
+        }
+
+        const Expression_Node *table = unwrap(root);
+        if (!is_column_ref(table)) throw Unsupported_Query("`" + to_string(root) + "` is not a table");
+
+        analyze_table(std::string(table->name));
+    }
+
+    Query Planner::build(const Expression_Node *query) const {
+        Arena arena { };
+        auto root = Builder { _tables, _zone_maps, _blooms, _compressed, arena }.build(query);
+
+        Query ret { std::move(arena), std::move(root) };
+        ret.set_memory_limit(_memory_limit);
+        return ret;
+    }
+
+    void Planner::optimize(Query &query) const {
+        Estimator estimator { *this };
+        Optimizer { query._arena, estimator, _reorder_joins }.optimize(query._root);
+    }
+
+    Query Planner::plan(const Expression_Node *query) const {
+        Query ret = build(query);
+        optimize(ret);
+        return ret;
+    }
+
+    Query Planner::plan(std::string_view stmt) const {
+        auto tree = parser::Syntax_Tree::parse(std::string(stmt));
+
+        if (tree->stmts.size() != 1) throw parser::Parsing_Exception("Expected one query statement");
+
+        const auto &query = tree->stmts[0];
+        if (query.variant != parser::Top_Level_Statement::Call && query.variant != parser::Top_Level_Statement::Explain
+            && query.variant != parser::Top_Level_Statement::Explain_Analyze)
+            throw Unsupported_Query(parser::to_string(query.variant));
+
+        return plan(query.call_data.root);
+    }
+
+    std::string Planner::explain(std::string_view stmt) const {
+        return plan(stmt).explain();
+    }
+
+    Profile Planner::explain_analyze(std::string_view stmt, Engine &engine) const {
+        Profile ret;
+        plan(stmt).execute(engine, ret);
+        return ret;
+    }
+}
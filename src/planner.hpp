@@ -0,0 +1,445 @@
+#ifndef planner_hpp_INCLUDED
+#define planner_hpp_INCLUDED
+
+#include <arena.hpp>
+#include <bloom.hpp>
+#include <common.hpp>
+#include <compression.hpp>
+#include <interpreter.hpp>
+#include <memory>
+#include <parser.hpp>
+#include <statistics.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <zone_map.hpp>
+
+namespace toad_db::interact {
+
+    /**
+     * # Logical plans of the queries.
+     *
+     * Query expression is translated to the tree of relational operators
+     * exactly as it's written, then the tree is rewritten by the rules:
+     *
+     *  - predicates of `?=>` are split by `&&` and pushed down through
+     *    projections, renames and to the side of `*` they refer to;
+     *  - `a * b ?=> x == y` with `x` of `a` and `y` of `b` becomes hash join;
+     *  - only the columns needed above are read by the scans;
+     *  - consecutive projections and renames are merged.
+     *
+     * Then the joins and products of three and more inputs are reordered by
+     * the cost estimated from the statistics of the tables, and the hash
+     * tables are built on the smaller inputs.
+     *
+     * ```
+     *  (@Users<name, group_key>{name, uk} * @Groups<title, key>{title, gk} ?=> gk == uk)<name, title>
+     *
+     *  Project <name, title>                        Project <name, title>
+     *    Filter gk == uk                              Join uk == gk
+     *      Product                            =>        Rename {group_key: uk}
+     *        Rename {group_key: uk}                       Scan Users <name, group_key>
+     *          Project <name, group_key>                Rename {key: gk}
+     *            Scan Users <uk, name, ...>               Scan Groups <title, key>
+     *        ...
+     * ```
+     *
+     * Rewritten plan is shown by the `explain` statement, `explain analyze`
+     * executes it and shows rows, time and bytes of every operator.
+     **/
+    namespace plan {
+        using Expression_Node = parser::Top_Level_Statement::Expression_Data::Expression_Node;
+
+        struct Column {
+            std::string name;
+            Domain *domain;
+
+            /**
+             * Dictionary of the encoded column (@see Table::Column_Field).
+             **/
+            std::shared_ptr<Dictionary> dictionary { };
+        };
+
+        struct Node {
+            using pointer = std::unique_ptr<Node>;
+
+            enum Kind {
+                /**
+                 * Columns `.columns` of the table.
+                 **/
+                Scan,
+
+                /**
+                 * Rows of the input for which all `.predicates` are true.
+                 **/
+                Filter,
+
+                /**
+                 * Columns `.names` of the input in the given order.
+                 **/
+                Project,
+
+                /**
+                 * Columns of the input renamed by `.renames` (old, new).
+                 **/
+                Rename,
+
+                /**
+                 * All pairs of the rows of two inputs.
+                 **/
+                Product,
+
+                /**
+                 * Pairs of the rows of two inputs with equal `.left_key` and `.right_key`.
+                 **/
+                Join,
+            } kind;
+
+            /**
+             * Output columns: for Product and Join columns of the left input
+             * and then of the right one.
+             **/
+            std::vector<Column> schema;
+
+            std::vector<pointer> inputs;
+
+            std::string table_name;
+            const Table *table = nullptr;
+            std::vector<size_t> columns;
+
+            /**
+             * Scan: zone map and Bloom filters of the table, filters over the
+             * scan and joins probing it skip blocks by them. Filters read the
+             * sealed segments from the compressed columns, if the table has them.
+             **/
+            Zone_Map *zones = nullptr;
+            Segment_Blooms *blooms = nullptr;
+            compression::Compressed_Segments *compressed = nullptr;
+
+            /**
+             * Conjuncts of the predicate, allocated in the arena of the query.
+             **/
+            std::vector<Expression_Node::pointer> predicates;
+
+            std::vector<std::string> names;
+            std::vector<std::pair<std::string, std::string>> renames;
+
+            std::string left_key, right_key;
+
+            /**
+             * Join: hash table is built on the left input, otherwise on the right one.
+             **/
+            bool build_left = true;
+
+            /**
+             * Count of the output rows estimated by the statistics, negative if unknown.
+             **/
+            double estimated_rows = -1;
+
+            explicit Node(Kind kind): kind(kind) { }
+        };
+
+        /**
+         * Measures of the executed operator, times and bytes are of the
+         * operator itself, without its inputs.
+         **/
+        struct Operator_Profile {
+            Node::Kind kind;
+
+            /**
+             * Operator as it's shown by `explain`: `Join uk == gk, build right`.
+             **/
+            std::string description;
+
+            double estimated_rows = -1;
+            size_t rows_in = 0, rows_out = 0;
+
+            double wall_ms = 0, cpu_ms = 0;
+
+            /**
+             * Times of the operator with its inputs.
+             **/
+            double total_wall_ms = 0, total_cpu_ms = 0;
+
+            /**
+             * Bytes read by the predicates and join keys and copied to
+             * the new tables.
+             **/
+            size_t bytes = 0;
+
+            size_t hash_table_bytes = 0;
+
+            /**
+             * Filter over the scan: blocks of the zone map and the blocks skipped by it.
+             **/
+            size_t blocks = 0, skipped_blocks = 0;
+
+            /**
+             * Blocks checked by the Bloom filters, skipped by them and read
+             * without rows of the equality or of the join.
+             **/
+            size_t bloom_blocks = 0, bloom_skipped_blocks = 0, bloom_false_positives = 0;
+
+            /**
+             * Bytes written out of the memory, operators don't spill yet.
+             **/
+            size_t spilled_bytes = 0;
+
+            std::vector<Operator_Profile> inputs;
+        };
+
+        /**
+         * # Profile of the executed query (`explain analyze`).
+         **/
+        struct Profile {
+            Operator_Profile root;
+
+            /**
+             * Time of the whole query with gathering of the result.
+             **/
+            double wall_ms = 0, cpu_ms = 0;
+
+            /**
+             * Max of the bytes held at once by the temporaries of the query
+             * and the count of their allocations (@see Query_Memory).
+             **/
+            size_t peak_bytes = 0, allocations = 0;
+
+            /**
+             * Tree of the operators like `explain` with the measures.
+             **/
+            std::string to_string(void) const;
+
+            /**
+             * Profile as JSON object, operators are nested by `inputs`.
+             **/
+            std::string to_json(void) const;
+        };
+
+        std::string to_string(Node::Kind kind);
+
+        /**
+         * Predicate as it's written: `level > 1 && title == "admin"`.
+         **/
+        std::string to_string(const Expression_Node *predicate);
+
+        /**
+         * # Planned query.
+         *
+         * Owns the plan and the predicates, so it doesn't depend on the
+         * syntax tree it was built from.
+         **/
+        class Query {
+            public:
+                Query(Arena arena, Node::pointer root): _arena(std::move(arena)), _root(std::move(root)) { }
+
+                const Node& root(void) const { return *_root; }
+                const std::vector<Column>& schema(void) const { return _root->schema; }
+
+                /**
+                 * Tree of the operators, one per line, inputs are indented.
+                 **/
+                std::string explain(void) const;
+
+                /**
+                 * Execute the plan. Scans, filters and projections of the
+                 * scans are not copying the tables, rows are gathered once
+                 * for the join, product or the result.
+                 *
+                 * @return new table with `schema()` columns.
+                 **/
+                Table execute(Engine &engine) const noexcept(false);
+
+                /**
+                 * Execute the plan with temporaries charged to the `memory`.
+                 *
+                 * @throws Query_Memory::Memory_Limit_Exceeded if the temporaries don't fit the limit of the memory.
+                 **/
+                Table execute(Engine &engine, Query_Memory &memory) const noexcept(false);
+
+                /**
+                 * Execute the plan and measure every operator.
+                 **/
+                Table execute(Engine &engine, Profile &profile) const noexcept(false);
+
+                /**
+                 * Limit of the memory of `execute` without the given memory.
+                 **/
+                size_t memory_limit(void) const { return _memory_limit; }
+                void set_memory_limit(size_t bytes) { _memory_limit = bytes; }
+
+            private:
+                Arena _arena;
+                Node::pointer _root;
+                size_t _memory_limit = Query_Memory::Unlimited;
+
+            friend class Planner;
+        };
+
+        /**
+         * # Planner.
+         *
+         * ```cpp
+         * Planner planner { };
+         * planner.add_table("Users", users);
+         * planner.add_table("Groups", groups);
+         *
+         * std::cout << planner.explain("explain (@Users * @Groups ?=> gk == uk)<name, title>;");
+         * Table result = planner.plan("(@Users * @Groups ?=> gk == uk)<name, title>").execute(engine);
+         * ```
+         *
+         * Queries consist of tables (`Users` or `@Users`), products `a * b`,
+         * filters `a ?=> predicate`, projections `a<x, y>` and renames `a{x, y}`
+         * (new names for all columns) or `a{x: z}` (only for some of them).
+         * Projections and renames are written right after the table or the
+         * group: `(a * b)<x>`.
+         **/
+        class Planner {
+            public:
+                /**
+                 * Count of inputs of the joins that are reordered, the join
+                 * orders of bigger ones are kept as written.
+                 **/
+                static constexpr size_t Max_Reordered_Inputs = 12;
+
+                /**
+                 * @param reorder_joins - choose the order of the joins by the cost,
+                 *                        otherwise keep it as written.
+                 **/
+                explicit Planner(bool reorder_joins = true): _reorder_joins(reorder_joins) { }
+
+                /**
+                 * Limit of the memory of the temporaries of every planned query.
+                 **/
+                size_t memory_limit(void) const { return _memory_limit; }
+                void set_memory_limit(size_t bytes) { _memory_limit = bytes; }
+
+                /**
+                 * Register the table, it must outlive the planner and the queries.
+                 **/
+                void add_table(const std::string &name, const Table &table);
+                void drop_table(const std::string &name);
+
+                /**
+                 * Build Bloom filters of the column for the sealed segments of
+                 * the table, equality filters and joins check them (@see Segment_Blooms).
+                 *
+                 * @throws Unknown_Table if there is no such table.
+                 * @throws Unknown_Column if there is no such column.
+                 **/
+                void add_bloom_filter(const std::string &table, const std::string &column,
+                                      size_t bits_per_key = Segment_Blooms::Bits_Per_Key) noexcept(false);
+
+                /**
+                 * Compress the sealed segments of the table, filters over its
+                 * scans read them from the compressed columns. The columns are
+                 * kept beside the rows (@see compression::Compressed_Segments).
+                 *
+                 * @throws Unknown_Table if there is no such table.
+                 **/
+                void add_compression(const std::string &table) noexcept(false);
+
+                /**
+                 * Statistics of the table. Rows appended since the previous
+                 * call are taken into them (@see Table_Statistics).
+                 *
+                 * @throws Unknown_Table if there is no such table.
+                 **/
+                const Table_Statistics& statistics(const std::string &name) const noexcept(false);
+
+                /**
+                 * Rebuild statistics of the table from scratch.
+                 **/
+                void analyze_table(const std::string &name) noexcept(false);
+
+                /**
+                 * Execute the statement `analyze <Table>;` or `analyze;` (all tables).
+                 **/
+                void analyze(std::string_view stmt) noexcept(false);
+
+                /**
+                 * Plan of the query as it's written, without rewriting.
+                 *
+                 * @throws Unsupported_Query if expression is not a query.
+                 * @throws Unknown_Table if there is no such table.
+                 * @throws Unknown_Column if projection, rename or predicate refers to not existing column.
+                 * @throws Ambiguous_Column if columns of the result have the same names.
+                 **/
+                Query build(const Expression_Node *query) const noexcept(false);
+
+                /**
+                 * Plan of the query rewritten by the optimizer.
+                 **/
+                Query plan(const Expression_Node *query) const noexcept(false);
+
+                /**
+                 * Parse and plan the query statement (`explain` and `explain analyze` are allowed).
+                 *
+                 * @throws Parsing_Exception if text is not one statement.
+                 **/
+                Query plan(std::string_view stmt) const noexcept(false);
+
+                /**
+                 * Rewrite the plan by the rules and order the joins (@see plan).
+                 **/
+                void optimize(Query &query) const;
+
+                /**
+                 * Plan of the statement `explain <query>;`.
+                 **/
+                std::string explain(std::string_view stmt) const noexcept(false);
+
+                /**
+                 * Execute the statement `explain analyze <query>;`, the result is dropped.
+                 **/
+                Profile explain_analyze(std::string_view stmt, Engine &engine) const noexcept(false);
+
+                class Unsupported_Query: public Toad_Exception {
+                    public:
+                        Unsupported_Query(const std::string &what):
+                            Toad_Exception("Plan: Unsupported query: " + what) { }
+                };
+
+                class Unknown_Table: public Toad_Exception {
+                    public:
+                        Unknown_Table(std::string_view name):
+                            Toad_Exception("Plan: Unknown table `" + std::string(name) + "`") { }
+                };
+
+                class Unknown_Column: public Toad_Exception {
+                    public:
+                        Unknown_Column(std::string_view name):
+                            Toad_Exception("Plan: Unknown column `" + std::string(name) + "`") { }
+                };
+
+                class Ambiguous_Column: public Toad_Exception {
+                    public:
+                        Ambiguous_Column(std::string_view name):
+                            Toad_Exception("Plan: More than one column `" + std::string(name) + "`") { }
+                };
+
+            private:
+                bool _reorder_joins;
+                size_t _memory_limit = Query_Memory::Unlimited;
+                std::unordered_map<std::string, const Table*> _tables;
+
+                /**
+                 * Statistics are caught up with the tables lazily, when they are used.
+                 **/
+                mutable std::unordered_map<std::string, Table_Statistics> _statistics;
+
+                /**
+                 * Zone maps, Bloom filters and compressed segments are caught up
+                 * with the tables by the filters and the joins over the scans.
+                 * Only tables given to `add_compression` are compressed.
+                 **/
+                mutable std::unordered_map<std::string, Zone_Map> _zone_maps;
+                mutable std::unordered_map<std::string, Segment_Blooms> _blooms;
+                mutable std::unordered_map<std::string, compression::Compressed_Segments> _compressed;
+        };
+    }
+}
+
+#endif // planner_hpp_INCLUDED
@@ -0,0 +1,214 @@
+#include <limits>
+#include <prepared.hpp>
+
+namespace toad_db::interact {
+    using namespace types;
+    using bytecode::Type;
+
+    void Plan_Cache::add_table(const std::string &name, const Table &table) {
+        std::lock_guard lock { _mutex };
+        _tables[name] = Table_Entry { &table, ++_version };
+    }
+
+    void Plan_Cache::drop_table(const std::string &name) {
+        std::lock_guard lock { _mutex };
+        _tables.erase(name);
+    }
+
+    void Plan_Cache::invalidate(const std::string &name) {
+        std::lock_guard lock { _mutex };
+
+        auto table = _tables.find(name);
+        if (table != _tables.end()) table->second.version = ++_version;
+    }
+
+    size_t Plan_Cache::size(void) const {
+        std::lock_guard lock { _mutex };
+        return _plans.size();
+    }
+
+    size_t Plan_Cache::hits(void) const {
+        std::lock_guard lock { _mutex };
+        return _hits;
+    }
+
+    size_t Plan_Cache::misses(void) const {
+        std::lock_guard lock { _mutex };
+        return _misses;
+    }
+
+    std::string Plan_Cache::normalize(std::string_view text) {
+        parser::tokenize(text, _tree.symbols, _tokens);
+
+        std::string ret;
+        ret.reserve(text.size());
+
+        for (auto &token: _tokens) {
+            if (token.kind == parser::Token::End) break;
+
+            if (!ret.empty()) ret += ' ';
+            ret += token.text;
+        }
+
+        return ret;
+    }
+
+    bool Plan_Cache::is_valid(const Plan &plan) const {
+        auto table = _tables.find(plan.table);
+        return table != _tables.end() && table->second.version == plan.version;
+    }
+
+    std::shared_ptr<const Plan_Cache::Plan> Plan_Cache::make_plan(const std::string &text) const {
+        using Kind = parser::Top_Level_Statement::Expression_Data::kind;
+
+        // Nodes are needed only while planning, the filter doesn't keep them.
+        parser::Syntax_Tree tree { };
+        auto root = tree.parse_call(text).root;
+
+        if (root->args.size() != 1) throw Unsupported_Statement(text);
+
+        auto query = root->args[0];
+        if (query->kind != Kind::Operator || query->name != "?=>" || query->args.size() != 2
+            || query->args[0]->kind != Kind::Name || query->args[0]->args.size() != 0)
+            throw Unsupported_Statement(text);
+
+        const std::string name { query->args[0]->name };
+        auto table = _tables.find(name);
+        if (table == _tables.end()) throw Unknown_Table(name);
+
+        return std::make_shared<const Plan>(Plan {
+            name, table->second.version, vectorized::Batch_Filter { *table->second.table, query->args[1] }
+        });
+    }
+
+    std::shared_ptr<const Plan_Cache::Plan> Plan_Cache::get_plan(const std::string &text) {
+        auto cached = _plans.find(text);
+
+        if (cached != _plans.end() && is_valid(*cached->second.plan)) {
+            _hits++;
+            _lru.splice(_lru.begin(), _lru, cached->second.lru);
+            return cached->second.plan;
+        }
+
+        _misses++;
+        auto plan = make_plan(text);
+
+        if (cached != _plans.end()) {
+            cached->second.plan = plan;
+            _lru.splice(_lru.begin(), _lru, cached->second.lru);
+            return plan;
+        }
+
+        _lru.push_front(text);
+        _plans.emplace(text, Plan_Entry { plan, _lru.begin() });
+
+        if (_plans.size() > _capacity) {
+            _plans.erase(_lru.back());
+            _lru.pop_back();
+        }
+
+        return plan;
+    }
+
+    Prepared_Statement Plan_Cache::prepare(std::string_view text) {
+        std::lock_guard lock { _mutex };
+
+        std::string normalized = normalize(text);
+        auto plan = get_plan(normalized);
+
+        return Prepared_Statement { *this, std::move(normalized), std::move(plan) };
+    }
+
+    std::shared_ptr<const Plan_Cache::Plan> Plan_Cache::refresh(const std::shared_ptr<const Plan> &plan,
+                                                                const std::string &text) {
+        std::lock_guard lock { _mutex };
+        return is_valid(*plan) ? plan : get_plan(text);
+    }
+
+
+    Prepared_Statement::Prepared_Statement(Plan_Cache &cache, std::string text,
+                                           std::shared_ptr<const Plan_Cache::Plan> plan):
+        _cache(&cache), _text(std::move(text)), _plan(std::move(plan)) { }
+
+    const bytecode::Param& Prepared_Statement::find_param(std::string_view name) const {
+        for (auto &param: params()) {
+            if (std::string_view { param.name }.substr(1) == name) return param;
+        }
+
+        throw Bind_Failed(name, "statement has not such parameter");
+    }
+
+    bytecode::Argument Prepared_Statement::convert(const bytecode::Param &param, const Bound &bound) {
+        const std::string_view name = std::string_view { param.name }.substr(1);
+        bytecode::Argument ret { };
+
+        const auto mismatch = [&] {
+            return Bind_Failed(name, bytecode::to_string(bound.type) + " value for "
+                                     + bytecode::to_string(param.type) + " parameter");
+        };
+
+        switch (param.type) {
+        case Type::Str:
+            if (bound.type != Type::Str) throw mismatch();
+            ret.string = bound.string;
+            break;
+
+        case Type::Bool:
+            if (bound.type != Type::Bool) throw mismatch();
+            ret.value = bound.value;
+            break;
+
+        case Type::Float:
+            if (bound.type == Type::Int)        ret.value.f = (F64)bound.value.i;
+            else if (bound.type == Type::Uint)  ret.value.f = (F64)bound.value.u;
+            else if (bound.type == Type::Float) ret.value.f = bound.value.f;
+            else throw mismatch();
+            break;
+
+        case Type::Uint:
+            if (bound.type == Type::Int && bound.value.i < 0) throw Bind_Failed(name, "negative value for Uint parameter");
+            if (bound.type != Type::Int && bound.type != Type::Uint) throw mismatch();
+            ret.value.u = bound.value.u;
+            break;
+
+        case Type::Int:
+            if (bound.type == Type::Uint && bound.value.u > (U64)std::numeric_limits<I64>::max())
+                throw Bind_Failed(name, "value is too big for Int parameter");
+            if (bound.type != Type::Int && bound.type != Type::Uint) throw mismatch();
+            ret.value.i = bound.value.i;
+            break;
+        }
+
+        return ret;
+    }
+
+    Prepared_Statement& Prepared_Statement::bind_value(std::string_view name, Type type, bytecode::Value value) {
+        Bound bound { type, value, { } };
+        convert(find_param(name), bound);
+
+        _bound[std::string(name)] = std::move(bound);
+        return *this;
+    }
+
+    Prepared_Statement& Prepared_Statement::bind_string(std::string_view name, std::string_view value) {
+        Bound bound { Type::Str, { }, std::string(value) };
+        convert(find_param(name), bound);
+
+        _bound[std::string(name)] = std::move(bound);
+        return *this;
+    }
+
+    std::vector<size_t> Prepared_Statement::execute(Engine &engine) {
+        _plan = _cache->refresh(_plan, _text);
+
+        _args.clear();
+        for (auto &param: params()) {
+            auto bound = _bound.find(param.name.substr(1));
+            if (bound == _bound.end()) throw bytecode::Unbound_Param(param.name);
+
+            _args.push_back(convert(param, bound->second));
+        }
+
+        return _plan->filter.filter(engine, _args);
+    }
+}
@@ -0,0 +1,245 @@
+#ifndef prepared_hpp_INCLUDED
+#define prepared_hpp_INCLUDED
+
+#include <bytecode.hpp>
+#include <common.hpp>
+#include <interpreter.hpp>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <parser.hpp>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <vectorized.hpp>
+
+namespace toad_db::interact {
+
+    class Prepared_Statement;
+
+    /**
+     * # Cache of the query plans.
+     *
+     * Statements are parsed, resolved against the schema of the table and
+     * planned once, then the plan is cached by the normalized text (tokens
+     * joined by one space), so `Users ?=> level>$min` and `Users ?=>  level > $min`
+     * share the plan:
+     *
+     * ```cpp
+     * Plan_Cache cache { };
+     * cache.add_table("Users", users);
+     *
+     * auto stmt = cache.prepare("Users ?=> level > $min && title == $title");
+     * auto rows = stmt.bind("min", 1).bind("title", "admin").execute(engine);
+     * ```
+     *
+     * Plans of the table are invalidated when the table is added again,
+     * dropped, or `invalidate` is called (after schema or domains of the
+     * columns are changed in place). Prepared statements notice it on the
+     * next `execute` and are planned again.
+     *
+     * All methods are thread safe. The least recently used plans are evicted
+     * when there are more than `capacity` of them.
+     **/
+    class Plan_Cache {
+        public:
+            struct Plan {
+                std::string table;
+
+                /**
+                 * Version of the table when the plan was made.
+                 **/
+                size_t version;
+
+                vectorized::Batch_Filter filter;
+            };
+
+            explicit Plan_Cache(size_t capacity = 1024): _capacity(capacity) { }
+
+            /**
+             * Register the table (or replace the table with the same name).
+             * Table must outlive the cache and prepared statements.
+             **/
+            void add_table(const std::string &name, const Table &table);
+
+            void drop_table(const std::string &name);
+
+            /**
+             * Invalidate plans of the table.
+             **/
+            void invalidate(const std::string &name);
+
+            /**
+             * Prepare the statement `Table ?=> predicate`, predicate can have
+             * parameters `$name`.
+             *
+             * @throws Parsing_Exception if the text can't be parsed.
+             * @throws Unsupported_Statement if it's not a filter of the table.
+             * @throws Unknown_Table if there is no such table.
+             * @throws bytecode::Compile_Exception if predicate can't be compiled.
+             **/
+            Prepared_Statement prepare(std::string_view text) noexcept(false);
+
+            /**
+             * Current plan for the normalized text: `plan` itself if it's still
+             * valid, otherwise the cached or new one.
+             **/
+            std::shared_ptr<const Plan> refresh(const std::shared_ptr<const Plan> &plan,
+                                                const std::string &text) noexcept(false);
+
+            size_t size(void) const;
+            size_t hits(void) const;
+            size_t misses(void) const;
+
+            class Unsupported_Statement: public Toad_Exception {
+                public:
+                    Unsupported_Statement(std::string_view text):
+                        Toad_Exception("Only `Table ?=> predicate` can be prepared, but get `"
+                                       + std::string(text) + "`") { }
+            };
+
+            class Unknown_Table: public Toad_Exception {
+                public:
+                    Unknown_Table(std::string_view name):
+                        Toad_Exception("Unknown table `" + std::string(name) + "`") { }
+            };
+
+        private:
+            struct Table_Entry {
+                const Table *table;
+                size_t version;
+            };
+
+            struct Plan_Entry {
+                std::shared_ptr<const Plan> plan;
+                std::list<std::string>::iterator lru;
+            };
+
+            size_t _capacity;
+            size_t _version = 0;
+            std::unordered_map<std::string, Table_Entry> _tables;
+
+            std::unordered_map<std::string, Plan_Entry> _plans;
+
+            /**
+             * Texts of the plans, the most recently used first.
+             **/
+            std::list<std::string> _lru;
+
+            size_t _hits = 0, _misses = 0;
+
+            /**
+             * Symbols of the language and the buffer for normalization.
+             **/
+            parser::Syntax_Tree _tree { };
+            std::vector<parser::Token> _tokens;
+
+            mutable std::mutex _mutex;
+
+            std::string normalize(std::string_view text);
+            bool is_valid(const Plan &plan) const;
+
+            /**
+             * Cached or new plan, `_mutex` must be locked.
+             **/
+            std::shared_ptr<const Plan> get_plan(const std::string &text);
+            std::shared_ptr<const Plan> make_plan(const std::string &text) const;
+    };
+
+    /**
+     * # Prepared statement.
+     *
+     * Plan shared with the cache and the arguments of it's parameters.
+     * Arguments are converted to the types of the parameters, so `$min` of
+     * `level > $min` for `U8` level accepts not negative integers.
+     * Arguments are kept between executions.
+     *
+     * Statement itself is not thread safe, use one per thread.
+     **/
+    class Prepared_Statement {
+        public:
+            Prepared_Statement(Plan_Cache &cache, std::string text, std::shared_ptr<const Plan_Cache::Plan> plan);
+
+            /**
+             * Bind the value to the parameter.
+             *
+             * @param name - name of the parameter without `$`.
+             * @throws Bind_Failed if there is no such parameter or value doesn't fit it's type.
+             **/
+            template<typename T>
+            Prepared_Statement& bind(std::string_view name, const T &value) noexcept(false) {
+                using namespace types;
+
+                if constexpr (std::is_same_v<T, bool>) {
+                    return bind_value(name, bytecode::Type::Bool, { .u = value });
+                } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                    return bind_value(name, bytecode::Type::Int, { .i = (I64)value });
+                } else if constexpr (std::is_integral_v<T>) {
+                    return bind_value(name, bytecode::Type::Uint, { .u = (U64)value });
+                } else if constexpr (std::is_floating_point_v<T>) {
+                    return bind_value(name, bytecode::Type::Float, { .f = (F64)value });
+                } else {
+                    return bind_string(name, std::string_view { value });
+                }
+            }
+
+            /**
+             * Select the rows of the table by the predicate.
+             *
+             * Statement is planned again if the table was changed since preparing.
+             *
+             * @return idxs of the selected rows in ascending order.
+             * @throws bytecode::Unbound_Param if not all parameters are bound.
+             **/
+            std::vector<size_t> execute(Engine &engine) noexcept(false);
+
+            const std::vector<bytecode::Param>& params(void) const { return _plan->filter.params(); }
+
+            /**
+             * Normalized text of the statement.
+             **/
+            const std::string& text(void) const { return _text; }
+
+            class Bind_Failed: public Toad_Exception {
+                public:
+                    Bind_Failed(std::string_view name, const std::string &why):
+                        Toad_Exception("Failed to bind `$" + std::string(name) + "`: " + why) { }
+            };
+
+        private:
+            Plan_Cache *_cache;
+            std::string _text;
+            std::shared_ptr<const Plan_Cache::Plan> _plan;
+
+            /**
+             * Value as it was bound, before conversion to the type of the
+             * parameter. Plan can be remade with other types and order of
+             * the parameters.
+             **/
+            struct Bound {
+                bytecode::Type type;
+                bytecode::Value value;
+                std::string string;
+            };
+            std::unordered_map<std::string, Bound> _bound;
+
+            /**
+             * Converted arguments in the order of the parameters of the plan.
+             **/
+            std::vector<bytecode::Argument> _args;
+
+            Prepared_Statement& bind_value(std::string_view name, bytecode::Type type, bytecode::Value value) noexcept(false);
+            Prepared_Statement& bind_string(std::string_view name, std::string_view value) noexcept(false);
+
+            const bytecode::Param& find_param(std::string_view name) const noexcept(false);
+
+            /**
+             * @throws Bind_Failed if value doesn't fit the type of the parameter.
+             **/
+            static bytecode::Argument convert(const bytecode::Param &param, const Bound &bound) noexcept(false);
+    };
+}
+
+#endif // prepared_hpp_INCLUDED
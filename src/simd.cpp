@@ -0,0 +1,1235 @@
+#include <array>
+#include <bit>
+#include <simd.hpp>
+
+#if defined(__x86_64__)
+#   include <immintrin.h>
+#   define TOAD_SIMD_X86
+#   define TOAD_SSE4_2 __attribute__((target("sse4.2,popcnt")))
+#   define TOAD_AVX2   __attribute__((target("avx2,bmi,bmi2,popcnt")))
+#   define TOAD_AVX512 __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,bmi,bmi2,popcnt")))
+#endif
+
+namespace toad_db::interact::simd {
+    using namespace types;
+
+    const char* to_string(Level level) {
+        switch (level) {
+        case Level::Scalar: return "scalar";
+        case Level::SSE4_2: return "sse4.2";
+        case Level::AVX2:   return "avx2";
+        case Level::AVX512: return "avx512";
+        }
+        return "unknown";
+    }
+
+    Level detect(void) {
+#ifdef TOAD_SIMD_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+            && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")
+            && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("popcnt"))
+            return Level::AVX512;
+
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi")
+            && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("popcnt"))
+            return Level::AVX2;
+
+        if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+            return Level::SSE4_2;
+#endif
+        return Level::Scalar;
+    }
+
+    static Level& current_level(void) {
+        static Level level = detect();
+        return level;
+    }
+
+    Level level(void) {
+        return current_level();
+    }
+
+    void set_level(Level level) {
+        if ((char)level > (char)detect()) throw Unsupported_Level(level);
+        current_level() = level;
+    }
+
+    /**
+     * Passes `Compare` to the kernels as compile time constant,
+     * so the comparison is chosen once per call, not per vector.
+     **/
+    template<Compare C>
+    using Compare_Tag = std::integral_constant<Compare, C>;
+
+    /**
+     * Integer sums are done modulo 2^64, like they are done by the vector kernels.
+     **/
+    template<typename T>
+    static void add_to_sum(Sum<T> &sum, T value) {
+        if constexpr (std::is_floating_point_v<T>) sum += value;
+        else sum = (Sum<T>)((U64)sum + (U64)(Sum<T>)value);
+    }
+
+    /**
+     * Idxs of the set bits of the every byte.
+     * Byte `k` of the entry is idx of the `k`'th set bit.
+     **/
+    static constexpr std::array<U64, 256> Selection_Lut = [] {
+        std::array<U64, 256> lut { };
+        for (size_t byte = 0; byte < 256; byte++) {
+            size_t set = 0;
+            for (size_t bit = 0; bit < 8; bit++) {
+                if (byte & (1 << bit)) lut[byte] |= (U64)bit << (8 * set++);
+            }
+        }
+        return lut;
+    }();
+
+    /**
+     * Words with less set bits are converted to the selection bit by bit,
+     * vector conversion costs the same for any count of bits.
+     **/
+    static constexpr size_t Sparse_Bits = 12;
+
+    /**
+     * # Scalar kernels.
+     *
+     * Portable fallback, also used for the tails which are shorter
+     * than a word of the bitmap. All of them start from the row `begin`,
+     * which is multiple of 64.
+     **/
+    namespace scalar {
+        template<typename T, Compare C>
+        static bool test(T a, T b) {
+            if constexpr (C == Compare::Eq) return a == b;
+            else if constexpr (C == Compare::Ne) return a != b;
+            else if constexpr (C == Compare::Lt) return a < b;
+            else if constexpr (C == Compare::Le) return a <= b;
+            else if constexpr (C == Compare::Gt) return a > b;
+            else return a >= b;
+        }
+
+        /**
+         * Fill words of the bitmap from `begin` by `test(i)`.
+         **/
+        template<typename Test>
+        static void fill(size_t begin, size_t count, U64 *bitmap, Test test) {
+            for (size_t base = begin; base < count; base += 64) {
+                const size_t size = std::min<size_t>(64, count - base);
+
+                U64 bits = 0;
+                for (size_t j = 0; j < size; j++) bits |= (U64)test(base + j) << j;
+                bitmap[base / 64] = bits;
+            }
+        }
+
+        template<typename T, Compare C>
+        static void compare_const(const T *values, size_t begin, size_t count, T constant, U64 *bitmap) {
+            fill(begin, count, bitmap, [&](size_t i) { return test<T, C>(values[i], constant); });
+        }
+
+        template<typename T, Compare C>
+        static void compare(const T *lhs, const T *rhs, size_t begin, size_t count, U64 *bitmap) {
+            fill(begin, count, bitmap, [&](size_t i) { return test<T, C>(lhs[i], rhs[i]); });
+        }
+
+        template<typename T>
+        static void between(const T *values, size_t begin, size_t count, T low, T high, U64 *bitmap) {
+            fill(begin, count, bitmap, [&](size_t i) { return low <= values[i] && values[i] <= high; });
+        }
+
+        template<typename T>
+        static void in_list(const T *values, size_t begin, size_t count,
+                            const T *list, size_t list_size, U64 *bitmap) {
+            fill(begin, count, bitmap, [&](size_t i) {
+                return std::find(list, list + list_size, values[i]) != list + list_size;
+            });
+        }
+
+        template<typename T>
+        static void aggregate_value(T value, Aggregate<T> &acc) {
+            add_to_sum(acc.sum, value);
+            if (value < acc.min) acc.min = value;
+            if (value > acc.max) acc.max = value;
+            acc.count++;
+        }
+
+        /**
+         * Aggregate values of the block selected by bits.
+         **/
+        template<typename T>
+        static void aggregate_bits(const T *block, U64 bits, Aggregate<T> &acc) {
+            while (bits) {
+                aggregate_value(block[std::countr_zero(bits)], acc);
+                bits &= bits - 1;
+            }
+        }
+
+        template<typename T>
+        static void aggregate(const T *values, size_t begin, size_t count,
+                              const U64 *bitmap, Aggregate<T> &acc) {
+            for (size_t base = begin; base < count; base += 64) {
+                const size_t size = std::min<size_t>(64, count - base);
+                const U64 all = size == 64 ? ~0ull : (1ull << size) - 1;
+
+                aggregate_bits(values + base, (bitmap ? bitmap[base / 64] : ~0ull) & all, acc);
+            }
+        }
+
+        static size_t popcount(const U64 *bitmap, size_t begin, size_t count) {
+            size_t result = 0;
+            for (size_t base = begin; base < count; base += 64) {
+                const size_t size = std::min<size_t>(64, count - base);
+                const U64 all = size == 64 ? ~0ull : (1ull << size) - 1;
+                result += std::popcount(bitmap[base / 64] & all);
+            }
+            return result;
+        }
+
+        static size_t bitmap_to_selection(const U64 *bitmap, size_t begin, size_t count,
+                                          U32 *selection, size_t selected) {
+            for (size_t base = begin & ~(size_t)63; base < count; base += 64) {
+                U64 bits = bitmap[base / 64];
+                if (base < begin) bits &= ~0ull << (begin - base);
+                if (count - base < 64) bits &= (1ull << (count - base)) - 1;
+
+                while (bits) {
+                    selection[selected++] = (U32)(base + std::countr_zero(bits));
+                    bits &= bits - 1;
+                }
+            }
+            return selected;
+        }
+    }
+
+#ifdef TOAD_SIMD_X86
+    template<typename T>
+    static constexpr bool is_f32 = std::is_same_v<T, F32>;
+
+    template<typename T>
+    static constexpr bool is_f64 = std::is_same_v<T, F64>;
+
+    /**
+     * Bit which flips order of the unsigned values to the order of the signed ones.
+     **/
+    template<typename T>
+    static constexpr T Sign_Bit = (T)((T)1 << (sizeof(T) * 8 - 1));
+
+    /**
+     * # SSE4.2 kernels.
+     *
+     * 128 bit vectors. There are only `==` and signed `>` of the integers,
+     * all other comparisons are derived from them, unsigned values are
+     * compared after flipping of the sign bit.
+     **/
+    namespace sse4_2 {
+        /**
+         * Vector of `T`, sums are accumulated in the vectors of 64 bit lanes.
+         **/
+        template<typename T>
+        struct Vector { using Reg = __m128i; using Acc = __m128i; };
+
+        template<> struct Vector<F32> { using Reg = __m128; using Acc = __m128d; };
+        template<> struct Vector<F64> { using Reg = __m128d; using Acc = __m128d; };
+
+        template<typename T>
+        using Reg = typename Vector<T>::Reg;
+
+        template<typename T>
+        using Acc = typename Vector<T>::Acc;
+
+        template<typename T>
+        constexpr size_t Lanes = 16 / sizeof(T);
+
+        template<typename T>
+        TOAD_SSE4_2 inline Reg<T> load(const T *p) {
+            if constexpr (is_f32<T>) return _mm_loadu_ps(p);
+            else if constexpr (is_f64<T>) return _mm_loadu_pd(p);
+            else return _mm_loadu_si128((const __m128i*)p);
+        }
+
+        template<typename T>
+        TOAD_SSE4_2 inline void store(T *p, Reg<T> v) {
+            if constexpr (is_f32<T>) _mm_storeu_ps(p, v);
+            else if constexpr (is_f64<T>) _mm_storeu_pd(p, v);
+            else _mm_storeu_si128((__m128i*)p, v);
+        }
+
+        template<typename T>
+        TOAD_SSE4_2 inline Reg<T> set1(T value) {
+            if constexpr (is_f32<T>) return _mm_set1_ps(value);
+            else if constexpr (is_f64<T>) return _mm_set1_pd(value);
+            else if constexpr (sizeof(T) == 1) return _mm_set1_epi8((char)value);
+            else if constexpr (sizeof(T) == 2) return _mm_set1_epi16((short)value);
+            else if constexpr (sizeof(T) == 4) return _mm_set1_epi32((int)value);
+            else return _mm_set1_epi64x((long long)value);
+        }
+
+        /**
+         * One bit per lane of the comparison result.
+         **/
+        template<typename T>
+        TOAD_SSE4_2 inline U64 movemask(Reg<T> m) {
+            if constexpr (is_f32<T>) return (U64)_mm_movemask_ps(m);
+            else if constexpr (is_f64<T>) return (U64)_mm_movemask_pd(m);
+            else if constexpr (sizeof(T) == 1) return (U64)_mm_movemask_epi8(m);
+            else if constexpr (sizeof(T) == 2) return (U64)_mm_movemask_epi8(_mm_packs_epi16(m, _mm_setzero_si128()));
+            else if constexpr (sizeof(T) == 4) return (U64)_mm_movemask_ps(_mm_castsi128_ps(m));
+            else return (U64)_mm_movemask_pd(_mm_castsi128_pd(m));
+        }
+
+        template<typename T>
+        TOAD_SSE4_2 inline __m128i eq(__m128i a, __m128i b) {
+            if constexpr (sizeof(T) == 1) return _mm_cmpeq_epi8(a, b);
+            else if constexpr (sizeof(T) == 2) return _mm_cmpeq_epi16(a, b);
+            else if constexpr (sizeof(T) == 4) return _mm_cmpeq_epi32(a, b);
+            else return _mm_cmpeq_epi64(a, b);
+        }
+
+        template<typename T>
+        TOAD_SSE4_2 inline __m128i gt(__m128i a, __m128i b) {
+            if constexpr (std::is_unsigned_v<T>) {
+                const __m128i sign = set1<T>(Sign_Bit<T>);
+                a = _mm_xor_si128(a, sign);
+                b = _mm_xor_si128(b, sign);
+            }
+
+            if constexpr (sizeof(T) == 1) return _mm_cmpgt_epi8(a, b);
+            else if constexpr (sizeof(T) == 2) return _mm_cmpgt_epi16(a, b);
+            else if constexpr (sizeof(T) == 4) return _mm_cmpgt_epi32(a, b);
+            else return _mm_cmpgt_epi64(a, b);
+        }
+
+        template<typename T, Compare C>
+        TOAD_SSE4_2 inline U64 test(Reg<T> a, Reg<T> b) {
+            if constexpr (is_f32<T>) {
+                if constexpr (C == Compare::Eq) return movemask<T>(_mm_cmpeq_ps(a, b));
+                else if constexpr (C == Compare::Ne) return movemask<T>(_mm_cmpneq_ps(a, b));
+                else if constexpr (C == Compare::Lt) return movemask<T>(_mm_cmplt_ps(a, b));
+                else if constexpr (C == Compare::Le) return movemask<T>(_mm_cmple_ps(a, b));
+                else if constexpr (C == Compare::Gt) return movemask<T>(_mm_cmpgt_ps(a, b));
+                else return movemask<T>(_mm_cmpge_ps(a, b));
+            } else if constexpr (is_f64<T>) {
+                if constexpr (C == Compare::Eq) return movemask<T>(_mm_cmpeq_pd(a, b));
+                else if constexpr (C == Compare::Ne) return movemask<T>(_mm_cmpneq_pd(a, b));
+                else if constexpr (C == Compare::Lt) return movemask<T>(_mm_cmplt_pd(a, b));
+                else if constexpr (C == Compare::Le) return movemask<T>(_mm_cmple_pd(a, b));
+                else if constexpr (C == Compare::Gt) return movemask<T>(_mm_cmpgt_pd(a, b));
+                else return movemask<T>(_mm_cmpge_pd(a, b));
+            } else {
+                constexpr U64 all = (1ull << Lanes<T>) - 1;
+
+                if constexpr (C == Compare::Eq) return movemask<T>(eq<T>(a, b));
+                else if constexpr (C == Compare::Ne) return ~movemask<T>(eq<T>(a, b)) & all;
+                else if constexpr (C == Compare::Lt) return movemask<T>(gt<T>(b, a));
+                else if constexpr (C == Compare::Le) return ~movemask<T>(gt<T>(a, b)) & all;
+                else if constexpr (C == Compare::Gt) return movemask<T>(gt<T>(a, b));
+                else return ~movemask<T>(gt<T>(b, a)) & all;
+            }
+        }
+
+        template<typename T>
+        TOAD_SSE4_2 inline Reg<T> min(Reg<T> a, Reg<T> b) {
+            if constexpr (is_f32<T>) return _mm_min_ps(a, b);
+            else if constexpr (is_f64<T>) return _mm_min_pd(a, b);
+            else if constexpr (std::is_same_v<T, U8>) return _mm_min_epu8(a, b);
+            else if constexpr (std::is_same_v<T, I8>) return _mm_min_epi8(a, b);
+            else if constexpr (std::is_same_v<T, U16>) return _mm_min_epu16(a, b);
+            else if constexpr (std::is_same_v<T, I16>) return _mm_min_epi16(a, b);
+            else if constexpr (std::is_same_v<T, U32>) return _mm_min_epu32(a, b);
+            else if constexpr (std::is_same_v<T, I32>) return _mm_min_epi32(a, b);
+            else return _mm_blendv_epi8(a, b, gt<T>(a, b));
+        }
+
+        template<typename T>
+        TOAD_SSE4_2 inline Reg<T> max(Reg<T> a, Reg<T> b) {
+            if constexpr (is_f32<T>) return _mm_max_ps(a, b);
+            else if constexpr (is_f64<T>) return _mm_max_pd(a, b);
+            else if constexpr (std::is_same_v<T, U8>) return _mm_max_epu8(a, b);
+            else if constexpr (std::is_same_v<T, I8>) return _mm_max_epi8(a, b);
+            else if constexpr (std::is_same_v<T, U16>) return _mm_max_epu16(a, b);
+            else if constexpr (std::is_same_v<T, I16>) return _mm_max_epi16(a, b);
+            else if constexpr (std::is_same_v<T, U32>) return _mm_max_epu32(a, b);
+            else if constexpr (std::is_same_v<T, I32>) return _mm_max_epi32(a, b);
+            else return _mm_blendv_epi8(b, a, gt<T>(a, b));
+        }
+
+        /**
+         * Widen the values to 64 bit lanes and add them to the sum.
+         *
+         * Bytes are summed by `psadbw`, `I8` are shifted by 128 before.
+         * Words are summed in pairs by `pmaddwd`, `U16` are shifted by -32768 before.
+         * @see sum_bias.
+         **/
+        template<typename T>
+        TOAD_SSE4_2 inline void add_sum(Reg<T> v, Acc<T> &acc) {
+            if constexpr (is_f32<T>) {
+                acc = _mm_add_pd(acc, _mm_cvtps_pd(v));
+                acc = _mm_add_pd(acc, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+            } else if constexpr (is_f64<T>) {
+                acc = _mm_add_pd(acc, v);
+            } else if constexpr (sizeof(T) == 1) {
+                if constexpr (std::is_signed_v<T>) v = _mm_xor_si128(v, _mm_set1_epi8((char)0x80));
+                acc = _mm_add_epi64(acc, _mm_sad_epu8(v, _mm_setzero_si128()));
+            } else if constexpr (sizeof(T) == 2) {
+                if constexpr (std::is_unsigned_v<T>) v = _mm_xor_si128(v, _mm_set1_epi16((short)0x8000));
+                const __m128i pairs = _mm_madd_epi16(v, _mm_set1_epi16(1));
+                acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(pairs));
+                acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_srli_si128(pairs, 8)));
+            } else if constexpr (sizeof(T) == 4) {
+                if constexpr (std::is_signed_v<T>) {
+                    acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(v));
+                    acc = _mm_add_epi64(acc, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+                } else {
+                    acc = _mm_add_epi64(acc, _mm_cvtepu32_epi64(v));
+                    acc = _mm_add_epi64(acc, _mm_cvtepu32_epi64(_mm_srli_si128(v, 8)));
+                }
+            } else {
+                acc = _mm_add_epi64(acc, v);
+            }
+        }
+
+        template<typename T, Compare C>
+        TOAD_SSE4_2 static size_t compare_const(Compare_Tag<C>, const T *values, size_t count, T constant, U64 *bitmap) {
+            const Reg<T> c = set1(constant);
+
+            for (size_t word = 0; word < count / 64; word++, values += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>)
+                    bits |= test<T, C>(load(values + j), c) << j;
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        template<typename T, Compare C>
+        TOAD_SSE4_2 static size_t compare(Compare_Tag<C>, const T *lhs, const T *rhs, size_t count, U64 *bitmap) {
+            for (size_t word = 0; word < count / 64; word++, lhs += 64, rhs += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>)
+                    bits |= test<T, C>(load(lhs + j), load(rhs + j)) << j;
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        template<typename T>
+        TOAD_SSE4_2 static size_t between(const T *values, size_t count, T low, T high, U64 *bitmap) {
+            const Reg<T> l = set1(low), h = set1(high);
+
+            for (size_t word = 0; word < count / 64; word++, values += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>) {
+                    const Reg<T> v = load(values + j);
+                    bits |= (test<T, Compare::Ge>(v, l) & test<T, Compare::Le>(v, h)) << j;
+                }
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        template<typename T>
+        TOAD_SSE4_2 static size_t in_list(const T *values, size_t count,
+                                          const T *list, size_t list_size, U64 *bitmap) {
+            for (size_t word = 0; word < count / 64; word++, values += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>) {
+                    const Reg<T> v = load(values + j);
+                    U64 lanes = 0;
+                    for (size_t k = 0; k < list_size; k++) lanes |= test<T, Compare::Eq>(v, set1(list[k]));
+                    bits |= lanes << j;
+                }
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        template<typename T>
+        TOAD_SSE4_2 static size_t aggregate(const T *values, size_t count, const U64 *bitmap, Aggregate<T> &acc) {
+            Acc<T> sum { };
+            Reg<T> low = set1(acc.min), high = set1(acc.max);
+            U64 vectorized = 0;
+
+            for (size_t word = 0; word < count / 64; word++) {
+                const T *block = values + word * 64;
+                const U64 bits = bitmap ? bitmap[word] : ~0ull;
+
+                if (bits != ~0ull) {
+                    scalar::aggregate_bits(block, bits, acc);
+                    continue;
+                }
+
+                for (size_t j = 0; j < 64; j += Lanes<T>) {
+                    const Reg<T> v = load(block + j);
+                    add_sum<T>(v, sum);
+                    low = min<T>(v, low);
+                    high = max<T>(v, high);
+                }
+                vectorized += 64;
+            }
+
+            if constexpr (std::is_floating_point_v<T>) {
+                F64 lanes[2];
+                _mm_storeu_pd(lanes, sum);
+                acc.sum += lanes[0] + lanes[1];
+            } else {
+                U64 lanes[2];
+                _mm_storeu_si128((__m128i*)lanes, sum);
+
+                U64 total = lanes[0] + lanes[1];
+                if constexpr (std::is_same_v<T, I8>) total -= 0x80 * vectorized;
+                if constexpr (std::is_same_v<T, U16>) total += 0x8000 * vectorized;
+                acc.sum = (Sum<T>)((U64)acc.sum + total);
+            }
+
+            T lows[Lanes<T>], highs[Lanes<T>];
+            store(lows, low);
+            store(highs, high);
+            for (size_t i = 0; i < Lanes<T>; i++) {
+                if (lows[i] < acc.min) acc.min = lows[i];
+                if (highs[i] > acc.max) acc.max = highs[i];
+            }
+            acc.count += vectorized;
+
+            return count / 64 * 64;
+        }
+
+        TOAD_SSE4_2 static size_t popcount(const U64 *bitmap, size_t count) {
+            size_t result = 0;
+            for (size_t word = 0; word < count / 64; word++) result += _mm_popcnt_u64(bitmap[word]);
+            return result;
+        }
+
+        TOAD_SSE4_2 static size_t bitmap_to_selection(const U64 *bitmap, size_t count, U32 *selection) {
+            size_t selected = 0;
+
+            for (size_t word = 0; word < count / 64; word++) {
+                U64 bits = bitmap[word];
+                if ((size_t)_mm_popcnt_u64(bits) < Sparse_Bits) {
+                    for (; bits; bits &= bits - 1) selection[selected++] = (U32)(word * 64 + std::countr_zero(bits));
+                    continue;
+                }
+
+                for (size_t byte = 0; byte < 8; byte++) {
+                    const U8 set = (U8)(bits >> (byte * 8));
+                    const __m128i idxs = _mm_cvtsi64_si128((long long)Selection_Lut[set]);
+                    const __m128i base = _mm_set1_epi32((int)(word * 64 + byte * 8));
+
+                    _mm_storeu_si128((__m128i*)(selection + selected),
+                                     _mm_add_epi32(base, _mm_cvtepu8_epi32(idxs)));
+                    _mm_storeu_si128((__m128i*)(selection + selected + 4),
+                                     _mm_add_epi32(base, _mm_cvtepu8_epi32(_mm_srli_si128(idxs, 4))));
+                    selected += _mm_popcnt_u32(set);
+                }
+            }
+
+            return scalar::bitmap_to_selection(bitmap, count / 64 * 64, count, selection, selected);
+        }
+    }
+
+    /**
+     * # AVX2 kernels.
+     *
+     * Same as SSE4.2 kernels, but 256 bit vectors, compare of the floats
+     * has predicate and words mask is packed by `pext`.
+     **/
+    namespace avx2 {
+        /**
+         * Vector of `T`, sums are accumulated in the vectors of 64 bit lanes.
+         **/
+        template<typename T>
+        struct Vector { using Reg = __m256i; using Acc = __m256i; };
+
+        template<> struct Vector<F32> { using Reg = __m256; using Acc = __m256d; };
+        template<> struct Vector<F64> { using Reg = __m256d; using Acc = __m256d; };
+
+        template<typename T>
+        using Reg = typename Vector<T>::Reg;
+
+        template<typename T>
+        using Acc = typename Vector<T>::Acc;
+
+        template<typename T>
+        constexpr size_t Lanes = 32 / sizeof(T);
+
+        constexpr int predicate(Compare compare) {
+            switch (compare) {
+            case Compare::Eq: return _CMP_EQ_OQ;
+            case Compare::Ne: return _CMP_NEQ_UQ;
+            case Compare::Lt: return _CMP_LT_OQ;
+            case Compare::Le: return _CMP_LE_OQ;
+            case Compare::Gt: return _CMP_GT_OQ;
+            case Compare::Ge: return _CMP_GE_OQ;
+            }
+            return _CMP_FALSE_OQ;
+        }
+
+        template<typename T>
+        TOAD_AVX2 inline Reg<T> load(const T *p) {
+            if constexpr (is_f32<T>) return _mm256_loadu_ps(p);
+            else if constexpr (is_f64<T>) return _mm256_loadu_pd(p);
+            else return _mm256_loadu_si256((const __m256i*)p);
+        }
+
+        template<typename T>
+        TOAD_AVX2 inline void store(T *p, Reg<T> v) {
+            if constexpr (is_f32<T>) _mm256_storeu_ps(p, v);
+            else if constexpr (is_f64<T>) _mm256_storeu_pd(p, v);
+            else _mm256_storeu_si256((__m256i*)p, v);
+        }
+
+        template<typename T>
+        TOAD_AVX2 inline Reg<T> set1(T value) {
+            if constexpr (is_f32<T>) return _mm256_set1_ps(value);
+            else if constexpr (is_f64<T>) return _mm256_set1_pd(value);
+            else if constexpr (sizeof(T) == 1) return _mm256_set1_epi8((char)value);
+            else if constexpr (sizeof(T) == 2) return _mm256_set1_epi16((short)value);
+            else if constexpr (sizeof(T) == 4) return _mm256_set1_epi32((int)value);
+            else return _mm256_set1_epi64x((long long)value);
+        }
+
+        template<typename T>
+        TOAD_AVX2 inline U64 movemask(Reg<T> m) {
+            if constexpr (is_f32<T>) return (U64)_mm256_movemask_ps(m);
+            else if constexpr (is_f64<T>) return (U64)_mm256_movemask_pd(m);
+            else if constexpr (sizeof(T) == 1) return (U64)(U32)_mm256_movemask_epi8(m);
+            else if constexpr (sizeof(T) == 2) return (U64)_pext_u32((U32)_mm256_movemask_epi8(m), 0xAAAAAAAA);
+            else if constexpr (sizeof(T) == 4) return (U64)_mm256_movemask_ps(_mm256_castsi256_ps(m));
+            else return (U64)_mm256_movemask_pd(_mm256_castsi256_pd(m));
+        }
+
+        template<typename T>
+        TOAD_AVX2 inline __m256i eq(__m256i a, __m256i b) {
+            if constexpr (sizeof(T) == 1) return _mm256_cmpeq_epi8(a, b);
+            else if constexpr (sizeof(T) == 2) return _mm256_cmpeq_epi16(a, b);
+            else if constexpr (sizeof(T) == 4) return _mm256_cmpeq_epi32(a, b);
+            else return _mm256_cmpeq_epi64(a, b);
+        }
+
+        template<typename T>
+        TOAD_AVX2 inline __m256i gt(__m256i a, __m256i b) {
+            if constexpr (std::is_unsigned_v<T>) {
+                const __m256i sign = set1<T>(Sign_Bit<T>);
+                a = _mm256_xor_si256(a, sign);
+                b = _mm256_xor_si256(b, sign);
+            }
+
+            if constexpr (sizeof(T) == 1) return _mm256_cmpgt_epi8(a, b);
+            else if constexpr (sizeof(T) == 2) return _mm256_cmpgt_epi16(a, b);
+            else if constexpr (sizeof(T) == 4) return _mm256_cmpgt_epi32(a, b);
+            else return _mm256_cmpgt_epi64(a, b);
+        }
+
+        template<typename T, Compare C>
+        TOAD_AVX2 inline U64 test(Reg<T> a, Reg<T> b) {
+            constexpr int P = predicate(C);
+
+            if constexpr (is_f32<T>) {
+                return movemask<T>(_mm256_cmp_ps(a, b, P));
+            } else if constexpr (is_f64<T>) {
+                return movemask<T>(_mm256_cmp_pd(a, b, P));
+            } else {
+                constexpr U64 all = Lanes<T> == 64 ? ~0ull : (1ull << Lanes<T>) - 1;
+
+                if constexpr (C == Compare::Eq) return movemask<T>(eq<T>(a, b));
+                else if constexpr (C == Compare::Ne) return ~movemask<T>(eq<T>(a, b)) & all;
+                else if constexpr (C == Compare::Lt) return movemask<T>(gt<T>(b, a));
+                else if constexpr (C == Compare::Le) return ~movemask<T>(gt<T>(a, b)) & all;
+                else if constexpr (C == Compare::Gt) return movemask<T>(gt<T>(a, b));
+                else return ~movemask<T>(gt<T>(b, a)) & all;
+            }
+        }
+
+        template<typename T>
+        TOAD_AVX2 inline Reg<T> min(Reg<T> a, Reg<T> b) {
+            if constexpr (is_f32<T>) return _mm256_min_ps(a, b);
+            else if constexpr (is_f64<T>) return _mm256_min_pd(a, b);
+            else if constexpr (std::is_same_v<T, U8>) return _mm256_min_epu8(a, b);
+            else if constexpr (std::is_same_v<T, I8>) return _mm256_min_epi8(a, b);
+            else if constexpr (std::is_same_v<T, U16>) return _mm256_min_epu16(a, b);
+            else if constexpr (std::is_same_v<T, I16>) return _mm256_min_epi16(a, b);
+            else if constexpr (std::is_same_v<T, U32>) return _mm256_min_epu32(a, b);
+            else if constexpr (std::is_same_v<T, I32>) return _mm256_min_epi32(a, b);
+            else return _mm256_blendv_epi8(a, b, gt<T>(a, b));
+        }
+
+        template<typename T>
+        TOAD_AVX2 inline Reg<T> max(Reg<T> a, Reg<T> b) {
+            if constexpr (is_f32<T>) return _mm256_max_ps(a, b);
+            else if constexpr (is_f64<T>) return _mm256_max_pd(a, b);
+            else if constexpr (std::is_same_v<T, U8>) return _mm256_max_epu8(a, b);
+            else if constexpr (std::is_same_v<T, I8>) return _mm256_max_epi8(a, b);
+            else if constexpr (std::is_same_v<T, U16>) return _mm256_max_epu16(a, b);
+            else if constexpr (std::is_same_v<T, I16>) return _mm256_max_epi16(a, b);
+            else if constexpr (std::is_same_v<T, U32>) return _mm256_max_epu32(a, b);
+            else if constexpr (std::is_same_v<T, I32>) return _mm256_max_epi32(a, b);
+            else return _mm256_blendv_epi8(b, a, gt<T>(a, b));
+        }
+
+        /**
+         * @see sse4_2::add_sum.
+         **/
+        template<typename T>
+        TOAD_AVX2 inline void add_sum(Reg<T> v, Acc<T> &acc) {
+            if constexpr (is_f32<T>) {
+                acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+                acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+            } else if constexpr (is_f64<T>) {
+                acc = _mm256_add_pd(acc, v);
+            } else if constexpr (sizeof(T) == 1) {
+                if constexpr (std::is_signed_v<T>) v = _mm256_xor_si256(v, _mm256_set1_epi8((char)0x80));
+                acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, _mm256_setzero_si256()));
+            } else if constexpr (sizeof(T) == 2) {
+                if constexpr (std::is_unsigned_v<T>) v = _mm256_xor_si256(v, _mm256_set1_epi16((short)0x8000));
+                const __m256i pairs = _mm256_madd_epi16(v, _mm256_set1_epi16(1));
+                acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+                acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+            } else if constexpr (sizeof(T) == 4) {
+                if constexpr (std::is_signed_v<T>) {
+                    acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+                    acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+                } else {
+                    acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+                    acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+                }
+            } else {
+                acc = _mm256_add_epi64(acc, v);
+            }
+        }
+
+        template<typename T, Compare C>
+        TOAD_AVX2 static size_t compare_const(Compare_Tag<C>, const T *values, size_t count, T constant, U64 *bitmap) {
+            const Reg<T> c = set1(constant);
+
+            for (size_t word = 0; word < count / 64; word++, values += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>)
+                    bits |= test<T, C>(load(values + j), c) << j;
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        template<typename T, Compare C>
+        TOAD_AVX2 static size_t compare(Compare_Tag<C>, const T *lhs, const T *rhs, size_t count, U64 *bitmap) {
+            for (size_t word = 0; word < count / 64; word++, lhs += 64, rhs += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>)
+                    bits |= test<T, C>(load(lhs + j), load(rhs + j)) << j;
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        template<typename T>
+        TOAD_AVX2 static size_t between(const T *values, size_t count, T low, T high, U64 *bitmap) {
+            const Reg<T> l = set1(low), h = set1(high);
+
+            for (size_t word = 0; word < count / 64; word++, values += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>) {
+                    const Reg<T> v = load(values + j);
+                    bits |= (test<T, Compare::Ge>(v, l) & test<T, Compare::Le>(v, h)) << j;
+                }
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        template<typename T>
+        TOAD_AVX2 static size_t in_list(const T *values, size_t count,
+                                        const T *list, size_t list_size, U64 *bitmap) {
+            for (size_t word = 0; word < count / 64; word++, values += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>) {
+                    const Reg<T> v = load(values + j);
+                    U64 lanes = 0;
+                    for (size_t k = 0; k < list_size; k++) lanes |= test<T, Compare::Eq>(v, set1(list[k]));
+                    bits |= lanes << j;
+                }
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        template<typename T>
+        TOAD_AVX2 static size_t aggregate(const T *values, size_t count, const U64 *bitmap, Aggregate<T> &acc) {
+            Acc<T> sum { };
+            Reg<T> low = set1(acc.min), high = set1(acc.max);
+            U64 vectorized = 0;
+
+            for (size_t word = 0; word < count / 64; word++) {
+                const T *block = values + word * 64;
+                const U64 bits = bitmap ? bitmap[word] : ~0ull;
+
+                if (bits != ~0ull) {
+                    scalar::aggregate_bits(block, bits, acc);
+                    continue;
+                }
+
+                for (size_t j = 0; j < 64; j += Lanes<T>) {
+                    const Reg<T> v = load(block + j);
+                    add_sum<T>(v, sum);
+                    low = min<T>(v, low);
+                    high = max<T>(v, high);
+                }
+                vectorized += 64;
+            }
+
+            if constexpr (std::is_floating_point_v<T>) {
+                F64 lanes[4];
+                _mm256_storeu_pd(lanes, sum);
+                acc.sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            } else {
+                U64 lanes[4];
+                _mm256_storeu_si256((__m256i*)lanes, sum);
+
+                U64 total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+                if constexpr (std::is_same_v<T, I8>) total -= 0x80 * vectorized;
+                if constexpr (std::is_same_v<T, U16>) total += 0x8000 * vectorized;
+                acc.sum = (Sum<T>)((U64)acc.sum + total);
+            }
+
+            T lows[Lanes<T>], highs[Lanes<T>];
+            store(lows, low);
+            store(highs, high);
+            for (size_t i = 0; i < Lanes<T>; i++) {
+                if (lows[i] < acc.min) acc.min = lows[i];
+                if (highs[i] > acc.max) acc.max = highs[i];
+            }
+            acc.count += vectorized;
+
+            return count / 64 * 64;
+        }
+
+        /**
+         * Every byte of the bitmap is expanded by `Selection_Lut` to 8 idxs.
+         * Stores are always of 8 idxs, but count of stored idxs is not greater
+         * than count of processed bits, so they never overflow the selection.
+         **/
+        TOAD_AVX2 static size_t bitmap_to_selection(const U64 *bitmap, size_t count, U32 *selection) {
+            size_t selected = 0;
+
+            for (size_t word = 0; word < count / 64; word++) {
+                U64 bits = bitmap[word];
+                if ((size_t)_mm_popcnt_u64(bits) < Sparse_Bits) {
+                    for (; bits; bits &= bits - 1) selection[selected++] = (U32)(word * 64 + std::countr_zero(bits));
+                    continue;
+                }
+
+                for (size_t byte = 0; byte < 8; byte++) {
+                    const U8 set = (U8)(bits >> (byte * 8));
+                    const __m256i idxs = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long)Selection_Lut[set]));
+
+                    _mm256_storeu_si256((__m256i*)(selection + selected),
+                                        _mm256_add_epi32(idxs, _mm256_set1_epi32((int)(word * 64 + byte * 8))));
+                    selected += _mm_popcnt_u32(set);
+                }
+            }
+
+            return scalar::bitmap_to_selection(bitmap, count / 64 * 64, count, selection, selected);
+        }
+    }
+
+    /**
+     * # AVX-512 kernels.
+     *
+     * 512 bit vectors, comparisons write mask registers directly. Partially
+     * selected blocks of the aggregation are handled by masked instructions.
+     **/
+    namespace avx512 {
+        /**
+         * Vector of `T`, sums are accumulated in the vectors of 64 bit lanes.
+         **/
+        template<typename T>
+        struct Vector { using Reg = __m512i; using Acc = __m512i; };
+
+        template<> struct Vector<F32> { using Reg = __m512; using Acc = __m512d; };
+        template<> struct Vector<F64> { using Reg = __m512d; using Acc = __m512d; };
+
+        template<typename T>
+        using Reg = typename Vector<T>::Reg;
+
+        template<typename T>
+        using Acc = typename Vector<T>::Acc;
+
+        template<typename T>
+        constexpr size_t Lanes = 64 / sizeof(T);
+
+        constexpr int predicate(Compare compare) {
+            switch (compare) {
+            case Compare::Eq: return _MM_CMPINT_EQ;
+            case Compare::Ne: return _MM_CMPINT_NE;
+            case Compare::Lt: return _MM_CMPINT_LT;
+            case Compare::Le: return _MM_CMPINT_LE;
+            case Compare::Gt: return _MM_CMPINT_NLE;
+            case Compare::Ge: return _MM_CMPINT_NLT;
+            }
+            return _MM_CMPINT_EQ;
+        }
+
+        template<typename T>
+        TOAD_AVX512 inline Reg<T> load(const T *p) {
+            if constexpr (is_f32<T>) return _mm512_loadu_ps(p);
+            else if constexpr (is_f64<T>) return _mm512_loadu_pd(p);
+            else return _mm512_loadu_si512(p);
+        }
+
+        template<typename T>
+        TOAD_AVX512 inline void store(T *p, Reg<T> v) {
+            if constexpr (is_f32<T>) _mm512_storeu_ps(p, v);
+            else if constexpr (is_f64<T>) _mm512_storeu_pd(p, v);
+            else _mm512_storeu_si512(p, v);
+        }
+
+        template<typename T>
+        TOAD_AVX512 inline Reg<T> set1(T value) {
+            if constexpr (is_f32<T>) return _mm512_set1_ps(value);
+            else if constexpr (is_f64<T>) return _mm512_set1_pd(value);
+            else if constexpr (sizeof(T) == 1) return _mm512_set1_epi8((char)value);
+            else if constexpr (sizeof(T) == 2) return _mm512_set1_epi16((short)value);
+            else if constexpr (sizeof(T) == 4) return _mm512_set1_epi32((int)value);
+            else return _mm512_set1_epi64((long long)value);
+        }
+
+        template<typename T, Compare C>
+        TOAD_AVX512 inline U64 test(Reg<T> a, Reg<T> b) {
+            constexpr int P = predicate(C), F = avx2::predicate(C);
+
+            if constexpr (is_f32<T>) return _mm512_cmp_ps_mask(a, b, F);
+            else if constexpr (is_f64<T>) return _mm512_cmp_pd_mask(a, b, F);
+            else if constexpr (std::is_same_v<T, U8>) return _mm512_cmp_epu8_mask(a, b, P);
+            else if constexpr (std::is_same_v<T, I8>) return _mm512_cmp_epi8_mask(a, b, P);
+            else if constexpr (std::is_same_v<T, U16>) return _mm512_cmp_epu16_mask(a, b, P);
+            else if constexpr (std::is_same_v<T, I16>) return _mm512_cmp_epi16_mask(a, b, P);
+            else if constexpr (std::is_same_v<T, U32>) return _mm512_cmp_epu32_mask(a, b, P);
+            else if constexpr (std::is_same_v<T, I32>) return _mm512_cmp_epi32_mask(a, b, P);
+            else if constexpr (std::is_same_v<T, U64>) return _mm512_cmp_epu64_mask(a, b, P);
+            else return _mm512_cmp_epi64_mask(a, b, P);
+        }
+
+        /**
+         * Lanes out of the mask are zero.
+         **/
+        template<typename T>
+        TOAD_AVX512 inline Reg<T> select(U64 mask, Reg<T> v) {
+            if constexpr (is_f32<T>) return _mm512_maskz_mov_ps((__mmask16)mask, v);
+            else if constexpr (is_f64<T>) return _mm512_maskz_mov_pd((__mmask8)mask, v);
+            else if constexpr (sizeof(T) == 1) return _mm512_maskz_mov_epi8(mask, v);
+            else if constexpr (sizeof(T) == 2) return _mm512_maskz_mov_epi16((__mmask32)mask, v);
+            else if constexpr (sizeof(T) == 4) return _mm512_maskz_mov_epi32((__mmask16)mask, v);
+            else return _mm512_maskz_mov_epi64((__mmask8)mask, v);
+        }
+
+        /**
+         * `min(a, b)` for the lanes in mask, `a` for others.
+         **/
+        template<typename T>
+        TOAD_AVX512 inline Reg<T> min(U64 mask, Reg<T> a, Reg<T> b) {
+            if constexpr (is_f32<T>) return _mm512_mask_min_ps(a, (__mmask16)mask, b, a);
+            else if constexpr (is_f64<T>) return _mm512_mask_min_pd(a, (__mmask8)mask, b, a);
+            else if constexpr (std::is_same_v<T, U8>) return _mm512_mask_min_epu8(a, mask, a, b);
+            else if constexpr (std::is_same_v<T, I8>) return _mm512_mask_min_epi8(a, mask, a, b);
+            else if constexpr (std::is_same_v<T, U16>) return _mm512_mask_min_epu16(a, (__mmask32)mask, a, b);
+            else if constexpr (std::is_same_v<T, I16>) return _mm512_mask_min_epi16(a, (__mmask32)mask, a, b);
+            else if constexpr (std::is_same_v<T, U32>) return _mm512_mask_min_epu32(a, (__mmask16)mask, a, b);
+            else if constexpr (std::is_same_v<T, I32>) return _mm512_mask_min_epi32(a, (__mmask16)mask, a, b);
+            else if constexpr (std::is_same_v<T, U64>) return _mm512_mask_min_epu64(a, (__mmask8)mask, a, b);
+            else return _mm512_mask_min_epi64(a, (__mmask8)mask, a, b);
+        }
+
+        template<typename T>
+        TOAD_AVX512 inline Reg<T> max(U64 mask, Reg<T> a, Reg<T> b) {
+            if constexpr (is_f32<T>) return _mm512_mask_max_ps(a, (__mmask16)mask, b, a);
+            else if constexpr (is_f64<T>) return _mm512_mask_max_pd(a, (__mmask8)mask, b, a);
+            else if constexpr (std::is_same_v<T, U8>) return _mm512_mask_max_epu8(a, mask, a, b);
+            else if constexpr (std::is_same_v<T, I8>) return _mm512_mask_max_epi8(a, mask, a, b);
+            else if constexpr (std::is_same_v<T, U16>) return _mm512_mask_max_epu16(a, (__mmask32)mask, a, b);
+            else if constexpr (std::is_same_v<T, I16>) return _mm512_mask_max_epi16(a, (__mmask32)mask, a, b);
+            else if constexpr (std::is_same_v<T, U32>) return _mm512_mask_max_epu32(a, (__mmask16)mask, a, b);
+            else if constexpr (std::is_same_v<T, I32>) return _mm512_mask_max_epi32(a, (__mmask16)mask, a, b);
+            else if constexpr (std::is_same_v<T, U64>) return _mm512_mask_max_epu64(a, (__mmask8)mask, a, b);
+            else return _mm512_mask_max_epi64(a, (__mmask8)mask, a, b);
+        }
+
+        /**
+         * @see sse4_2::add_sum.
+         **/
+        template<typename T>
+        TOAD_AVX512 inline void add_sum(Reg<T> v, Acc<T> &acc) {
+            if constexpr (is_f32<T>) {
+                acc = _mm512_add_pd(acc, _mm512_cvtps_pd(_mm512_castps512_ps256(v)));
+                acc = _mm512_add_pd(acc, _mm512_cvtps_pd(_mm512_extractf32x8_ps(v, 1)));
+            } else if constexpr (is_f64<T>) {
+                acc = _mm512_add_pd(acc, v);
+            } else if constexpr (sizeof(T) == 1) {
+                if constexpr (std::is_signed_v<T>) v = _mm512_xor_si512(v, _mm512_set1_epi8((char)0x80));
+                acc = _mm512_add_epi64(acc, _mm512_sad_epu8(v, _mm512_setzero_si512()));
+            } else if constexpr (sizeof(T) == 2) {
+                if constexpr (std::is_unsigned_v<T>) v = _mm512_xor_si512(v, _mm512_set1_epi16((short)0x8000));
+                const __m512i pairs = _mm512_madd_epi16(v, _mm512_set1_epi16(1));
+                acc = _mm512_add_epi64(acc, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(pairs)));
+                acc = _mm512_add_epi64(acc, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(pairs, 1)));
+            } else if constexpr (sizeof(T) == 4) {
+                if constexpr (std::is_signed_v<T>) {
+                    acc = _mm512_add_epi64(acc, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)));
+                    acc = _mm512_add_epi64(acc, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+                } else {
+                    acc = _mm512_add_epi64(acc, _mm512_cvtepu32_epi64(_mm512_castsi512_si256(v)));
+                    acc = _mm512_add_epi64(acc, _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+                }
+            } else {
+                acc = _mm512_add_epi64(acc, v);
+            }
+        }
+
+        template<typename T, Compare C>
+        TOAD_AVX512 static size_t compare_const(Compare_Tag<C>, const T *values, size_t count, T constant, U64 *bitmap) {
+            const Reg<T> c = set1(constant);
+
+            for (size_t word = 0; word < count / 64; word++, values += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>)
+                    bits |= test<T, C>(load(values + j), c) << j;
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        template<typename T, Compare C>
+        TOAD_AVX512 static size_t compare(Compare_Tag<C>, const T *lhs, const T *rhs, size_t count, U64 *bitmap) {
+            for (size_t word = 0; word < count / 64; word++, lhs += 64, rhs += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>)
+                    bits |= test<T, C>(load(lhs + j), load(rhs + j)) << j;
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        template<typename T>
+        TOAD_AVX512 static size_t between(const T *values, size_t count, T low, T high, U64 *bitmap) {
+            const Reg<T> l = set1(low), h = set1(high);
+
+            for (size_t word = 0; word < count / 64; word++, values += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>) {
+                    const Reg<T> v = load(values + j);
+                    bits |= (test<T, Compare::Ge>(v, l) & test<T, Compare::Le>(v, h)) << j;
+                }
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        template<typename T>
+        TOAD_AVX512 static size_t in_list(const T *values, size_t count,
+                                          const T *list, size_t list_size, U64 *bitmap) {
+            for (size_t word = 0; word < count / 64; word++, values += 64) {
+                U64 bits = 0;
+                for (size_t j = 0; j < 64; j += Lanes<T>) {
+                    const Reg<T> v = load(values + j);
+                    U64 lanes = 0;
+                    for (size_t k = 0; k < list_size; k++) lanes |= test<T, Compare::Eq>(v, set1(list[k]));
+                    bits |= lanes << j;
+                }
+                bitmap[word] = bits;
+            }
+            return count / 64 * 64;
+        }
+
+        /**
+         * Lanes out of the bitmap are zeroed before the sum, the bias
+         * of `I8` and `U16` (@see sse4_2::add_sum) is applied to all lanes,
+         * so zeroed lanes are adding nothing.
+         **/
+        template<typename T>
+        TOAD_AVX512 static size_t aggregate(const T *values, size_t count, const U64 *bitmap, Aggregate<T> &acc) {
+            constexpr U64 all = Lanes<T> == 64 ? ~0ull : (1ull << Lanes<T>) - 1;
+
+            Acc<T> sum { };
+            Reg<T> low = set1(acc.min), high = set1(acc.max);
+            U64 lanes_summed = 0;
+
+            for (size_t word = 0; word < count / 64; word++) {
+                const T *block = values + word * 64;
+                const U64 bits = bitmap ? bitmap[word] : ~0ull;
+                if (bits == 0) continue;
+
+                for (size_t j = 0; j < 64; j += Lanes<T>) {
+                    const U64 mask = (bits >> j) & all;
+                    const Reg<T> v = load(block + j);
+
+                    add_sum<T>(select<T>(mask, v), sum);
+                    low = min<T>(mask, low, v);
+                    high = max<T>(mask, high, v);
+                }
+                lanes_summed += 64;
+                acc.count += std::popcount(bits);
+            }
+
+            if constexpr (std::is_floating_point_v<T>) {
+                acc.sum += _mm512_reduce_add_pd(sum);
+            } else {
+                U64 total = (U64)_mm512_reduce_add_epi64(sum);
+                if constexpr (std::is_same_v<T, I8>) total -= 0x80 * lanes_summed;
+                if constexpr (std::is_same_v<T, U16>) total += 0x8000 * lanes_summed;
+                acc.sum = (Sum<T>)((U64)acc.sum + total);
+            }
+
+            T lows[Lanes<T>], highs[Lanes<T>];
+            store(lows, low);
+            store(highs, high);
+            for (size_t i = 0; i < Lanes<T>; i++) {
+                if (lows[i] < acc.min) acc.min = lows[i];
+                if (highs[i] > acc.max) acc.max = highs[i];
+            }
+
+            return count / 64 * 64;
+        }
+
+        /**
+         * Idxs of the 16 rows are compressed by the 16 bits of the bitmap.
+         * @see avx2::bitmap_to_selection.
+         **/
+        TOAD_AVX512 static size_t bitmap_to_selection(const U64 *bitmap, size_t count, U32 *selection) {
+            const __m512i steps = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+            size_t selected = 0;
+
+            for (size_t word = 0; word < count / 64; word++) {
+                U64 bits = bitmap[word];
+                if ((size_t)_mm_popcnt_u64(bits) < Sparse_Bits) {
+                    for (; bits; bits &= bits - 1) selection[selected++] = (U32)(word * 64 + std::countr_zero(bits));
+                    continue;
+                }
+
+                for (size_t part = 0; part < 4; part++) {
+                    const __mmask16 set = (__mmask16)(bits >> (part * 16));
+                    const __m512i idxs = _mm512_add_epi32(steps, _mm512_set1_epi32((int)(word * 64 + part * 16)));
+
+                    _mm512_storeu_si512(selection + selected, _mm512_maskz_compress_epi32(set, idxs));
+                    selected += _mm_popcnt_u32(set);
+                }
+            }
+
+            return scalar::bitmap_to_selection(bitmap, count / 64 * 64, count, selection, selected);
+        }
+    }
+#endif
+
+    /**
+     * Call `fn` with `Compare` as compile time constant.
+     **/
+    template<typename Fn>
+    static void with_compare(Compare compare, Fn fn) {
+        switch (compare) {
+        case Compare::Eq: fn(Compare_Tag<Compare::Eq> { }); break;
+        case Compare::Ne: fn(Compare_Tag<Compare::Ne> { }); break;
+        case Compare::Lt: fn(Compare_Tag<Compare::Lt> { }); break;
+        case Compare::Le: fn(Compare_Tag<Compare::Le> { }); break;
+        case Compare::Gt: fn(Compare_Tag<Compare::Gt> { }); break;
+        case Compare::Ge: fn(Compare_Tag<Compare::Ge> { }); break;
+        }
+    }
+
+    /**
+     * Vector kernels are processing whole words of the bitmap and return
+     * count of processed rows, rest of the rows is processed by scalar kernel.
+     **/
+#ifdef TOAD_SIMD_X86
+#   define TOAD_DISPATCH(done, kernel, ...)                                      \
+        switch (level()) {                                                       \
+        case Level::AVX512: done = avx512::kernel(__VA_ARGS__); break;           \
+        case Level::AVX2:   done = avx2::kernel(__VA_ARGS__);   break;           \
+        case Level::SSE4_2: done = sse4_2::kernel(__VA_ARGS__); break;           \
+        case Level::Scalar:                                     break;           \
+        }
+#else
+#   define TOAD_DISPATCH(done, kernel, ...)
+#endif
+
+    template<typename T>
+    void compare_const(const T *values, size_t count, Compare compare, T constant, U64 *bitmap) {
+        with_compare(compare, [&](auto c) {
+            constexpr Compare C = decltype(c)::value;
+
+            size_t done = 0;
+            TOAD_DISPATCH(done, compare_const, c, values, count, constant, bitmap);
+            scalar::compare_const<T, C>(values, done, count, constant, bitmap);
+        });
+    }
+
+    template<typename T>
+    void compare(const T *lhs, const T *rhs, size_t count, Compare compare, U64 *bitmap) {
+        with_compare(compare, [&](auto c) {
+            constexpr Compare C = decltype(c)::value;
+
+            size_t done = 0;
+            TOAD_DISPATCH(done, compare, c, lhs, rhs, count, bitmap);
+            scalar::compare<T, C>(lhs, rhs, done, count, bitmap);
+        });
+    }
+
+    template<typename T>
+    void between(const T *values, size_t count, T low, T high, U64 *bitmap) {
+        size_t done = 0;
+        TOAD_DISPATCH(done, between, values, count, low, high, bitmap);
+        scalar::between<T>(values, done, count, low, high, bitmap);
+    }
+
+    template<typename T>
+    void in_list(const T *values, size_t count, const T *list, size_t list_size, U64 *bitmap) {
+        size_t done = 0;
+        TOAD_DISPATCH(done, in_list, values, count, list, list_size, bitmap);
+        scalar::in_list<T>(values, done, count, list, list_size, bitmap);
+    }
+
+    template<typename T>
+    void aggregate(const T *values, size_t count, const U64 *bitmap, Aggregate<T> &acc) {
+        size_t done = 0;
+        TOAD_DISPATCH(done, aggregate, values, count, bitmap, acc);
+        scalar::aggregate<T>(values, done, count, bitmap, acc);
+    }
+
+    size_t popcount(const U64 *bitmap, size_t count) {
+        size_t done = 0, result = 0;
+#ifdef TOAD_SIMD_X86
+        switch (level()) {
+        case Level::AVX512:
+        case Level::AVX2:
+        case Level::SSE4_2: result = sse4_2::popcount(bitmap, count); done = count / 64 * 64; break;
+        case Level::Scalar: break;
+        }
+#endif
+        return result + scalar::popcount(bitmap, done, count);
+    }
+
+    size_t bitmap_to_selection(const U64 *bitmap, size_t count, U32 *selection) {
+#ifdef TOAD_SIMD_X86
+        switch (level()) {
+        case Level::AVX512: return avx512::bitmap_to_selection(bitmap, count, selection);
+        case Level::AVX2:   return avx2::bitmap_to_selection(bitmap, count, selection);
+        case Level::SSE4_2: return sse4_2::bitmap_to_selection(bitmap, count, selection);
+        case Level::Scalar: break;
+        }
+#endif
+        return scalar::bitmap_to_selection(bitmap, 0, count, selection, 0);
+    }
+
+#undef TOAD_DISPATCH
+
+#define TOAD_INSTANTIATE(T)                                                                  \
+    template void compare_const<T>(const T*, size_t, Compare, T, U64*);                      \
+    template void compare<T>(const T*, const T*, size_t, Compare, U64*);                     \
+    template void between<T>(const T*, size_t, T, T, U64*);                                  \
+    template void in_list<T>(const T*, size_t, const T*, size_t, U64*);                      \
+    template void aggregate<T>(const T*, size_t, const U64*, Aggregate<T>&);
+
+    TOAD_INSTANTIATE(U8)  TOAD_INSTANTIATE(U16) TOAD_INSTANTIATE(U32) TOAD_INSTANTIATE(U64)
+    TOAD_INSTANTIATE(I8)  TOAD_INSTANTIATE(I16) TOAD_INSTANTIATE(I32) TOAD_INSTANTIATE(I64)
+    TOAD_INSTANTIATE(F32) TOAD_INSTANTIATE(F64)
+
+#undef TOAD_INSTANTIATE
+}
@@ -0,0 +1,135 @@
+#ifndef simd_hpp_INCLUDED
+#define simd_hpp_INCLUDED
+
+#include <common.hpp>
+#include <limits>
+#include <type_traits>
+
+namespace toad_db::interact {
+
+    /**
+     * # SIMD kernels.
+     *
+     * Innermost loops of the filters and aggregates over contiguous typed
+     * vectors (@see vectorized::Column_Vector). Every kernel has hand-written
+     * SSE4.2, AVX2 and AVX-512 implementations and the portable scalar one,
+     * the best supported path is detected once with CPUID:
+     *
+     * ```cpp
+     * U64 bitmap[Batch_Size / 64];
+     * simd::compare_const<U8>(levels, count, simd::Compare::Gt, 1, bitmap);
+     * size_t selected = simd::bitmap_to_selection(bitmap, count, selection);
+     * ```
+     *
+     * Results of the comparisons are bitmaps, bit `i % 64` of the word `i / 64`
+     * is set when the row `i` matched. Bits after `count` are zero.
+     *
+     * Kernels are instantiated for `U8`..`U64`, `I8`..`I64`, `F32` and `F64`
+     * (`Bool` values are `U8`).
+     **/
+    namespace simd {
+        enum class Level: char {
+            Scalar, SSE4_2, AVX2, AVX512
+        };
+
+        const char* to_string(Level level);
+
+        /**
+         * Best level supported by the CPU.
+         **/
+        Level detect(void);
+
+        /**
+         * Level used by the kernels, detected on the first call.
+         **/
+        Level level(void);
+
+        class Unsupported_Level: public Toad_Exception {
+            public:
+                Unsupported_Level(Level level):
+                    Toad_Exception(std::string("Level `") + to_string(level) + "` is not supported by CPU") { }
+        };
+
+        /**
+         * Force the level of kernels (to compare implementations).
+         *
+         * @throws Unsupported_Level if level is higher than detected one.
+         **/
+        void set_level(Level level) noexcept(false);
+
+        enum class Compare: char {
+            Eq, Ne, Lt, Le, Gt, Ge
+        };
+
+        /**
+         * Count of words in bitmap of `count` rows.
+         **/
+        constexpr size_t bitmap_words(size_t count) { return (count + 63) / 64; }
+
+        /**
+         * `values[i] <compare> constant`.
+         **/
+        template<typename T>
+        void compare_const(const T *values, size_t count, Compare compare, T constant, types::U64 *bitmap);
+
+        /**
+         * `lhs[i] <compare> rhs[i]`.
+         **/
+        template<typename T>
+        void compare(const T *lhs, const T *rhs, size_t count, Compare compare, types::U64 *bitmap);
+
+        /**
+         * `low <= values[i] && values[i] <= high`.
+         **/
+        template<typename T>
+        void between(const T *values, size_t count, T low, T high, types::U64 *bitmap);
+
+        /**
+         * `values[i]` is equal to one of the `list` values.
+         **/
+        template<typename T>
+        void in_list(const T *values, size_t count, const T *list, size_t list_size, types::U64 *bitmap);
+
+        /**
+         * Type of the sum, integers are summed modulo 2^64.
+         **/
+        template<typename T>
+        using Sum = std::conditional_t<std::is_floating_point_v<T>, types::F64,
+                        std::conditional_t<std::is_signed_v<T>, types::I64, types::U64>>;
+
+        template<typename T>
+        struct Aggregate {
+            Sum<T> sum = 0;
+            T min = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                         : std::numeric_limits<T>::max();
+            T max = std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                         : std::numeric_limits<T>::lowest();
+            types::U64 count = 0;
+        };
+
+        /**
+         * Sum, min, max and count of the values, accumulated to `acc`.
+         * NaNs are ignored by min and max. Order of the float additions
+         * depends on the level.
+         *
+         * @param bitmap - only selected values are aggregated (nullptr for all).
+         **/
+        template<typename T>
+        void aggregate(const T *values, size_t count, const types::U64 *bitmap, Aggregate<T> &acc);
+
+        /**
+         * Count of set bits of the first `count` bits.
+         **/
+        size_t popcount(const types::U64 *bitmap, size_t count);
+
+        /**
+         * Convert bitmap to the idxs of set bits.
+         *
+         * @param selection - idxs in ascending order (capacity at least `count`).
+         * @return count of selected rows.
+         **/
+        size_t bitmap_to_selection(const types::U64 *bitmap, size_t count, types::U32 *selection);
+    }
+}
+
+#endif // simd_hpp_INCLUDED
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <interpreter.hpp>
+#include <statistics.hpp>
+
+namespace toad_db::interact::plan {
+    using namespace types;
+
+    void Hyper_Log_Log::merge(const Hyper_Log_Log &other) {
+        for (size_t i = 0; i < Registers; i++) _registers[i] = std::max(_registers[i], other._registers[i]);
+    }
+
+    double Hyper_Log_Log::estimate(void) const {
+        const double m = Registers;
+        const double alpha = 0.7213 / (1 + 1.079 / m);
+
+        double sum = 0;
+        size_t zeros = 0;
+        for (auto reg: _registers) {
+            sum += std::ldexp(1.0, -reg);
+            zeros += reg == 0;
+        }
+
+        const double raw = alpha * m * m / sum;
+
+        // Linear counting is more precise for the small counts.
+        if (raw <= 2.5 * m && zeros != 0) return m * std::log(m / zeros);
+        return raw;
+    }
+
+    Histogram::Histogram(std::vector<double> values, size_t buckets) {
+        // NaN isn't ordered with the numbers, so it can't be sorted or bucketed.
+        std::erase_if(values, [](double value) { return std::isnan(value); });
+
+        if (values.empty() || buckets == 0) return;
+        std::sort(values.begin(), values.end());
+
+        buckets = std::min(buckets, values.size());
+        for (size_t i = 0; i <= buckets; i++) {
+            _bounds.push_back(values[std::min(i * values.size() / buckets, values.size() - 1)]);
+        }
+    }
+
+    double Histogram::fraction_below(double value, bool inclusive) const {
+        if (_bounds.empty()) return 0.5;
+
+        if (value < _bounds.front() || (!inclusive && value == _bounds.front())) return 0;
+        if (value > _bounds.back() || (inclusive && value == _bounds.back())) return 1;
+
+        const size_t buckets = _bounds.size() - 1;
+
+        // Bucket of the value, values are uniform inside it.
+        const auto upper = inclusive ? std::upper_bound(_bounds.begin(), _bounds.end(), value)
+                                     : std::lower_bound(_bounds.begin(), _bounds.end(), value);
+        const size_t bucket = std::min((size_t)(upper - _bounds.begin()), buckets) - 1;
+
+        const double low = _bounds[bucket], high = _bounds[bucket + 1];
+        const double inside = high > low ? (value - low) / (high - low) : (inclusive ? 1.0 : 0.0);
+
+        return std::clamp((bucket + inside) / buckets, 0.0, 1.0);
+    }
+
+    template<typename T>
+    static double read(const U8 *data) {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return (double)value;
+    }
+
+    static bool to_number(const Domain &domain, const U8 *data, double &out) {
+        switch (domain.variant) {
+        case Domain::Variant::U8:   out = read<U8>(data); return true;
+        case Domain::Variant::U16:  out = read<U16>(data); return true;
+        case Domain::Variant::U32:  out = read<U32>(data); return true;
+        case Domain::Variant::U64:  out = read<U64>(data); return true;
+        case Domain::Variant::I8:   out = read<I8>(data); return true;
+        case Domain::Variant::I16:  out = read<I16>(data); return true;
+        case Domain::Variant::I32:  out = read<I32>(data); return true;
+        case Domain::Variant::I64:  out = read<I64>(data); return true;
+        case Domain::Variant::F32:  out = read<F32>(data); return true;
+        case Domain::Variant::F64:  out = read<F64>(data); return true;
+        case Domain::Variant::Bool: out = read<Bool>(data); return true;
+        default:                    return false;
+        }
+    }
+
+    Table_Statistics::Table_Statistics(const Table &table): _table(&table), _columns(table.columns().size()) {
+        for (size_t i = 0; i < _columns.size(); i++)
+            _columns[i].numeric = Domain::is_basic(table.columns()[i].domain->variant);
+    }
+
+    U64 Table_Statistics::next_random(void) {
+        _random ^= _random << 13;
+        _random ^= _random >> 7;
+        _random ^= _random << 17;
+        return _random;
+    }
+
+    void Table_Statistics::update(void) {
+        const size_t size = _table->size();
+        if (size <= _rows) return;
+
+        for (size_t c = 0; c < _columns.size(); c++) {
+            Column_Statistics &column = _columns[c];
+            const Domain &domain = *_table->columns()[c].domain;
+            const size_t offset = _table->column_offset(c), value_size = domain.size_of();
+
+            for (size_t row = _rows; row < size; row++) {
+                const U8 *data = _table->row_data(row) + offset;
+                column.distinct.add(hash_bytes(data, value_size));
+
+                double value;
+                if (!column.numeric || !to_number(domain, data, value)) continue;
+
+                if (std::isnan(value)) {
+                    column.nans++;
+                    continue;
+                }
+
+                if (column.numbers++ == 0) column.min = column.max = value;
+                column.min = std::min(column.min, value);
+                column.max = std::max(column.max, value);
+
+                if (column.sample.size() < Sample_Size) {
+                    column.sample.push_back(value);
+                } else {
+                    const size_t idx = next_random() % column.numbers;
+                    if (idx < Sample_Size) column.sample[idx] = value;
+                }
+            }
+
+            if (column.numeric) column.histogram = Histogram { column.sample, Buckets };
+        }
+
+        _rows = size;
+    }
+
+    void Table_Statistics::analyze(void) {
+        *this = Table_Statistics { *_table };
+        update();
+    }
+}
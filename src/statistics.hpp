@@ -0,0 +1,153 @@
+#ifndef statistics_hpp_INCLUDED
+#define statistics_hpp_INCLUDED
+
+#include <array>
+#include <common.hpp>
+#include <vector>
+
+namespace toad_db::interact::plan {
+
+    /**
+     * # HyperLogLog sketch of the count of distinct values.
+     *
+     * Values are added by their hashes, the sketch has fixed size
+     * (`Registers` bytes) and the error about `1.04 / sqrt(Registers)`,
+     * so it's ~2% for any count of values. Sketches of the parts are merged.
+     **/
+    class Hyper_Log_Log {
+        public:
+            static constexpr size_t Precision = 11;
+            static constexpr size_t Registers = (size_t)1 << Precision;
+
+            void add(types::U64 hash) {
+                const size_t idx = hash >> (64 - Precision);
+                const types::U64 rest = (hash << Precision) | ((types::U64)1 << (Precision - 1));
+
+                const types::U8 rank = (types::U8)(__builtin_clzll(rest) + 1);
+                if (rank > _registers[idx]) _registers[idx] = rank;
+            }
+
+            void merge(const Hyper_Log_Log &other);
+
+            /**
+             * Estimated count of distinct added values.
+             **/
+            double estimate(void) const;
+
+        private:
+            std::array<types::U8, Registers> _registers { };
+    };
+
+    /**
+     * # Equi-depth histogram.
+     *
+     * Bounds of the buckets with the same count of values in each, so
+     * ranges of the frequent values are narrow and estimation of the range
+     * predicates doesn't depend on the skew.
+     **/
+    class Histogram {
+        public:
+            Histogram() = default;
+
+            /**
+             * @param values - values (or uniform sample of them), NaNs are skipped.
+             * @param buckets - max count of buckets.
+             **/
+            Histogram(std::vector<double> values, size_t buckets);
+
+            bool empty(void) const { return _bounds.empty(); }
+
+            /**
+             * Estimated fraction of the values less than `value`
+             * (or equal to it if `inclusive`).
+             **/
+            double fraction_below(double value, bool inclusive) const;
+
+            /**
+             * `buckets + 1` bounds, the first one is min and the last one is max.
+             **/
+            const std::vector<double>& bounds(void) const { return _bounds; }
+
+        private:
+            std::vector<double> _bounds;
+    };
+
+    struct Column_Statistics {
+        Hyper_Log_Log distinct;
+
+        /**
+         * Column is of basic domain, `min`, `max` and histogram are known.
+         **/
+        bool numeric = false;
+        double min = 0, max = 0;
+
+        /**
+         * Count of the numbers and of the NaNs, NaNs aren't in `min`, `max`,
+         * sample and histogram, they match no range.
+         **/
+        size_t numbers = 0, nans = 0;
+
+        /**
+         * Uniform sample of the values (reservoir), histogram is built from it.
+         **/
+        std::vector<double> sample;
+        Histogram histogram;
+
+        /**
+         * Estimated count of distinct values.
+         **/
+        double distinct_count(void) const { return distinct.estimate(); }
+    };
+
+    /**
+     * # Statistics of the table.
+     *
+     * Rows are counted and sketched once: `update` takes only rows appended
+     * since the previous call, so statistics are kept up to date on inserts
+     * for the cost of the new rows. `analyze` rebuilds them from scratch
+     * after rows were changed or removed in place.
+     **/
+    class Table_Statistics {
+        public:
+            static constexpr size_t Sample_Size = 1024;
+            static constexpr size_t Buckets = 32;
+
+            /**
+             * Table must outlive the statistics.
+             **/
+            explicit Table_Statistics(const Table &table);
+
+            /**
+             * Take rows appended since the last update.
+             **/
+            void update(void);
+
+            /**
+             * Rebuild statistics of all rows.
+             **/
+            void analyze(void);
+
+            /**
+             * Count of the rows taken into the statistics.
+             **/
+            size_t rows(void) const { return _rows; }
+
+            const Column_Statistics& column(size_t idx) const { return _columns[idx]; }
+
+            const Table& table(void) const { return *_table; }
+
+        private:
+            const Table *_table;
+            size_t _rows = 0;
+            std::vector<Column_Statistics> _columns;
+
+            /**
+             * State of the generator for the reservoir sampling.
+             **/
+            types::U64 _random = 0x9E3779B97F4A7C15ull;
+
+            types::U64 next_random(void);
+    };
+}
+
+#endif // statistics_hpp_INCLUDED
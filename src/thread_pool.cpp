@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <thread_pool.hpp>
+
+namespace toad_db::interact {
+    /**
+     * Pool and slot of the worker executing current thread.
+     **/
+    static thread_local const Thread_Pool *current_pool = nullptr;
+    static thread_local size_t current_worker = 0;
+
+    Thread_Pool::Thread_Pool(size_t threads) {
+        if (threads == 0) threads = 1;
+
+        for (size_t i = 0; i < threads; i++) {
+            _queues.push_back(std::make_unique<Queue>());
+        }
+
+        for (size_t i = 0; i + 1 < threads; i++) {
+            _workers.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    Thread_Pool::~Thread_Pool() {
+        {
+            std::lock_guard lock { _sleep_mutex };
+            _stop = true;
+        }
+        _wake.notify_all();
+
+        for (auto &worker: _workers) worker.join();
+    }
+
+    bool Thread_Pool::try_pop(size_t self, Job &job, const Batch *batch) {
+        if (_queued.load(std::memory_order_acquire) == 0) return false;
+
+        auto of_batch = [batch](const Job &queued) { return !batch || queued.batch == batch; };
+
+        {
+            auto &own = *_queues[self];
+            std::lock_guard lock { own.mutex };
+            auto it = std::find_if(own.jobs.rbegin(), own.jobs.rend(), of_batch);
+            if (it != own.jobs.rend()) {
+                job = std::move(*it);
+                own.jobs.erase(std::next(it).base());
+                _queued--;
+                return true;
+            }
+        }
+
+        for (size_t i = 1; i < _queues.size(); i++) {
+            auto &victim = *_queues[(self + i) % _queues.size()];
+            std::lock_guard lock { victim.mutex };
+            auto it = std::find_if(victim.jobs.begin(), victim.jobs.end(), of_batch);
+            if (it != victim.jobs.end()) {
+                job = std::move(*it);
+                victim.jobs.erase(it);
+                _queued--;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void Thread_Pool::execute(size_t self, Job &job) {
+        try {
+            job.task(self);
+        } catch (...) {
+            std::lock_guard lock { job.batch->error_mutex };
+            if (!job.batch->error) job.batch->error = std::current_exception();
+        }
+        job.batch->remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    void Thread_Pool::worker_loop(size_t self) {
+        current_pool = this;
+        current_worker = self;
+
+        Job job;
+        while (true) {
+            if (try_pop(self, job)) {
+                execute(self, job);
+                continue;
+            }
+
+            std::unique_lock lock { _sleep_mutex };
+            _wake.wait(lock, [this] { return _stop || _queued.load() > 0; });
+            if (_stop) return;
+        }
+    }
+
+    void Thread_Pool::run(std::vector<Task> &tasks) {
+        if (tasks.empty()) return;
+
+        // Threads out of the pool share the last slot. Waiting threads execute
+        // only tasks of their own batch, so a slot is never used by two tasks of
+        // one batch at once: by two callers, or by a nested batch and its outer one.
+        const Thread_Pool *caller_pool = current_pool;
+        const size_t caller_worker = current_worker;
+        if (current_pool != this) {
+            current_pool = this;
+            current_worker = size() - 1;
+        }
+        const size_t self = current_worker;
+
+        Batch batch { };
+        batch.remaining = tasks.size();
+
+        for (size_t i = 0; i < tasks.size(); i++) {
+            auto &queue = *_queues[(self + i) % _queues.size()];
+            std::lock_guard lock { queue.mutex };
+            queue.jobs.push_back({ std::move(tasks[i]), &batch });
+            _queued++;
+        }
+        {
+            std::lock_guard lock { _sleep_mutex };
+        }
+        _wake.notify_all();
+
+        Job job;
+        while (batch.remaining.load(std::memory_order_acquire) > 0) {
+            if (try_pop(self, job, &batch)) {
+                execute(self, job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+        current_pool = caller_pool;
+        current_worker = caller_worker;
+
+        tasks.clear();
+        if (batch.error) std::rethrow_exception(batch.error);
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef thread_pool_hpp_INCLUDED
+#define thread_pool_hpp_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace toad_db::interact {
+
+    /**
+     * # Work stealing thread pool.
+     *
+     * Every worker owns a deque of tasks. The owner pops tasks from the back
+     * of it's own deque, and when it's empty, steals from the front of the
+     * others. So big batches of small tasks (morsels) are balanced between
+     * threads without one central queue.
+     *
+     * The thread which calls `run` also executes tasks of the batch, callers
+     * out of the pool use the last slot (`size() - 1`), batches of the tasks
+     * may be nested. While it waits, the caller executes only tasks of its
+     * own batch, so a slot runs one task of the batch at a time and states
+     * of the batch can be indexed by worker idx:
+     *
+     * ```cpp
+     * Thread_Pool pool { };
+     * std::vector<size_t> partial(pool.size(), 0);
+     *
+     * std::vector<Thread_Pool::Task> tasks;
+     * for (size_t i = 0; i < 100; i++)
+     *     tasks.push_back([&, i](size_t worker) { partial[worker] += i; });
+     *
+     * pool.run(tasks);
+     * ```
+     **/
+    class Thread_Pool {
+        public:
+            /**
+             * Task gets idx of the worker which executes it.
+             **/
+            using Task = std::function<void (size_t worker)>;
+
+            /**
+             * Spawn workers.
+             *
+             * @param threads - count of threads including the calling one.
+             **/
+            explicit Thread_Pool(size_t threads = std::thread::hardware_concurrency());
+
+            ~Thread_Pool();
+
+            Thread_Pool(const Thread_Pool&) = delete;
+            Thread_Pool& operator=(const Thread_Pool&) = delete;
+
+            /**
+             * Count of worker slots (spawned workers + caller).
+             **/
+            size_t size(void) const { return _queues.size(); }
+
+            /**
+             * Execute all tasks and wait until they are finished.
+             *
+             * Can be called from the task itself (nested batches) and from
+             * several threads out of the pool at once. If any task throws, then first exception is rethrown there
+             * after the whole batch is finished.
+             *
+             * @param tasks - tasks to execute.
+             **/
+            void run(std::vector<Task> &tasks);
+
+        private:
+            struct Batch {
+                std::atomic<size_t> remaining;
+                std::mutex error_mutex;
+                std::exception_ptr error;
+            };
+
+            struct Job {
+                Task task;
+                Batch *batch;
+            };
+
+            struct Queue {
+                std::mutex mutex;
+                std::deque<Job> jobs;
+            };
+
+            std::vector<std::unique_ptr<Queue>> _queues;
+            std::vector<std::thread> _workers;
+
+            std::mutex _sleep_mutex;
+            std::condition_variable _wake;
+            std::atomic<size_t> _queued { 0 };
+            bool _stop = false;
+
+            /**
+             * Pop a job of the batch, or of any batch if it's null.
+             **/
+            bool try_pop(size_t self, Job &job, const Batch *batch = nullptr);
+            void execute(size_t self, Job &job);
+            void worker_loop(size_t self);
+    };
+}
+
+#endif // thread_pool_hpp_INCLUDED
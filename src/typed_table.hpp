@@ -0,0 +1,282 @@
+#ifndef typed_table_hpp_INCLUDED
+#define typed_table_hpp_INCLUDED
+
+#include <array>
+#include <common.hpp>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace toad_db {
+
+    /**
+     * String literal usable as a template argument: `Field<"name", typed::Str>`.
+     **/
+    template<size_t N>
+    struct Fixed_String {
+        char data[N] { };
+
+        constexpr Fixed_String(const char (&str)[N]) {
+            for (size_t i = 0; i < N; i++) data[i] = str[i];
+        }
+
+        constexpr std::string_view view(void) const { return { data, N - 1 }; }
+    };
+
+    /**
+     * # Domains of the typed tables.
+     *
+     * Every domain is a tag with the name of the runtime domain
+     * (@see Domain::default_domains) and the C++ type of the same layout.
+     **/
+    namespace typed {
+
+        template<typename Type, Fixed_String Name>
+        struct Basic {
+            using type = Type;
+            static constexpr std::string_view domain_name = Name.view();
+        };
+
+        using U8   = Basic<types::U8, "U8">;
+        using U16  = Basic<types::U16, "U16">;
+        using U32  = Basic<types::U32, "U32">;
+        using U64  = Basic<types::U64, "U64">;
+        using Key  = Basic<types::U64, "Key">;
+        using I8   = Basic<types::I8, "I8">;
+        using I16  = Basic<types::I16, "I16">;
+        using I32  = Basic<types::I32, "I32">;
+        using I64  = Basic<types::I64, "I64">;
+        using F32  = Basic<types::F32, "F32">;
+        using F64  = Basic<types::F64, "F64">;
+        using Bool = Basic<types::Bool, "Bool">;
+
+        /**
+         * Array of `I8` of the `Capacity`: counter of the length and the chars.
+         **/
+        template<size_t Capacity>
+        class String_Value {
+            public:
+                static constexpr size_t Counter_Size = Domain::counter_size_of(Capacity);
+
+                class String_Too_Long: public Toad_Exception {
+                    public:
+                        String_Too_Long(size_t size):
+                            Toad_Exception("String of " + std::to_string(size) + " chars is longer than "
+                                            + std::to_string(Capacity) + " chars") { }
+                };
+
+                size_t size(void) const { return Domain::get_counter((types::U8*)_bytes, Capacity); }
+
+                std::string_view view(void) const { return { (const char*)_bytes + Counter_Size, size() }; }
+                operator std::string_view(void) const { return view(); }
+
+                /**
+                 * @throws String_Too_Long if string doesn't fit the capacity.
+                 **/
+                String_Value& operator=(std::string_view str) noexcept(false) {
+                    if (str.size() > Capacity) throw String_Too_Long(str.size());
+
+                    Domain::set_counter(_bytes, Capacity, str.size());
+                    std::memcpy(_bytes + Counter_Size, str.data(), str.size());
+                    return *this;
+                }
+
+            private:
+                types::U8 _bytes[Counter_Size + Capacity];
+        };
+
+        template<size_t Capacity, Fixed_String Name>
+        struct String {
+            using type = String_Value<Capacity>;
+            static constexpr std::string_view domain_name = Name.view();
+        };
+
+        using Str     = String<64, "Str">;
+        using Text    = String<1024, "Text">;
+        using BigText = String<0xFFFF, "BigText">;
+
+        /**
+         * Variants of the `Month` in the order of the domain.
+         **/
+        enum class Month_Value: types::U8 {
+            jan, feb, mar, apr, may, jul, jun, aug, sep, oct, nov, dec,
+        };
+
+        struct Date_Value {
+            types::U8 day;
+            Month_Value month;
+            types::U16 year;
+            types::U32 time;
+        };
+
+        using Month = Basic<Month_Value, "Month">;
+        using Date = Basic<Date_Value, "Date">;
+    }
+
+    template<Fixed_String Name, typename Type>
+    struct Field {
+        static constexpr std::string_view name = Name.view();
+
+        using domain = Type;
+        using type = typename Type::type;
+    };
+
+    /**
+     * # Table with the schema known at compile time.
+     *
+     * ```cpp
+     * Typed_Table<Field<"uk", typed::Key>, Field<"name", typed::Str>, Field<"level", typed::U8>> users { domains };
+     *
+     * auto row = users.append();
+     * row.get<"name">() = "Vasya";
+     * row.get<"level">() = 3;
+     *
+     * for (size_t i = 0; i < users.size(); i++) sum += users[i].get<"level">();
+     *
+     * planner.add_table("Users", users.table());
+     * ```
+     *
+     * Offsets of the fields are computed at compile time and accessors are
+     * plain references into the rows, without `Domain` dispatch and checks.
+     * Rows are stored in the runtime `Table` of the same layout, so queries
+     * read the same data.
+     **/
+    template<typename... Fields>
+    class Typed_Table {
+        public:
+            static constexpr size_t Fields_Count = sizeof...(Fields);
+
+            static constexpr std::array<size_t, Fields_Count> Sizes { sizeof(typename Fields::type)... };
+
+            static constexpr std::array<size_t, Fields_Count> Offsets = [] {
+                std::array<size_t, Fields_Count> ret { };
+                for (size_t i = 1; i < Fields_Count; i++) ret[i] = ret[i - 1] + Sizes[i - 1];
+                return ret;
+            }();
+
+            static constexpr size_t Row_Size = Fields_Count ? Offsets[Fields_Count - 1] + Sizes[Fields_Count - 1] : 0;
+
+            /**
+             * Idx of the field by the name.
+             **/
+            template<Fixed_String Name>
+            static constexpr size_t idx_of(void) {
+                constexpr std::array<std::string_view, Fields_Count> names { Fields::name... };
+
+                size_t ret = 0;
+                while (ret < Fields_Count && names[ret] != Name.view()) ret++;
+                return ret;
+            }
+
+            template<size_t Idx>
+            using type_of = typename std::tuple_element_t<Idx, std::tuple<Fields...>>::type;
+
+            class Schema_Mismatch: public Toad_Exception {
+                public:
+                    Schema_Mismatch(std::string_view field, size_t size, size_t expected):
+                        Toad_Exception("Typed field `" + std::string(field) + "` is of " + std::to_string(size)
+                                        + " bytes, but its domain is of " + std::to_string(expected) + " bytes") { }
+            };
+
+            /**
+             * Row of the table, valid until the rows are appended.
+             **/
+            template<bool Const>
+            class Basic_Row {
+                using Data = std::conditional_t<Const, const types::U8*, types::U8*>;
+
+                template<typename Type>
+                using Ref = std::conditional_t<Const, const Type&, Type&>;
+
+                public:
+                    explicit Basic_Row(Data data): _data(data) { }
+
+                    template<size_t Idx>
+                    Ref<type_of<Idx>> get(void) const {
+                        static_assert(Idx < Fields_Count, "no such field");
+                        return *(std::conditional_t<Const, const type_of<Idx>*, type_of<Idx>*>)(_data + Offsets[Idx]);
+                    }
+
+                    template<Fixed_String Name>
+                    decltype(auto) get(void) const {
+                        return get<idx_of<Name>()>();
+                    }
+
+                    Data data(void) const { return _data; }
+
+                private:
+                    Data _data;
+            };
+
+            using Row = Basic_Row<false>;
+            using Const_Row = Basic_Row<true>;
+
+            /**
+             * Runtime table of the fields with the domains of the same names.
+             *
+             * @throws Domain::Domains::Invalid_Domain_Name if there is no such domain.
+             * @throws Schema_Mismatch if layout of the domain differs from the typed one.
+             **/
+            explicit Typed_Table(Domain::Domains &domains) noexcept(false): _table(columns(domains)) { }
+
+            /**
+             * Runtime table, it can be registered for the queries.
+             **/
+            Table& table(void) { return _table; }
+            const Table& table(void) const { return _table; }
+
+            size_t size(void) const { return _table.size(); }
+
+            Row operator[](size_t idx) { return Row { _table.row_data(idx) }; }
+            Const_Row operator[](size_t idx) const { return Const_Row { _table.row_data(idx) }; }
+
+            /**
+             * Append zeroed row.
+             **/
+            Row append(void) {
+                types::U8 *data = _table.append_rows(1);
+                std::memset(data, 0, Row_Size);
+                return Row { data };
+            }
+
+            /**
+             * Append rows with the values of the fields in the order.
+             **/
+            template<typename... Values>
+            Row append(Values&&... values) {
+                static_assert(sizeof...(Values) == Fields_Count, "values of all fields are expected");
+
+                Row ret = append();
+                set(ret, std::index_sequence_for<Values...> { }, std::forward<Values>(values)...);
+                return ret;
+            }
+
+        private:
+            Table _table;
+
+            static std::vector<Table::Column_Field> columns(Domain::Domains &domains) noexcept(false) {
+                std::vector<Table::Column_Field> ret;
+
+                size_t idx = 0;
+                ((ret.push_back({ std::string(Fields::name), &domains(std::string(Fields::domain::domain_name)) }),
+                  check(Fields::name, Sizes[idx++], ret.back().domain->size_of())), ...);
+
+                return ret;
+            }
+
+            static void check(std::string_view field, size_t size, size_t expected) noexcept(false) {
+                if (size != expected) throw Schema_Mismatch(field, size, expected);
+            }
+
+            template<size_t... Idxs, typename... Values>
+            static void set(Row row, std::index_sequence<Idxs...>, Values&&... values) {
+                ((row.template get<Idxs>() = std::forward<Values>(values)), ...);
+            }
+    };
+}
+
+#endif // typed_table_hpp_INCLUDED
@@ -0,0 +1,770 @@
+#include <bloom.hpp>
+#include <charconv>
+#include <cmath>
+#include <compression.hpp>
+#include <limits>
+#include <vectorized.hpp>
+#include <zone_map.hpp>
+
+namespace toad_db::interact::vectorized {
+    using namespace types;
+    using bytecode::Type;
+    using bytecode::Value;
+
+    Compare flip(Compare compare) {
+        switch (compare) {
+        case Compare::Lt: return Compare::Gt;
+        case Compare::Le: return Compare::Ge;
+        case Compare::Gt: return Compare::Lt;
+        case Compare::Ge: return Compare::Le;
+        default:          return compare;
+        }
+    }
+
+    template<typename T>
+    static void gather(const Table &table, size_t offset, size_t begin, size_t count, T *out) {
+        const U8 *row = table.row_data(begin) + offset;
+        const size_t row_size = table.row_size();
+
+        for (size_t i = 0; i < count; i++, row += row_size) {
+            std::memcpy(out + i, row, sizeof(T));
+        }
+    }
+
+    void extract(const Table &table, size_t column, size_t begin, size_t count, Column_Vector &out) {
+        const Domain *domain = table.columns().at(column).domain;
+        const size_t offset = table.column_offset(column);
+
+        out.variant = domain->variant;
+        out.count = count;
+
+        switch (domain->variant) {
+        case Domain::Variant::U8:   gather(table, offset, begin, count, out.as<U8>());  break;
+        case Domain::Variant::U16:  gather(table, offset, begin, count, out.as<U16>()); break;
+        case Domain::Variant::U32:  gather(table, offset, begin, count, out.as<U32>()); break;
+        case Domain::Variant::U64:  gather(table, offset, begin, count, out.as<U64>()); break;
+        case Domain::Variant::I8:   gather(table, offset, begin, count, out.as<I8>());  break;
+        case Domain::Variant::I16:  gather(table, offset, begin, count, out.as<I16>()); break;
+        case Domain::Variant::I32:  gather(table, offset, begin, count, out.as<I32>()); break;
+        case Domain::Variant::I64:  gather(table, offset, begin, count, out.as<I64>()); break;
+        case Domain::Variant::F32:  gather(table, offset, begin, count, out.as<F32>()); break;
+        case Domain::Variant::F64:  gather(table, offset, begin, count, out.as<F64>()); break;
+        case Domain::Variant::Bool: gather(table, offset, begin, count, out.as<U8>());  break;
+        default:
+            throw Not_Basic_Column(domain->domain_name);
+        }
+    }
+
+
+    /**
+     * Convert constant to the type of the column.
+     *
+     * @return false if the constant is out of range of `T`, then `result`
+     *         is the result of comparison for every value.
+     **/
+    template<typename T>
+    static bool fit_constant(Value constant, Type type, Compare compare, T &out, bool &result) {
+        if constexpr (std::is_floating_point_v<T>) {
+            out = type == Type::Float ? (T)constant.f
+                : type == Type::Int   ? (T)constant.i : (T)constant.u;
+            return true;
+        } else {
+            using Limits = std::numeric_limits<T>;
+            bool below = false, above = false;
+
+            if (type == Type::Float) {
+                /* NaN and not integral constants are equal to no value. */
+                F64 f = constant.f;
+                if (std::isnan(f) || (std::isfinite(f) && f != std::trunc(f))) {
+                    result = compare == Compare::Ne;
+                    if (std::isnan(f) || compare == Compare::Eq || compare == Compare::Ne) return false;
+
+                    /* `a < 1.5` is `a < 2`, `a <= 1.5` is `a <= 1`. */
+                    f = compare == Compare::Lt || compare == Compare::Ge ? std::ceil(f) : std::floor(f);
+                }
+
+                /* Bounds are powers of two, so they are exact in F64 (`max() + 1` isn't). */
+                const F64 lo = std::is_signed_v<T> ? -std::ldexp(1.0, Limits::digits) : 0.0;
+                const F64 hi = std::ldexp(1.0, Limits::digits);
+                below = f < lo;
+                above = f >= hi;
+                if (!below && !above) out = (T)f;
+            } else if (type == Type::Int) {
+                if constexpr (std::is_signed_v<T>) {
+                    below = constant.i < (I64)Limits::min();
+                    above = constant.i > (I64)Limits::max();
+                } else {
+                    below = constant.i < 0;
+                    above = constant.i >= 0 && (U64)constant.i > (U64)Limits::max();
+                }
+                out = (T)constant.i;
+            } else {
+                above = constant.u > (U64)Limits::max();
+                out = (T)constant.u;
+            }
+
+            if (!below && !above) return true;
+
+            switch (compare) {
+            case Compare::Eq: result = false; break;
+            case Compare::Ne: result = true;  break;
+            case Compare::Lt:
+            case Compare::Le: result = above; break;
+            case Compare::Gt:
+            case Compare::Ge: result = below; break;
+            }
+            return false;
+        }
+    }
+
+    /**
+     * Set first `count` bits of the bitmap to `value`, other bits are zero.
+     **/
+    static void fill(U64 *bitmap, size_t count, bool value) {
+        const size_t words = simd::bitmap_words(count);
+        std::memset(bitmap, value ? 0xFF : 0, words * sizeof(U64));
+        if (value && count % 64) bitmap[words - 1] = (1ull << (count % 64)) - 1;
+    }
+
+    template<typename T>
+    static void compare_const_as(const Column_Vector &values, Compare compare,
+                                 Value constant, Type type, U64 *bitmap) {
+        T fitted { };
+        bool result = false;
+
+        if (!fit_constant<T>(constant, type, compare, fitted, result)) {
+            fill(bitmap, values.count, result);
+            return;
+        }
+        simd::compare_const<T>(values.as<T>(), values.count, compare, fitted, bitmap);
+    }
+
+    void compare_const(const Column_Vector &values, Compare compare, Value constant, Type type, U64 *bitmap) {
+        switch (values.variant) {
+        case Domain::Variant::U8:   compare_const_as<U8>(values, compare, constant, type, bitmap);  break;
+        case Domain::Variant::U16:  compare_const_as<U16>(values, compare, constant, type, bitmap); break;
+        case Domain::Variant::U32:  compare_const_as<U32>(values, compare, constant, type, bitmap); break;
+        case Domain::Variant::U64:  compare_const_as<U64>(values, compare, constant, type, bitmap); break;
+        case Domain::Variant::I8:   compare_const_as<I8>(values, compare, constant, type, bitmap);  break;
+        case Domain::Variant::I16:  compare_const_as<I16>(values, compare, constant, type, bitmap); break;
+        case Domain::Variant::I32:  compare_const_as<I32>(values, compare, constant, type, bitmap); break;
+        case Domain::Variant::I64:  compare_const_as<I64>(values, compare, constant, type, bitmap); break;
+        case Domain::Variant::F32:  compare_const_as<F32>(values, compare, constant, type, bitmap); break;
+        case Domain::Variant::F64:  compare_const_as<F64>(values, compare, constant, type, bitmap); break;
+        case Domain::Variant::Bool: compare_const_as<U8>(values, compare, constant, type, bitmap);  break;
+        default:
+            throw Domain::Invalid_Variant_Value(values.variant);
+        }
+    }
+
+    template<typename T>
+    static bool to_value_as(Value constant, Type type, U8 *out) {
+        T value { };
+        bool result = false;
+
+        if (!fit_constant<T>(constant, type, Compare::Eq, value, result)) return false;
+        std::memcpy(out, &value, sizeof(T));
+        return true;
+    }
+
+    bool to_value(Domain::Variant variant, Value constant, Type type, U8 *out) {
+        switch (variant) {
+        case Domain::Variant::U8:   return to_value_as<U8>(constant, type, out);
+        case Domain::Variant::U16:  return to_value_as<U16>(constant, type, out);
+        case Domain::Variant::U32:  return to_value_as<U32>(constant, type, out);
+        case Domain::Variant::U64:  return to_value_as<U64>(constant, type, out);
+        case Domain::Variant::I8:   return to_value_as<I8>(constant, type, out);
+        case Domain::Variant::I16:  return to_value_as<I16>(constant, type, out);
+        case Domain::Variant::I32:  return to_value_as<I32>(constant, type, out);
+        case Domain::Variant::I64:  return to_value_as<I64>(constant, type, out);
+        case Domain::Variant::Bool: return to_value_as<U8>(constant, type, out);
+        default:                    return false;
+        }
+    }
+
+    Range_Match compare_range(const Column_Vector &bounds, Compare compare, Value constant, Type type) {
+        // NaN is not ordered, comparisons with it aren't monotonic.
+        if (bounds.variant == Domain::Variant::F32 && (std::isnan(bounds.as<F32>()[0]) || std::isnan(bounds.as<F32>()[1])))
+            return Range_Match::Some;
+        if (bounds.variant == Domain::Variant::F64 && (std::isnan(bounds.as<F64>()[0]) || std::isnan(bounds.as<F64>()[1])))
+            return Range_Match::Some;
+
+        if (compare == Compare::Eq || compare == Compare::Ne) {
+            U64 le = 0, ge = 0;
+            compare_const(bounds, Compare::Le, constant, type, &le);
+            compare_const(bounds, Compare::Ge, constant, type, &ge);
+
+            // Constant is out of `[min, max]`, or it's the only value of the range.
+            const bool outside = !(le & 1) || !(ge & 2), single = (le & 2) && (ge & 1);
+            if (outside) return compare == Compare::Eq ? Range_Match::None : Range_Match::All;
+            if (single) return compare == Compare::Eq ? Range_Match::All : Range_Match::None;
+            return Range_Match::Some;
+        }
+
+        // Ordered comparison is monotonic, so results of the bounds are results of all values.
+        U64 result = 0;
+        compare_const(bounds, compare, constant, type, &result);
+        if ((result & 1) != (result >> 1 & 1)) return Range_Match::Some;
+        return result ? Range_Match::All : Range_Match::None;
+    }
+
+    void compare(const Column_Vector &lhs, const Column_Vector &rhs, Compare compare, U64 *bitmap) {
+        if (lhs.variant != rhs.variant) throw Domain::Invalid_Variant_Value(rhs.variant);
+
+        const size_t count = std::min(lhs.count, rhs.count);
+
+        switch (lhs.variant) {
+        case Domain::Variant::U8:   simd::compare<U8>(lhs.as<U8>(), rhs.as<U8>(), count, compare, bitmap); break;
+        case Domain::Variant::U16:  simd::compare<U16>(lhs.as<U16>(), rhs.as<U16>(), count, compare, bitmap); break;
+        case Domain::Variant::U32:  simd::compare<U32>(lhs.as<U32>(), rhs.as<U32>(), count, compare, bitmap); break;
+        case Domain::Variant::U64:  simd::compare<U64>(lhs.as<U64>(), rhs.as<U64>(), count, compare, bitmap); break;
+        case Domain::Variant::I8:   simd::compare<I8>(lhs.as<I8>(), rhs.as<I8>(), count, compare, bitmap); break;
+        case Domain::Variant::I16:  simd::compare<I16>(lhs.as<I16>(), rhs.as<I16>(), count, compare, bitmap); break;
+        case Domain::Variant::I32:  simd::compare<I32>(lhs.as<I32>(), rhs.as<I32>(), count, compare, bitmap); break;
+        case Domain::Variant::I64:  simd::compare<I64>(lhs.as<I64>(), rhs.as<I64>(), count, compare, bitmap); break;
+        case Domain::Variant::F32:  simd::compare<F32>(lhs.as<F32>(), rhs.as<F32>(), count, compare, bitmap); break;
+        case Domain::Variant::F64:  simd::compare<F64>(lhs.as<F64>(), rhs.as<F64>(), count, compare, bitmap); break;
+        case Domain::Variant::Bool: simd::compare<U8>(lhs.as<U8>(), rhs.as<U8>(), count, compare, bitmap); break;
+        default:
+            throw Domain::Invalid_Variant_Value(lhs.variant);
+        }
+    }
+
+
+    using Node = Batch_Filter::Node;
+
+    static const Node::pointer& unwrap(const Node::pointer &node) {
+        if (node->kind == Node::Kind::Expression && node->args.size() == 1)
+            return unwrap(node->args[0]);
+
+        if (node->kind == Node::Kind::Bound_Operator && node->name == "(" && node->args.size() == 2)
+            return unwrap(node->args[0]);
+
+        return node;
+    }
+
+    static bool to_compare(std::string_view name, Compare &compare) {
+        static const std::pair<std::string_view, Compare> compares[] = {
+            { "==", Compare::Eq }, { "!=", Compare::Ne }, { "<", Compare::Lt },
+            { "<=", Compare::Le }, { ">", Compare::Gt }, { ">=", Compare::Ge },
+        };
+
+        for (auto &[op, value]: compares) {
+            if (op == name) {
+                compare = value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Get constant of the literal node (numbers, chars and bools).
+     **/
+    static bool to_constant(const Node::pointer &node, Value &value) {
+        std::string_view text = node->name;
+
+        switch (node->kind) {
+        case Node::Kind::Num_Literal: {
+            if (text.starts_with("+")) text.remove_prefix(1);
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value.i);
+            return error == std::errc { } && end == text.data() + text.size();
+        }
+        case Node::Kind::Char_Literal:
+            if (text.size() < 3) return false;
+            value.i = text[1];
+            return true;
+        case Node::Kind::Name:
+            if (text != "true" && text != "false") return false;
+            value.i = text == "true";
+            return node->args.size() == 0;
+        default:
+            return false;
+        }
+    }
+
+    Batch_Filter::Batch_Filter(const Table &table, const Node::pointer &predicate,
+                               Segments segments):
+        _table(table), _compressed(segments.compressed), _zones(segments.zones), _blooms(segments.blooms) {
+
+        compile(predicate, 0);
+
+        _compared_only.assign(_columns.size(), true);
+        for (auto &step: _steps) {
+            if (step.kind == Step::Compare_Columns) _compared_only[step.lhs] = _compared_only[step.rhs] = false;
+        }
+    }
+
+    size_t Batch_Filter::use_column(size_t column) {
+        auto it = std::find(_columns.begin(), _columns.end(), column);
+        if (it != _columns.end()) return it - _columns.begin();
+
+        _columns.push_back(column);
+        return _columns.size() - 1;
+    }
+
+    void Batch_Filter::compile(const Node::pointer &node, size_t depth) {
+        auto &unwrapped = unwrap(node);
+        _max_depth = std::max(_max_depth, depth + 1);
+
+        if (unwrapped->kind == Node::Kind::Operator && unwrapped->args.size() == 2
+            && (unwrapped->name == "&&" || unwrapped->name == "||")) {
+
+            compile(unwrapped->args[0], depth);
+            compile(unwrapped->args[1], depth + 1);
+            _steps.push_back({ unwrapped->name == "&&" ? Step::And : Step::Or });
+            return;
+        }
+
+        if (compile_compare(unwrapped)) return;
+
+        Value value;
+        if (to_constant(unwrapped, value) && unwrapped->kind == Node::Kind::Name) {
+            Step step { Step::Fill };
+            step.value = value.i != 0;
+            _steps.push_back(step);
+            return;
+        }
+
+        auto program = bytecode::Compiler { _table }.compile(unwrapped);
+        if (program.result_type != Type::Bool)
+            throw bytecode::Unsupported_Expression(unwrapped->name, "predicate must be Bool");
+
+        std::vector<size_t> params;
+        for (auto &param: program.params) params.push_back(use_param(param.name, param.type));
+        _program_params.push_back(std::move(params));
+
+        _programs.push_back(std::make_unique<bytecode::Program>(std::move(program)));
+
+        Step step { Step::Row_Program };
+        step.lhs = _programs.size() - 1;
+        step.key = string_key(unwrapped, step.compare, step.key_column);
+        _steps.push_back(step);
+    }
+
+    std::string Batch_Filter::string_key(const Node::pointer &node, Compare &compare, size_t &column) const {
+        if (node->kind != Node::Kind::Operator || node->args.size() != 2 || !to_compare(node->name, compare)
+            || (compare != Compare::Eq && compare != Compare::Ne))
+            return { };
+
+        auto *name = &unwrap(node->args[0]), *literal = &unwrap(node->args[1]);
+        if ((*name)->kind == Node::Kind::Str_Literal) std::swap(name, literal);
+        if ((*name)->kind != Node::Kind::Name || (*name)->args.size() != 0 || (*literal)->kind != Node::Kind::Str_Literal)
+            return { };
+
+        const auto &columns = _table.columns();
+        auto it = std::find_if(columns.begin(), columns.end(), [&](auto &field) { return field.name == (*name)->name; });
+        if (it == columns.end() || it->dictionary || !it->domain->is_string()) return { };
+
+        const std::string_view text = (*literal)->name;
+        const size_t capacity = it->domain->array.capacity;
+        if (text.size() < 2 || text.size() - 2 > capacity) return { };
+
+        std::vector<U8> value(it->domain->size_of());
+        Domain::set_counter(value.data(), capacity, text.size() - 2);
+        std::memcpy(value.data() + Domain::counter_size_of(capacity), text.data() + 1, text.size() - 2);
+
+        column = it - columns.begin();
+        return std::string(Segment_Blooms::key_of(*it->domain, value.data()));
+    }
+
+    bool Batch_Filter::compile_compare(const Node::pointer &node) {
+        Compare compare;
+        if (node->kind != Node::Kind::Operator || node->args.size() != 2
+            || !to_compare(node->name, compare))
+            return false;
+
+        if (compile_encoded(node, compare)) return true;
+
+        /* Idx of the basic column or -1. */
+        const auto column_of = [&](const Node::pointer &operand) -> std::ptrdiff_t {
+            if (operand->kind != Node::Kind::Name || operand->args.size() != 0) return -1;
+
+            const auto &columns = _table.columns();
+            for (size_t i = 0; i < columns.size(); i++) {
+                if (columns[i].name == operand->name)
+                    return Domain::is_basic(columns[i].domain->variant) && !columns[i].dictionary ? (std::ptrdiff_t)i : -1;
+            }
+            return -1;
+        };
+
+        auto &lhs = unwrap(node->args[0]), &rhs = unwrap(node->args[1]);
+        const std::ptrdiff_t lhs_column = column_of(lhs), rhs_column = column_of(rhs);
+
+        /* Parameter compared with the numeric column, it's type is the type of the column. */
+        const auto is_param = [&](const Node::pointer &operand, std::ptrdiff_t column) {
+            if (operand->kind != Node::Kind::Name || !operand->name.starts_with("$") || column < 0) return false;
+
+            const auto variant = _table.columns()[column].domain->variant;
+            return Domain::is_uint(variant) || Domain::is_sint(variant) || Domain::is_float(variant);
+        };
+
+        if (is_param(lhs, rhs_column) || is_param(rhs, lhs_column)) {
+            const bool flipped = lhs_column < 0;
+            const std::ptrdiff_t column = flipped ? rhs_column : lhs_column;
+            const auto variant = _table.columns()[column].domain->variant;
+
+            Step step { Step::Compare_Const };
+            step.compare = flipped ? flip(compare) : compare;
+            step.lhs = use_column(column);
+            step.constant_type = Domain::is_uint(variant) ? Type::Uint
+                                 : Domain::is_sint(variant) ? Type::Int : Type::Float;
+            step.param = use_param((flipped ? lhs : rhs)->name, step.constant_type);
+            _steps.push_back(step);
+            return true;
+        }
+
+        Value constant;
+        if (lhs_column >= 0 && rhs_column >= 0) {
+            if (_table.columns()[lhs_column].domain->variant != _table.columns()[rhs_column].domain->variant)
+                return false;
+
+            Step step { Step::Compare_Columns };
+            step.compare = compare;
+            step.lhs = use_column(lhs_column);
+            step.rhs = use_column(rhs_column);
+            _steps.push_back(step);
+            return true;
+        }
+
+        if (lhs_column < 0 && rhs_column >= 0 && to_constant(lhs, constant)) {
+            Step step { Step::Compare_Const };
+            step.compare = flip(compare);
+            step.lhs = use_column(rhs_column);
+            step.constant = constant;
+            _steps.push_back(step);
+            return true;
+        }
+
+        if (lhs_column >= 0 && rhs_column < 0 && to_constant(rhs, constant)) {
+            Step step { Step::Compare_Const };
+            step.compare = compare;
+            step.lhs = use_column(lhs_column);
+            step.constant = constant;
+            _steps.push_back(step);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool Batch_Filter::compile_encoded(const Node::pointer &node, Compare compare) {
+        const auto &columns = _table.columns();
+
+        /* Idx of the column or -1. */
+        const auto column_of = [&](const Node::pointer &operand) -> std::ptrdiff_t {
+            if (operand->kind != Node::Kind::Name || operand->args.size() != 0) return -1;
+
+            for (size_t i = 0; i < columns.size(); i++) {
+                if (columns[i].name == operand->name) return i;
+            }
+            return -1;
+        };
+
+        auto *lhs = &unwrap(node->args[0]), *rhs = &unwrap(node->args[1]);
+        std::ptrdiff_t lhs_column = column_of(*lhs), rhs_column = column_of(*rhs);
+
+        if (rhs_column >= 0 && columns[rhs_column].dictionary && (lhs_column < 0 || !columns[lhs_column].dictionary)) {
+            std::swap(lhs, rhs);
+            std::swap(lhs_column, rhs_column);
+            compare = flip(compare);
+        }
+        if (lhs_column < 0 || !columns[lhs_column].dictionary) return false;
+
+        if (compare != Compare::Eq && compare != Compare::Ne)
+            throw bytecode::Unsupported_Expression(node->name, "dictionary-encoded column is only compared by `==` and `!=`");
+
+        const Dictionary &dictionary = *columns[lhs_column].dictionary;
+
+        if (rhs_column >= 0) {
+            if (columns[rhs_column].dictionary == columns[lhs_column].dictionary) {
+                Step step { Step::Compare_Columns };
+                step.compare = compare;
+                step.lhs = use_column(lhs_column);
+                step.rhs = use_column(rhs_column);
+                _steps.push_back(step);
+                return true;
+            }
+
+            const Domain &rhs_domain = columns[rhs_column].dictionary ? *columns[rhs_column].dictionary->domain()
+                                                                       : *columns[rhs_column].domain;
+            if (!Domain::is_competible(*dictionary.domain(), rhs_domain) || dictionary.domain()->size_of() != rhs_domain.size_of())
+                throw bytecode::Unsupported_Expression(node->name, "values of the columns are of incompetible domains");
+
+            Step step { Step::Compare_Values };
+            step.compare = compare;
+            step.lhs = lhs_column;
+            step.rhs = rhs_column;
+            _steps.push_back(step);
+            return true;
+        }
+
+        if ((*rhs)->kind != Node::Kind::Str_Literal || (*rhs)->name.size() < 2 || !dictionary.domain()->is_string())
+            throw bytecode::Unsupported_Expression(node->name, "dictionary-encoded column is compared with the string or the other column");
+
+        const std::string_view text = (*rhs)->name;
+        const auto code = dictionary.find(text.substr(1, text.size() - 2));
+
+        /* Value isn't in the dictionary, so it's in no row. */
+        if (!code) {
+            Step step { Step::Fill };
+            step.value = compare == Compare::Ne;
+            _steps.push_back(step);
+            return true;
+        }
+
+        Step step { Step::Compare_Const };
+        step.compare = compare;
+        step.lhs = use_column(lhs_column);
+        step.constant.u = *code;
+        step.constant_type = Type::Uint;
+        _steps.push_back(step);
+        return true;
+    }
+
+    size_t Batch_Filter::use_param(std::string_view name, Type type) {
+        for (size_t i = 0; i < _params.size(); i++) {
+            if (_params[i].name != name) continue;
+
+            if (_params[i].type != type)
+                throw bytecode::Unsupported_Expression(name, "parameter is used as " + bytecode::to_string(_params[i].type)
+                                                             + " and as " + bytecode::to_string(type));
+            return i;
+        }
+
+        _params.push_back(bytecode::Param { std::string(name), type });
+        return _params.size() - 1;
+    }
+
+    Batch_Filter::Scratch Batch_Filter::make_scratch(std::span<const bytecode::Argument> args) const {
+        if (args.size() < _params.size()) throw bytecode::Unbound_Param(_params[args.size()].name);
+
+        Scratch scratch { };
+        scratch.columns.resize(_columns.size());
+        scratch.bitmaps.resize(_max_depth);
+        scratch.args.assign(args.begin(), args.end());
+
+        for (size_t i = 0; i < _programs.size(); i++) {
+            std::vector<bytecode::Argument> program_args;
+            for (auto param: _program_params[i]) program_args.push_back(args[param]);
+
+            scratch.vms.emplace_back(*_programs[i], program_args);
+        }
+        return scratch;
+    }
+
+    size_t Batch_Filter::filter_batch(Scratch &scratch, size_t begin, size_t count, U32 *selection) const {
+        const bool compressed = _compressed && _compressed->covers(begin, count);
+
+        for (size_t i = 0; i < _columns.size(); i++) {
+            if (!compressed) extract(_table, _columns[i], begin, count, scratch.columns[i]);
+            else if (!_compared_only[i]) _compressed->decompress(_columns[i], begin, count, scratch.columns[i]);
+        }
+
+        size_t top = 0;
+        for (auto &step: _steps) {
+            switch (step.kind) {
+            case Step::Compare_Const: {
+                const Value constant = step.param == Step::No_Param ? step.constant : scratch.args[step.param].value;
+
+                if (compressed) {
+                    _compressed->compare_const(_columns[step.lhs], begin, count, step.compare, constant,
+                                               step.constant_type, scratch.bitmaps[top++].data());
+                } else {
+                    compare_const(scratch.columns[step.lhs], step.compare, constant, step.constant_type,
+                                  scratch.bitmaps[top++].data());
+                }
+            } break;
+
+            case Step::Compare_Columns:
+                compare(scratch.columns[step.lhs], scratch.columns[step.rhs],
+                        step.compare, scratch.bitmaps[top++].data());
+                break;
+
+            case Step::Compare_Values: {
+                const auto &lhs = _table.columns()[step.lhs], &rhs = _table.columns()[step.rhs];
+                const size_t lhs_offset = _table.column_offset(step.lhs), rhs_offset = _table.column_offset(step.rhs);
+                const size_t size = lhs.dictionary->domain()->size_of();
+
+                U64 *bitmap = scratch.bitmaps[top++].data();
+                fill(bitmap, count, false);
+                for (size_t i = 0; i < count; i++) {
+                    const U8 *row = _table.row_data(begin + i);
+                    const U8 *rhs_value = rhs.dictionary ? rhs.dictionary->value(rhs.dictionary->code_at(row + rhs_offset)).data
+                                                         : row + rhs_offset;
+
+                    const bool equal = std::memcmp(lhs.dictionary->value(lhs.dictionary->code_at(row + lhs_offset)).data,
+                                                   rhs_value, size) == 0;
+                    bitmap[i / 64] |= (U64)(equal == (step.compare == Compare::Eq)) << (i % 64);
+                }
+            } break;
+
+            case Step::Row_Program: {
+                auto &vm = scratch.vms[step.lhs];
+                U64 *bitmap = scratch.bitmaps[top++].data();
+                fill(bitmap, count, false);
+                for (size_t i = 0; i < count; i++)
+                    bitmap[i / 64] |= (U64)vm.test(_table.row_data(begin + i)) << (i % 64);
+            } break;
+
+            case Step::Fill:
+                fill(scratch.bitmaps[top++].data(), count, step.value);
+                break;
+
+            case Step::And: {
+                top--;
+                U64 *lhs = scratch.bitmaps[top - 1].data(), *rhs = scratch.bitmaps[top].data();
+                for (size_t i = 0; i < simd::bitmap_words(count); i++) lhs[i] &= rhs[i];
+            } break;
+
+            case Step::Or: {
+                top--;
+                U64 *lhs = scratch.bitmaps[top - 1].data(), *rhs = scratch.bitmaps[top].data();
+                for (size_t i = 0; i < simd::bitmap_words(count); i++) lhs[i] |= rhs[i];
+            } break;
+            }
+        }
+
+        return simd::bitmap_to_selection(scratch.bitmaps[0].data(), count, selection);
+    }
+
+    void Batch_Filter::filter(Scratch &scratch, size_t begin, size_t end, std::vector<size_t> &out) const {
+        U32 selection[Batch_Size];
+
+        for (size_t batch = begin; batch < end; batch += Batch_Size) {
+            const size_t count = std::min(Batch_Size, end - batch);
+            const size_t selected = filter_batch(scratch, batch, count, selection);
+
+            for (size_t i = 0; i < selected; i++) out.push_back(batch + selection[i]);
+        }
+    }
+
+    Range_Match Batch_Filter::match_block(size_t block, bool zones, std::span<const bytecode::Argument> args,
+                                          Bloom_Check &bloom) const {
+        std::vector<Range_Match> stack;
+        Column_Vector bounds;
+
+        /* Equality of the value of the column by the Bloom filter of the block. */
+        const auto check = [&](size_t column, std::string_view key, Compare compare, Range_Match &match) {
+            if (!_blooms || !_blooms->has(column) || block >= _blooms->sealed(column)) return;
+
+            if (_blooms->may_contain(block, column, key)) {
+                if (bloom == Bloom_Check::None) bloom = Bloom_Check::Maybe;
+                return;
+            }
+
+            bloom = Bloom_Check::Absent;
+            match = compare == Compare::Eq ? Range_Match::None : Range_Match::All;
+        };
+
+        for (auto &step: _steps) {
+            switch (step.kind) {
+            case Step::Compare_Const: {
+                const size_t column = _columns[step.lhs];
+                const Value constant = step.param == Step::No_Param ? step.constant : args[step.param].value;
+                Range_Match match = Range_Match::Some;
+
+                if (zones && _zones->has(column)) {
+                    _zones->bounds(block, column, bounds);
+                    match = compare_range(bounds, step.compare, constant, step.constant_type);
+                }
+
+                U8 value[sizeof(U64)];
+                Domain &domain = *_table.columns()[column].domain;
+                if (match == Range_Match::Some && (step.compare == Compare::Eq || step.compare == Compare::Ne)
+                    && to_value(domain.variant, constant, step.constant_type, value))
+                    check(column, Segment_Blooms::key_of(domain, value), step.compare, match);
+
+                stack.push_back(match);
+            } break;
+
+            case Step::Row_Program: {
+                Range_Match match = Range_Match::Some;
+                if (step.key_column != Step::No_Column) check(step.key_column, step.key, step.compare, match);
+                stack.push_back(match);
+            } break;
+
+            case Step::Fill:
+                stack.push_back(step.value ? Range_Match::All : Range_Match::None);
+                break;
+
+            case Step::And: {
+                const Range_Match rhs = stack.back();
+                stack.pop_back();
+                if (rhs == Range_Match::None || stack.back() == Range_Match::None) stack.back() = Range_Match::None;
+                else if (rhs != Range_Match::All || stack.back() != Range_Match::All) stack.back() = Range_Match::Some;
+            } break;
+
+            case Step::Or: {
+                const Range_Match rhs = stack.back();
+                stack.pop_back();
+                if (rhs == Range_Match::All || stack.back() == Range_Match::All) stack.back() = Range_Match::All;
+                else if (rhs != Range_Match::None || stack.back() != Range_Match::None) stack.back() = Range_Match::Some;
+            } break;
+
+            default:
+                stack.push_back(Range_Match::Some);
+                break;
+            }
+        }
+
+        return stack[0];
+    }
+
+    std::vector<size_t> Batch_Filter::filter(Engine &engine, std::span<const bytecode::Argument> args, Stats *stats) const {
+        std::vector<std::vector<size_t>> selected(Engine::split(_table.size()).size());
+
+        // Checked there, not by the first morsel.
+        if (args.size() < _params.size()) throw bytecode::Unbound_Param(_params[args.size()].name);
+
+        // Blocks with all their rows in the zone map, and sealed ones with the Bloom filters.
+        static_assert(Zone_Map::Block_Rows % Engine::Morsel_Rows == 0 && Zone_Map::Block_Rows == Table::Segment_Rows);
+
+        size_t zoned = 0;
+        if (_zones && _zones->rows() <= _table.size())
+            zoned = _zones->rows() == _table.size() ? _zones->blocks() : _zones->rows() / Zone_Map::Block_Rows;
+
+        size_t mapped = zoned;
+        for (size_t column = 0; _blooms && column < _table.columns().size(); column++) {
+            if (_blooms->has(column))
+                mapped = std::max(mapped, std::min(_blooms->sealed(column), _table.size() / Table::Segment_Rows));
+        }
+
+        std::vector<Range_Match> blocks(mapped);
+        std::vector<Bloom_Check> blooms(mapped, Bloom_Check::None);
+        for (size_t i = 0; i < blocks.size(); i++) blocks[i] = match_block(i, i < zoned, args, blooms[i]);
+
+        engine.for_each_morsel(_table.size(), [&](size_t, size_t idx, Engine::Morsel morsel) {
+            const size_t block = morsel.begin / Zone_Map::Block_Rows;
+            const Range_Match match = block < blocks.size() ? blocks[block] : Range_Match::Some;
+
+            if (match == Range_Match::None) return;
+            if (match == Range_Match::All) {
+                for (size_t row = morsel.begin; row < morsel.end; row++) selected[idx].push_back(row);
+                return;
+            }
+
+            auto scratch = make_scratch(args);
+            filter(scratch, morsel.begin, morsel.end, selected[idx]);
+        });
+
+        auto ret = Engine::concat(selected);
+        if (!stats) return ret;
+
+        stats->blocks += blocks.size();
+        for (size_t i = 0; i < blocks.size(); i++) {
+            stats->skipped_blocks += blocks[i] == Range_Match::None;
+            stats->whole_blocks += blocks[i] == Range_Match::All;
+            if (blooms[i] == Bloom_Check::None) continue;
+
+            stats->bloom_blocks++;
+            stats->bloom_skipped_blocks += blooms[i] == Bloom_Check::Absent && blocks[i] == Range_Match::None;
+
+            // Selected rows are in ascending order.
+            const auto first = std::lower_bound(ret.begin(), ret.end(), i * Zone_Map::Block_Rows);
+            stats->bloom_false_positives += blooms[i] == Bloom_Check::Maybe
+                                            && (first == ret.end() || *first >= (i + 1) * Zone_Map::Block_Rows);
+        }
+        return ret;
+    }
+}
@@ -0,0 +1,338 @@
+#ifndef vectorized_hpp_INCLUDED
+#define vectorized_hpp_INCLUDED
+
+#include <array>
+#include <bytecode.hpp>
+#include <common.hpp>
+#include <interpreter.hpp>
+#include <memory>
+#include <simd.hpp>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace toad_db::interact {
+
+    namespace compression {
+        class Compressed_Segments;
+    }
+
+    class Segment_Blooms;
+    class Zone_Map;
+
+    /**
+     * # Vectorized evaluation.
+     *
+     * Rows of the table are stored row by row, so values of one column are
+     * strided and the loops over them can't be vectorized. There values of the
+     * columns are extracted batch by batch to the contiguous typed vectors,
+     * and the comparisons are done by SIMD kernels over the whole batch
+     * (@see simd):
+     *
+     * ```
+     *  rows:        | key level title | key level title | ...
+     *  extract:     level  = [ 2, 1, 0, 0, ... ]          (U8 x Batch_Size)
+     *  compare > 1: bitmap = 0b...0001                    (Batch_Size bits)
+     *  selection:   [ 0, ... ]                            (U32 idxs in batch)
+     * ```
+     **/
+    namespace vectorized {
+        /**
+         * Count of rows processed by one kernel call.
+         **/
+        constexpr size_t Batch_Size = 1024;
+
+        /**
+         * Result of the kernel, one bit per row of the batch.
+         **/
+        using Bitmap = std::array<types::U64, simd::bitmap_words(Batch_Size)>;
+
+        using Compare = simd::Compare;
+
+        /**
+         * Compare with swapped operands (`c < a` is `a > c`).
+         **/
+        Compare flip(Compare compare);
+
+        /**
+         * Values of one basic column for the rows of the batch.
+         **/
+        struct Column_Vector {
+            Domain::Variant variant;
+            size_t count = 0;
+            alignas(64) types::U8 data[Batch_Size * sizeof(types::U64)];
+
+            template<typename T>
+            T* as(void) { return (T*)data; }
+
+            template<typename T>
+            const T* as(void) const { return (const T*)data; }
+        };
+
+        class Not_Basic_Column: public Toad_Exception {
+            public:
+                Not_Basic_Column(const std::string &domain):
+                    Toad_Exception("Only columns of basic domains can be vectorized, but get `" + domain + "`") { }
+        };
+
+        /**
+         * Extract values of the column.
+         *
+         * @param table - source table.
+         * @param column - idx of the basic column.
+         * @param begin - first row.
+         * @param count - count of rows (at most Batch_Size).
+         * @param out - vector to fill.
+         * @throws Not_Basic_Column if column is not of basic domain.
+         **/
+        void extract(const Table &table, size_t column, size_t begin, size_t count,
+                     Column_Vector &out) noexcept(false);
+
+        /**
+         * Typed kernels for every basic variant.
+         * Bit `i` of the bitmap is `values[i] <compare> constant`.
+         *
+         * Constant is given as register of the bytecode, it's converted
+         * to the type of the column once per call. If constant doesn't fit into
+         * the type, bitmap is filled by the result known without comparison.
+         **/
+        void compare_const(const Column_Vector &values, Compare compare,
+                           bytecode::Value constant, bytecode::Type type, types::U64 *bitmap);
+
+        /**
+         * Constant as the value of the basic variant it's equal to by `==`.
+         *
+         * @param out - bytes of the value.
+         * @return false if the constant isn't equal to exactly one value of the
+         *         variant by bytes, floats never are (`-0.0 == 0.0`).
+         **/
+        bool to_value(Domain::Variant variant, bytecode::Value constant, bytecode::Type type, types::U8 *out);
+
+        /**
+         * Result of the comparison known for all values in the range.
+         **/
+        enum class Range_Match: char {
+            None, Some, All
+        };
+
+        /**
+         * Result of `value <compare> constant` for every value in `[min, max]`.
+         *
+         * @param bounds - vector of two values, `min` and `max`.
+         * @return None or All if the result is the same for all values of the range, else Some
+         *         (always for the bounds with NaN).
+         **/
+        Range_Match compare_range(const Column_Vector &bounds, Compare compare,
+                                  bytecode::Value constant, bytecode::Type type);
+
+        /**
+         * Bit `i` is `lhs[i] <compare> rhs[i]`, vectors must be of the same variant.
+         **/
+        void compare(const Column_Vector &lhs, const Column_Vector &rhs,
+                     Compare compare, types::U64 *bitmap);
+
+        /**
+         * # Batch filter.
+         *
+         * Predicate compiled to the steps over bitmaps. Comparisons of the
+         * basic columns with constants or with other columns of the same variant
+         * are evaluated by the typed kernels. `&&` and `||` are combining the bitmaps.
+         * All other subexpressions (strings, enums, arithmetic) are evaluated
+         * row by row by bytecode @see bytecode::Vm.
+         *
+         * Batches of the sealed segments are read from the compressed
+         * segments if they are given (@see compression::Compressed_Segments),
+         * comparisons with constants are evaluated on the compressed values.
+         *
+         * Blocks of the zone map (@see Zone_Map) are skipped if the predicate
+         * is false for the bounds of the block, and are taken as is if
+         * it's true, so only the blocks on the edge of the range are filtered.
+         * Equalities with constants (`name == "j.doe"`, `uk == 5`) skip the
+         * sealed segments by their Bloom filters (@see Segment_Blooms).
+         *
+         * Dictionary-encoded columns (@see Dictionary) are compared by the
+         * codes: the string literal is looked up once, then `title == "admin"`
+         * is the kernel over the codes. Columns of different dictionaries
+         * are compared by the decoded values.
+         *
+         * ```cpp
+         * Batch_Filter filter { table, tree->parse_call("gk == uk && level > 1").root };
+         * auto rows = filter.filter(engine);
+         * ```
+         **/
+        class Batch_Filter {
+            public:
+                using Node = bytecode::Compiler::Node;
+
+                /**
+                 * Side structures of the table, not given ones are nullptr.
+                 * They must outlive the filter.
+                 **/
+                struct Segments {
+                    const compression::Compressed_Segments *compressed;
+                    const Zone_Map *zones;
+                    const Segment_Blooms *blooms;
+                };
+
+                /**
+                 * Blocks of the zone map and segments of the Bloom filters seen by the filter.
+                 **/
+                struct Stats {
+                    size_t blocks = 0;
+
+                    /**
+                     * Blocks without rows of the predicate, they aren't read.
+                     **/
+                    size_t skipped_blocks = 0;
+
+                    /**
+                     * Blocks with all rows selected by the bounds.
+                     **/
+                    size_t whole_blocks = 0;
+
+                    /**
+                     * Blocks checked by the Bloom filters and skipped by them.
+                     **/
+                    size_t bloom_blocks = 0, bloom_skipped_blocks = 0;
+
+                    /**
+                     * Checked blocks which are read, but have no selected rows.
+                     **/
+                    size_t bloom_false_positives = 0;
+                };
+
+                Batch_Filter(const Table &table, const Node::pointer &predicate,
+                             Segments segments = { }) noexcept(false);
+
+                /**
+                 * Buffers of the evaluation, one per thread.
+                 **/
+                struct Scratch {
+                    std::vector<Column_Vector> columns;
+                    std::vector<Bitmap> bitmaps;
+                    std::vector<bytecode::Vm> vms;
+
+                    /**
+                     * Bound arguments of the parameters.
+                     **/
+                    std::vector<bytecode::Argument> args;
+                };
+
+                /**
+                 * Parameters (`$name`) of the predicate, arguments are given in this order.
+                 **/
+                const std::vector<bytecode::Param>& params(void) const { return _params; }
+
+                /**
+                 * @param args - values of the parameters.
+                 * @throws bytecode::Unbound_Param if there are less arguments than parameters.
+                 **/
+                Scratch make_scratch(std::span<const bytecode::Argument> args = { }) const noexcept(false);
+
+                /**
+                 * Filter one batch of rows.
+                 *
+                 * @param scratch - buffers.
+                 * @param begin - first row of the batch.
+                 * @param count - count of rows (at most Batch_Size).
+                 * @param selection - idxs of selected rows in the batch.
+                 * @return count of selected rows.
+                 **/
+                size_t filter_batch(Scratch &scratch, size_t begin, size_t count,
+                                    types::U32 *selection) const;
+
+                /**
+                 * Filter the rows `[begin, end)`.
+                 *
+                 * @param out - idxs of selected rows are appended there.
+                 **/
+                void filter(Scratch &scratch, size_t begin, size_t end, std::vector<size_t> &out) const;
+
+                /**
+                 * Filter the whole table in parallel.
+                 *
+                 * @param stats - blocks of the zone map are counted there, may be nullptr.
+                 * @return idxs of selected rows in ascending order.
+                 **/
+                std::vector<size_t> filter(Engine &engine, std::span<const bytecode::Argument> args = { },
+                                           Stats *stats = nullptr) const;
+
+            private:
+                struct Step {
+                    enum Kind {
+                        Compare_Const, Compare_Columns, Compare_Values, Row_Program, Fill, And, Or
+                    } kind;
+
+                    Compare compare = Compare::Eq;
+
+                    /* idxs in columns (.columns) or programs, idxs of the table columns for Compare_Values. */
+                    size_t lhs = 0, rhs = 0;
+
+                    bytecode::Value constant { };
+                    bytecode::Type constant_type = bytecode::Type::Int;
+
+                    /* For Fill. */
+                    bool value = false;
+
+                    /* For Compare_Const with parameter instead of constant, idx in params. */
+                    static constexpr size_t No_Param = (size_t)-1;
+                    size_t param = No_Param;
+
+                    /* For Row_Program of `column == "string"`: idx of the table column and the key of the string. */
+                    static constexpr size_t No_Column = (size_t)-1;
+                    size_t key_column = No_Column;
+                    std::string key;
+                };
+
+                const Table &_table;
+                const compression::Compressed_Segments *_compressed;
+                const Zone_Map *_zones;
+                const Segment_Blooms *_blooms;
+
+                /* Steps in postfix order, each step pushes one bitmap (And, Or pop two). */
+                std::vector<Step> _steps;
+
+                /* Columns which are extracted for every batch. */
+                std::vector<size_t> _columns;
+
+                /* Column is only compared with constants, it's not decompressed for such comparisons. */
+                std::vector<bool> _compared_only;
+                std::vector<std::unique_ptr<bytecode::Program>> _programs;
+                size_t _max_depth = 0;
+
+                std::vector<bytecode::Param> _params;
+
+                /* Idxs in params of the parameters of every program. */
+                std::vector<std::vector<size_t>> _program_params;
+
+                void compile(const Node::pointer &node, size_t depth);
+                bool compile_compare(const Node::pointer &node);
+                bool compile_encoded(const Node::pointer &node, Compare compare);
+                size_t use_column(size_t column);
+                size_t use_param(std::string_view name, bytecode::Type type);
+
+                /**
+                 * Bloom filters of the block: not checked, the value of some equality
+                 * is absent, or all checked values may be there.
+                 **/
+                enum class Bloom_Check: char {
+                    None, Absent, Maybe
+                };
+
+                /**
+                 * Result of the predicate for the bounds and the Bloom filters of the block.
+                 *
+                 * @param zones - block has all its rows in the zone map.
+                 **/
+                Range_Match match_block(size_t block, bool zones, std::span<const bytecode::Argument> args,
+                                        Bloom_Check &bloom) const;
+
+                /**
+                 * Key of the string compared with the column by the program or empty.
+                 **/
+                std::string string_key(const Node::pointer &node, Compare &compare, size_t &column) const;
+        };
+    }
+}
+
+#endif // vectorized_hpp_INCLUDED
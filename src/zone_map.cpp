@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <zone_map.hpp>
+
+namespace toad_db::interact {
+    using namespace types;
+
+    template<typename T>
+    static void extend(const Table &table, size_t offset, size_t begin, size_t end, Zone_Map::Bounds &bounds) {
+        T min { }, max { };
+        std::memcpy(&min, &bounds.min, sizeof(T));
+        std::memcpy(&max, &bounds.max, sizeof(T));
+
+        for (size_t row = begin; row < end; row++) {
+            T value;
+            std::memcpy(&value, table.row_data(row) + offset, sizeof(T));
+
+            // NaN is not ordered, so it's not in the bounds.
+            if constexpr (std::is_floating_point_v<T>) {
+                if (std::isnan(value)) {
+                    bounds.nan = true;
+                    continue;
+                }
+            }
+
+            min = bounds.empty ? value : std::min(min, value);
+            max = bounds.empty ? value : std::max(max, value);
+            bounds.empty = false;
+        }
+
+        std::memcpy(&bounds.min, &min, sizeof(T));
+        std::memcpy(&bounds.max, &max, sizeof(T));
+    }
+
+    static void extend(Domain::Variant variant, const Table &table, size_t offset, size_t begin, size_t end,
+                       Zone_Map::Bounds &bounds) {
+        switch (variant) {
+        case Domain::Variant::U16: extend<U16>(table, offset, begin, end, bounds); break;
+        case Domain::Variant::U32: extend<U32>(table, offset, begin, end, bounds); break;
+        case Domain::Variant::U64: extend<U64>(table, offset, begin, end, bounds); break;
+        case Domain::Variant::I8:  extend<I8>(table, offset, begin, end, bounds);  break;
+        case Domain::Variant::I16: extend<I16>(table, offset, begin, end, bounds); break;
+        case Domain::Variant::I32: extend<I32>(table, offset, begin, end, bounds); break;
+        case Domain::Variant::I64: extend<I64>(table, offset, begin, end, bounds); break;
+        case Domain::Variant::F32: extend<F32>(table, offset, begin, end, bounds); break;
+        case Domain::Variant::F64: extend<F64>(table, offset, begin, end, bounds); break;
+        default:                   extend<U8>(table, offset, begin, end, bounds);  break;
+        }
+    }
+
+    Zone_Map::Zone_Map(const Table &table): _table(&table) {
+        for (auto &column: table.columns()) _basic.push_back(Domain::is_basic(column.domain->variant));
+    }
+
+    void Zone_Map::update(void) {
+        const size_t columns = _basic.size();
+
+        while (_rows < _table->size()) {
+            const size_t block = _rows / Block_Rows;
+            const size_t end = std::min(_table->size(), (block + 1) * Block_Rows);
+            _bounds.resize((block + 1) * columns);
+
+            for (size_t i = 0; i < columns; i++) {
+                if (!_basic[i]) continue;
+                extend(_table->columns()[i].domain->variant, *_table, _table->column_offset(i), _rows, end,
+                       _bounds[block * columns + i]);
+            }
+            _rows = end;
+        }
+    }
+
+    void Zone_Map::rebuild(void) {
+        _rows = 0;
+        _bounds.clear();
+        update();
+    }
+
+    void Zone_Map::bounds(size_t block, size_t column, vectorized::Column_Vector &out) const {
+        const Domain *domain = _table->columns()[column].domain;
+        const size_t size = domain->size_of();
+        const auto &bounds = _bounds[block * _basic.size() + column];
+
+        out.variant = domain->variant;
+        out.count = 2;
+        std::memcpy(out.data, &bounds.min, size);
+        std::memcpy(out.data + size, &bounds.max, size);
+
+        // Result of the comparison isn't known for the block with NaN (@see vectorized::compare_range).
+        if (bounds.nan && domain->variant == Domain::Variant::F32)
+            out.as<F32>()[0] = out.as<F32>()[1] = std::numeric_limits<F32>::quiet_NaN();
+        if (bounds.nan && domain->variant == Domain::Variant::F64)
+            out.as<F64>()[0] = out.as<F64>()[1] = std::numeric_limits<F64>::quiet_NaN();
+    }
+}
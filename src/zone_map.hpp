@@ -0,0 +1,83 @@
+#ifndef zone_map_hpp_INCLUDED
+#define zone_map_hpp_INCLUDED
+
+#include <common.hpp>
+#include <vector>
+#include <vectorized.hpp>
+
+namespace toad_db::interact {
+
+    /**
+     * # Zone map of the table.
+     *
+     * Min and max of every basic column for every block of `Block_Rows`
+     * rows. Filter skips the blocks where the predicate can't be true by
+     * the bounds of the columns (@see vectorized::Batch_Filter), so `ts >= X`
+     * over the append-ordered time stamps reads only the blocks after `X`:
+     *
+     * ```
+     *  block:   0             1             2             3
+     *  ts:      [100, 180]    [181, 260]    [261, 330]    [331, 400]
+     *  ts >= 300:  skipped       skipped       filtered      all rows
+     * ```
+     *
+     * Like the statistics (@see plan::Table_Statistics) the map takes only
+     * rows appended since the previous `update`, the bounds of the last
+     * block are extended by them.
+     **/
+    class Zone_Map {
+        public:
+            static constexpr size_t Block_Rows = Table::Segment_Rows;
+
+            /**
+             * Table must outlive the map.
+             **/
+            explicit Zone_Map(const Table &table);
+
+            /**
+             * Take rows appended since the last update.
+             **/
+            void update(void);
+
+            /**
+             * Rebuild the map of all rows after rows were changed in place.
+             **/
+            void rebuild(void);
+
+            /**
+             * Count of rows taken into the map.
+             **/
+            size_t rows(void) const { return _rows; }
+
+            size_t blocks(void) const { return (_rows + Block_Rows - 1) / Block_Rows; }
+
+            /**
+             * Bounds of the column are kept, it's of basic domain.
+             **/
+            bool has(size_t column) const { return _basic[column]; }
+
+            /**
+             * Min and max of the column in the block as the vector of two values,
+             * both are NaN if there is NaN in the block.
+             **/
+            void bounds(size_t block, size_t column, vectorized::Column_Vector &out) const;
+
+            /**
+             * Bounds as the bytes of the values, NaNs are not in them.
+             **/
+            struct Bounds {
+                types::U64 min = 0, max = 0;
+                bool empty = true, nan = false;
+            };
+
+        private:
+            const Table *_table;
+            size_t _rows = 0;
+            std::vector<bool> _basic;
+
+            /* Bounds of every column of every block. */
+            std::vector<Bounds> _bounds;
+    };
+}
+
+#endif // zone_map_hpp_INCLUDED